@@ -1,10 +1,75 @@
 #pragma once
-#include <vector>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
+
+// Where captured audio comes from
+enum class CaptureBackend {
+    Alsa,       // ALSA PCM in mmap mode (falls back to Arecord when built without ALSA)
+    Arecord,    // arecord child process read through a pipe
+    WavReplay   // 16-bit PCM WAV file, for tests and offline runs
+};
+
+struct CaptureConfig {
+    CaptureBackend backend = CaptureBackend::Alsa;
+    std::string device = "default";  // ALSA PCM name (Alsa backend)
+    int periods = 4;                  // Periods in the ALSA ring buffer
+    std::string replayPath;           // WAV file (WavReplay backend)
+    bool replayRealtime = true;       // Pace replay at the sample rate; false delivers as fast as popped, dropping nothing
+
+    // Chunk buffers are allocated once, at start(), and recycled
+    size_t queueChunks = 64;          // Captured chunks held for the consumer; when full the oldest is dropped
+    size_t leaseChunks = 4;           // AudioChunk leases the consumer may hold without forcing drops
+};
+
+struct AudioChunkInfo {
+    std::chrono::steady_clock::time_point timestamp;  // Capture time of the first sample
+    uint64_t framePosition = 0;                        // Frames captured before this chunk
+    bool hardwareTimestamp = false;                    // From the sound card rather than taken on arrival
+};
+
+class AudioChunkPool;
+
+// Lease on a captured chunk: the buffer stays valid until the lease is released or
+// destroyed, then returns to the streamer's pool. Move-only; may outlive the streamer.
+class AudioChunk {
+public:
+    AudioChunk() = default;
+    AudioChunk(AudioChunk&& other) noexcept;
+    AudioChunk& operator=(AudioChunk&& other) noexcept;
+    ~AudioChunk();
+
+    AudioChunk(const AudioChunk&) = delete;
+    AudioChunk& operator=(const AudioChunk&) = delete;
+
+    const short* data() const { return mData; }
+    size_t size() const { return mSize; }  // Interleaved samples
+    const short* begin() const { return mData; }
+    const short* end() const { return mData + mSize; }
+    const AudioChunkInfo& info() const { return mInfo; }
+    explicit operator bool() const { return mData != nullptr; }
+
+    // Return the buffer to the pool now
+    void release();
+
+private:
+    friend class AudioStreamer;
+
+    std::shared_ptr<AudioChunkPool> mPool;
+    size_t mSlot = 0;
+    const short* mData = nullptr;
+    size_t mSize = 0;
+    AudioChunkInfo mInfo;
+};
 
 class AudioStreamer {
 public:
-    AudioStreamer(size_t chunkSizeMs = 10, int sampleRate = 16000, int channels = 1);
+    // With the Alsa backend the chunk is one ALSA period, as close to chunkSizeMs as the
+    // hardware allows; WavReplay takes rate and channels from the file.
+    AudioStreamer(size_t chunkSizeMs = 10, int sampleRate = 16000, int channels = 1,
+                  const CaptureConfig& capture = CaptureConfig());
     ~AudioStreamer();
 
     void start();
@@ -13,9 +78,27 @@ public:
     // Blocking: waits until data is available or stopped
     bool popChunk(std::vector<short>& outChunk);
 
+    // As above, also returning when and where in the stream the chunk was captured
+    bool popChunk(std::vector<short>& outChunk, AudioChunkInfo& info);
+
+    // The vector variants swap outChunk with the pooled buffer, so a caller that reuses
+    // one vector does not allocate. This one hands out the pooled buffer itself.
+    bool popChunk(AudioChunk& outChunk);
+
     // Check if the streamer is currently running
     bool isRunning() const;
 
+    // Actual capture format, known once start() has opened the device or file
+    int getSampleRate() const;
+    int getChannels() const;
+    size_t getChunkFrames() const;
+
+    // Capture overruns the backend recovered from (audio was lost)
+    uint64_t getOverruns() const;
+
+    // Chunks dropped because the consumer fell behind (queue full or every buffer leased)
+    uint64_t getDroppedChunks() const;
+
 private:
     class Impl;                  // Forward declaration
     std::unique_ptr<Impl> mImpl;  // Pimpl pointer
@@ -0,0 +1,417 @@
+#include "OggOpusReader.h"
+
+#include <ogg/ogg.h>
+#include <opus.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace opus {
+
+namespace {
+
+constexpr long kReadBytes = 64 * 1024;
+
+uint32_t getLe32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 |
+           static_cast<uint32_t>(p[3]) << 24;
+}
+
+} // namespace
+
+class OggOpusReader::Impl {
+public:
+    explicit Impl(const std::string& path)
+        : mPath(path)
+        , mFd(-1)
+        , mFileSize(0)
+        , mSyncOffset(0)
+        , mStreamInit(false)
+        , mSerial(0)
+        , mChannels(0)
+        , mInputSampleRate(0)
+        , mPreSkip(0)
+        , mDataOffset(0)
+        , mEndGranule(0)
+        , mQueueSize(0)
+        , mQueueNext(0)
+        , mLastGranule(0)
+        , mHaveLastGranule(false)
+        , mEos(false)
+        , mDiscardPage(false)
+    {
+        mFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (mFd < 0) {
+            throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+        }
+        ogg_sync_init(&mSync);
+        try {
+            struct stat st;
+            if (fstat(mFd, &st) != 0) {
+                throw std::runtime_error("Failed to stat " + path + ": " + std::strerror(errno));
+            }
+            mFileSize = st.st_size;
+            readHeaders();
+            findEndGranule();
+            rewind(mDataOffset);
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    ~Impl() { release(); }
+
+    bool readPacket(OggOpusPacket& packet) {
+        while (mQueueNext == mQueueSize) {
+            if (!loadPage()) {
+                return false;
+            }
+        }
+        const Queued& queued = mQueue[mQueueNext++];
+        packet.data.assign(queued.data.begin(), queued.data.end());
+        packet.startSample = queued.start - mPreSkip;
+        packet.durationSamples = queued.duration;
+        return true;
+    }
+
+    // Start at the last page that ends before the pre-rolled target. Its packets are
+    // dropped; reading it only recovers the packet continued onto the next page,
+    // which begins at that page's granule.
+    void seek(int64_t sample) {
+        const int64_t target = sample + mPreSkip - kSeekPreRollSamples;
+        ogg_page page;
+        int64_t offset = 0;
+
+        int64_t lo = mDataOffset;
+        int64_t hi = mFileSize;
+        while (hi - lo > kReadBytes) {
+            int64_t mid = lo + (hi - lo) / 2;
+            rewind(mid);
+            int64_t granule = -1;
+            while (nextPage(page, &offset) && offset < hi) {
+                if (ogg_page_serialno(&page) == mSerial && (granule = ogg_page_granulepos(&page)) >= 0) {
+                    break;
+                }
+            }
+            if (granule >= 0 && offset < hi && granule < target) {
+                lo = offset;
+            } else {
+                hi = mid;
+            }
+        }
+
+        // Pages from lo on, up to the first one reaching the target
+        rewind(lo);
+        int64_t start = mDataOffset;
+        bool discard = false;
+        while (nextPage(page, &offset)) {
+            int64_t granule = ogg_page_granulepos(&page);
+            if (ogg_page_serialno(&page) != mSerial || granule < 0) {
+                continue;
+            }
+            if (granule >= target) {
+                break;
+            }
+            start = offset;
+            discard = true;
+        }
+
+        rewind(start);
+        mDiscardPage = discard;
+    }
+
+    int getChannels() const { return mChannels; }
+    int getInputSampleRate() const { return mInputSampleRate; }
+    int getPreSkip() const { return static_cast<int>(mPreSkip); }
+    const std::string& getVendor() const { return mVendor; }
+    const std::vector<std::string>& getComments() const { return mComments; }
+    int64_t getDurationSamples() const { return std::max<int64_t>(0, mEndGranule - mPreSkip); }
+
+private:
+    struct Queued {
+        std::vector<uint8_t> data;
+        int64_t start;
+        int duration;
+    };
+
+    std::string mPath;
+    int mFd;
+    int64_t mFileSize;
+    ogg_sync_state mSync;
+    int64_t mSyncOffset;  // File offset of the next byte ogg_sync_pageseek() examines
+    ogg_stream_state mStream;
+    bool mStreamInit;
+    int mSerial;
+
+    int mChannels;
+    int mInputSampleRate;
+    int64_t mPreSkip;
+    std::string mVendor;
+    std::vector<std::string> mComments;
+    int64_t mDataOffset;  // First audio page
+    int64_t mEndGranule;
+
+    // Packets completed on the current page; entries are reused between pages
+    std::vector<Queued> mQueue;
+    size_t mQueueSize;
+    size_t mQueueNext;
+    int64_t mLastGranule;
+    bool mHaveLastGranule;
+    bool mEos;
+    bool mDiscardPage;  // Set by seek() for the page before the one it targets
+
+    void release() {
+        if (mStreamInit) {
+            ogg_stream_clear(&mStream);
+            mStreamInit = false;
+        }
+        ogg_sync_clear(&mSync);
+        if (mFd >= 0) {
+            ::close(mFd);
+            mFd = -1;
+        }
+    }
+
+    bool readChunk() {
+        char* buffer = ogg_sync_buffer(&mSync, kReadBytes);
+        ssize_t bytes;
+        do {
+            bytes = ::read(mFd, buffer, kReadBytes);
+        } while (bytes < 0 && errno == EINTR);
+        if (bytes < 0) {
+            throw std::runtime_error("Failed to read " + mPath + ": " + std::strerror(errno));
+        }
+        ogg_sync_wrote(&mSync, static_cast<long>(bytes));
+        return bytes > 0;
+    }
+
+    bool nextPage(ogg_page& page, int64_t* offset) {
+        while (true) {
+            long result = ogg_sync_pageseek(&mSync, &page);
+            if (result < 0) {
+                mSyncOffset -= result;  // Skipped bytes that are not a page
+            } else if (result > 0) {
+                if (offset) {
+                    *offset = mSyncOffset;
+                }
+                mSyncOffset += result;
+                return true;
+            } else if (!readChunk()) {
+                return false;
+            }
+        }
+    }
+
+    void rewind(int64_t offset) {
+        if (::lseek(mFd, offset, SEEK_SET) < 0) {
+            throw std::runtime_error("Failed to seek in " + mPath + ": " + std::strerror(errno));
+        }
+        ogg_sync_reset(&mSync);
+        mSyncOffset = offset;
+        ogg_stream_reset(&mStream);
+        mQueueSize = 0;
+        mQueueNext = 0;
+        mHaveLastGranule = false;
+        mEos = false;
+        mDiscardPage = false;
+    }
+
+    // Next complete packet of our stream during header parsing
+    bool headerPacket(ogg_packet& packet) {
+        ogg_page page;
+        while (ogg_stream_packetout(&mStream, &packet) != 1) {
+            if (!nextPage(page, nullptr)) {
+                return false;
+            }
+            if (ogg_page_serialno(&page) == mSerial) {
+                ogg_stream_pagein(&mStream, &page);
+            }
+        }
+        return true;
+    }
+
+    void readHeaders() {
+        ogg_page page;
+        if (!nextPage(page, nullptr) || !ogg_page_bos(&page)) {
+            throw std::runtime_error(mPath + " is not an Ogg file");
+        }
+        mSerial = ogg_page_serialno(&page);
+        ogg_stream_init(&mStream, mSerial);
+        mStreamInit = true;
+        ogg_stream_pagein(&mStream, &page);
+
+        ogg_packet packet;
+        if (!headerPacket(packet) || packet.bytes < 19 || std::memcmp(packet.packet, "OpusHead", 8) != 0) {
+            throw std::runtime_error(mPath + " has no OpusHead header");
+        }
+        const unsigned char* head = packet.packet;
+        if ((head[8] & 0xf0) != 0) {
+            throw std::runtime_error(mPath + ": unsupported Ogg Opus version " + std::to_string(head[8]));
+        }
+        mChannels = head[9];
+        mPreSkip = head[10] | head[11] << 8;
+        mInputSampleRate = static_cast<int>(getLe32(head + 12));
+
+        if (!headerPacket(packet) || packet.bytes < 16 || std::memcmp(packet.packet, "OpusTags", 8) != 0) {
+            throw std::runtime_error(mPath + " has no OpusTags header");
+        }
+        parseTags(packet.packet, static_cast<size_t>(packet.bytes));
+
+        // OpusTags ends its page, so audio starts on the next one
+        mDataOffset = mSyncOffset;
+    }
+
+    void parseTags(const unsigned char* data, size_t bytes) {
+        size_t pos = 8;
+        auto readString = [&](std::string& out) {
+            if (pos + 4 > bytes) {
+                return false;
+            }
+            uint32_t length = getLe32(data + pos);
+            pos += 4;
+            if (length > bytes - pos) {
+                return false;
+            }
+            out.assign(reinterpret_cast<const char*>(data + pos), length);
+            pos += length;
+            return true;
+        };
+        if (!readString(mVendor) || pos + 4 > bytes) {
+            throw std::runtime_error(mPath + ": malformed OpusTags header");
+        }
+        uint32_t count = getLe32(data + pos);
+        pos += 4;
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string comment;
+            if (!readString(comment)) {
+                throw std::runtime_error(mPath + ": malformed OpusTags header");
+            }
+            mComments.push_back(std::move(comment));
+        }
+    }
+
+    // The last granule position sits in one of the final pages
+    void findEndGranule() {
+        for (int64_t tail = kReadBytes;; tail *= 2) {
+            int64_t from = std::max(mDataOffset, mFileSize - tail);
+            rewind(from);
+            ogg_page page;
+            bool found = false;
+            while (nextPage(page, nullptr)) {
+                if (ogg_page_serialno(&page) == mSerial && ogg_page_granulepos(&page) >= 0) {
+                    mEndGranule = ogg_page_granulepos(&page);
+                    found = true;
+                }
+            }
+            if (found || from == mDataOffset) {
+                return;
+            }
+        }
+    }
+
+    bool loadPage() {
+        ogg_page page;
+        do {
+            if (mEos || !nextPage(page, nullptr)) {
+                return false;
+            }
+        } while (ogg_page_serialno(&page) != mSerial);
+        ogg_stream_pagein(&mStream, &page);
+
+        mQueueSize = 0;
+        mQueueNext = 0;
+        ogg_packet packet;
+        int result;
+        while ((result = ogg_stream_packetout(&mStream, &packet)) != 0) {
+            if (result < 0) {
+                continue;  // Lost data: the next packet is complete again
+            }
+            if (mQueueSize == mQueue.size()) {
+                mQueue.emplace_back();
+            }
+            Queued& queued = mQueue[mQueueSize++];
+            queued.data.assign(packet.packet, packet.packet + packet.bytes);
+            int samples = opus_packet_get_nb_samples(packet.packet, static_cast<opus_int32>(packet.bytes), 48000);
+            queued.duration = std::max(samples, 0);
+        }
+
+        int64_t granule = ogg_page_granulepos(&page);
+        mEos = ogg_page_eos(&page) != 0;
+        if (mQueueSize == 0 || granule < 0) {
+            return true;
+        }
+
+        // A lone end-of-stream page holding more audio than its granule started at granule 0
+        // (RFC 7845 section 4); otherwise it would be counted back past the stream start
+        int64_t pageSamples = 0;
+        for (size_t i = 0; i < mQueueSize; ++i) {
+            pageSamples += mQueue[i].duration;
+        }
+        if (mEos && (mHaveLastGranule || pageSamples > granule)) {
+            // The end may fall inside the last packet: count forward and trim
+            int64_t start = mHaveLastGranule ? mLastGranule : 0;
+            for (size_t i = 0; i < mQueueSize; ++i) {
+                mQueue[i].start = start;
+                mQueue[i].duration = static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(mQueue[i].duration, granule - start)));
+                start += mQueue[i].duration;
+            }
+        } else {
+            int64_t end = granule;
+            for (size_t i = mQueueSize; i-- > 0;) {
+                mQueue[i].start = end - mQueue[i].duration;
+                end = mQueue[i].start;
+            }
+        }
+        mLastGranule = granule;
+        mHaveLastGranule = true;
+        if (mDiscardPage) {
+            mDiscardPage = false;
+            mQueueSize = 0;
+        }
+        return true;
+    }
+};
+
+OggOpusReader::OggOpusReader(const std::string& path) : mImpl(std::make_unique<Impl>(path)) {}
+
+OggOpusReader::~OggOpusReader() = default;
+
+bool OggOpusReader::readPacket(OggOpusPacket& packet) {
+    return mImpl->readPacket(packet);
+}
+
+void OggOpusReader::seek(int64_t sample) {
+    mImpl->seek(sample);
+}
+
+int OggOpusReader::getChannels() const {
+    return mImpl->getChannels();
+}
+
+int OggOpusReader::getInputSampleRate() const {
+    return mImpl->getInputSampleRate();
+}
+
+int OggOpusReader::getPreSkip() const {
+    return mImpl->getPreSkip();
+}
+
+const std::string& OggOpusReader::getVendor() const {
+    return mImpl->getVendor();
+}
+
+const std::vector<std::string>& OggOpusReader::getComments() const {
+    return mImpl->getComments();
+}
+
+int64_t OggOpusReader::getDurationSamples() const {
+    return mImpl->getDurationSamples();
+}
+
+} // namespace opus
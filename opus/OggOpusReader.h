@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace opus {
+
+/// One Opus packet with its place on the playback timeline
+struct OggOpusPacket {
+    std::vector<uint8_t> data;
+    /// First sample at 48 kHz, pre-skip removed (negative while inside the pre-skip)
+    int64_t startSample = 0;
+    /// Samples at 48 kHz to play; the final packet is cut to the stream end
+    int durationSamples = 0;
+};
+
+/**
+ * @brief Streams Opus packets out of an Ogg Opus file (RFC 7845)
+ *
+ * Pages are read through one file descriptor in large chunks. Packet times come
+ * from the page granule positions: counted back from the page end, or forward
+ * from the previous page on the end-of-stream page, where the last packet is
+ * trimmed. An end-of-stream page that is also the first audio page counts from
+ * granule 0 when its granule falls inside its own packets. Only the first
+ * logical stream of the file is read.
+ */
+class OggOpusReader {
+public:
+    /// Audio to decode before a seek target so the decoder has converged (RFC 7845)
+    static constexpr int kSeekPreRollSamples = 3840;
+
+    /**
+     * @brief Open the file and parse the OpusHead and OpusTags headers
+     * @param path Ogg Opus file
+     * @throws std::runtime_error if the file cannot be read or is not Ogg Opus
+     */
+    explicit OggOpusReader(const std::string& path);
+    ~OggOpusReader();
+
+    OggOpusReader(const OggOpusReader&) = delete;
+    OggOpusReader& operator=(const OggOpusReader&) = delete;
+
+    /**
+     * @brief Read the next packet
+     * @param packet Receives the packet; its data buffer is reused
+     * @return false at the end of the stream (or of a truncated file)
+     * @throws std::runtime_error on a read error
+     */
+    bool readPacket(OggOpusPacket& packet);
+
+    /**
+     * @brief Position the reader for playback from sample
+     *
+     * Bisects the file on page granule positions. The next packet then starts at
+     * least kSeekPreRollSamples before sample; decode and discard up to sample.
+     *
+     * @param sample Target at 48 kHz on the playback timeline
+     * @throws std::runtime_error on a read error
+     */
+    void seek(int64_t sample);
+
+    int getChannels() const;
+    int getInputSampleRate() const;
+    int getPreSkip() const;  ///< At 48 kHz
+    const std::string& getVendor() const;
+    const std::vector<std::string>& getComments() const;
+
+    /// Playback length at 48 kHz, from the last granule position in the file
+    int64_t getDurationSamples() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
+} // namespace opus
@@ -0,0 +1,275 @@
+#include "OggOpusWriter.h"
+
+#include <ogg/ogg.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace opus {
+
+namespace {
+
+constexpr int64_t kGranuleRate = 48000;  // Ogg Opus granule positions are always 48 kHz
+
+void putLe16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void putLe32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void putString(std::vector<uint8_t>& out, const std::string& value) {
+    putLe32(out, static_cast<uint32_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+} // namespace
+
+class OggOpusWriter::Impl {
+public:
+    Impl(const std::string& path, const OggOpusWriterOptions& options)
+        : mOptions(options)
+        , mFd(-1)
+        , mClosed(false)
+        , mPacketNo(0)
+        , mGranule(0)
+        , mPageEndGranule(mGranule)
+        , mMaxPageGranules(static_cast<int64_t>(options.maxPageDurationMs) * kGranuleRate / 1000)
+        , mHavePending(false)
+        , mPendingGranules(0)
+    {
+        if (options.channels < 1 || options.channels > 2) {
+            throw std::invalid_argument("Ogg Opus channel mapping family 0 holds 1 or 2 channels, got " +
+                                        std::to_string(options.channels));
+        }
+
+        mFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (mFd < 0) {
+            throw std::runtime_error("Failed to create " + path + ": " + std::strerror(errno));
+        }
+        ogg_stream_init(&mStream, static_cast<int>(std::random_device()() & 0x7fffffff));
+        try {
+            mBuffer.reserve(options.bufferBytes);
+            writeHeaders();
+        } catch (...) {
+            ogg_stream_clear(&mStream);
+            ::close(mFd);
+            throw;
+        }
+    }
+
+    ~Impl() {
+        try {
+            close(-1);
+        } catch (const std::exception& e) {
+            std::cerr << "OggOpusWriter: " << e.what() << std::endl;
+        }
+        ogg_stream_clear(&mStream);
+    }
+
+    void writePacket(const uint8_t* data, size_t bytes, int samplesPerChannel) {
+        if (mClosed) {
+            throw std::runtime_error("OggOpusWriter is closed");
+        }
+
+        // The held-back packet is not the last one after all
+        submitPending(false, -1);
+
+        mPending.assign(data, data + bytes);
+        mPendingGranules = toGranules(samplesPerChannel);
+        mHavePending = true;
+    }
+
+    void close(int64_t totalSamples) {
+        if (mClosed) {
+            return;
+        }
+        mClosed = true;
+
+        // Trim only into the last packet; the end can not precede earlier packets
+        int64_t endGranule = -1;
+        if (totalSamples >= 0) {
+            int64_t target = toGranules(mOptions.preSkip) + toGranules(totalSamples);
+            if (target >= mGranule && target <= mGranule + mPendingGranules) {
+                endGranule = target;
+            }
+        }
+        try {
+            if (!mHavePending) {
+                pendSilence();
+                endGranule = toGranules(mOptions.preSkip);
+            }
+            submitPending(true, endGranule);
+            flushPages();
+            drain();
+        } catch (...) {
+            ::close(mFd);
+            mFd = -1;
+            throw;
+        }
+
+        int fd = mFd;
+        mFd = -1;
+        if (::close(fd) != 0) {
+            throw std::runtime_error(std::string("Failed to close Ogg Opus file: ") + std::strerror(errno));
+        }
+    }
+
+    const OggOpusWriterStats& getStats() const { return mStats; }
+
+private:
+    OggOpusWriterOptions mOptions;
+    int mFd;
+    bool mClosed;
+    ogg_stream_state mStream;
+    int64_t mPacketNo;
+    int64_t mGranule;          // End of the audio submitted to the stream
+    int64_t mPageEndGranule;   // Granule of the last page written
+    int64_t mMaxPageGranules;
+    std::vector<uint8_t> mBuffer;
+    OggOpusWriterStats mStats;
+
+    // The most recent packet, held back so close() can mark it end-of-stream
+    std::vector<uint8_t> mPending;
+    bool mHavePending;
+    int64_t mPendingGranules;
+
+    int64_t toGranules(int64_t samples) const { return samples * kGranuleRate / mOptions.sampleRate; }
+
+    // Both header packets end their own page, as RFC 7845 requires
+    void writeHeaders() {
+        std::vector<uint8_t> head;
+        head.insert(head.end(), {'O', 'p', 'u', 's', 'H', 'e', 'a', 'd', 1, static_cast<uint8_t>(mOptions.channels)});
+        putLe16(head, static_cast<uint16_t>(toGranules(mOptions.preSkip)));
+        putLe32(head, static_cast<uint32_t>(mOptions.sampleRate));
+        putLe16(head, 0);  // Output gain
+        head.push_back(0); // Channel mapping family
+        submit(head.data(), head.size(), 0, true, false);
+        flushPages();
+
+        std::vector<uint8_t> tags;
+        tags.insert(tags.end(), {'O', 'p', 'u', 's', 'T', 'a', 'g', 's'});
+        putString(tags, mOptions.vendor);
+        putLe32(tags, static_cast<uint32_t>(mOptions.comments.size()));
+        for (const auto& comment : mOptions.comments) {
+            putString(tags, comment);
+        }
+        submit(tags.data(), tags.size(), 0, false, false);
+        flushPages();
+    }
+
+    void submit(const uint8_t* data, size_t bytes, int64_t granule, bool bos, bool eos) {
+        ogg_packet packet;
+        packet.packet = const_cast<uint8_t*>(data);
+        packet.bytes = static_cast<long>(bytes);
+        packet.b_o_s = bos ? 1 : 0;
+        packet.e_o_s = eos ? 1 : 0;
+        packet.granulepos = granule;
+        packet.packetno = mPacketNo++;
+        if (ogg_stream_packetin(&mStream, &packet) != 0) {
+            throw std::runtime_error("ogg_stream_packetin failed");
+        }
+    }
+
+    void submitPending(bool last, int64_t endGranule) {
+        if (!mHavePending) {
+            return;
+        }
+        mHavePending = false;
+        mGranule += mPendingGranules;
+        submit(mPending.data(), mPending.size(), last && endGranule >= 0 ? endGranule : mGranule, false, last);
+        ++mStats.packets;
+
+        if (last) {
+            flushPages();
+            return;
+        }
+        ogg_page page;
+        while (ogg_stream_pageout(&mStream, &page)) {
+            appendPage(page);
+        }
+        if (mMaxPageGranules > 0 && mGranule - mPageEndGranule >= mMaxPageGranules) {
+            flushPages();
+        }
+    }
+
+    void flushPages() {
+        ogg_page page;
+        while (ogg_stream_flush(&mStream, &page)) {
+            appendPage(page);
+        }
+    }
+
+    // Holds back silent frames covering the pre-skip for a stream without audio, so the
+    // end-of-stream packet can trim it to nothing; RFC 7845 demuxers reject a stream that
+    // ends before its pre-skip. A TOC byte without frame data (CELT fullband, 20 ms) is
+    // decoded as silence.
+    void pendSilence() {
+        const uint8_t toc = static_cast<uint8_t>(0xf8 | (mOptions.channels == 2 ? 0x04 : 0));
+        const int64_t preSkip = toGranules(mOptions.preSkip);
+        do {
+            submitPending(false, -1);
+            mPending.assign(1, toc);
+            mPendingGranules = kGranuleRate / 50;
+            mHavePending = true;
+        } while (mGranule + mPendingGranules < preSkip);
+    }
+
+    void appendPage(const ogg_page& page) {
+        if (ogg_page_granulepos(&page) >= 0) {
+            mPageEndGranule = ogg_page_granulepos(&page);
+        }
+        mBuffer.insert(mBuffer.end(), page.header, page.header + page.header_len);
+        mBuffer.insert(mBuffer.end(), page.body, page.body + page.body_len);
+        ++mStats.pages;
+        mStats.bytes += static_cast<uint64_t>(page.header_len + page.body_len);
+        if (mBuffer.size() >= mOptions.bufferBytes) {
+            drain();
+        }
+    }
+
+    void drain() {
+        size_t offset = 0;
+        while (offset < mBuffer.size()) {
+            ssize_t written = ::write(mFd, mBuffer.data() + offset, mBuffer.size() - offset);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("Failed to write Ogg Opus file: ") + std::strerror(errno));
+            }
+            offset += static_cast<size_t>(written);
+            ++mStats.writes;
+        }
+        mBuffer.clear();
+    }
+};
+
+OggOpusWriter::OggOpusWriter(const std::string& path, const OggOpusWriterOptions& options)
+    : mImpl(std::make_unique<Impl>(path, options)) {}
+
+OggOpusWriter::~OggOpusWriter() = default;
+
+void OggOpusWriter::writePacket(utils::Span<const uint8_t> packet, int samplesPerChannel) {
+    mImpl->writePacket(packet.data(), packet.size(), samplesPerChannel);
+}
+
+void OggOpusWriter::close(int64_t totalSamples) {
+    mImpl->close(totalSamples);
+}
+
+const OggOpusWriterStats& OggOpusWriter::getStats() const {
+    return mImpl->getStats();
+}
+
+} // namespace opus
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Span.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace opus {
+
+struct OggOpusWriterOptions {
+    int sampleRate = 16000;  ///< Rate of the encoded PCM; unit of packet durations and preSkip
+    int channels = 1;
+    int preSkip = 0;         ///< Encoder lookahead in samples (OpusAudioCodec::getLookahead())
+    std::string vendor = "opuscodec";
+    std::vector<std::string> comments;  ///< "KEY=value" user comments for OpusTags
+    size_t bufferBytes = 64 * 1024;     ///< Pages are collected up to this size per write()
+    /// 0 lets libogg fill pages (about 4 KB each). Otherwise a page is closed once it
+    /// holds this much audio, which bounds what a crash can lose from a live capture.
+    int maxPageDurationMs = 0;
+};
+
+struct OggOpusWriterStats {
+    uint64_t packets = 0;
+    uint64_t pages = 0;
+    uint64_t bytes = 0;
+    uint64_t writes = 0;  ///< write() system calls
+};
+
+/**
+ * @brief Writes Opus packets to an Ogg Opus file (RFC 7845)
+ *
+ * Packets are paginated with ogg_stream_pageout(), so each page carries many
+ * packets, and pages are collected in a user-space buffer that goes to the file
+ * descriptor in large write() calls. Granule positions count 48 kHz samples from
+ * the start of the pre-skip. The last packet is held back until close(), which
+ * marks it end-of-stream and trims the padding of the final frame.
+ */
+class OggOpusWriter {
+public:
+    /**
+     * @brief Create the file and write the OpusHead and OpusTags headers
+     * @param path Output file, truncated if it exists
+     * @param options Stream parameters
+     * @throws std::runtime_error if the file cannot be created or written
+     */
+    OggOpusWriter(const std::string& path, const OggOpusWriterOptions& options);
+
+    /**
+     * @brief Closes the file if close() was not called; errors are only reported on stderr
+     */
+    ~OggOpusWriter();
+
+    OggOpusWriter(const OggOpusWriter&) = delete;
+    OggOpusWriter& operator=(const OggOpusWriter&) = delete;
+
+    /**
+     * @brief Append one Opus packet
+     * @param packet Packet bytes (copied)
+     * @param samplesPerChannel Packet duration at options.sampleRate
+     * @throws std::runtime_error if writing fails or the writer is closed
+     */
+    void writePacket(utils::Span<const uint8_t> packet, int samplesPerChannel);
+
+    /**
+     * @brief Finish the stream and close the file
+     *
+     * The last packet ends the stream. Without any packet, silent frames covering
+     * the pre-skip are written and trimmed to zero length, so the stream still
+     * ends with an end-of-stream page that demuxers accept.
+     *
+     * @param totalSamples Samples per channel of real audio at options.sampleRate, so
+     *        the padding of the last frame is cut on playback; -1 keeps every sample.
+     *        The packets must cover preSkip + totalSamples (OpusFrameEncoder::drain())
+     * @throws std::runtime_error if writing fails
+     */
+    void close(int64_t totalSamples = -1);
+
+    const OggOpusWriterStats& getStats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
+} // namespace opus
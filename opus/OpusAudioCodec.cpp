@@ -1,17 +1,39 @@
 #include "OpusAudioCodec.h"
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include <iostream>
 
 namespace opus {
 
+namespace {
+
+// Frame durations an Opus encoder accepts
+int frameSizeFor(int sampleRate, double frameDurationMs) {
+    static const double kDurationsMs[] = {2.5, 5.0, 10.0, 20.0, 40.0, 60.0};
+    for (double durationMs : kDurationsMs) {
+        if (frameDurationMs == durationMs) {
+            return static_cast<int>(std::lround(sampleRate * durationMs / 1000.0));
+        }
+    }
+    throw std::invalid_argument("Unsupported Opus frame duration: " + std::to_string(frameDurationMs) +
+                                " ms (use 2.5, 5, 10, 20, 40 or 60)");
+}
+
+} // namespace
+
 class OpusAudioCodec::Impl {
 public:
-    Impl(int sampleRate, int channels, int application)
+    Impl(int sampleRate, int channels, int application, double frameDurationMs)
         : mSampleRate(sampleRate)
         , mChannels(channels)
-        , mFrameSize((sampleRate * 20) / 1000) // 20ms frame size based on sample rate
+        , mFrameDurationMs(frameDurationMs)
+        , mFrameSize(frameSizeFor(sampleRate, frameDurationMs))
+        , mMaxDecodeSamples(static_cast<size_t>(sampleRate) * OpusAudioCodec::kMaxPacketDurationMs / 1000 * channels)
         , mEncoder(nullptr)
         , mDecoder(nullptr)
+        , mPacketScratch(OpusAudioCodec::kMaxPacketBytes)
+        , mPcmScratch(mMaxDecodeSamples)
     {
         int error = 0;
 
@@ -37,11 +59,11 @@ public:
 
         // Warm up the encoder/decoder with multiple dummy frames
         for (int i = 0; i < 2; i++) {
-            std::vector<opus_int16> warmupFrame(mFrameSize, i * 100);
+            std::vector<opus_int16> warmupFrame(static_cast<size_t>(mFrameSize) * mChannels, i * 100);
             unsigned char warmupCompressed[4000];
             int warmupSize = opus_encode(mEncoder, warmupFrame.data(), mFrameSize, warmupCompressed, sizeof(warmupCompressed));
             if (warmupSize > 0) {
-                std::vector<opus_int16> warmupDecoded(mFrameSize);
+                std::vector<opus_int16> warmupDecoded(static_cast<size_t>(mFrameSize) * mChannels);
                 int decoded = opus_decode(mDecoder, warmupCompressed, warmupSize, warmupDecoded.data(), mFrameSize, 0);
                 // Warmup frame processed
             }
@@ -57,76 +79,136 @@ public:
         }
     }
 
+    // The vector API copies out of the reused scratch buffers, so each call allocates
+    // exactly one result vector of the final size
     std::vector<unsigned char> encode(const std::vector<opus_int16>& pcm) {
-        if (pcm.empty()) {
-            return {};
+        size_t compressedSize = encodeInto(pcm.data(), pcm.size(), mPacketScratch.data(), mPacketScratch.size());
+        return std::vector<unsigned char>(mPacketScratch.begin(), mPacketScratch.begin() + compressedSize);
+    }
+
+    std::vector<opus_int16> decode(const std::vector<unsigned char>& data) {
+        size_t decodedSamples = decodeInto(data.data(), data.size(), mPcmScratch.data(), mPcmScratch.size());
+        return std::vector<opus_int16>(mPcmScratch.begin(), mPcmScratch.begin() + decodedSamples * mChannels);
+    }
+
+    size_t encodeInto(const opus_int16* pcm, size_t samples, uint8_t* out, size_t outBytes) {
+        if (samples == 0) {
+            return 0;
         }
 
         // Ensure we have the right frame size
-        if (pcm.size() != static_cast<size_t>(mFrameSize)) {
+        if (samples != static_cast<size_t>(mFrameSize) * mChannels) {
             throw std::runtime_error("PCM frame size mismatch. Expected: " +
-                                   std::to_string(mFrameSize) +
-                                   ", Got: " + std::to_string(pcm.size()));
+                                   std::to_string(mFrameSize * mChannels) +
+                                   ", Got: " + std::to_string(samples));
         }
 
-        // Maximum possible output size for a frame
-        const int maxDataBytes = 4000;
-        std::vector<unsigned char> compressed(maxDataBytes);
-
-        int compressedSize = opus_encode(mEncoder, pcm.data(), mFrameSize,
-                                       compressed.data(), maxDataBytes);
+        int compressedSize = opus_encode(mEncoder, pcm, mFrameSize, out,
+                                       static_cast<opus_int32>(std::min(outBytes, OpusAudioCodec::kMaxPacketBytes)));
 
         if (compressedSize < 0) {
             throw std::runtime_error("Opus encoding failed: " + std::string(opus_strerror(compressedSize)));
         }
 
-        // Resize to actual compressed size
-        compressed.resize(compressedSize);
-        return compressed;
+        return static_cast<size_t>(compressedSize);
     }
 
-    std::vector<opus_int16> decode(const std::vector<unsigned char>& data) {
-        if (data.empty()) {
-            return {};
+    size_t decodeInto(const uint8_t* data, size_t bytes, opus_int16* pcm, size_t samples) {
+        if (bytes == 0) {
+            return 0;
         }
 
-        std::vector<opus_int16> pcm(mFrameSize);
-
-        int decodedSamples = opus_decode(mDecoder, data.data(), data.size(),
-                                       pcm.data(), mFrameSize, 0);
-
-        // Decoding completed
+        // Opus decoder might return fewer samples than the buffer holds, which is normal
+        int decodedSamples = opus_decode(mDecoder, data, static_cast<opus_int32>(bytes),
+                                       pcm, static_cast<int>(samples / mChannels), 0);
 
         if (decodedSamples < 0) {
             throw std::runtime_error("Opus decoding failed: " + std::string(opus_strerror(decodedSamples)));
         }
 
-        // Opus decoder might return fewer samples than requested, which is normal
-        if (decodedSamples > 0 && decodedSamples <= mFrameSize) {
-            pcm.resize(decodedSamples);
-        } else if (decodedSamples == 0) {
+        if (decodedSamples == 0) {
             // This might indicate silence or an issue
             std::cerr << "Warning: Opus decoder returned 0 samples" << std::endl;
         }
 
-        return pcm;
+        return static_cast<size_t>(decodedSamples);
+    }
+
+    size_t concealInto(opus_int16* pcm, size_t samples, int samplesPerChannel) {
+        return decodeMissing(nullptr, 0, pcm, samples, samplesPerChannel, 0);
+    }
+
+    size_t recoverInto(const uint8_t* next, size_t bytes, opus_int16* pcm, size_t samples, int samplesPerChannel) {
+        return decodeMissing(next, bytes, pcm, samples, samplesPerChannel, 1);
+    }
+
+    void setBitrate(int bitsPerSecond) {
+        opus_encoder_ctl(mEncoder, OPUS_SET_BITRATE(bitsPerSecond));
+    }
+
+    void setComplexity(int complexity) {
+        opus_encoder_ctl(mEncoder, OPUS_SET_COMPLEXITY(std::max(0, std::min(complexity, 10))));
+    }
+
+    void reset() {
+        opus_encoder_ctl(mEncoder, OPUS_RESET_STATE);
+        opus_decoder_ctl(mDecoder, OPUS_RESET_STATE);
+    }
+
+    void setInbandFec(bool enable) {
+        opus_encoder_ctl(mEncoder, OPUS_SET_INBAND_FEC(enable ? 1 : 0));
+    }
+
+    void setPacketLossPercent(int percent) {
+        opus_encoder_ctl(mEncoder, OPUS_SET_PACKET_LOSS_PERC(std::max(0, std::min(percent, 100))));
     }
 
     int getFrameSize() const { return mFrameSize; }
+    double getFrameDurationMs() const { return mFrameDurationMs; }
+    size_t getMaxDecodeSamples() const { return mMaxDecodeSamples; }
+
+    int getLookahead() const {
+        opus_int32 lookahead = 0;
+        opus_encoder_ctl(mEncoder, OPUS_GET_LOOKAHEAD(&lookahead));
+        return lookahead;
+    }
+
     int getSampleRate() const { return mSampleRate; }
     int getChannels() const { return mChannels; }
 
 private:
+    // PLC (no data) or FEC (decodeFec = 1 with the next packet) for samplesPerChannel of lost audio
+    size_t decodeMissing(const uint8_t* data, size_t bytes, opus_int16* pcm, size_t samples, int samplesPerChannel,
+                         int decodeFec) {
+        if (static_cast<size_t>(samplesPerChannel) * mChannels > samples) {
+            throw std::runtime_error("PCM buffer too small for " + std::to_string(samplesPerChannel) +
+                                   " lost samples per channel");
+        }
+
+        int decodedSamples = opus_decode(mDecoder, data, static_cast<opus_int32>(bytes), pcm, samplesPerChannel, decodeFec);
+        if (decodedSamples < 0) {
+            throw std::runtime_error(std::string(decodeFec ? "Opus FEC decoding failed: " : "Opus concealment failed: ") +
+                                   opus_strerror(decodedSamples));
+        }
+        return static_cast<size_t>(decodedSamples);
+    }
+
     int mSampleRate;
     int mChannels;
+    double mFrameDurationMs;
     int mFrameSize;
+    size_t mMaxDecodeSamples;
     OpusEncoder* mEncoder;
     OpusDecoder* mDecoder;
+
+    // Reused by the vector API; sized once at construction
+    std::vector<uint8_t> mPacketScratch;
+    std::vector<opus_int16> mPcmScratch;
 };
 
 // OpusAudioCodec implementation
-OpusAudioCodec::OpusAudioCodec(int sampleRate, int channels, int application)
-    : mImpl(std::make_unique<Impl>(sampleRate, channels, application)) {}
+OpusAudioCodec::OpusAudioCodec(int sampleRate, int channels, int application, double frameDurationMs)
+    : mImpl(std::make_unique<Impl>(sampleRate, channels, application, frameDurationMs)) {}
 
 OpusAudioCodec::~OpusAudioCodec() = default;
 
@@ -138,10 +220,59 @@ std::vector<opus_int16> OpusAudioCodec::decode(const std::vector<unsigned char>&
     return mImpl->decode(data);
 }
 
+size_t OpusAudioCodec::encodeInto(utils::Span<const opus_int16> pcm, utils::Span<uint8_t> out) {
+    return mImpl->encodeInto(pcm.data(), pcm.size(), out.data(), out.size());
+}
+
+size_t OpusAudioCodec::decodeInto(utils::Span<const uint8_t> data, utils::Span<opus_int16> pcm) {
+    return mImpl->decodeInto(data.data(), data.size(), pcm.data(), pcm.size());
+}
+
+size_t OpusAudioCodec::concealInto(utils::Span<opus_int16> pcm, int samplesPerChannel) {
+    return mImpl->concealInto(pcm.data(), pcm.size(), samplesPerChannel);
+}
+
+size_t OpusAudioCodec::recoverInto(utils::Span<const uint8_t> nextPacket, utils::Span<opus_int16> pcm,
+                                   int samplesPerChannel) {
+    return mImpl->recoverInto(nextPacket.data(), nextPacket.size(), pcm.data(), pcm.size(), samplesPerChannel);
+}
+
+void OpusAudioCodec::setBitrate(int bitsPerSecond) {
+    mImpl->setBitrate(bitsPerSecond);
+}
+
+void OpusAudioCodec::setComplexity(int complexity) {
+    mImpl->setComplexity(complexity);
+}
+
+void OpusAudioCodec::reset() {
+    mImpl->reset();
+}
+
+void OpusAudioCodec::setInbandFec(bool enable) {
+    mImpl->setInbandFec(enable);
+}
+
+void OpusAudioCodec::setPacketLossPercent(int percent) {
+    mImpl->setPacketLossPercent(percent);
+}
+
 int OpusAudioCodec::getFrameSize() const {
     return mImpl->getFrameSize();
 }
 
+double OpusAudioCodec::getFrameDurationMs() const {
+    return mImpl->getFrameDurationMs();
+}
+
+size_t OpusAudioCodec::getMaxDecodeSamples() const {
+    return mImpl->getMaxDecodeSamples();
+}
+
+int OpusAudioCodec::getLookahead() const {
+    return mImpl->getLookahead();
+}
+
 int OpusAudioCodec::getSampleRate() const {
     return mImpl->getSampleRate();
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "Span.h"
+
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <opus.h>
@@ -15,13 +19,23 @@ namespace opus {
  */
 class OpusAudioCodec {
 public:
+    /// Largest packet encode() produces; an encodeInto() buffer of this size always suffices
+    static constexpr size_t kMaxPacketBytes = 4000;
+
+    /// Longest packet Opus allows (multi-frame packets included), in milliseconds
+    static constexpr int kMaxPacketDurationMs = 120;
+
     /**
      * @brief Constructor
      * @param sampleRate Sample rate in Hz (default: 16000)
      * @param channels Number of channels (default: 1 for mono)
      * @param application Opus application type (default: OPUS_APPLICATION_VOIP)
+     * @param frameDurationMs Encoder frame duration: 2.5, 5, 10, 20, 40 or 60 ms (default: 20).
+     *        Shorter frames lower latency, longer frames lower the bitrate overhead.
+     * @throws std::invalid_argument for any other frame duration
      */
-    OpusAudioCodec(int sampleRate = 16000, int channels = 1, int application = OPUS_APPLICATION_VOIP);
+    OpusAudioCodec(int sampleRate = 16000, int channels = 1, int application = OPUS_APPLICATION_VOIP,
+                   double frameDurationMs = 20.0);
 
     /**
      * @brief Destructor
@@ -42,18 +56,129 @@ public:
 
     /**
      * @brief Decode Opus compressed data to PCM samples
+     *
+     * Accepts packets of any duration up to kMaxPacketDurationMs, including
+     * multi-frame packets from OpusFrameEncoder.
+     *
      * @param data Vector of compressed Opus data
      * @return Vector of decoded PCM samples
      * @throws std::runtime_error if decoding fails
      */
     std::vector<opus_int16> decode(const std::vector<unsigned char>& data);
 
+    /**
+     * @brief Encode one frame of PCM samples into a caller-provided buffer
+     *
+     * Allocation-free alternative to encode() for per-frame streaming loops.
+     *
+     * @param pcm Exactly getFrameSize() * getChannels() interleaved samples
+     * @param out Destination for the packet (kMaxPacketBytes always suffices)
+     * @return Number of bytes written to out (0 for empty pcm)
+     * @throws std::runtime_error on a frame size mismatch or if encoding fails
+     */
+    size_t encodeInto(utils::Span<const opus_int16> pcm, utils::Span<uint8_t> out);
+
+    /**
+     * @brief Decode one Opus packet into a caller-provided buffer
+     *
+     * Allocation-free alternative to decode() for per-frame streaming loops.
+     *
+     * @param data Compressed packet
+     * @param pcm Destination for interleaved samples; getMaxDecodeSamples() always suffices
+     * @return Number of decoded samples per channel (0 for empty data)
+     * @throws std::runtime_error if decoding fails or pcm is too small for the packet
+     */
+    size_t decodeInto(utils::Span<const uint8_t> data, utils::Span<opus_int16> pcm);
+
+    /**
+     * @brief Conceal a lost packet (packet loss concealment)
+     *
+     * Extrapolates audio from the decoder state so playback continues without a gap.
+     *
+     * @param pcm Destination for interleaved samples
+     * @param samplesPerChannel Duration of the lost audio; a multiple of 2.5 ms
+     * @return Number of samples per channel written
+     * @throws std::runtime_error if concealment fails or pcm is too small
+     */
+    size_t concealInto(utils::Span<opus_int16> pcm, int samplesPerChannel);
+
+    /**
+     * @brief Recover a lost packet from the in-band FEC data of the packet after it
+     *
+     * Only valid directly before decoding nextPacket itself. Where the next packet
+     * carries no FEC data, the audio is concealed as with concealInto().
+     *
+     * @param nextPacket The packet that followed the lost one
+     * @param pcm Destination for interleaved samples
+     * @param samplesPerChannel Duration of the lost audio; a multiple of 2.5 ms
+     * @return Number of samples per channel written
+     * @throws std::runtime_error if decoding fails or pcm is too small
+     */
+    size_t recoverInto(utils::Span<const uint8_t> nextPacket, utils::Span<opus_int16> pcm, int samplesPerChannel);
+
+    /**
+     * @brief Set the encoder target bitrate (default: 64000)
+     * @param bitsPerSecond Target bitrate, or OPUS_AUTO
+     */
+    void setBitrate(int bitsPerSecond);
+
+    /**
+     * @brief Set the encoder complexity (default: 5)
+     * @param complexity 0 (fastest) to 10 (best quality)
+     */
+    void setComplexity(int complexity);
+
+    /**
+     * @brief Reset encoder and decoder state for an unrelated stream
+     *
+     * Settings such as bitrate and complexity are kept.
+     */
+    void reset();
+
+    /**
+     * @brief Enable or disable in-band forward error correction in the encoder
+     *
+     * With FEC on (and a non-zero expected loss), each packet carries a low-bitrate
+     * copy of the previous one that recoverInto() can decode. It costs bitrate and
+     * applies to SILK and hybrid modes only.
+     *
+     * @param enable true to embed FEC data
+     */
+    void setInbandFec(bool enable);
+
+    /**
+     * @brief Tell the encoder how much loss to expect
+     *
+     * Higher values make the encoder spend more on FEC and less on inter-frame prediction.
+     *
+     * @param percent Expected packet loss, 0-100
+     */
+    void setPacketLossPercent(int percent);
+
     /**
      * @brief Get the frame size in samples
      * @return Frame size in samples
      */
     int getFrameSize() const;
 
+    /**
+     * @brief Get the frame duration
+     * @return Frame duration in milliseconds
+     */
+    double getFrameDurationMs() const;
+
+    /**
+     * @brief Get the decode buffer size that fits any packet
+     * @return Interleaved samples in kMaxPacketDurationMs of audio
+     */
+    size_t getMaxDecodeSamples() const;
+
+    /**
+     * @brief Get the encoder lookahead (the decoder output lags the input by this much)
+     * @return Lookahead in samples per channel
+     */
+    int getLookahead() const;
+
     /**
      * @brief Get the sample rate
      * @return Sample rate in Hz
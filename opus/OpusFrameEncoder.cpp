@@ -0,0 +1,231 @@
+#include "OpusFrameEncoder.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace opus {
+
+OpusFramingConfig OpusFramingConfig::interactive() {
+    OpusFramingConfig config;
+    config.frameDurationMs = 10.0;
+    config.framesPerPacket = 1;
+    return config;
+}
+
+OpusFramingConfig OpusFramingConfig::bulk() {
+    OpusFramingConfig config;
+    config.frameDurationMs = 60.0;
+    config.framesPerPacket = 2;
+    return config;
+}
+
+class OpusFrameEncoder::Impl {
+public:
+    Impl(const OpusFramingConfig& config, PacketCallback callback)
+        : mCodec(config.sampleRate, config.channels, config.application, config.frameDurationMs)
+        , mCallback(std::move(callback))
+        , mChannels(config.channels)
+        , mFrameSize(mCodec.getFrameSize())
+        , mFrameSamples(static_cast<size_t>(mFrameSize) * config.channels)
+        , mFramesPerPacket(config.framesPerPacket)
+        , mPending(mFrameSamples)
+        , mPendingFill(0)
+        , mFrameBytes(static_cast<size_t>(std::max(config.framesPerPacket, 1)) * OpusAudioCodec::kMaxPacketBytes)
+        , mFrameLengths(std::max(config.framesPerPacket, 1))
+        , mFrames(0)
+        , mPacket(mFrameBytes.size())
+        , mRepacketizer(nullptr)
+    {
+        if (mFramesPerPacket < 1 ||
+            config.frameDurationMs * mFramesPerPacket > OpusAudioCodec::kMaxPacketDurationMs) {
+            throw std::invalid_argument("Opus packets hold 1 to " +
+                                        std::to_string(OpusAudioCodec::kMaxPacketDurationMs) + " ms of frames, got " +
+                                        std::to_string(mFramesPerPacket) + " x " +
+                                        std::to_string(config.frameDurationMs) + " ms");
+        }
+
+        if (mFramesPerPacket > 1) {
+            mRepacketizer = opus_repacketizer_create();
+            if (!mRepacketizer) {
+                throw std::runtime_error("Failed to create Opus repacketizer");
+            }
+        }
+    }
+
+    ~Impl() {
+        if (mRepacketizer) {
+            opus_repacketizer_destroy(mRepacketizer);
+        }
+    }
+
+    size_t write(const opus_int16* pcm, size_t samples) {
+        if (samples % mChannels != 0) {
+            throw std::invalid_argument("PCM must hold whole sample frames of " + std::to_string(mChannels) +
+                                        " channels, got " + std::to_string(samples) + " samples");
+        }
+
+        size_t packets = 0;
+        while (samples > 0) {
+            // Whole frames are encoded straight from the caller's buffer
+            if (mPendingFill == 0 && samples >= mFrameSamples) {
+                packets += encodeFrame(pcm);
+                pcm += mFrameSamples;
+                samples -= mFrameSamples;
+                continue;
+            }
+
+            size_t take = std::min(samples, mFrameSamples - mPendingFill);
+            std::copy(pcm, pcm + take, mPending.begin() + mPendingFill);
+            mPendingFill += take;
+            pcm += take;
+            samples -= take;
+            if (mPendingFill == mFrameSamples) {
+                mPendingFill = 0;
+                packets += encodeFrame(mPending.data());
+            }
+        }
+        return packets;
+    }
+
+    size_t flush() {
+        size_t packets = 0;
+        if (mPendingFill > 0) {
+            std::fill(mPending.begin() + mPendingFill, mPending.end(), 0);
+            mPendingFill = 0;
+            packets += encodeFrame(mPending.data());
+        }
+        return packets + emitPacket();
+    }
+
+    size_t drain() {
+        size_t packets = 0;
+        for (size_t silence = static_cast<size_t>(mCodec.getLookahead()) * mChannels; silence > 0;) {
+            size_t take = std::min(silence, mFrameSamples - mPendingFill);
+            std::fill(mPending.begin() + mPendingFill, mPending.begin() + mPendingFill + take, 0);
+            mPendingFill += take;
+            silence -= take;
+            if (mPendingFill == mFrameSamples) {
+                mPendingFill = 0;
+                packets += encodeFrame(mPending.data());
+            }
+        }
+        return packets + flush();
+    }
+
+    void reset() {
+        mPendingFill = 0;
+        mFrames = 0;
+        mCodec.reset();
+    }
+
+    size_t bufferedSamples() const {
+        return static_cast<size_t>(mFrames) * mFrameSize + mPendingFill / mChannels;
+    }
+
+    OpusAudioCodec& codec() { return mCodec; }
+
+private:
+    OpusAudioCodec mCodec;
+    PacketCallback mCallback;
+    int mChannels;
+    int mFrameSize;
+    size_t mFrameSamples;  // Interleaved samples per frame
+    int mFramesPerPacket;
+
+    // Partial frame carried over between write() calls
+    std::vector<opus_int16> mPending;
+    size_t mPendingFill;
+
+    // Encoded frames of the packet being assembled, one kMaxPacketBytes slot each; the
+    // repacketizer references them until the packet is out
+    std::vector<uint8_t> mFrameBytes;
+    std::vector<size_t> mFrameLengths;
+    int mFrames;
+
+    std::vector<uint8_t> mPacket;
+    OpusRepacketizer* mRepacketizer;
+
+    uint8_t* frameSlot(int frame) { return &mFrameBytes[static_cast<size_t>(frame) * OpusAudioCodec::kMaxPacketBytes]; }
+
+    size_t encodeFrame(const opus_int16* pcm) {
+        mFrameLengths[mFrames] = mCodec.encodeInto(utils::Span<const opus_int16>(pcm, mFrameSamples),
+                                                   utils::Span<uint8_t>(frameSlot(mFrames), OpusAudioCodec::kMaxPacketBytes));
+        ++mFrames;
+        return mFrames == mFramesPerPacket ? emitPacket() : 0;
+    }
+
+    size_t emitPacket() {
+        if (mFrames == 0) {
+            return 0;
+        }
+        int frames = mFrames;
+        mFrames = 0;
+
+        if (!mRepacketizer) {
+            mCallback(utils::Span<const uint8_t>(frameSlot(0), mFrameLengths[0]), mFrameSize);
+            return 1;
+        }
+
+        // Frames merge only while they share the TOC configuration (mode, bandwidth);
+        // on a change the frames so far are sent on their own
+        size_t packets = 0;
+        int merged = 0;
+        opus_repacketizer_init(mRepacketizer);
+        for (int i = 0; i < frames; ++i) {
+            auto length = static_cast<opus_int32>(mFrameLengths[i]);
+            if (opus_repacketizer_cat(mRepacketizer, frameSlot(i), length) != OPUS_OK) {
+                packets += emitMerged(merged);
+                merged = 0;
+                opus_repacketizer_init(mRepacketizer);
+                int error = opus_repacketizer_cat(mRepacketizer, frameSlot(i), length);
+                if (error != OPUS_OK) {
+                    throw std::runtime_error("Opus repacketizer rejected a frame: " + std::string(opus_strerror(error)));
+                }
+            }
+            ++merged;
+        }
+        return packets + emitMerged(merged);
+    }
+
+    size_t emitMerged(int frames) {
+        opus_int32 length = opus_repacketizer_out(mRepacketizer, mPacket.data(), static_cast<opus_int32>(mPacket.size()));
+        if (length < 0) {
+            throw std::runtime_error("Opus repacketizer failed: " + std::string(opus_strerror(length)));
+        }
+        mCallback(utils::Span<const uint8_t>(mPacket.data(), static_cast<size_t>(length)), frames * mFrameSize);
+        return 1;
+    }
+};
+
+OpusFrameEncoder::OpusFrameEncoder(const OpusFramingConfig& config, PacketCallback callback)
+    : mImpl(std::make_unique<Impl>(config, std::move(callback))) {}
+
+OpusFrameEncoder::~OpusFrameEncoder() = default;
+
+size_t OpusFrameEncoder::write(utils::Span<const opus_int16> pcm) {
+    return mImpl->write(pcm.data(), pcm.size());
+}
+
+size_t OpusFrameEncoder::flush() {
+    return mImpl->flush();
+}
+
+size_t OpusFrameEncoder::drain() {
+    return mImpl->drain();
+}
+
+void OpusFrameEncoder::reset() {
+    mImpl->reset();
+}
+
+size_t OpusFrameEncoder::bufferedSamples() const {
+    return mImpl->bufferedSamples();
+}
+
+OpusAudioCodec& OpusFrameEncoder::codec() {
+    return mImpl->codec();
+}
+
+} // namespace opus
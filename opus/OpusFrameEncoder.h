@@ -0,0 +1,120 @@
+#pragma once
+
+#include "OpusAudioCodec.h"
+#include "Span.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace opus {
+
+/**
+ * @brief Framing settings for one stream
+ *
+ * Latency is frameDurationMs * framesPerPacket plus the encoder lookahead. Longer
+ * frames spend fewer bits on per-frame overhead; packing several frames into one
+ * packet further saves the per-packet TOC and transport overhead.
+ */
+struct OpusFramingConfig {
+    int sampleRate = 16000;
+    int channels = 1;
+    int application = OPUS_APPLICATION_VOIP;
+    double frameDurationMs = 20.0;  ///< 2.5, 5, 10, 20, 40 or 60
+    int framesPerPacket = 1;        ///< Packet duration must not exceed 120 ms
+
+    /// 10 ms single-frame packets for interactive streams
+    static OpusFramingConfig interactive();
+
+    /// 60 ms frames, two per packet, for bulk uplink where latency does not matter
+    static OpusFramingConfig bulk();
+};
+
+/**
+ * @brief Turns PCM of any length into Opus packets of a fixed duration
+ *
+ * write() accepts interleaved PCM in chunks of any size, keeps the remainder that
+ * does not fill a frame until the next call, and emits a packet through the callback
+ * whenever framesPerPacket frames are complete. Multi-frame packets are merged with
+ * the Opus repacketizer; if the encoder switches mode or bandwidth mid-packet, the
+ * frames so far go out as a shorter packet. All buffers are sized at construction,
+ * so write() does not allocate.
+ */
+class OpusFrameEncoder {
+public:
+    /**
+     * @brief Packet sink
+     * @param packet Packet bytes, valid only during the call
+     * @param samplesPerChannel Audio duration of the packet in samples per channel
+     */
+    using PacketCallback = std::function<void(utils::Span<const uint8_t> packet, int samplesPerChannel)>;
+
+    /**
+     * @brief Constructor
+     * @param config Stream settings
+     * @param callback Receives every packet, in order
+     * @throws std::invalid_argument for an unsupported frame duration or packet length
+     * @throws std::runtime_error if the codec cannot be created
+     */
+    OpusFrameEncoder(const OpusFramingConfig& config, PacketCallback callback);
+
+    ~OpusFrameEncoder();
+
+    OpusFrameEncoder(const OpusFrameEncoder&) = delete;
+    OpusFrameEncoder& operator=(const OpusFrameEncoder&) = delete;
+
+    /**
+     * @brief Append interleaved PCM samples
+     * @param pcm Any whole number of sample frames (size a multiple of the channel count)
+     * @return Number of packets emitted during the call
+     * @throws std::invalid_argument if pcm ends inside a sample frame
+     * @throws std::runtime_error if encoding fails
+     */
+    size_t write(utils::Span<const opus_int16> pcm);
+
+    /**
+     * @brief Emit everything still buffered
+     *
+     * The partial frame is padded with silence and a partial packet carries fewer
+     * frames, so the stream ends on the last written sample rounded up to a frame.
+     *
+     * @return Number of packets emitted
+     */
+    size_t flush();
+
+    /**
+     * @brief End the stream so that it decodes to every written sample
+     *
+     * Encodes codec().getLookahead() samples of silence before flush(): the decoder
+     * output lags the input by the lookahead, which would otherwise cut the tail of
+     * the audio when the stream ends on a frame boundary. Container writers then trim
+     * the padding (see OggOpusWriter::close()).
+     *
+     * @return Number of packets emitted
+     */
+    size_t drain();
+
+    /**
+     * @brief Drop buffered samples and reset the codec, to encode an unrelated stream
+     */
+    void reset();
+
+    /**
+     * @brief Get the samples per channel written but not yet emitted
+     * @return Buffered samples per channel
+     */
+    size_t bufferedSamples() const;
+
+    /**
+     * @brief Get the codec used for encoding (for its frame size, lookahead, etc.)
+     * @return The codec
+     */
+    OpusAudioCodec& codec();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
+} // namespace opus
@@ -0,0 +1,108 @@
+#include "OpusStreamDecoder.h"
+
+#include <vector>
+
+namespace opus {
+
+class OpusStreamDecoder::Impl {
+public:
+    // Packets at most this far behind are late; further back is a sender restart (RFC 3550 MAX_MISORDER)
+    static constexpr int kMaxMisorder = 100;
+
+    Impl(OpusAudioCodec& codec, PcmCallback callback, bool useFec, int maxConcealedPackets)
+        : mCodec(codec)
+        , mCallback(std::move(callback))
+        , mUseFec(useFec)
+        , mMaxConcealedPackets(maxConcealedPackets)
+        , mPcm(codec.getMaxDecodeSamples())
+        , mStarted(false)
+        , mNextSequence(0)
+        , mPacketSamples(codec.getFrameSize())
+    {}
+
+    void receive(uint16_t sequence, utils::Span<const uint8_t> packet) {
+        if (mStarted) {
+            // Signed distance modulo 2^16, so the sequence number may wrap
+            auto gap = static_cast<int16_t>(static_cast<uint16_t>(sequence - mNextSequence));
+            if (gap < 0 && gap >= -kMaxMisorder) {
+                ++mStats.late;
+                return;
+            }
+            if (gap < 0 || gap > mMaxConcealedPackets) {
+                // Far ahead or far behind: the sender restarted or skipped, pick up from here
+                ++mStats.resyncs;
+            } else if (gap > 0) {
+                for (int i = 0; i < gap - 1; ++i) {
+                    concealPacket();
+                }
+                if (mUseFec) {
+                    size_t samples = mCodec.recoverInto(utils::Span<const uint8_t>(packet.data(), packet.size()),
+                                                        mPcm, mPacketSamples);
+                    emit(samples, PcmSource::Recovered);
+                    ++mStats.recovered;
+                } else {
+                    concealPacket();
+                }
+            }
+        }
+
+        size_t samples = mCodec.decodeInto(utils::Span<const uint8_t>(packet.data(), packet.size()), mPcm);
+        emit(samples, PcmSource::Decoded);
+        ++mStats.received;
+        if (samples > 0) {
+            mPacketSamples = static_cast<int>(samples);
+        }
+        mStarted = true;
+        mNextSequence = static_cast<uint16_t>(sequence + 1);
+    }
+
+    void conceal() {
+        if (!mStarted) {
+            return;
+        }
+        concealPacket();
+        ++mNextSequence;
+    }
+
+    const OpusStreamStats& stats() const { return mStats; }
+
+private:
+    OpusAudioCodec& mCodec;
+    PcmCallback mCallback;
+    bool mUseFec;
+    int mMaxConcealedPackets;
+    std::vector<opus_int16> mPcm;  // Decoder output, sized for the longest packet
+
+    bool mStarted;
+    uint16_t mNextSequence;
+    int mPacketSamples;  // Duration of the last decoded packet, assumed for lost ones
+    OpusStreamStats mStats;
+
+    void concealPacket() {
+        emit(mCodec.concealInto(mPcm, mPacketSamples), PcmSource::Concealed);
+        ++mStats.concealed;
+    }
+
+    void emit(size_t samplesPerChannel, PcmSource source) {
+        mCallback(utils::Span<const opus_int16>(mPcm.data(), samplesPerChannel * mCodec.getChannels()), source);
+    }
+};
+
+OpusStreamDecoder::OpusStreamDecoder(OpusAudioCodec& codec, PcmCallback callback, bool useFec, int maxConcealedPackets)
+    : mImpl(std::make_unique<Impl>(codec, std::move(callback), useFec, maxConcealedPackets)) {}
+
+OpusStreamDecoder::~OpusStreamDecoder() = default;
+
+void OpusStreamDecoder::receive(uint16_t sequence, utils::Span<const uint8_t> packet) {
+    mImpl->receive(sequence, std::move(packet));
+}
+
+void OpusStreamDecoder::conceal() {
+    mImpl->conceal();
+}
+
+const OpusStreamStats& OpusStreamDecoder::stats() const {
+    return mImpl->stats();
+}
+
+} // namespace opus
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "OpusAudioCodec.h"
+#include "Span.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace opus {
+
+/// Where a stretch of decoder output came from
+enum class PcmSource {
+    Decoded,    ///< The packet itself
+    Recovered,  ///< A lost packet rebuilt from the FEC data in the packet after it
+    Concealed   ///< A lost packet extrapolated by packet loss concealment
+};
+
+struct OpusStreamStats {
+    uint64_t received = 0;   ///< Packets decoded
+    uint64_t recovered = 0;  ///< Lost packets rebuilt from FEC
+    uint64_t concealed = 0;  ///< Lost packets concealed
+    uint64_t late = 0;       ///< Late or duplicate packets dropped
+    uint64_t resyncs = 0;    ///< Jumps too far ahead or behind, treated as a restart
+};
+
+/**
+ * @brief Decodes a sequenced packet stream with loss recovery
+ *
+ * Packets carry a 16-bit sequence number that wraps around, as in RTP. When
+ * receive() sees a gap, each missing packet but the last is concealed, and the
+ * last one is rebuilt from the in-band FEC data of the packet that just arrived
+ * (or concealed as well when FEC is off). The output therefore stays continuous:
+ * one packet duration of audio per sequence number.
+ *
+ * A missing packet is assumed to last as long as the packet before it. Packets
+ * up to 100 sequence numbers older than the last one decoded are dropped as late;
+ * a packet further back, like one too far ahead, restarts the stream.
+ */
+class OpusStreamDecoder {
+public:
+    /**
+     * @brief PCM sink
+     * @param pcm Interleaved samples, valid only during the call
+     * @param source How the samples were produced
+     */
+    using PcmCallback = std::function<void(utils::Span<const opus_int16> pcm, PcmSource source)>;
+
+    /**
+     * @brief Constructor
+     * @param codec Codec whose decoder is used; must outlive this object
+     * @param callback Receives the output in playback order
+     * @param useFec Rebuild the packet before each arrival from its FEC data
+     * @param maxConcealedPackets Longer gaps are treated as a stream restart and skipped
+     */
+    OpusStreamDecoder(OpusAudioCodec& codec, PcmCallback callback, bool useFec = true, int maxConcealedPackets = 50);
+
+    ~OpusStreamDecoder();
+
+    OpusStreamDecoder(const OpusStreamDecoder&) = delete;
+    OpusStreamDecoder& operator=(const OpusStreamDecoder&) = delete;
+
+    /**
+     * @brief Decode the next packet that arrived
+     * @param sequence Sequence number of the packet
+     * @param packet Packet bytes
+     * @throws std::runtime_error if decoding fails
+     */
+    void receive(uint16_t sequence, utils::Span<const uint8_t> packet);
+
+    /**
+     * @brief Conceal the next packet without waiting for it
+     *
+     * For a playout deadline that passes before the packet arrives; the packet is
+     * then dropped as late if it turns up.
+     */
+    void conceal();
+
+    /**
+     * @brief Get the loss statistics so far
+     * @return Statistics
+     */
+    const OpusStreamStats& stats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
+} // namespace opus
@@ -0,0 +1,297 @@
+// Tests for AudioStreamer with the WAV replay backend: chunking, positions and timestamps,
+// real-time pacing, stopping mid-stream, the bounded queue, chunk leases and unreadable files
+#include "AudioStreamer.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+const char* kPath = "audio_streamer_test.wav";
+
+void put16(std::ofstream& out, uint16_t value) {
+    out.put(static_cast<char>(value & 0xff)).put(static_cast<char>(value >> 8));
+}
+
+void put32(std::ofstream& out, uint32_t value) {
+    put16(out, static_cast<uint16_t>(value & 0xffff));
+    put16(out, static_cast<uint16_t>(value >> 16));
+}
+
+// WAV with a LIST chunk between "fmt " and "data", as many recorders write
+std::vector<short> writeWav(int sampleRate, int channels, size_t frames) {
+    std::vector<short> pcm(frames * channels);
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        pcm[i] = static_cast<short>(std::lround(9000.0 * std::sin(0.01 * static_cast<double>(i))) + (i % 7));
+    }
+    const char list[] = "INFOISFT\x06\0\0\0test\0\0";
+    const uint32_t listBytes = sizeof(list) - 1;
+    const uint32_t dataBytes = static_cast<uint32_t>(pcm.size() * sizeof(short));
+
+    std::ofstream out(kPath, std::ios::binary | std::ios::trunc);
+    out.write("RIFF", 4);
+    put32(out, 4 + 24 + 8 + listBytes + 8 + dataBytes);
+    out.write("WAVEfmt ", 8);
+    put32(out, 16);
+    put16(out, 1);
+    put16(out, static_cast<uint16_t>(channels));
+    put32(out, static_cast<uint32_t>(sampleRate));
+    put32(out, static_cast<uint32_t>(sampleRate * channels * 2));
+    put16(out, static_cast<uint16_t>(channels * 2));
+    put16(out, 16);
+    out.write("LIST", 4);
+    put32(out, listBytes);
+    out.write(list, listBytes);
+    out.write("data", 4);
+    put32(out, dataBytes);
+    out.write(reinterpret_cast<const char*>(pcm.data()), dataBytes);
+    return pcm;
+}
+
+CaptureConfig replay(bool realtime) {
+    CaptureConfig capture;
+    capture.backend = CaptureBackend::WavReplay;
+    capture.replayPath = kPath;
+    capture.replayRealtime = realtime;
+    return capture;
+}
+
+} // namespace
+
+static void testChunking() {
+    std::cout << "\nReplay as fast as consumed, 48 kHz stereo in 10 ms chunks" << std::endl;
+    const size_t frames = 48000 * 2 + 123;  // Ends with a partial chunk
+    std::vector<short> pcm = writeWav(48000, 2, frames);
+
+    // Rate and channels come from the file, not the constructor
+    AudioStreamer streamer(10, 16000, 1, replay(false));
+    streamer.start();
+    check(streamer.getSampleRate() == 48000 && streamer.getChannels() == 2 && streamer.getChunkFrames() == 480,
+          "Format and chunk size follow the file");
+
+    std::vector<short> all;
+    std::vector<short> chunk;
+    AudioChunkInfo info;
+    bool sizes = true;
+    bool positions = true;
+    bool timestamps = true;
+    size_t chunks = 0;
+    Clock::time_point first;
+    while (streamer.popChunk(chunk, info)) {
+        size_t chunkFrames = chunk.size() / 2;
+        uint64_t position = all.size() / 2;
+        sizes = sizes && (chunkFrames == 480 || position + chunkFrames == frames);
+        positions = positions && info.framePosition == position && !info.hardwareTimestamp;
+        if (chunks == 0) {
+            first = info.timestamp;
+        }
+        double offsetSec = std::chrono::duration<double>(info.timestamp - first).count();
+        timestamps = timestamps && std::fabs(offsetSec - static_cast<double>(position) / 48000) < 1e-6;
+        all.insert(all.end(), chunk.begin(), chunk.end());
+        ++chunks;
+    }
+    check(chunks == 201, "Every 10 ms chunk plus the partial one (" + std::to_string(chunks) + " chunks)");
+    check(all == pcm, "Chunks concatenate to the file data");
+    check(sizes, "Chunks hold exactly one period, except the last");
+    check(positions, "Frame positions are contiguous");
+    check(timestamps, "Timestamps advance by the audio duration");
+    check(!streamer.isRunning(), "The streamer stops at the end of the file");
+    streamer.stop();
+}
+
+static void testRealtimePacing() {
+    std::cout << "\nReal-time replay" << std::endl;
+    writeWav(16000, 1, 16000 / 2);  // 0.5 s
+
+    AudioStreamer streamer(20, 16000, 1, replay(true));
+    auto start = Clock::now();
+    streamer.start();
+    std::vector<short> chunk;
+    AudioChunkInfo info;
+    size_t chunks = 0;
+    bool neverEarly = true;
+    while (streamer.popChunk(chunk, info)) {
+        // A chunk is complete only once its last sample has been "captured"
+        auto complete = info.timestamp + std::chrono::milliseconds(20);
+        neverEarly = neverEarly && Clock::now() >= complete - std::chrono::milliseconds(1);
+        ++chunks;
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << "  " << chunks << " chunks in " << elapsed << " s" << std::endl;
+    check(chunks == 25, "25 chunks of 20 ms");
+    check(neverEarly, "No chunk is delivered before its audio has elapsed");
+    check(elapsed >= 0.49 && elapsed < 0.8, "Replay takes the audio duration");
+    streamer.stop();
+}
+
+static void testStopMidStream() {
+    std::cout << "\nStop during real-time replay" << std::endl;
+    writeWav(16000, 1, 16000 * 10);
+
+    AudioStreamer streamer(10, 16000, 1, replay(true));
+    streamer.start();
+    std::vector<short> chunk;
+    check(streamer.popChunk(chunk) && chunk.size() == 160, "First chunk arrives");
+    std::thread consumer([&]() {
+        while (streamer.popChunk(chunk)) {
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto before = Clock::now();
+    streamer.stop();
+    double stopMs = std::chrono::duration<double, std::milli>(Clock::now() - before).count();
+    consumer.join();
+    std::cout << "  stop() took " << stopMs << " ms" << std::endl;
+    check(stopMs < 20.0, "stop() wakes the capture thread instead of waiting for the next chunk");
+    check(!streamer.isRunning() && !streamer.popChunk(chunk), "popChunk() returns false once stopped");
+
+    // And it can start over from the beginning
+    streamer.start();
+    AudioChunkInfo info;
+    check(streamer.popChunk(chunk, info) && info.framePosition == 0, "Restart replays from the start");
+    streamer.stop();
+}
+
+static void waitForEnd(const AudioStreamer& streamer) {
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (streamer.isRunning() && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+static void testBoundedQueue() {
+    std::cout << "\nConsumer slower than capture, 8-chunk queue" << std::endl;
+    std::vector<short> pcm = writeWav(16000, 1, 16000 / 4);  // 25 chunks of 10 ms
+
+    // Real-time sources drop; an offline replay waits for the consumer instead
+    CaptureConfig capture = replay(true);
+    capture.queueChunks = 8;
+    AudioStreamer streamer(10, 16000, 1, capture);
+    streamer.start();
+    waitForEnd(streamer);
+
+    std::vector<short> chunk;
+    AudioChunkInfo info;
+    std::vector<uint64_t> positions;
+    bool data = true;
+    while (streamer.popChunk(chunk, info)) {
+        positions.push_back(info.framePosition);
+        data = data && std::equal(chunk.begin(), chunk.end(), pcm.begin() + static_cast<long>(info.framePosition));
+    }
+    std::cout << "  " << positions.size() << " chunks delivered, " << streamer.getDroppedChunks() << " dropped"
+              << std::endl;
+    check(positions.size() == 8, "The queue holds at most queueChunks chunks");
+    check(streamer.getDroppedChunks() == 17, "Every chunk that did not fit is counted as dropped");
+    bool newest = positions.size() == 8;
+    for (size_t i = 0; newest && i < positions.size(); ++i) {
+        newest = positions[i] == (17 + i) * 160;
+    }
+    check(newest, "The oldest chunks are dropped, the newest kept in order");
+    check(data, "Kept chunks hold their own audio");
+
+    // Offline, the same queue delivers everything
+    AudioStreamer offline(10, 16000, 1, [] {
+        CaptureConfig config = replay(false);
+        config.queueChunks = 8;
+        return config;
+    }());
+    offline.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    size_t chunks = 0;
+    bool contiguous = true;
+    while (offline.popChunk(chunk, info)) {
+        contiguous = contiguous && info.framePosition == chunks * 160;
+        ++chunks;
+    }
+    check(chunks == 25 && contiguous && offline.getDroppedChunks() == 0,
+          "Offline replay waits for the consumer and drops nothing");
+}
+
+static void testLeases() {
+    std::cout << "\nAudioChunk leases" << std::endl;
+    std::vector<short> pcm = writeWav(16000, 1, 16000 / 4);
+
+    CaptureConfig capture = replay(true);
+    capture.queueChunks = 4;
+    capture.leaseChunks = 2;
+    std::vector<AudioChunk> leases;
+    uint64_t dropped = 0;
+    {
+        AudioStreamer streamer(10, 16000, 1, capture);
+        streamer.start();
+        // Hold on to every chunk: once all 4 + 2 + 1 buffers are leased the rest is dropped
+        AudioChunk lease;
+        while (streamer.popChunk(lease)) {
+            leases.push_back(std::move(lease));
+        }
+        dropped = streamer.getDroppedChunks();
+        check(!lease && lease.size() == 0, "A failed popChunk() leaves the lease empty");
+    }
+    std::cout << "  " << leases.size() << " leases held, " << dropped << " chunks dropped" << std::endl;
+    check(!leases.empty() && leases.size() <= 7, "Leases are limited to the pooled buffers");
+    check(leases.size() + dropped == 25, "Every chunk is either delivered or counted as dropped");
+
+    // Leased buffers are not reused, even after the streamer is gone
+    bool intact = true;
+    for (const AudioChunk& lease : leases) {
+        intact = intact && lease.size() == 160 &&
+                 std::equal(lease.begin(), lease.end(), pcm.begin() + static_cast<long>(lease.info().framePosition));
+    }
+    check(intact, "Leased data stays valid and unchanged, also after the streamer is destroyed");
+
+    AudioStreamer streamer(10, 16000, 1, capture);
+    streamer.start();
+    AudioChunk first;
+    AudioChunk second;
+    bool popped = streamer.popChunk(first) && streamer.popChunk(second);
+    const short* buffer = first.data();
+    first.release();
+    second = std::move(first);
+    check(popped && !first && !second && buffer != nullptr, "release() and moves leave empty leases behind");
+    streamer.stop();
+}
+
+static void testUnreadableFile() {
+    std::cout << "\nUnreadable input" << std::endl;
+    std::remove(kPath);
+    AudioStreamer missing(10, 16000, 1, replay(false));
+    missing.start();
+    std::vector<short> chunk;
+    check(!missing.isRunning() && !missing.popChunk(chunk), "A missing file does not start");
+
+    const char junk[] = "RIFF\x04\0\0\0WAVEjunk";
+    std::ofstream(kPath, std::ios::binary).write(junk, sizeof(junk) - 1);
+    AudioStreamer invalid(10, 16000, 1, replay(false));
+    invalid.start();
+    check(!invalid.isRunning() && !invalid.popChunk(chunk), "A file without fmt and data chunks does not start");
+}
+
+int main() {
+    std::cout << "Audio Streamer Test Suite" << std::endl;
+    std::cout << "=========================" << std::endl;
+
+    testChunking();
+    testRealtimePacing();
+    testStopMidStream();
+    testBoundedQueue();
+    testLeases();
+    testUnreadableFile();
+    std::remove(kPath);
+
+    if (gFailures) {
+        std::cout << "\n" << gFailures << " AUDIO STREAMER CHECK(S) FAILED!" << std::endl;
+        return 1;
+    }
+    std::cout << "\nALL AUDIO STREAMER TESTS PASSED!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Benchmark: frames/s and heap allocations per frame for OpusAudioCodec, vector API
+// (encode/decode returning new vectors) vs span API (encodeInto/decodeInto into
+// caller-owned buffers).
+//
+// Allocations are counted by replacing the global operator new for this process.
+#include "OpusAudioCodec.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::atomic<size_t> gAllocations{0};
+std::atomic<size_t> gAllocatedBytes{0};
+
+constexpr int kSampleRate = 16000;
+constexpr int kFrames = 3000;  // One minute of 20 ms frames
+
+struct Result {
+    double framesPerSec;
+    double allocsPerFrame;
+    double bytesPerFrame;
+    size_t compressedBytes;
+};
+
+// Voiced-speech stand-in: a gliding harmonic tone with noise, so the encoder does real work
+std::vector<opus_int16> makeSignal(size_t samples) {
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 600.0);
+    std::vector<opus_int16> pcm(samples);
+    double phase = 0.0;
+    for (size_t i = 0; i < samples; ++i) {
+        double t = static_cast<double>(i) / kSampleRate;
+        double pitch = 140.0 + 40.0 * std::sin(2.0 * M_PI * 0.5 * t);
+        phase += 2.0 * M_PI * pitch / kSampleRate;
+        double sample = 6000.0 * std::sin(phase) + 3000.0 * std::sin(2.0 * phase) + 1500.0 * std::sin(3.0 * phase);
+        pcm[i] = static_cast<opus_int16>(std::max(-32768.0, std::min(32767.0, sample + noise(rng))));
+    }
+    return pcm;
+}
+
+template <typename Body>
+Result measure(Body body) {
+    size_t allocsBefore = gAllocations.load();
+    size_t bytesBefore = gAllocatedBytes.load();
+    auto start = std::chrono::steady_clock::now();
+    size_t compressed = body();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return Result{kFrames / seconds, static_cast<double>(gAllocations.load() - allocsBefore) / kFrames,
+                  static_cast<double>(gAllocatedBytes.load() - bytesBefore) / kFrames, compressed};
+}
+
+void report(const char* name, const Result& r) {
+    std::cout << "  " << name << ": " << static_cast<long>(r.framesPerSec) << " frames/s ("
+              << r.framesPerSec * 0.02 << "x real time), " << r.allocsPerFrame << " allocs/frame, "
+              << r.bytesPerFrame << " bytes/frame allocated, " << r.compressedBytes << " bytes compressed"
+              << std::endl;
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Kept out of line so GCC does not pair the inlined free() with operator new
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+int main() {
+    opus::OpusAudioCodec vectorCodec(kSampleRate, 1, OPUS_APPLICATION_VOIP);
+    opus::OpusAudioCodec spanCodec(kSampleRate, 1, OPUS_APPLICATION_VOIP);
+    const size_t frameSize = static_cast<size_t>(vectorCodec.getFrameSize());
+    std::vector<opus_int16> signal = makeSignal(frameSize * kFrames);
+
+    std::cout << "OpusAudioCodec encode+decode, " << kFrames << " frames of " << frameSize << " samples @ "
+              << kSampleRate << " Hz" << std::endl;
+
+    // Frames are copied into a vector, as a streaming caller holding chunks would have them
+    std::vector<opus_int16> frame(frameSize);
+    Result vectorResult = measure([&] {
+        size_t compressed = 0;
+        for (int i = 0; i < kFrames; ++i) {
+            std::copy(signal.begin() + i * frameSize, signal.begin() + (i + 1) * frameSize, frame.begin());
+            std::vector<unsigned char> packet = vectorCodec.encode(frame);
+            std::vector<opus_int16> decoded = vectorCodec.decode(packet);
+            compressed += packet.size();
+        }
+        return compressed;
+    });
+
+    std::vector<uint8_t> packet(opus::OpusAudioCodec::kMaxPacketBytes);
+    std::vector<opus_int16> decoded(frameSize);
+    Result spanResult = measure([&] {
+        size_t compressed = 0;
+        for (int i = 0; i < kFrames; ++i) {
+            size_t bytes = spanCodec.encodeInto(utils::Span<const opus_int16>(&signal[i * frameSize], frameSize), packet);
+            spanCodec.decodeInto(utils::Span<const uint8_t>(packet.data(), bytes), decoded);
+            compressed += bytes;
+        }
+        return compressed;
+    });
+
+    report("encode/decode        ", vectorResult);
+    report("encodeInto/decodeInto", spanResult);
+
+    if (spanResult.compressedBytes != vectorResult.compressedBytes) {
+        std::cerr << "ERROR: both APIs should produce the same stream" << std::endl;
+        return 1;
+    }
+    if (spanResult.allocsPerFrame != 0.0) {
+        std::cerr << "ERROR: encodeInto/decodeInto allocated on the heap" << std::endl;
+        return 1;
+    }
+    return 0;
+}
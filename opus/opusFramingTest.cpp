@@ -0,0 +1,238 @@
+// Tests for OpusFrameEncoder: arbitrary-length input, every frame duration, multi-frame
+// packets, and decoding variable-duration packets with OpusAudioCodec
+#include "OpusFrameEncoder.h"
+#include "test_check.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace opus;
+
+static std::vector<opus_int16> makeTone(size_t samples, int sampleRate) {
+    std::vector<opus_int16> pcm(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        double t = static_cast<double>(i) / sampleRate;
+        pcm[i] = static_cast<opus_int16>(std::lround(8000.0 * std::sin(2.0 * M_PI * 440.0 * t) +
+                                                     3000.0 * std::sin(2.0 * M_PI * 1250.0 * t)));
+    }
+    return pcm;
+}
+
+struct Stream {
+    std::vector<std::vector<uint8_t>> packets;
+    std::vector<int> durations;
+    size_t bytes = 0;
+    int lookahead = 0;
+};
+
+// Feeds pcm to a new encoder in random chunk sizes (or whole frames when rng is null)
+static Stream encode(const OpusFramingConfig& config, const std::vector<opus_int16>& pcm, std::mt19937* rng,
+                     std::vector<opus_int16>* decoded = nullptr) {
+    Stream stream;
+    OpusFrameEncoder* encoderPtr = nullptr;
+    std::vector<opus_int16> frame;
+    OpusFrameEncoder encoder(config, [&](utils::Span<const uint8_t> packet, int samplesPerChannel) {
+        stream.packets.emplace_back(packet.begin(), packet.end());
+        stream.durations.push_back(samplesPerChannel);
+        stream.bytes += packet.size();
+        if (decoded) {
+            // The codec's own decoder went through the same warm-up as its encoder
+            size_t samples = encoderPtr->codec().decodeInto(utils::Span<const uint8_t>(packet.data(), packet.size()), frame);
+            decoded->insert(decoded->end(), frame.begin(), frame.begin() + samples * config.channels);
+        }
+    });
+    encoderPtr = &encoder;
+    frame.resize(encoder.codec().getMaxDecodeSamples());
+    stream.lookahead = encoder.codec().getLookahead();
+
+    std::uniform_int_distribution<size_t> chunk(1, 997);
+    size_t frameSamples = static_cast<size_t>(encoder.codec().getFrameSize()) * config.channels;
+    for (size_t offset = 0; offset < pcm.size();) {
+        size_t count = std::min(pcm.size() - offset, rng ? chunk(*rng) * config.channels : frameSamples);
+        encoder.write(utils::Span<const opus_int16>(&pcm[offset], count));
+        offset += count;
+    }
+    encoder.flush();
+    check(encoder.bufferedSamples() == 0, "Nothing left buffered after flush");
+    return stream;
+}
+
+// Signal-to-noise ratio of decoded against input, at the delay that fits best around the lookahead
+static double alignedSnrDb(const std::vector<opus_int16>& input, const std::vector<opus_int16>& decoded,
+                           int lookahead) {
+    double best = -100.0;
+    for (int delay = 0; delay <= 2 * lookahead; ++delay) {
+        double signal = 0.0;
+        double noise = 0.0;
+        for (size_t i = 0; i + delay < decoded.size() && i < input.size(); ++i) {
+            double diff = static_cast<double>(decoded[i + delay]) - input[i];
+            signal += static_cast<double>(input[i]) * input[i];
+            noise += diff * diff;
+        }
+        best = std::max(best, 10.0 * std::log10(signal / std::max(noise, 1.0)));
+    }
+    return best;
+}
+
+static void testFrameDurations() {
+    std::cout << "\nEvery frame duration and packet length, random chunk sizes" << std::endl;
+    const int sampleRate = 16000;
+    std::vector<opus_int16> pcm = makeTone(sampleRate + 123, sampleRate);  // Ends mid-frame
+    std::mt19937 rng(5);
+
+    for (double frameMs : {2.5, 5.0, 10.0, 20.0, 40.0, 60.0}) {
+        for (int framesPerPacket : {1, 2, 3}) {
+            if (frameMs * framesPerPacket > OpusAudioCodec::kMaxPacketDurationMs) {
+                continue;
+            }
+            OpusFramingConfig config;
+            config.sampleRate = sampleRate;
+            config.frameDurationMs = frameMs;
+            config.framesPerPacket = framesPerPacket;
+
+            std::vector<opus_int16> decoded;
+            Stream stream = encode(config, pcm, &rng, &decoded);
+
+            int frameSize = static_cast<int>(std::lround(sampleRate * frameMs / 1000.0));
+            size_t expected = (pcm.size() + frameSize - 1) / frameSize * frameSize;
+            size_t total = 0;
+            bool durationsMatch = true;
+            for (size_t i = 0; i < stream.packets.size(); ++i) {
+                const auto& packet = stream.packets[i];
+                int samples = opus_packet_get_nb_samples(packet.data(), static_cast<opus_int32>(packet.size()), sampleRate);
+                durationsMatch = durationsMatch && samples == stream.durations[i] && samples % frameSize == 0 &&
+                                 samples <= frameSize * framesPerPacket;
+                total += static_cast<size_t>(stream.durations[i]);
+            }
+
+            double snr = alignedSnrDb(pcm, decoded, stream.lookahead);
+            std::string name = std::to_string(frameMs).substr(0, 4) + " ms x " + std::to_string(framesPerPacket);
+            std::cout << "  " << name << ": " << stream.packets.size() << " packets, " << stream.bytes * 8 / 1000.0
+                      << " kbit, SNR " << snr << " dB" << std::endl;
+            check(durationsMatch && total == expected && decoded.size() == expected,
+                  name + ": packet durations add up to the input rounded up to a frame");
+            check(snr > 10.0, name + ": decoded audio follows the input");
+        }
+    }
+}
+
+static void testChunkingIsTransparent() {
+    std::cout << "\nChunk sizes do not change the stream" << std::endl;
+    OpusFramingConfig config = OpusFramingConfig::bulk();
+    config.channels = 2;
+    std::vector<opus_int16> mono = makeTone(48000, config.sampleRate);
+    std::vector<opus_int16> stereo(mono.size() * 2);
+    for (size_t i = 0; i < mono.size(); ++i) {
+        stereo[2 * i] = mono[i];
+        stereo[2 * i + 1] = static_cast<opus_int16>(mono[i] / 2);
+    }
+
+    std::mt19937 rng(9);
+    Stream chunked = encode(config, stereo, &rng);
+    Stream framed = encode(config, stereo, nullptr);
+    check(chunked.packets == framed.packets, "Random chunks and whole frames give identical packets (stereo, bulk)");
+}
+
+static void testInvalidConfigurations() {
+    std::cout << "\nInvalid configurations" << std::endl;
+    auto rejects = [](OpusFramingConfig config) {
+        try {
+            OpusFrameEncoder encoder(config, [](utils::Span<const uint8_t>, int) {});
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    OpusFramingConfig config;
+    config.frameDurationMs = 15.0;
+    check(rejects(config), "15 ms frames are rejected");
+    config.frameDurationMs = 60.0;
+    config.framesPerPacket = 3;
+    check(rejects(config), "180 ms packets are rejected");
+    config.framesPerPacket = 0;
+    check(rejects(config), "Zero frames per packet is rejected");
+
+    OpusFramingConfig stereo;
+    stereo.channels = 2;
+    OpusFrameEncoder encoder(stereo, [](utils::Span<const uint8_t>, int) {});
+    std::vector<opus_int16> odd(3);
+    bool threw = false;
+    try {
+        encoder.write(odd);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "Stereo input ending inside a sample frame is rejected");
+}
+
+static void testDrainAndReset() {
+    std::cout << "\nDrain and reset" << std::endl;
+    OpusFramingConfig config = OpusFramingConfig::bulk();
+    std::vector<opus_int16> first = makeTone(config.sampleRate * 2, config.sampleRate);  // Ends on a packet
+    std::vector<opus_int16> second = makeTone(config.sampleRate + 321, config.sampleRate / 2);
+
+    std::vector<std::vector<uint8_t>>* sink = nullptr;
+    int emitted = 0;
+    auto collect = [&](utils::Span<const uint8_t> packet, int samplesPerChannel) {
+        sink->emplace_back(packet.begin(), packet.end());
+        emitted += samplesPerChannel;
+    };
+    std::vector<std::vector<uint8_t>> ignored;
+    std::vector<std::vector<uint8_t>> reused;
+    std::vector<std::vector<uint8_t>> fresh;
+
+    OpusFrameEncoder encoder(config, collect);
+    sink = &ignored;
+    encoder.write(first);
+    encoder.drain();
+    check(encoder.bufferedSamples() == 0 &&
+              emitted >= static_cast<int>(first.size()) + encoder.codec().getLookahead(),
+          "drain() covers the input plus the encoder lookahead");
+
+    encoder.reset();
+    sink = &reused;
+    encoder.write(second);
+    encoder.flush();
+
+    OpusFrameEncoder clean(config, collect);
+    clean.reset();
+    sink = &fresh;
+    clean.write(second);
+    clean.flush();
+    check(!reused.empty() && reused == fresh, "After reset() a used encoder produces the same packets as a clean one");
+}
+
+static void testLatencyPresets() {
+    std::cout << "\nLatency presets" << std::endl;
+    std::vector<opus_int16> pcm = makeTone(16000 * 5, 16000);
+    Stream interactive = encode(OpusFramingConfig::interactive(), pcm, nullptr);
+    Stream bulk = encode(OpusFramingConfig::bulk(), pcm, nullptr);
+    std::cout << "  interactive: " << interactive.packets.size() << " packets, " << interactive.bytes << " bytes"
+              << std::endl;
+    std::cout << "  bulk:        " << bulk.packets.size() << " packets, " << bulk.bytes << " bytes" << std::endl;
+    check(interactive.packets.size() == 500, "Interactive sends a packet every 10 ms");
+    check(bulk.packets.size() >= 42 && bulk.packets.size() < interactive.packets.size() / 10,
+          "Bulk sends about one packet every 120 ms");
+}
+
+int main() {
+    std::cout << "Opus Framing Test Suite" << std::endl;
+    std::cout << "=======================" << std::endl;
+
+    testFrameDurations();
+    testChunkingIsTransparent();
+    testInvalidConfigurations();
+    testDrainAndReset();
+    testLatencyPresets();
+
+    if (gFailures) {
+        std::cout << "\n" << gFailures << " FRAMING CHECK(S) FAILED!" << std::endl;
+        return 1;
+    }
+    std::cout << "\nALL FRAMING TESTS PASSED!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,254 @@
+// Lossy-channel simulation for OpusStreamDecoder: speech-like audio is encoded with and
+// without in-band FEC, packets are dropped at random, and the receiver output is scored
+// against the input for each loss rate.
+//
+// The score is a segmental spectral SNR: per 20 ms segment, the error between the input
+// and output magnitude spectra. Like PESQ it ignores waveform phase, which SILK does not
+// preserve, so it tracks audible damage rather than sample-exact differences.
+#include "OpusStreamDecoder.h"
+#include "test_check.h"
+
+#include <cmath>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace opus;
+
+namespace {
+
+constexpr int kSampleRate = 16000;
+constexpr int kSeconds = 20;
+
+// Voiced syllables: a gliding harmonic tone under a 4 Hz envelope with short pauses
+std::vector<opus_int16> makeSpeechLike() {
+    std::mt19937 rng(1);
+    std::normal_distribution<double> noise(0.0, 150.0);
+    std::vector<opus_int16> pcm(static_cast<size_t>(kSampleRate) * kSeconds);
+    double phase = 0.0;
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        double t = static_cast<double>(i) / kSampleRate;
+        double pitch = 120.0 + 50.0 * std::sin(2.0 * M_PI * 0.7 * t);
+        phase += 2.0 * M_PI * pitch / kSampleRate;
+        double envelope = std::max(0.0, std::sin(2.0 * M_PI * 4.0 * t) + 0.3);
+        double voice = 5000.0 * std::sin(phase) + 2500.0 * std::sin(2.0 * phase + 0.5) + 1200.0 * std::sin(3.0 * phase);
+        pcm[i] = static_cast<opus_int16>(std::lround(envelope * voice + noise(rng)));
+    }
+    return pcm;
+}
+
+std::vector<std::vector<uint8_t>> encodeStream(const std::vector<opus_int16>& pcm, bool fec, int lossPercent) {
+    OpusAudioCodec codec(kSampleRate, 1, OPUS_APPLICATION_VOIP);
+    codec.setInbandFec(fec);
+    codec.setPacketLossPercent(lossPercent);
+
+    std::vector<std::vector<uint8_t>> packets;
+    std::vector<uint8_t> packet(OpusAudioCodec::kMaxPacketBytes);
+    size_t frame = static_cast<size_t>(codec.getFrameSize());
+    for (size_t offset = 0; offset + frame <= pcm.size(); offset += frame) {
+        size_t bytes = codec.encodeInto(utils::Span<const opus_int16>(&pcm[offset], frame), packet);
+        packets.emplace_back(packet.begin(), packet.begin() + bytes);
+    }
+    return packets;
+}
+
+// Bernoulli loss; the first packet always arrives so the receiver has a starting point
+std::vector<bool> makeLossPattern(size_t packets, double lossRate, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::bernoulli_distribution lost(lossRate);
+    std::vector<bool> pattern(packets);
+    for (size_t i = 1; i < packets; ++i) {
+        pattern[i] = lost(rng);
+    }
+    return pattern;
+}
+
+struct Reception {
+    std::vector<opus_int16> pcm;
+    std::vector<opus_int16> zeroFilled;  // Same output with every concealed packet muted
+    OpusStreamStats stats;
+};
+
+// Sequence numbers start near the wrap-around point to exercise it
+Reception receive(const std::vector<std::vector<uint8_t>>& packets, const std::vector<bool>& lost, bool useFec) {
+    OpusAudioCodec codec(kSampleRate, 1, OPUS_APPLICATION_VOIP);
+    Reception reception;
+    OpusStreamDecoder decoder(codec, [&](utils::Span<const opus_int16> pcm, PcmSource source) {
+        reception.pcm.insert(reception.pcm.end(), pcm.begin(), pcm.end());
+        if (source == PcmSource::Concealed) {
+            reception.zeroFilled.insert(reception.zeroFilled.end(), pcm.size(), 0);
+        } else {
+            reception.zeroFilled.insert(reception.zeroFilled.end(), pcm.begin(), pcm.end());
+        }
+    }, useFec);
+
+    const uint16_t firstSequence = 65500;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        if (!lost[i]) {
+            decoder.receive(static_cast<uint16_t>(firstSequence + i),
+                            utils::Span<const uint8_t>(packets[i].data(), packets[i].size()));
+        }
+    }
+    reception.stats = decoder.stats();
+    return reception;
+}
+
+// In-place radix-2 FFT
+void fft(std::vector<std::complex<double>>& a) {
+    const size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        std::complex<double> step = std::polar(1.0, -2.0 * M_PI / len);
+        for (size_t i = 0; i < n; i += len) {
+            std::complex<double> w(1.0);
+            for (size_t k = 0; k < len / 2; ++k) {
+                std::complex<double> u = a[i + k];
+                std::complex<double> v = a[i + k + len / 2] * w;
+                a[i + k] = u + v;
+                a[i + k + len / 2] = u - v;
+                w *= step;
+            }
+        }
+    }
+}
+
+// Hann-windowed magnitude spectrum of 512 samples starting at pcm[start]
+std::vector<double> magnitudes(const std::vector<opus_int16>& pcm, size_t start) {
+    const size_t n = 512;
+    std::vector<std::complex<double>> bins(n);
+    for (size_t i = 0; i < n; ++i) {
+        double window = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / (n - 1));
+        bins[i] = start + i < pcm.size() ? window * pcm[start + i] : 0.0;
+    }
+    fft(bins);
+    std::vector<double> result(n / 2 + 1);
+    for (size_t i = 0; i < result.size(); ++i) {
+        result[i] = std::abs(bins[i]);
+    }
+    return result;
+}
+
+// Mean spectral SNR over 20 ms segments, each clamped to [-10, 35] dB; quiet segments are skipped
+double segmentalSnrDb(const std::vector<opus_int16>& input, const std::vector<opus_int16>& output, int delay) {
+    const size_t segment = kSampleRate / 50;
+    double total = 0.0;
+    size_t count = 0;
+    for (size_t start = 0; start + 512 + delay <= output.size() && start + 512 <= input.size(); start += segment) {
+        std::vector<double> reference = magnitudes(input, start);
+        std::vector<double> degraded = magnitudes(output, start + delay);
+        double signal = 0.0;
+        double noise = 0.0;
+        for (size_t i = 0; i < reference.size(); ++i) {
+            signal += reference[i] * reference[i];
+            noise += (degraded[i] - reference[i]) * (degraded[i] - reference[i]);
+        }
+        if (signal < 1e12) {
+            continue;
+        }
+        double snr = 10.0 * std::log10(signal / std::max(noise, 1.0));
+        total += std::max(-10.0, std::min(snr, 35.0));
+        ++count;
+    }
+    return count ? total / count : 0.0;
+}
+
+} // namespace
+
+static void testLossyChannel() {
+    std::cout << "\nSegmental spectral SNR (dB) vs. random packet loss (20 ms packets, " << kSeconds << " s)" << std::endl;
+    std::vector<opus_int16> input = makeSpeechLike();
+    int delay = OpusAudioCodec(kSampleRate, 1, OPUS_APPLICATION_VOIP).getLookahead();
+
+    std::cout << "  loss   muted    PLC   FEC+PLC  recovered" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::vector<std::vector<uint8_t>> plain = encodeStream(input, false, 0);
+    for (int lossPercent : {0, 5, 10, 20, 30}) {
+        std::vector<std::vector<uint8_t>> withFec = encodeStream(input, true, lossPercent);
+        std::vector<bool> lost = makeLossPattern(plain.size(), lossPercent / 100.0, 42);
+
+        Reception concealed = receive(plain, lost, false);
+        Reception recovered = receive(withFec, lost, true);
+        double mutedSnr = segmentalSnrDb(input, concealed.zeroFilled, delay);
+        double plcSnr = segmentalSnrDb(input, concealed.pcm, delay);
+        double fecSnr = segmentalSnrDb(input, recovered.pcm, delay);
+        std::cout << "  " << std::setw(3) << lossPercent << "%  " << std::setw(6) << mutedSnr << "  " << std::setw(6)
+                  << plcSnr << "  " << std::setw(7) << fecSnr << "  " << std::setw(5) << recovered.stats.recovered
+                  << " / " << recovered.stats.recovered + recovered.stats.concealed << " lost" << std::endl;
+
+        std::string label = std::to_string(lossPercent) + "% loss: ";
+        check(concealed.pcm.size() == input.size() && recovered.pcm.size() == input.size(),
+              label + "output keeps the timeline (one packet duration per sequence number)");
+        if (lossPercent == 0) {
+            check(plcSnr > 10.0 && std::abs(fecSnr - plcSnr) < 3.0, label + "FEC costs little quality without loss");
+        } else {
+            check(plcSnr > mutedSnr, label + "concealment beats muting lost packets");
+            check(fecSnr > plcSnr, label + "FEC recovery beats concealment alone");
+        }
+    }
+}
+
+static void testSequenceHandling() {
+    std::cout << "\nSequence numbers" << std::endl;
+    OpusAudioCodec sender(kSampleRate, 1, OPUS_APPLICATION_VOIP);
+    OpusAudioCodec codec(kSampleRate, 1, OPUS_APPLICATION_VOIP);
+    std::vector<PcmSource> sources;
+    OpusStreamDecoder decoder(codec, [&](utils::Span<const opus_int16>, PcmSource source) {
+        sources.push_back(source);
+    });
+
+    std::vector<opus_int16> frame(sender.getFrameSize(), 1000);
+    std::vector<unsigned char> packet = sender.encode(frame);
+    auto receive = [&](uint16_t sequence) {
+        decoder.receive(sequence, utils::Span<const uint8_t>(packet.data(), packet.size()));
+    };
+
+    receive(65534);
+    receive(65535);
+    receive(2);      // 0 concealed, 1 recovered from FEC, then 2
+    receive(1);      // Late
+    receive(2);      // Duplicate
+    decoder.conceal();  // 3 misses its playout deadline
+    receive(3);      // Late
+    receive(4);
+    receive(1000);   // Too far ahead: restart without concealment
+    receive(990);    // Late, within the misorder window
+    receive(5);      // Sender restarted with a lower sequence number: restart again
+    receive(6);
+
+    std::vector<PcmSource> expected = {PcmSource::Decoded, PcmSource::Decoded, PcmSource::Concealed,
+                                       PcmSource::Recovered, PcmSource::Decoded, PcmSource::Concealed,
+                                       PcmSource::Decoded, PcmSource::Decoded, PcmSource::Decoded,
+                                       PcmSource::Decoded};
+    const OpusStreamStats& stats = decoder.stats();
+    check(sources == expected, "Gaps across the wrap-around are concealed, then recovered from the next packet");
+    check(stats.received == 7 && stats.recovered == 1 && stats.concealed == 2, "Received/recovered/concealed counts");
+    check(stats.late == 4, "Late and duplicate packets are dropped");
+    check(stats.resyncs == 2, "Jumps past maxConcealedPackets ahead or the misorder window behind restart the stream");
+}
+
+int main() {
+    std::cout << "Opus Packet Loss Test Suite" << std::endl;
+    std::cout << "===========================" << std::endl;
+
+    testSequenceHandling();
+    testLossyChannel();
+
+    if (gFailures) {
+        std::cout << "\n" << gFailures << " LOSS CHECK(S) FAILED!" << std::endl;
+        return 1;
+    }
+    std::cout << "\nALL PACKET LOSS TESTS PASSED!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,298 @@
+// Tests for OggOpusWriter and OggOpusReader: round trip, page batching, granule
+// positions with pre-skip and end trimming, seeking, and truncated files
+#include "OggOpusReader.h"
+#include "OggOpusWriter.h"
+#include "OpusFrameEncoder.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace opus;
+
+namespace {
+
+const char* kPath = "opus_ogg_file_test.opus";
+
+struct Written {
+    std::vector<std::vector<uint8_t>> packets;
+    std::vector<int> durations;  // At the input rate
+    int preSkip = 0;
+    OggOpusWriterStats stats;
+};
+
+std::vector<opus_int16> makeAudio(size_t samples, int sampleRate) {
+    std::mt19937 rng(3);
+    std::normal_distribution<double> noise(0.0, 300.0);
+    std::vector<opus_int16> pcm(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        double t = static_cast<double>(i) / sampleRate;
+        pcm[i] = static_cast<opus_int16>(std::lround(6000.0 * std::sin(2.0 * M_PI * 330.0 * t) *
+                                                     (0.6 + 0.4 * std::sin(2.0 * M_PI * 3.0 * t)) + noise(rng)));
+    }
+    return pcm;
+}
+
+Written writeFile(const OpusFramingConfig& config, const std::vector<opus_int16>& pcm, int maxPageDurationMs) {
+    Written written;
+    std::unique_ptr<OggOpusWriter> writer;
+    OpusFrameEncoder encoder(config, [&](utils::Span<const uint8_t> packet, int samples) {
+        written.packets.emplace_back(packet.begin(), packet.end());
+        written.durations.push_back(samples);
+        writer->writePacket(std::move(packet), samples);
+    });
+
+    OggOpusWriterOptions options;
+    options.sampleRate = config.sampleRate;
+    options.channels = config.channels;
+    options.preSkip = encoder.codec().getLookahead();
+    options.comments = {"TITLE=ogg file test", "ENCODER=OpusFrameEncoder"};
+    options.maxPageDurationMs = maxPageDurationMs;
+    writer = std::make_unique<OggOpusWriter>(kPath, options);
+    written.preSkip = options.preSkip;
+
+    encoder.write(pcm);
+    encoder.drain();
+    writer->close(static_cast<int64_t>(pcm.size() / config.channels));
+    written.stats = writer->getStats();
+    return written;
+}
+
+std::vector<OggOpusPacket> readAll(OggOpusReader& reader) {
+    std::vector<OggOpusPacket> packets;
+    OggOpusPacket packet;
+    while (reader.readPacket(packet)) {
+        packets.push_back(packet);
+    }
+    return packets;
+}
+
+long fileSize(const char* path) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fclose(file);
+    return size;
+}
+
+} // namespace
+
+static void testRoundTrip() {
+    std::cout << "\nRound trip, 3 minutes at 16 kHz in 20 ms packets" << std::endl;
+    OpusFramingConfig config;
+    const size_t samples = static_cast<size_t>(config.sampleRate) * 180 + 77;  // Ends mid-frame
+    std::vector<opus_int16> pcm = makeAudio(samples, config.sampleRate);
+    Written written = writeFile(config, pcm, 0);
+    const int scale = 48000 / config.sampleRate;
+
+    OggOpusReader reader(kPath);
+    std::vector<OggOpusPacket> packets = readAll(reader);
+    std::cout << "  " << written.stats.packets << " packets, " << written.stats.pages << " pages, "
+              << written.stats.bytes << " bytes in " << written.stats.writes << " write() calls" << std::endl;
+
+    check(reader.getChannels() == 1 && reader.getInputSampleRate() == config.sampleRate &&
+              reader.getPreSkip() == written.preSkip * scale,
+          "OpusHead carries channels, input rate and pre-skip at 48 kHz");
+    check(reader.getComments().size() == 2 && reader.getComments()[0] == "TITLE=ogg file test",
+          "OpusTags comments survive");
+
+    bool same = packets.size() == written.packets.size();
+    bool continuous = same && packets.front().startSample == -reader.getPreSkip();
+    for (size_t i = 0; same && i < packets.size(); ++i) {
+        same = packets[i].data == written.packets[i];
+        if (i + 1 < packets.size()) {
+            continuous = continuous && packets[i].durationSamples == written.durations[i] * scale &&
+                         packets[i + 1].startSample == packets[i].startSample + packets[i].durationSamples;
+        }
+    }
+    check(same, "Every packet is read back unchanged and in order");
+    check(continuous, "Packet times follow from the granule positions, starting at -preSkip");
+
+    const OggOpusPacket& last = packets.back();
+    check(reader.getDurationSamples() == static_cast<int64_t>(samples) * scale &&
+              last.startSample + last.durationSamples == reader.getDurationSamples(),
+          "The final granule trims the last frame's padding");
+    check(written.stats.pages < written.stats.packets / 10, "Pages carry many packets each");
+    check(written.stats.writes <= written.stats.bytes / (64 * 1024) + 1, "Pages reach the file in 64 KiB writes");
+}
+
+static void testPageBatching() {
+    std::cout << "\nBatched pages vs. a page per packet" << std::endl;
+    OpusFramingConfig config;
+    std::vector<opus_int16> pcm = makeAudio(static_cast<size_t>(config.sampleRate) * 60, config.sampleRate);
+    Written perPacket = writeFile(config, pcm, 20);
+    long perPacketSize = fileSize(kPath);
+    Written batched = writeFile(config, pcm, 0);
+    long batchedSize = fileSize(kPath);
+    std::cout << "  page per packet: " << perPacket.stats.pages << " pages, " << perPacketSize << " bytes" << std::endl;
+    std::cout << "  batched:         " << batched.stats.pages << " pages, " << batchedSize << " bytes" << std::endl;
+    check(perPacket.stats.pages >= perPacket.stats.packets, "maxPageDurationMs = 20 closes a page per packet");
+    check(batchedSize < perPacketSize, "Batched pages make a smaller file");
+
+    Written oneSecond = writeFile(config, pcm, 1000);
+    OggOpusReader reader(kPath);
+    check(oneSecond.stats.pages >= 60 && readAll(reader).size() == oneSecond.stats.packets,
+          "maxPageDurationMs = 1000 closes a page at least every second");
+}
+
+static void testSeeking() {
+    std::cout << "\nSeeking" << std::endl;
+    OpusFramingConfig config = OpusFramingConfig::bulk();  // 120 ms packets
+    config.channels = 2;
+    const size_t frames = static_cast<size_t>(config.sampleRate) * 300;
+    std::vector<opus_int16> mono = makeAudio(frames, config.sampleRate);
+    std::vector<opus_int16> stereo(frames * 2);
+    for (size_t i = 0; i < frames; ++i) {
+        stereo[2 * i] = mono[i];
+        stereo[2 * i + 1] = static_cast<opus_int16>(-mono[i]);
+    }
+    writeFile(config, stereo, 0);
+
+    OggOpusReader reader(kPath);
+    std::vector<OggOpusPacket> all = readAll(reader);
+    check(reader.getChannels() == 2, "Stereo header");
+    check(reader.getDurationSamples() == static_cast<int64_t>(frames) * 3,
+          "A stream ending on a packet boundary still covers every sample");
+
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int64_t> position(0, reader.getDurationSamples() - 1);
+    bool covered = true;
+    bool close = true;
+    bool matches = true;
+    for (int i = 0; i < 200; ++i) {
+        int64_t target = i == 0 ? 0 : (i == 1 ? reader.getDurationSamples() - 1 : position(rng));
+        reader.seek(target);
+        OggOpusPacket packet;
+        if (!reader.readPacket(packet)) {
+            covered = false;
+            continue;
+        }
+        int64_t earliest = std::max<int64_t>(-reader.getPreSkip(), target - OggOpusReader::kSeekPreRollSamples);
+        covered = covered && packet.startSample <= earliest;
+        // At most one page (about 4 KB, here under 1.5 s) ahead of the pre-roll
+        close = close && packet.startSample >= earliest - 72000;
+
+        // The packets from there on are the ones a linear read gives at the same times
+        size_t index = 0;
+        while (index < all.size() && all[index].startSample != packet.startSample) {
+            ++index;
+        }
+        for (int n = 0; n < 5 && index < all.size(); ++n, ++index) {
+            matches = matches && all[index].data == packet.data && all[index].durationSamples == packet.durationSamples;
+            if (!reader.readPacket(packet)) {
+                break;
+            }
+        }
+    }
+    check(covered, "After seek(t) the next packet starts at least the pre-roll before t");
+    check(close, "... and no more than a page before that");
+    check(matches, "Packets after a seek match the linear read");
+}
+
+static void testShortClip() {
+    std::cout << "\nClip shorter than one page" << std::endl;
+    OpusFramingConfig config;
+    const size_t samples = static_cast<size_t>(config.sampleRate) * 3 / 10 + 77;  // 0.3 s, ends mid-frame
+    std::vector<opus_int16> pcm = makeAudio(samples, config.sampleRate);
+    Written written = writeFile(config, pcm, 0);
+    const int scale = 48000 / config.sampleRate;
+
+    OggOpusReader reader(kPath);
+    std::vector<OggOpusPacket> packets = readAll(reader);
+    check(written.stats.pages == 3, "Headers and all audio fit in three pages, the audio page being end-of-stream");
+
+    bool continuous = packets.size() == written.packets.size() && packets.front().startSample == -reader.getPreSkip();
+    for (size_t i = 0; continuous && i + 1 < packets.size(); ++i) {
+        continuous = packets[i].durationSamples == written.durations[i] * scale &&
+                     packets[i + 1].startSample == packets[i].startSample + packets[i].durationSamples;
+    }
+    check(continuous, "Packet times count forward from -preSkip");
+    const OggOpusPacket& last = packets.back();
+    check(reader.getDurationSamples() == static_cast<int64_t>(samples) * scale &&
+              last.startSample + last.durationSamples == reader.getDurationSamples() &&
+              last.durationSamples < written.durations.back() * scale,
+          "The last packet is trimmed to the stream end");
+
+    // No audio at all: silent frames cover the pre-skip and end the stream at zero length
+    for (int preSkip : {0, written.preSkip}) {
+        OggOpusWriterOptions options;
+        options.sampleRate = config.sampleRate;
+        options.preSkip = preSkip;
+        OggOpusWriter writer(kPath, options);
+        writer.close(0);
+
+        std::vector<char> bytes(static_cast<size_t>(fileSize(kPath)));
+        FILE* file = std::fopen(kPath, "rb");
+        bool read = file && std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        if (file) {
+            std::fclose(file);
+        }
+        const std::string data(bytes.begin(), bytes.end());
+        size_t lastPage = data.rfind("OggS");
+        bool eos = read && lastPage != std::string::npos && (data[lastPage + 5] & 0x04) != 0;
+
+        OggOpusReader empty(kPath);
+        std::vector<OggOpusPacket> silent = readAll(empty);
+        bool inPreSkip = !silent.empty();
+        for (const auto& packet : silent) {
+            inPreSkip = inPreSkip && packet.startSample + packet.durationSamples <= 0;
+        }
+        const std::string label = "Empty stream, pre-skip " + std::to_string(preSkip) + ": ";
+        check(writer.getStats().pages == 3 && eos, label + "ends with an end-of-stream page");
+        check(inPreSkip && empty.getDurationSamples() == 0, label + "reads back as no audio");
+    }
+}
+
+static void testTruncatedFile() {
+    std::cout << "\nTruncated file" << std::endl;
+    OpusFramingConfig config;
+    std::vector<opus_int16> pcm = makeAudio(static_cast<size_t>(config.sampleRate) * 30, config.sampleRate);
+    Written written = writeFile(config, pcm, 0);
+    long size = fileSize(kPath);
+    if (truncate(kPath, size * 2 / 3) != 0) {
+        check(false, "truncate() the test file");
+        return;
+    }
+
+    OggOpusReader reader(kPath);
+    std::vector<OggOpusPacket> packets = readAll(reader);
+    bool prefix = !packets.empty() && packets.size() < written.packets.size();
+    for (size_t i = 0; prefix && i < packets.size(); ++i) {
+        prefix = packets[i].data == written.packets[i];
+    }
+    check(prefix, "A file cut mid-page reads up to the last complete page (" + std::to_string(packets.size()) + " of " +
+                      std::to_string(written.packets.size()) + " packets)");
+}
+
+int main() {
+    std::cout << "Ogg Opus File Test Suite" << std::endl;
+    std::cout << "========================" << std::endl;
+
+    try {
+        testRoundTrip();
+        testPageBatching();
+        testSeeking();
+        testShortClip();
+        testTruncatedFile();
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        ++gFailures;
+    }
+    std::remove(kPath);
+
+    if (gFailures) {
+        std::cout << "\n" << gFailures << " OGG FILE CHECK(S) FAILED!" << std::endl;
+        return 1;
+    }
+    std::cout << "\nALL OGG FILE TESTS PASSED!" << std::endl;
+    return 0;
+}
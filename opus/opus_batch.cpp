@@ -0,0 +1,469 @@
+// Batch transcoding between WAV and Ogg Opus on worker threads, for compressing captured
+// audio in idle time.
+//
+// .wav inputs are encoded to .opus, .opus/.ogg inputs are decoded back to .wav; outputs go
+// next to the inputs or into -o dir. WAV inputs are memory-mapped and encoded straight from
+// the mapping (16-bit PCM at an Opus rate: 8, 12, 16, 24 or 48 kHz, 1 or 2 channels). Each
+// worker thread owns one encoder and one decoder and reuses them from file to file; larger
+// files are handed out first so the workers finish together. At the end the tool reports
+// throughput in multiples of real time, for the whole batch and per worker, and the
+// compression ratio.
+//
+// So it does not disturb interactive work, the process lowers its priority (-n nice, 10 by
+// default; -I for the idle scheduling class) and can be confined to a number of CPUs
+// (-c cpus); -j sets the worker count, by default one per usable CPU.
+//
+// Usage: opus_batch [-j threads] [-c cpus] [-n nice] [-I] [-b bitrate] [-q complexity]
+//                   [-f frame_ms] [-p frames_per_packet] [-o dir] file ...
+#include "OggOpusReader.h"
+#include "OggOpusWriter.h"
+#include "OpusFrameEncoder.h"
+#include "WaveHeader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <mutex>
+#include <sched.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace opus;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t kWavWriteBytes = 256 * 1024;
+
+struct Options {
+    OpusFramingConfig framing = OpusFramingConfig::bulk();
+    int bitrate = 0;      // 0 keeps the codec default
+    int complexity = -1;  // < 0 keeps the codec default
+    std::string outputDir;
+};
+
+struct Job {
+    std::string input;
+    std::string output;
+    off_t size = 0;
+};
+
+struct Result {
+    bool ok = false;
+    double audioSec = 0.0;
+    uint64_t wavBytes = 0;
+    uint64_t opusBytes = 0;
+};
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [-j threads] [-c cpus] [-n nice] [-I] [-b bitrate] [-q complexity] [-f frame_ms]"
+                 " [-p frames_per_packet] [-o dir] file ..."
+              << std::endl;
+}
+
+bool endsWith(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool isWav(const std::string& path) {
+    return endsWith(path, ".wav") || endsWith(path, ".WAV");
+}
+
+std::string outputPath(const std::string& input, const std::string& outputDir) {
+    std::string name = input;
+    size_t slash = name.rfind('/');
+    size_t dot = name.rfind('.');
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+        name.erase(dot);
+    }
+    name += isWav(input) ? ".opus" : ".wav";
+    if (!outputDir.empty()) {
+        name = outputDir + "/" + name.substr(name.rfind('/') + 1);
+    }
+    return name;
+}
+
+bool isOpusRate(int rate) {
+    return rate == 8000 || rate == 12000 || rate == 16000 || rate == 24000 || rate == 48000;
+}
+
+// Read-only mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error(path + " is empty or cannot be read");
+        }
+        mSize = static_cast<size_t>(st.st_size);
+        mData = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mData == MAP_FAILED) {
+            throw std::runtime_error("Failed to map " + path + ": " + std::strerror(errno));
+        }
+        ::madvise(mData, mSize, MADV_SEQUENTIAL);
+    }
+
+    ~MappedFile() { ::munmap(mData, mSize); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return static_cast<const char*>(mData); }
+    size_t size() const { return mSize; }
+
+private:
+    void* mData = MAP_FAILED;
+    size_t mSize = 0;
+};
+
+void writeAll(int fd, const void* data, size_t bytes, const std::string& path) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t written = ::write(fd, p, bytes);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to write " + path + ": " + std::strerror(errno));
+        }
+        p += written;
+        bytes -= static_cast<size_t>(written);
+    }
+}
+
+// Codec state owned by one worker thread and reused from file to file
+class Worker {
+public:
+    explicit Worker(const Options& options) : mOptions(options) {}
+
+    Result encode(const Job& job) {
+        MappedFile input(job.input);
+        utils::WaveHeader header;
+        if (input.size() < sizeof(utils::WaveHeader) || !header.readFromBuffer(input.data())) {
+            throw std::runtime_error(job.input + " is not a canonical PCM WAV file");
+        }
+        const int rate = static_cast<int>(header.mSampleRate);
+        const int channels = header.mNumChannels;
+        if (header.mBitsPerSample != 16 || !isOpusRate(rate) || channels < 1 || channels > 2) {
+            throw std::runtime_error(job.input + ": need 16-bit PCM at 8, 12, 16, 24 or 48 kHz in 1 or 2 channels, got " +
+                                     std::to_string(header.mBitsPerSample) + "-bit, " + std::to_string(rate) + " Hz, " +
+                                     std::to_string(channels) + " channel(s)");
+        }
+        // WaveHeader::isValid() does not check the block alignment; a wrong one would
+        // mis-size the sample data (or divide by zero)
+        const size_t frameBytes = static_cast<size_t>(channels) * sizeof(opus_int16);
+        if (header.mBlockAlign != frameBytes) {
+            throw std::runtime_error(job.input + ": block align " + std::to_string(header.mBlockAlign) +
+                                     " does not match " + std::to_string(channels) + " channel(s) of 16-bit PCM");
+        }
+        size_t dataBytes = std::min<size_t>(header.mDataSize, input.size() - sizeof(utils::WaveHeader));
+        size_t frames = dataBytes / frameBytes;
+
+        encoderFor(rate, channels);
+        OggOpusWriterOptions writerOptions;
+        writerOptions.sampleRate = rate;
+        writerOptions.channels = channels;
+        writerOptions.preSkip = mEncoder->codec().getLookahead();
+        writerOptions.comments = {"ENCODER=opus_batch"};
+        OggOpusWriter writer(job.output, writerOptions);
+
+        // The data chunk follows the 44-byte header, so the samples are 2-byte aligned in the mapping
+        const auto* pcm = reinterpret_cast<const opus_int16*>(input.data() + sizeof(utils::WaveHeader));
+        mWriter = &writer;
+        try {
+            mEncoder->write(utils::Span<const opus_int16>(pcm, frames * channels));
+            mEncoder->drain();
+        } catch (...) {
+            mWriter = nullptr;
+            throw;
+        }
+        mWriter = nullptr;
+        writer.close(static_cast<int64_t>(frames));
+
+        Result result;
+        result.ok = true;
+        result.audioSec = static_cast<double>(frames) / rate;
+        result.wavBytes = input.size();
+        result.opusBytes = writer.getStats().bytes;
+        return result;
+    }
+
+    Result decode(const Job& job) {
+        OggOpusReader reader(job.input);
+        const int rate = isOpusRate(reader.getInputSampleRate()) ? reader.getInputSampleRate() : 48000;
+        const int channels = reader.getChannels();
+        decoderFor(rate, channels);
+        mPcm.resize(mDecoder->getMaxDecodeSamples());
+
+        int fd = ::open(job.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create " + job.output + ": " + std::strerror(errno));
+        }
+        uint64_t frames = 0;
+        try {
+            // Header first as a placeholder, rewritten once the length is known
+            mOut.assign(sizeof(utils::WaveHeader), 0);
+            OggOpusPacket packet;
+            while (reader.readPacket(packet)) {
+                size_t decoded = mDecoder->decodeInto(utils::Span<const uint8_t>(packet.data.data(), packet.data.size()),
+                                                      utils::Span<opus_int16>(mPcm.data(), mPcm.size()));
+
+                // Drop the pre-skip and the end padding; packet times are at 48 kHz
+                int64_t start = packet.startSample * rate / 48000;
+                int64_t end = (packet.startSample + packet.durationSamples) * rate / 48000;
+                int64_t skip = std::max<int64_t>(0, -start);
+                int64_t keep = std::min<int64_t>(static_cast<int64_t>(decoded), end - start) - skip;
+                if (keep > 0) {
+                    const auto* bytes = reinterpret_cast<const char*>(mPcm.data() + skip * channels);
+                    mOut.insert(mOut.end(), bytes, bytes + keep * channels * sizeof(opus_int16));
+                    frames += static_cast<uint64_t>(keep);
+                }
+                if (mOut.size() >= kWavWriteBytes) {
+                    writeAll(fd, mOut.data(), mOut.size(), job.output);
+                    mOut.clear();
+                }
+            }
+            writeAll(fd, mOut.data(), mOut.size(), job.output);
+
+            utils::WaveHeader header(static_cast<uint16_t>(channels), static_cast<uint32_t>(rate), 16,
+                                     static_cast<uint32_t>(frames));
+            char buffer[sizeof(utils::WaveHeader)];
+            header.writeToBuffer(buffer);
+            if (::pwrite(fd, buffer, sizeof(buffer), 0) != static_cast<ssize_t>(sizeof(buffer))) {
+                throw std::runtime_error("Failed to write " + job.output + ": " + std::strerror(errno));
+            }
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        if (::close(fd) != 0) {
+            throw std::runtime_error("Failed to close " + job.output + ": " + std::strerror(errno));
+        }
+
+        Result result;
+        result.ok = true;
+        result.audioSec = static_cast<double>(frames) / rate;
+        result.wavBytes = sizeof(utils::WaveHeader) + frames * channels * sizeof(opus_int16);
+        result.opusBytes = static_cast<uint64_t>(job.size);
+        return result;
+    }
+
+private:
+    const Options& mOptions;
+    OpusFramingConfig mCurrent;  // Settings of mEncoder
+    std::unique_ptr<OpusFrameEncoder> mEncoder;
+    OggOpusWriter* mWriter = nullptr;  // Output of the file being encoded
+    std::unique_ptr<OpusAudioCodec> mDecoder;
+    std::vector<opus_int16> mPcm;
+    std::vector<char> mOut;
+
+    void encoderFor(int rate, int channels) {
+        if (mEncoder && mCurrent.sampleRate == rate && mCurrent.channels == channels) {
+            mEncoder->reset();
+            return;
+        }
+        mCurrent = mOptions.framing;
+        mCurrent.sampleRate = rate;
+        mCurrent.channels = channels;
+        mEncoder = std::make_unique<OpusFrameEncoder>(mCurrent, [this](utils::Span<const uint8_t> packet, int samples) {
+            mWriter->writePacket(std::move(packet), samples);
+        });
+        if (mOptions.bitrate > 0) {
+            mEncoder->codec().setBitrate(mOptions.bitrate);
+        }
+        if (mOptions.complexity >= 0) {
+            mEncoder->codec().setComplexity(mOptions.complexity);
+        }
+        mEncoder->reset();  // Drop the warmup frames of the constructor
+    }
+
+    void decoderFor(int rate, int channels) {
+        if (mDecoder && mDecoder->getSampleRate() == rate && mDecoder->getChannels() == channels) {
+            mDecoder->reset();
+            return;
+        }
+        mDecoder = std::make_unique<OpusAudioCodec>(rate, channels);
+    }
+};
+
+// Keep the first count CPUs of the affinity mask; returns the CPUs left usable
+int limitCpus(int count) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    int usable = CPU_COUNT(&set);
+    if (count <= 0 || count >= usable) {
+        return usable;
+    }
+    int kept = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set) && ++kept > count) {
+            CPU_CLR(cpu, &set);
+        }
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        std::perror("sched_setaffinity");
+        return usable;
+    }
+    return count;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    int threads = 0;
+    int cpus = 0;
+    int niceness = 10;
+    bool idle = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "j:c:n:Ib:q:f:p:o:")) != -1) {
+        switch (opt) {
+            case 'j': threads = std::max(1, std::atoi(optarg)); break;
+            case 'c': cpus = std::max(1, std::atoi(optarg)); break;
+            case 'n': niceness = std::atoi(optarg); break;
+            case 'I': idle = true; break;
+            case 'b': options.bitrate = std::atoi(optarg); break;
+            case 'q': options.complexity = std::max(0, std::min(10, std::atoi(optarg))); break;
+            case 'f': options.framing.frameDurationMs = std::atof(optarg); break;
+            case 'p': options.framing.framesPerPacket = std::atoi(optarg); break;
+            case 'o': options.outputDir = optarg; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind == argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Priority and CPU limits are set before the workers start, which inherit them
+    if (setpriority(PRIO_PROCESS, 0, niceness) != 0) {
+        std::perror("setpriority");
+    }
+    if (idle) {
+        sched_param param{};
+        if (sched_setscheduler(0, SCHED_IDLE, &param) != 0) {
+            std::perror("sched_setscheduler(SCHED_IDLE)");
+        }
+    }
+    int usableCpus = limitCpus(cpus);
+    if (threads == 0) {
+        threads = usableCpus;
+    }
+
+    std::vector<Job> jobs;
+    for (int i = optind; i < argc; ++i) {
+        Job job;
+        job.input = argv[i];
+        job.output = outputPath(job.input, options.outputDir);
+        struct stat st;
+        if (stat(argv[i], &st) != 0) {
+            std::cerr << "Cannot read " << argv[i] << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        job.size = st.st_size;
+        jobs.push_back(job);
+    }
+    std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.size > b.size; });
+    threads = std::min<int>(threads, static_cast<int>(jobs.size()));
+
+    // Validate the framing once, before any worker needs it
+    try {
+        OpusFrameEncoder probe(options.framing, [](utils::Span<const uint8_t>, int) {});
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<Result> results(jobs.size());
+    std::vector<double> busySec(threads, 0.0);
+    std::atomic<size_t> next(0);
+    std::mutex printMutex;
+
+    auto wallStart = Clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            Worker worker(options);
+            for (size_t i; (i = next.fetch_add(1)) < jobs.size();) {
+                const Job& job = jobs[i];
+                auto start = Clock::now();
+                std::string error;
+                try {
+                    results[i] = isWav(job.input) ? worker.encode(job) : worker.decode(job);
+                } catch (const std::exception& e) {
+                    error = e.what();
+                    ::unlink(job.output.c_str());
+                }
+                double sec = std::chrono::duration<double>(Clock::now() - start).count();
+                busySec[t] += sec;
+
+                std::lock_guard<std::mutex> lock(printMutex);
+                const Result& r = results[i];
+                if (r.ok) {
+                    std::printf("%s -> %s: %.1f s of audio, %.1f:1, %.0fx real time\n", job.input.c_str(),
+                                job.output.c_str(), r.audioSec,
+                                static_cast<double>(r.wavBytes) / std::max<uint64_t>(r.opusBytes, 1),
+                                r.audioSec / std::max(sec, 1e-9));
+                } else {
+                    std::printf("%s: FAILED: %s\n", job.input.c_str(), error.c_str());
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double wallSec = std::chrono::duration<double>(Clock::now() - wallStart).count();
+
+    double audioSec = 0.0;
+    double workerSec = 0.0;
+    uint64_t wavBytes = 0;
+    uint64_t opusBytes = 0;
+    size_t failed = 0;
+    for (const auto& r : results) {
+        if (!r.ok) {
+            ++failed;
+            continue;
+        }
+        audioSec += r.audioSec;
+        wavBytes += r.wavBytes;
+        opusBytes += r.opusBytes;
+    }
+    for (double sec : busySec) {
+        workerSec += sec;
+    }
+
+    std::printf("\nFiles:             %zu (%zu failed) on %d worker(s), %d CPU(s), nice %d%s\n", jobs.size(), failed,
+                threads, usableCpus, getpriority(PRIO_PROCESS, 0), idle ? ", idle class" : "");
+    std::printf("Audio:             %.1f s in %.2f s (%.1fx real time, %.1fx per worker)\n", audioSec, wallSec,
+                audioSec / std::max(wallSec, 1e-9), audioSec / std::max(workerSec, 1e-9));
+    std::printf("Size:              %llu bytes WAV, %llu bytes Opus (%.1f:1)\n",
+                static_cast<unsigned long long>(wavBytes), static_cast<unsigned long long>(opusBytes),
+                static_cast<double>(wavBytes) / std::max<uint64_t>(opusBytes, 1));
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+// Assertion helper shared by the opus unit tests: prints the result of each check and
+// counts failures in gFailures, which main() turns into the exit code
+inline int gFailures = 0;
+
+inline void check(bool condition, const std::string& message) {
+    std::cout << (condition ? "    PASS: " : "    FAIL: ") << message << std::endl;
+    if (!condition) {
+        ++gFailures;
+    }
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace perf {
+
+// Per-thread call tree of nested scopes.
+//
+// The owning thread keeps a stack of open scopes and attributes each closed scope to the
+// node for its full path, so inclusive time of a node and the time of its children are
+// known separately (exclusive = inclusive - children). Nodes live in fixed chunks and are
+// published with a release store of the node count; counters are single-writer relaxed
+// atomics, so report generation can walk the tree while the thread keeps recording.
+class CallTree {
+public:
+    static constexpr uint32_t kRoot = 0;
+    static constexpr uint32_t kNoNode = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t kChunkSize = 256;
+    static constexpr size_t kMaxChunks = 1024;
+
+    struct Node {
+        uint32_t mNameId = 0;
+        uint32_t mParent = kNoNode;
+        std::atomic<uint64_t> mCalls{0};
+        std::atomic<uint64_t> mInclusiveTicks{0};
+        std::atomic<uint64_t> mChildTicks{0};
+    };
+
+    CallTree() {
+        for (auto& chunk : mChunks) {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+        mChunks[0].store(new Node[kChunkSize], std::memory_order_relaxed);
+        mNodeCount.store(1, std::memory_order_release);  // Root
+    }
+
+    ~CallTree() {
+        for (auto& chunk : mChunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    CallTree(const CallTree&) = delete;
+    CallTree& operator=(const CallTree&) = delete;
+
+    // Owning thread: open a scope under the innermost open scope
+    void enter(uint32_t nameId, uint64_t startTicks) {
+        uint32_t parent = mStack.empty() ? kRoot : mStack.back().mNode;
+        uint32_t node = parent == kNoNode ? kNoNode : child(parent, nameId);
+        mStack.push_back(Frame{nameId, node, startTicks});
+    }
+
+    // Owning thread: close the innermost open scope with this name. Scopes opened after it
+    // (only possible with manual start/end) stay open.
+    void exit(uint32_t nameId, uint64_t endTicks) {
+        for (size_t i = mStack.size(); i-- > 0;) {
+            if (mStack[i].mNameId != nameId) {
+                continue;
+            }
+
+            const Frame& frame = mStack[i];
+            uint64_t ticks = endTicks - frame.mStartTicks;
+            if (frame.mNode != kNoNode) {
+                Node& node = at(frame.mNode);
+                add(node.mCalls, 1);
+                add(node.mInclusiveTicks, ticks);
+            }
+            if (i > 0 && mStack[i - 1].mNode != kNoNode) {
+                add(at(mStack[i - 1].mNode).mChildTicks, ticks);
+            }
+            mStack.erase(mStack.begin() + static_cast<std::ptrdiff_t>(i));
+            return;
+        }
+    }
+
+    // Any thread
+    uint32_t nodeCount() const {
+        return mNodeCount.load(std::memory_order_acquire);
+    }
+
+    const Node& node(uint32_t index) const {
+        return mChunks[index / kChunkSize].load(std::memory_order_acquire)[index % kChunkSize];
+    }
+
+    // Any thread; the structure is kept so open scopes stay valid
+    void reset() {
+        uint32_t count = nodeCount();
+        for (uint32_t i = 0; i < count; ++i) {
+            Node& entry = const_cast<Node&>(node(i));
+            entry.mCalls.store(0, std::memory_order_relaxed);
+            entry.mInclusiveTicks.store(0, std::memory_order_relaxed);
+            entry.mChildTicks.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Frame {
+        uint32_t mNameId;
+        uint32_t mNode;
+        uint64_t mStartTicks;
+    };
+
+    static void add(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    Node& at(uint32_t index) {
+        return mChunks[index / kChunkSize].load(std::memory_order_relaxed)[index % kChunkSize];
+    }
+
+    uint32_t child(uint32_t parent, uint32_t nameId) {
+        uint64_t key = (static_cast<uint64_t>(parent) << 32) | nameId;
+        auto it = mChildIndex.find(key);
+        if (it != mChildIndex.end()) {
+            return it->second;
+        }
+
+        uint32_t index = mNodeCount.load(std::memory_order_relaxed);
+        if (index >= kChunkSize * kMaxChunks) {
+            return kNoNode;  // Tree full; deeper scopes are not attributed
+        }
+        auto& chunk = mChunks[index / kChunkSize];
+        if (!chunk.load(std::memory_order_relaxed)) {
+            chunk.store(new Node[kChunkSize], std::memory_order_release);
+        }
+        Node& entry = at(index);
+        entry.mNameId = nameId;
+        entry.mParent = parent;
+        mNodeCount.store(index + 1, std::memory_order_release);
+        mChildIndex.emplace(key, index);
+        return index;
+    }
+
+    std::array<std::atomic<Node*>, kMaxChunks> mChunks;
+    std::atomic<uint32_t> mNodeCount{0};
+
+    // Owning thread only
+    std::unordered_map<uint64_t, uint32_t> mChildIndex;
+    std::vector<Frame> mStack;
+};
+
+// Plain call tree merged across threads by path
+struct CallTreeTotals {
+    struct Node {
+        uint32_t mNameId = 0;
+        uint64_t mCalls = 0;
+        uint64_t mInclusiveTicks = 0;
+        uint64_t mChildTicks = 0;
+        std::map<uint32_t, size_t> mChildren;  // Name id -> node index
+    };
+
+    std::vector<Node> mNodes{Node{}};  // Index 0 is the root
+
+    void merge(const CallTree& tree) {
+        // Parents are always created before their children, so one pass in index order works
+        uint32_t count = tree.nodeCount();
+        std::vector<size_t> mapping(count, 0);
+        for (uint32_t i = 1; i < count; ++i) {
+            const CallTree::Node& source = tree.node(i);
+            size_t target = childOf(mapping[source.mParent], source.mNameId);
+            mapping[i] = target;
+            mNodes[target].mCalls += source.mCalls.load(std::memory_order_relaxed);
+            mNodes[target].mInclusiveTicks += source.mInclusiveTicks.load(std::memory_order_relaxed);
+            mNodes[target].mChildTicks += source.mChildTicks.load(std::memory_order_relaxed);
+        }
+    }
+
+    void merge(const CallTreeTotals& other) {
+        mergeNode(other, 0, 0);
+    }
+
+    uint64_t exclusiveTicks(size_t index) const {
+        const Node& node = mNodes[index];
+        return node.mInclusiveTicks > node.mChildTicks ? node.mInclusiveTicks - node.mChildTicks : 0;
+    }
+
+private:
+    size_t childOf(size_t parent, uint32_t nameId) {
+        auto it = mNodes[parent].mChildren.find(nameId);
+        if (it != mNodes[parent].mChildren.end()) {
+            return it->second;
+        }
+        size_t index = mNodes.size();
+        mNodes.emplace_back();
+        mNodes.back().mNameId = nameId;
+        mNodes[parent].mChildren.emplace(nameId, index);
+        return index;
+    }
+
+    void mergeNode(const CallTreeTotals& other, size_t source, size_t target) {
+        for (const auto& child : other.mNodes[source].mChildren) {
+            size_t mapped = childOf(target, child.first);
+            const Node& from = other.mNodes[child.second];
+            mNodes[mapped].mCalls += from.mCalls;
+            mNodes[mapped].mInclusiveTicks += from.mInclusiveTicks;
+            mNodes[mapped].mChildTicks += from.mChildTicks;
+            mergeNode(other, child.second, mapped);
+        }
+    }
+};
+
+}  // namespace perf
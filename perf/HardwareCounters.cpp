@@ -0,0 +1,184 @@
+#include "HardwareCounters.h"
+
+// Standard library headers
+#include <cerrno>
+#include <cstring>
+
+// System headers
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perf {
+
+const char* hardwareEventName(HardwareEvent event) {
+    switch (event) {
+    case kCycles: return "cycles";
+    case kInstructions: return "instructions";
+    case kCacheMisses: return "cache-misses";
+    case kBranchMisses: return "branch-misses";
+    default: return "unknown";
+    }
+}
+
+void HardwareTotals::add(const HardwareSample& start, const HardwareSample& end) {
+    // Scale when the group was multiplexed with other users of the PMU
+    uint64_t enabled = end.mTimeEnabled - start.mTimeEnabled;
+    uint64_t running = end.mTimeRunning - start.mTimeRunning;
+    double scale = running > 0 && running < enabled ? static_cast<double>(enabled) / static_cast<double>(running) : 1.0;
+
+    ++mSamples;
+    for (size_t i = 0; i < kHardwareEventCount; ++i) {
+        uint64_t delta = end.mValues[i] - start.mValues[i];
+        mValues[i] += scale == 1.0 ? delta : static_cast<uint64_t>(static_cast<double>(delta) * scale);
+    }
+}
+
+void ShardHardwareTotals::record(const HardwareTotals& delta) {
+    mSamples.store(mSamples.load(std::memory_order_relaxed) + delta.mSamples, std::memory_order_relaxed);
+    for (size_t i = 0; i < kHardwareEventCount; ++i) {
+        mValues[i].store(mValues[i].load(std::memory_order_relaxed) + delta.mValues[i], std::memory_order_relaxed);
+    }
+}
+
+void ShardHardwareTotals::reset() {
+    mSamples.store(0, std::memory_order_relaxed);
+    for (auto& value : mValues) {
+        value.store(0, std::memory_order_relaxed);
+    }
+}
+
+void ShardHardwareTotals::mergeInto(HardwareTotals& target) const {
+    target.mSamples += mSamples.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kHardwareEventCount; ++i) {
+        target.mValues[i] += mValues[i].load(std::memory_order_relaxed);
+    }
+}
+
+HardwareCounterGroup::HardwareCounterGroup() : mLeaderFd(-1), mMemberCount(0), mAvailableMask(0) {
+    mFds.fill(-1);
+    mReadIndex.fill(-1);
+}
+
+HardwareCounterGroup::~HardwareCounterGroup() {
+    close();
+}
+
+#ifdef __linux__
+
+namespace {
+
+constexpr uint64_t kEventConfigs[kHardwareEventCount] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+int openEvent(uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = groupFd < 0 ? 1 : 0;  // The leader enables the whole group at once
+    attr.exclude_kernel = 1;              // Allowed at perf_event_paranoid <= 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, PERF_FLAG_FD_CLOEXEC));
+}
+
+}  // namespace
+
+bool HardwareCounterGroup::open(std::string* error) {
+    if (isOpen()) {
+        return true;
+    }
+
+    int firstErrno = 0;
+    for (size_t event = 0; event < kHardwareEventCount; ++event) {
+        int fd = openEvent(kEventConfigs[event], mLeaderFd);
+        if (fd < 0) {
+            if (!firstErrno) {
+                firstErrno = errno;
+            }
+            continue;
+        }
+        if (mLeaderFd < 0) {
+            mLeaderFd = fd;
+        }
+        mFds[event] = fd;
+        mReadIndex[event] = static_cast<int>(mMemberCount++);
+        mAvailableMask |= 1u << event;
+    }
+
+    if (mLeaderFd < 0) {
+        if (error) {
+            *error = std::string("perf_event_open failed: ") + std::strerror(firstErrno) +
+                     (firstErrno == EACCES || firstErrno == EPERM
+                          ? " (check /proc/sys/kernel/perf_event_paranoid or container seccomp policy)"
+                          : firstErrno == ENOENT ? " (no hardware PMU exposed, e.g. in a VM)" : "");
+        }
+        return false;
+    }
+
+    ioctl(mLeaderFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(mLeaderFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void HardwareCounterGroup::close() {
+    for (int& fd : mFds) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    mReadIndex.fill(-1);
+    mLeaderFd = -1;
+    mMemberCount = 0;
+    mAvailableMask = 0;
+}
+
+bool HardwareCounterGroup::read(HardwareSample& sample) const {
+    if (!isOpen()) {
+        return false;
+    }
+
+    // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, value[nr]
+    uint64_t buffer[3 + kHardwareEventCount];
+    ssize_t size = ::read(mLeaderFd, buffer, sizeof(buffer));
+    if (size < static_cast<ssize_t>(3 * sizeof(uint64_t)) || buffer[0] != mMemberCount) {
+        return false;
+    }
+
+    sample.mTimeEnabled = buffer[1];
+    sample.mTimeRunning = buffer[2];
+    for (size_t event = 0; event < kHardwareEventCount; ++event) {
+        sample.mValues[event] = mReadIndex[event] >= 0 ? buffer[3 + mReadIndex[event]] : 0;
+    }
+    return true;
+}
+
+#else
+
+bool HardwareCounterGroup::open(std::string* error) {
+    if (error) {
+        *error = "hardware counters require Linux perf_event_open";
+    }
+    return false;
+}
+
+void HardwareCounterGroup::close() {
+}
+
+bool HardwareCounterGroup::read(HardwareSample&) const {
+    return false;
+}
+
+#endif
+
+}  // namespace perf
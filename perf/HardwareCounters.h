@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace perf {
+
+// Hardware events counted per scope, in group order
+enum HardwareEvent : size_t {
+    kCycles = 0,
+    kInstructions,
+    kCacheMisses,
+    kBranchMisses,
+    kHardwareEventCount
+};
+
+const char* hardwareEventName(HardwareEvent event);
+
+// Raw group reading; values of events that could not be opened stay zero
+struct HardwareSample {
+    std::array<uint64_t, kHardwareEventCount> mValues{};
+    uint64_t mTimeEnabled = 0;
+    uint64_t mTimeRunning = 0;
+};
+
+// Counter deltas of one or more scopes, scaled for multiplexing
+struct HardwareTotals {
+    uint64_t mSamples = 0;
+    std::array<uint64_t, kHardwareEventCount> mValues{};
+
+    void add(const HardwareSample& start, const HardwareSample& end);
+
+    void merge(const HardwareTotals& other) {
+        mSamples += other.mSamples;
+        for (size_t i = 0; i < kHardwareEventCount; ++i) {
+            mValues[i] += other.mValues[i];
+        }
+    }
+};
+
+// Single-writer totals for per-thread shards; readers may merge concurrently
+struct ShardHardwareTotals {
+    std::atomic<uint64_t> mSamples{0};
+    std::array<std::atomic<uint64_t>, kHardwareEventCount> mValues{};
+
+    void record(const HardwareTotals& delta);
+    void reset();
+    void mergeInto(HardwareTotals& target) const;
+};
+
+// perf_event_open counter group of one thread (user-space counts only).
+//
+// The first event that opens becomes the group leader and the others join it, so all are
+// scheduled together and one read() returns a consistent sample. Events the PMU or the
+// sandbox does not provide are skipped; when none opens the group stays unavailable.
+class HardwareCounterGroup {
+public:
+    HardwareCounterGroup();
+    ~HardwareCounterGroup();
+
+    HardwareCounterGroup(const HardwareCounterGroup&) = delete;
+    HardwareCounterGroup& operator=(const HardwareCounterGroup&) = delete;
+
+    // Open for the calling thread; on failure error (if given) describes why
+    bool open(std::string* error = nullptr);
+    void close();
+
+    bool isOpen() const { return mLeaderFd >= 0; }
+
+    // Bit i is set when HardwareEvent i is counted
+    uint32_t availableMask() const { return mAvailableMask; }
+
+    bool read(HardwareSample& sample) const;
+
+private:
+    int mLeaderFd;
+    std::array<int, kHardwareEventCount> mFds;
+    std::array<int, kHardwareEventCount> mReadIndex;  // Position in the group read, -1 if missing
+    size_t mMemberCount;
+    uint32_t mAvailableMask;
+};
+
+}  // namespace perf
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace perf {
+
+// Log-linear (HDR style) latency histogram layout.
+//
+// Values below 16 get one bucket each; every power of two above that is split into 16
+// linear sub-buckets, bounding the relative error to 1/16. Memory is fixed and histograms
+// with the same layout merge by adding bucket counts, so per-thread histograms can be
+// combined at report time.
+namespace histogram {
+
+constexpr int kSubBucketBits = 4;
+constexpr uint64_t kSubBucketCount = 1u << kSubBucketBits;
+constexpr int kMaxExponent = 40;  // ~18 minutes in nanoseconds; larger values share the last bucket
+constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits + 1) * kSubBucketCount + kSubBucketCount;
+
+inline size_t bucketIndex(uint64_t value) {
+    if (value < kSubBucketCount) {
+        return static_cast<size_t>(value);
+    }
+
+    int exponent = 63 - __builtin_clzll(value);
+    if (exponent > kMaxExponent) {
+        return kBucketCount - 1;
+    }
+
+    uint64_t subBucket = (value >> (exponent - kSubBucketBits)) - kSubBucketCount;
+    return static_cast<size_t>((exponent - kSubBucketBits + 1) * kSubBucketCount + subBucket);
+}
+
+inline uint64_t bucketLowerBound(size_t index) {
+    if (index < kSubBucketCount) {
+        return index;
+    }
+
+    int exponent = static_cast<int>(index / kSubBucketCount) + kSubBucketBits - 1;
+    uint64_t subBucket = index % kSubBucketCount;
+    return (kSubBucketCount + subBucket) << (exponent - kSubBucketBits);
+}
+
+// Representative value of a bucket, used for percentiles and unit conversion
+inline uint64_t bucketMidpoint(size_t index) {
+    if (index < kSubBucketCount) {
+        return index;
+    }
+
+    int exponent = static_cast<int>(index / kSubBucketCount) + kSubBucketBits - 1;
+    uint64_t width = 1ull << (exponent - kSubBucketBits);
+    return bucketLowerBound(index) + width / 2;
+}
+
+}  // namespace histogram
+
+// Plain histogram used for aggregation and reporting
+struct LatencyHistogram {
+    std::array<uint64_t, histogram::kBucketCount> mCounts{};
+    uint64_t mTotalCount = 0;
+
+    void record(uint64_t value, uint64_t count = 1) {
+        mCounts[histogram::bucketIndex(value)] += count;
+        mTotalCount += count;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < histogram::kBucketCount; ++i) {
+            mCounts[i] += other.mCounts[i];
+        }
+        mTotalCount += other.mTotalCount;
+    }
+
+    // Remove an earlier snapshot of the same cumulative histogram (used for time windows)
+    void subtract(const LatencyHistogram& earlier) {
+        mTotalCount = 0;
+        for (size_t i = 0; i < histogram::kBucketCount; ++i) {
+            mCounts[i] = mCounts[i] > earlier.mCounts[i] ? mCounts[i] - earlier.mCounts[i] : 0;
+            mTotalCount += mCounts[i];
+        }
+    }
+
+    // Merge a histogram recorded in other units, e.g. raw ticks converted to nanoseconds
+    void mergeScaled(const LatencyHistogram& other, double scale) {
+        for (size_t i = 0; i < histogram::kBucketCount; ++i) {
+            if (other.mCounts[i]) {
+                record(static_cast<uint64_t>(static_cast<double>(histogram::bucketMidpoint(i)) * scale),
+                       other.mCounts[i]);
+            }
+        }
+    }
+
+    // Value at quantile q (0..1); 0 when empty
+    uint64_t valueAtQuantile(double q) const {
+        if (mTotalCount == 0) {
+            return 0;
+        }
+
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(mTotalCount) + 0.5);
+        rank = rank == 0 ? 1 : (rank > mTotalCount ? mTotalCount : rank);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < histogram::kBucketCount; ++i) {
+            seen += mCounts[i];
+            if (seen >= rank) {
+                return histogram::bucketMidpoint(i);
+            }
+        }
+        return histogram::bucketMidpoint(histogram::kBucketCount - 1);
+    }
+};
+
+// Single-writer histogram for per-thread shards; readers may merge it concurrently
+struct ShardHistogram {
+    std::array<std::atomic<uint64_t>, histogram::kBucketCount> mCounts;
+
+    ShardHistogram() {
+        reset();
+    }
+
+    void record(uint64_t value) {
+        auto& counter = mCounts[histogram::bucketIndex(value)];
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        for (auto& counter : mCounts) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void mergeInto(LatencyHistogram& target) const {
+        for (size_t i = 0; i < histogram::kBucketCount; ++i) {
+            uint64_t count = mCounts[i].load(std::memory_order_relaxed);
+            target.mCounts[i] += count;
+            target.mTotalCount += count;
+        }
+    }
+};
+
+}  // namespace perf
@@ -1,9 +1,19 @@
 #include "PerfMonitor.h"
+#include "CallTree.h"
+#include "HardwareCounters.h"
+#include "LatencyHistogram.h"
+#include "PerfMonitorShm.h"
+#include "TraceBuffer.h"
+#include "TraceExport.h"
 
 // Standard library headers
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <condition_variable>
+#include <cstdio>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <iomanip>
 #include <limits>
@@ -14,7 +24,14 @@
 #include <vector>
 
 // System headers
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 namespace perf {
 
@@ -30,7 +47,8 @@ struct PerformanceMetrics {
     };
 
     Data mData;                    // All metrics data grouped together
-    mutable std::mutex mMutex;     // Protects mData
+    LatencyHistogram mHistogram;   // Durations in nanoseconds
+    mutable std::mutex mMutex;     // Protects mData and mHistogram
 
     // Methods for internal use
     void update(double durationMs);
@@ -39,6 +57,7 @@ struct PerformanceMetrics {
 
     // Efficient method to get all data with single lock
     Data getAllData() const;
+    void getSnapshot(Data& data, LatencyHistogram& histogram) const;
 };
 
 // PerformanceMetrics implementation
@@ -62,11 +81,14 @@ void PerformanceMetrics::update(double durationMs) {
 
     // Update average
     mData.avgDurationMs = mData.totalDurationMs / newCount;
+
+    mHistogram.record(static_cast<uint64_t>(durationMs * 1e6));
 }
 
 void PerformanceMetrics::reset() {
     std::lock_guard<std::mutex> lock(mMutex);
     mData = Data{};  // Reset to default values
+    mHistogram = LatencyHistogram{};
 }
 
 void PerformanceMetrics::addToGroup(size_t callCount, double totalDuration, double minDuration, double maxDuration) {
@@ -96,7 +118,700 @@ PerformanceMetrics::Data PerformanceMetrics::getAllData() const {
     return mData;  // Simple copy of the grouped data
 }
 
+void PerformanceMetrics::getSnapshot(Data& data, LatencyHistogram& histogram) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    data = mData;
+    histogram = mHistogram;
+}
+
+// Registered measurement sites.
+//
+// Each thread owns a shard of per-site counters. Only the owning thread writes a shard,
+// so updates are plain relaxed load/store pairs without read-modify-write instructions;
+// report generation reads every shard with relaxed loads and merges the results.
+namespace {
+
+constexpr uint32_t kInvalidSiteId = std::numeric_limits<uint32_t>::max();
+
+// Event tracing state checked on the hot path; the generation changes on every startTracing()
+std::atomic<bool> gTraceEnabled{false};
+std::atomic<uint64_t> gTraceGeneration{0};
+std::atomic<double> gTraceTicksPerMs{1e6};
+
+// Call-tree profiling switch; scopes opened while it is off are not attributed
+std::atomic<bool> gCallTreeEnabled{false};
+
+// Hardware counter switch and the events the probe could open (bit per HardwareEvent)
+std::atomic<bool> gHardwareCountersEnabled{false};
+std::atomic<uint32_t> gHardwareEventMask{0};
+
+// Bumped by reset() so manual measurements started before it are discarded
+std::atomic<uint64_t> gMeasurementGeneration{0};
+
+// Raw tick counter for the hot path; converted to time only when reporting
+inline uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+struct SiteCounters {
+    std::atomic<uint64_t> mCallCount{0};
+    std::atomic<uint64_t> mTotalTicks{0};
+    std::atomic<uint64_t> mMinTicks{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> mMaxTicks{0};
+    std::atomic<ShardHistogram*> mHistogram{nullptr};  // Allocated on first record, in ticks
+    std::atomic<ShardHardwareTotals*> mHardware{nullptr};  // Allocated on first hardware sample
+
+    ~SiteCounters() {
+        delete mHistogram.load(std::memory_order_relaxed);
+        delete mHardware.load(std::memory_order_relaxed);
+    }
+
+    // Single writer: the owning thread
+    void recordHardware(const HardwareTotals& delta) {
+        ShardHardwareTotals* hardware = mHardware.load(std::memory_order_relaxed);
+        if (!hardware) {
+            hardware = new ShardHardwareTotals();
+            mHardware.store(hardware, std::memory_order_release);
+        }
+        hardware->record(delta);
+    }
+
+    // Single writer: the owning thread
+    void record(uint64_t ticks) {
+        ShardHistogram* histogram = mHistogram.load(std::memory_order_relaxed);
+        if (!histogram) {
+            histogram = new ShardHistogram();
+            mHistogram.store(histogram, std::memory_order_release);
+        }
+        histogram->record(ticks);
+
+        mCallCount.store(mCallCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        mTotalTicks.store(mTotalTicks.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+        if (ticks < mMinTicks.load(std::memory_order_relaxed)) {
+            mMinTicks.store(ticks, std::memory_order_relaxed);
+        }
+        if (ticks > mMaxTicks.load(std::memory_order_relaxed)) {
+            mMaxTicks.store(ticks, std::memory_order_relaxed);
+        }
+    }
+
+    void reset() {
+        mCallCount.store(0, std::memory_order_relaxed);
+        mTotalTicks.store(0, std::memory_order_relaxed);
+        mMinTicks.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        mMaxTicks.store(0, std::memory_order_relaxed);
+        if (ShardHistogram* histogram = mHistogram.load(std::memory_order_acquire)) {
+            histogram->reset();
+        }
+        if (ShardHardwareTotals* hardware = mHardware.load(std::memory_order_acquire)) {
+            hardware->reset();
+        }
+    }
+};
+
+// Plain totals used while merging shards
+struct SiteTotals {
+    uint64_t mCallCount = 0;
+    uint64_t mTotalTicks = 0;
+    uint64_t mMinTicks = std::numeric_limits<uint64_t>::max();
+    uint64_t mMaxTicks = 0;
+    LatencyHistogram mHistogram;  // In ticks
+    HardwareTotals mHardware;
+
+    void merge(const SiteCounters& counters) {
+        if (const ShardHardwareTotals* hardware = counters.mHardware.load(std::memory_order_acquire)) {
+            hardware->mergeInto(mHardware);
+        }
+
+        uint64_t count = counters.mCallCount.load(std::memory_order_relaxed);
+        if (count == 0) {
+            return;
+        }
+        mCallCount += count;
+        mTotalTicks += counters.mTotalTicks.load(std::memory_order_relaxed);
+        mMinTicks = std::min(mMinTicks, counters.mMinTicks.load(std::memory_order_relaxed));
+        mMaxTicks = std::max(mMaxTicks, counters.mMaxTicks.load(std::memory_order_relaxed));
+        if (const ShardHistogram* histogram = counters.mHistogram.load(std::memory_order_acquire)) {
+            histogram->mergeInto(mHistogram);
+        }
+    }
+};
+
+// Per-thread counters, allocated in fixed chunks so they never move once published
+class ThreadShard {
+public:
+    static constexpr size_t kChunkSize = 64;
+    static constexpr size_t kMaxChunks = 1024;
+    static constexpr size_t kMaxSites = kChunkSize * kMaxChunks;
+
+    ThreadShard() {
+        for (auto& chunk : mChunks) {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~ThreadShard() {
+        for (auto& chunk : mChunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Owning thread only
+    SiteCounters& counters(uint32_t siteId) {
+        auto& slot = mChunks[siteId / kChunkSize];
+        SiteCounters* chunk = slot.load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new SiteCounters[kChunkSize];
+            slot.store(chunk, std::memory_order_release);
+        }
+        return chunk[siteId % kChunkSize];
+    }
+
+    // Any thread; returns nullptr for sites this thread never recorded
+    SiteCounters* find(uint32_t siteId) const {
+        SiteCounters* chunk = mChunks[siteId / kChunkSize].load(std::memory_order_acquire);
+        return chunk ? &chunk[siteId % kChunkSize] : nullptr;
+    }
+
+    // Trace ring of the current tracing session; owned by the registry, used by the owning thread
+    TraceRing* traceRing() const { return mTraceRing; }
+    void setTraceRing(TraceRing* ring) { mTraceRing = ring; }
+
+    CallTree& callTree() { return mCallTree; }
+    const CallTree& callTree() const { return mCallTree; }
+
+    // Owning thread; the group is opened on first use and nullptr if that failed
+    HardwareCounterGroup* hardwareCounters() {
+        if (!mHardwareOpenAttempted) {
+            mHardwareOpenAttempted = true;
+            mHardwareCounters.open();
+        }
+        return mHardwareCounters.isOpen() ? &mHardwareCounters : nullptr;
+    }
+
+private:
+    std::array<std::atomic<SiteCounters*>, kMaxChunks> mChunks;
+    TraceRing* mTraceRing = nullptr;
+    CallTree mCallTree;
+    HardwareCounterGroup mHardwareCounters;
+    bool mHardwareOpenAttempted = false;
+};
+
+// Site names and the set of live shards. Shards of exited threads are folded into
+// mRetiredTotals so short-lived threads do not accumulate memory.
+class SiteRegistry {
+public:
+    static SiteRegistry& getInstance() {
+        static SiteRegistry instance;
+        return instance;
+    }
+
+    uint32_t registerSite(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mSiteIds.find(name);
+        if (it != mSiteIds.end()) {
+            return it->second;
+        }
+        if (mSiteNames.size() >= ThreadShard::kMaxSites) {
+            return kInvalidSiteId;
+        }
+        uint32_t siteId = static_cast<uint32_t>(mSiteNames.size());
+        mSiteNames.push_back(name);
+        mSiteIds.emplace(name, siteId);
+        mRetiredTotals.emplace_back();
+        return siteId;
+    }
+
+    ThreadShard* attachShard() {
+        auto* shard = new ThreadShard();
+        std::lock_guard<std::mutex> lock(mMutex);
+        mShards.push_back(shard);
+        return shard;
+    }
+
+    void retireShard(ThreadShard* shard) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (uint32_t siteId = 0; siteId < mSiteNames.size(); ++siteId) {
+            if (const SiteCounters* counters = shard->find(siteId)) {
+                mRetiredTotals[siteId].merge(*counters);
+            }
+        }
+        mRetiredCallTree.merge(shard->callTree());
+        if (TraceRing* ring = shard->traceRing()) {
+            // Events stay available until the next writeTrace()
+            ring->mAbandoned.store(true, std::memory_order_release);
+        }
+        mShards.erase(std::remove(mShards.begin(), mShards.end(), shard), mShards.end());
+        delete shard;
+    }
+
+    // Merge every shard into per-site totals (names and totals share the same index)
+    void collect(std::vector<std::string>& names, std::vector<SiteTotals>& totals) const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        names = mSiteNames;
+        totals = mRetiredTotals;
+        for (const ThreadShard* shard : mShards) {
+            for (uint32_t siteId = 0; siteId < totals.size(); ++siteId) {
+                if (const SiteCounters* counters = shard->find(siteId)) {
+                    totals[siteId].merge(*counters);
+                }
+            }
+        }
+    }
 
+    // Merge the call trees of every thread, live and exited
+    void collectCallTree(std::vector<std::string>& names, CallTreeTotals& tree) const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        names = mSiteNames;
+        tree = mRetiredCallTree;
+        for (const ThreadShard* shard : mShards) {
+            tree.merge(shard->callTree());
+        }
+    }
+
+    // Resetting races benignly with concurrent recording: an in-flight update may survive
+    void reset(const std::string* name) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!name) {
+            mRetiredCallTree = CallTreeTotals{};
+            for (ThreadShard* shard : mShards) {
+                shard->callTree().reset();
+            }
+        }
+        for (uint32_t siteId = 0; siteId < mSiteNames.size(); ++siteId) {
+            if (name && mSiteNames[siteId] != *name) {
+                continue;
+            }
+            mRetiredTotals[siteId] = SiteTotals{};
+            for (ThreadShard* shard : mShards) {
+                if (SiteCounters* counters = shard->find(siteId)) {
+                    counters->reset();
+                }
+            }
+        }
+    }
+
+    // Ticks per millisecond of readTicks(), calibrated against steady_clock
+    double ticksPerMs() {
+#if defined(__aarch64__)
+        uint64_t frequency;
+        asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+        return static_cast<double>(frequency) / 1000.0;
+#elif defined(__x86_64__) || defined(__i386__)
+        auto elapsed = std::chrono::steady_clock::now() - mCalibrationTime;
+        if (elapsed < std::chrono::milliseconds(10)) {
+            // Too early for a meaningful ratio; spin briefly to widen the window
+            while (std::chrono::steady_clock::now() - mCalibrationTime < std::chrono::milliseconds(10)) {
+            }
+        }
+        uint64_t ticks = readTicks() - mCalibrationTicks;
+        double elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - mCalibrationTime).count();
+        return static_cast<double>(ticks) / elapsedMs;
+#else
+        return 1e6;  // readTicks() returns nanoseconds
+#endif
+    }
+
+    // Begin a tracing session: buffers of earlier sessions are discarded and every thread
+    // gets a fresh ring of the given capacity on its next event
+    void startTracing(size_t eventsPerThread) {
+        double rate = ticksPerMs();
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTraceCapacity = eventsPerThread;
+        mTraceAnchorTicks = readTicks();
+        mTraceAnchorTime = std::chrono::steady_clock::now();
+
+        uint64_t generation = gTraceGeneration.load(std::memory_order_relaxed) + 1;
+        releaseTraceRings([generation](const TraceRing& ring) { return ring.mGeneration != generation; });
+        mReleasedRecorded = 0;
+        mReleasedDropped = 0;
+        gTraceTicksPerMs.store(rate, std::memory_order_relaxed);
+        gTraceGeneration.store(generation, std::memory_order_release);
+        gTraceEnabled.store(true, std::memory_order_release);
+    }
+
+    // Called by the owning thread when its ring is missing or from an earlier session
+    TraceRing* attachTraceRing(ThreadShard& shard) {
+        char threadName[16] = {};
+        pthread_getname_np(pthread_self(), threadName, sizeof(threadName));
+        int32_t threadId = static_cast<int32_t>(syscall(SYS_gettid));
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (TraceRing* previous = shard.traceRing()) {
+            previous->mAbandoned.store(true, std::memory_order_release);
+        }
+        auto* ring = new TraceRing(mTraceCapacity, gTraceGeneration.load(std::memory_order_relaxed),
+                                   threadId, threadName);
+        mTraceRings.push_back(ring);
+        shard.setTraceRing(ring);
+        return ring;
+    }
+
+    // Move every buffered event of the current session into the capture
+    void drainTrace(TraceCapture& capture) {
+        double nsPerTick = 1e6 / ticksPerMs();
+        std::lock_guard<std::mutex> lock(mMutex);
+        uint64_t generation = gTraceGeneration.load(std::memory_order_relaxed);
+        int64_t anchorNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            mTraceAnchorTime.time_since_epoch()).count();
+        auto toNs = [&](uint64_t ticks) {
+            double offsetNs = static_cast<double>(static_cast<int64_t>(ticks - mTraceAnchorTicks)) * nsPerTick;
+            return static_cast<uint64_t>(std::max<int64_t>(0, anchorNs + static_cast<int64_t>(offsetNs)));
+        };
+
+        capture.mNames = mSiteNames;
+        std::unordered_map<int32_t, size_t> threadIndex;
+        for (TraceRing* ring : mTraceRings) {
+            if (ring->mGeneration != generation) {
+                continue;
+            }
+            auto inserted = threadIndex.emplace(ring->mThreadId, capture.mThreads.size());
+            if (inserted.second) {
+                capture.mThreads.emplace_back();
+                capture.mThreads.back().mThreadId = ring->mThreadId;
+                capture.mThreads.back().mThreadName = ring->mThreadName;
+            }
+            auto& slices = capture.mThreads[inserted.first->second].mSlices;
+            ring->drain([&](const TraceEvent& event) {
+                slices.push_back(TraceSlice{toNs(event.mStartTicks), toNs(event.mEndTicks), event.mNameId});
+            });
+        }
+
+        // Rings whose writer is gone are empty now; freeing them keeps their counts in the totals
+        releaseTraceRings([](const TraceRing& ring) {
+            return ring.mAbandoned.load(std::memory_order_acquire);
+        });
+        capture.mDroppedEvents = traceStatsLocked().droppedEvents;
+    }
+
+    PerfMonitor::TraceStats traceStats() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return traceStatsLocked();
+    }
+
+private:
+    SiteRegistry()
+        : mCalibrationTicks(readTicks()), mCalibrationTime(std::chrono::steady_clock::now()) {}
+
+    // Free abandoned rings matching the predicate; rings still owned by a thread are kept
+    // (the writer replaces them itself). Caller holds mMutex.
+    template <typename Predicate>
+    void releaseTraceRings(Predicate shouldRelease) {
+        uint64_t generation = gTraceGeneration.load(std::memory_order_relaxed);
+        auto it = mTraceRings.begin();
+        while (it != mTraceRings.end()) {
+            TraceRing* ring = *it;
+            if (ring->mAbandoned.load(std::memory_order_acquire) && shouldRelease(*ring)) {
+                if (ring->mGeneration == generation) {
+                    mReleasedRecorded += ring->recordedCount();
+                    mReleasedDropped += ring->droppedCount();
+                }
+                delete ring;
+                it = mTraceRings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    PerfMonitor::TraceStats traceStatsLocked() const {
+        PerfMonitor::TraceStats stats;
+        stats.recordedEvents = mReleasedRecorded;
+        stats.droppedEvents = mReleasedDropped;
+        stats.bufferCapacity = mTraceCapacity;
+        uint64_t generation = gTraceGeneration.load(std::memory_order_relaxed);
+        for (const TraceRing* ring : mTraceRings) {
+            if (ring->mGeneration == generation) {
+                stats.recordedEvents += ring->recordedCount();
+                stats.droppedEvents += ring->droppedCount();
+                stats.bufferCapacity = ring->capacity();
+                ++stats.threadCount;
+            }
+        }
+        return stats;
+    }
+
+    mutable std::mutex mMutex;
+    std::vector<std::string> mSiteNames;
+    std::unordered_map<std::string, uint32_t> mSiteIds;
+    std::vector<ThreadShard*> mShards;
+    std::vector<SiteTotals> mRetiredTotals;
+    CallTreeTotals mRetiredCallTree;
+
+    uint64_t mCalibrationTicks;
+    std::chrono::steady_clock::time_point mCalibrationTime;
+
+    // Event tracing
+    std::vector<TraceRing*> mTraceRings;
+    size_t mTraceCapacity = 0;
+    uint64_t mTraceAnchorTicks = 0;
+    std::chrono::steady_clock::time_point mTraceAnchorTime;
+    uint64_t mReleasedRecorded = 0;
+    uint64_t mReleasedDropped = 0;
+};
+
+// Hands the thread's shard back to the registry when the thread exits
+struct ShardOwner {
+    ThreadShard* mShard = nullptr;
+
+    ~ShardOwner();
+};
+
+// Trivial thread_local for the hot path; the owner only runs on first use and at exit
+thread_local ThreadShard* tThreadShard = nullptr;
+
+ShardOwner::~ShardOwner() {
+    if (mShard) {
+        tThreadShard = nullptr;
+        SiteRegistry::getInstance().retireShard(mShard);
+    }
+}
+
+ThreadShard* attachThreadShard() {
+    thread_local ShardOwner owner;
+    owner.mShard = SiteRegistry::getInstance().attachShard();
+    tThreadShard = owner.mShard;
+    return tThreadShard;
+}
+
+ThreadShard& currentThreadShard() {
+    ThreadShard* shard = tThreadShard;
+    return shard ? *shard : *attachThreadShard();
+}
+
+// Open a call-tree scope for a string-keyed measurement; returns its site id or kInvalidSiteId
+uint32_t enterNamedScope(const std::string& name) {
+    if (!gCallTreeEnabled.load(std::memory_order_relaxed)) {
+        return kInvalidSiteId;
+    }
+    uint32_t siteId = SiteRegistry::getInstance().registerSite(name);
+    if (siteId != kInvalidSiteId) {
+        currentThreadShard().callTree().enter(siteId, readTicks());
+    }
+    return siteId;
+}
+
+// Counter readings of the calling thread's open scopes, innermost last
+thread_local std::vector<HardwareSample> tHardwareSamples;
+
+bool beginHardwareSample() {
+    HardwareCounterGroup* counters = currentThreadShard().hardwareCounters();
+    HardwareSample sample;
+    if (!counters || !counters->read(sample)) {
+        return false;
+    }
+    tHardwareSamples.push_back(sample);
+    return true;
+}
+
+void endHardwareSample(ThreadShard& shard, uint32_t siteId) {
+    HardwareSample end;
+    bool valid = shard.hardwareCounters()->read(end);
+    HardwareSample start = tHardwareSamples.back();
+    tHardwareSamples.pop_back();
+    if (valid) {
+        HardwareTotals delta;
+        delta.add(start, end);
+        shard.counters(siteId).recordHardware(delta);
+    }
+}
+
+// Manual start/end pairs of the calling thread, innermost last
+struct ManualMeasurement {
+    std::string mName;
+    std::chrono::steady_clock::time_point mStartTime;
+    uint64_t mGeneration;
+    uint32_t mTreeSiteId;
+};
+
+thread_local std::vector<ManualMeasurement> tManualMeasurements;
+
+void recordTraceEvent(ThreadShard& shard, uint32_t nameId, uint64_t startTicks, uint64_t endTicks) {
+    TraceRing* ring = shard.traceRing();
+    if (!ring || ring->mGeneration != gTraceGeneration.load(std::memory_order_acquire)) {
+        ring = SiteRegistry::getInstance().attachTraceRing(shard);
+    }
+    ring->push(TraceEvent{startTicks, endTicks, nameId});
+}
+
+// String-keyed measurements only know their duration; the start is derived from it
+void recordNamedTraceEvent(const std::string& name, double durationMs) {
+    uint64_t endTicks = readTicks();
+    uint32_t nameId = SiteRegistry::getInstance().registerSite(name);
+    if (nameId == kInvalidSiteId) {
+        return;
+    }
+
+    ThreadShard* shard = tThreadShard;
+    if (!shard) {
+        shard = attachThreadShard();
+    }
+    auto durationTicks = static_cast<uint64_t>(durationMs * gTraceTicksPerMs.load(std::memory_order_relaxed));
+    recordTraceEvent(*shard, nameId, endTicks - durationTicks, endTicks);
+}
+
+std::string currentProcessName() {
+    std::ifstream comm("/proc/self/comm");
+    std::string name;
+    std::getline(comm, name);
+    return name.empty() ? "process" : name;
+}
+
+}  // namespace
+
+
+
+// Call-tree formatting
+namespace {
+
+std::vector<size_t> childrenByInclusiveTime(const CallTreeTotals& tree, size_t index) {
+    std::vector<size_t> children;
+    for (const auto& child : tree.mNodes[index].mChildren) {
+        if (tree.mNodes[child.second].mCalls > 0) {
+            children.push_back(child.second);
+        }
+    }
+    std::sort(children.begin(), children.end(), [&tree](size_t a, size_t b) {
+        return tree.mNodes[a].mInclusiveTicks > tree.mNodes[b].mInclusiveTicks;
+    });
+    return children;
+}
+
+void writeCallTreeNode(std::ostream& out, const CallTreeTotals& tree, const std::vector<std::string>& names,
+                       size_t index, size_t depth, double ticksPerMs, double rootTicks) {
+    const auto& node = tree.mNodes[index];
+    double inclusiveMs = static_cast<double>(node.mInclusiveTicks) / ticksPerMs;
+    double exclusiveMs = static_cast<double>(tree.exclusiveTicks(index)) / ticksPerMs;
+    double percent = rootTicks > 0.0 ? 100.0 * static_cast<double>(node.mInclusiveTicks) / rootTicks : 0.0;
+
+    out << std::left << std::setw(55) << (std::string(depth * 2, ' ') + names[node.mNameId])
+        << std::setw(10) << node.mCalls
+        << std::setw(14) << std::fixed << std::setprecision(3) << inclusiveMs
+        << std::setw(14) << std::fixed << std::setprecision(3) << exclusiveMs
+        << std::setw(8) << std::fixed << std::setprecision(1) << percent << "\n";
+
+    for (size_t child : childrenByInclusiveTime(tree, index)) {
+        writeCallTreeNode(out, tree, names, child, depth + 1, ticksPerMs, rootTicks);
+    }
+}
+
+void writeCallTree(std::ostream& out, const CallTreeTotals& tree, const std::vector<std::string>& names,
+                   double ticksPerMs) {
+    double rootTicks = 0.0;
+    for (const auto& child : tree.mNodes[0].mChildren) {
+        rootTicks += static_cast<double>(tree.mNodes[child.second].mInclusiveTicks);
+    }
+
+    out << std::left << std::setw(55) << "Scope"
+        << std::setw(10) << "Calls"
+        << std::setw(14) << "Incl (ms)"
+        << std::setw(14) << "Excl (ms)"
+        << std::setw(8) << "Incl %" << "\n";
+    out << std::string(101, '-') << "\n";
+
+    for (size_t child : childrenByInclusiveTime(tree, 0)) {
+        writeCallTreeNode(out, tree, names, child, 0, ticksPerMs, rootTicks);
+    }
+}
+
+// Per-function totals; inclusive time of recursive calls is counted at the outermost frame only
+void writeCallTreeByFunction(std::ostream& out, const CallTreeTotals& tree, const std::vector<std::string>& names,
+                             double ticksPerMs) {
+    struct FunctionTotals {
+        uint64_t mCalls = 0;
+        uint64_t mInclusiveTicks = 0;
+        uint64_t mExclusiveTicks = 0;
+    };
+    std::vector<FunctionTotals> totals(names.size());
+    std::vector<uint32_t> activeDepth(names.size(), 0);
+
+    std::vector<std::pair<size_t, bool>> pending{{0, false}};  // (node, leaving)
+    while (!pending.empty()) {
+        auto [index, leaving] = pending.back();
+        pending.pop_back();
+        const auto& node = tree.mNodes[index];
+        if (leaving) {
+            --activeDepth[node.mNameId];
+            continue;
+        }
+        if (index != 0) {
+            auto& entry = totals[node.mNameId];
+            entry.mCalls += node.mCalls;
+            entry.mExclusiveTicks += tree.exclusiveTicks(index);
+            if (activeDepth[node.mNameId] == 0) {
+                entry.mInclusiveTicks += node.mInclusiveTicks;
+            }
+            ++activeDepth[node.mNameId];
+            pending.push_back({index, true});
+        }
+        for (const auto& child : node.mChildren) {
+            pending.push_back({child.second, false});
+        }
+    }
+
+    std::vector<size_t> order;
+    for (size_t nameId = 0; nameId < totals.size(); ++nameId) {
+        if (totals[nameId].mCalls > 0) {
+            order.push_back(nameId);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&totals](size_t a, size_t b) {
+        return totals[a].mExclusiveTicks > totals[b].mExclusiveTicks;
+    });
+
+    out << std::left << std::setw(55) << "Function"
+        << std::setw(10) << "Calls"
+        << std::setw(14) << "Incl (ms)"
+        << std::setw(14) << "Excl (ms)" << "\n";
+    out << std::string(93, '-') << "\n";
+    for (size_t nameId : order) {
+        const auto& entry = totals[nameId];
+        out << std::left << std::setw(55) << names[nameId]
+            << std::setw(10) << entry.mCalls
+            << std::setw(14) << std::fixed << std::setprecision(3) << static_cast<double>(entry.mInclusiveTicks) / ticksPerMs
+            << std::setw(14) << std::fixed << std::setprecision(3) << static_cast<double>(entry.mExclusiveTicks) / ticksPerMs
+            << "\n";
+    }
+}
+
+// Brendan Gregg's collapsed format ("a;b;c weight"), weighted by exclusive microseconds
+void writeCollapsedStackLines(std::ostream& out, const CallTreeTotals& tree, const std::vector<std::string>& names,
+                              double ticksPerMs) {
+    std::vector<std::pair<size_t, std::string>> pending;
+    for (const auto& child : tree.mNodes[0].mChildren) {
+        pending.push_back({child.second, std::string()});
+    }
+
+    while (!pending.empty()) {
+        auto [index, prefix] = pending.back();
+        pending.pop_back();
+        const auto& node = tree.mNodes[index];
+
+        std::string frame = names[node.mNameId];
+        std::replace(frame.begin(), frame.end(), ';', ':');
+        std::string path = prefix.empty() ? frame : prefix + ";" + frame;
+
+        auto exclusiveUs = static_cast<uint64_t>(static_cast<double>(tree.exclusiveTicks(index)) * 1000.0 / ticksPerMs);
+        if (exclusiveUs > 0) {
+            out << path << " " << exclusiveUs << "\n";
+        }
+        for (const auto& child : node.mChildren) {
+            pending.push_back({child.second, path});
+        }
+    }
+}
+
+}  // namespace
 
 // PIMPL implementation class
 class PerfMonitor::Impl {
@@ -104,28 +819,380 @@ public:
     Impl() = default;
     ~Impl() = default;
 
+    // Per-function view used for reporting
+    struct FunctionSnapshot {
+        PerformanceMetrics::Data mData;
+        LatencyHistogram mHistogram;  // Nanoseconds
+        HardwareTotals mHardware;
+    };
+    using Snapshot = std::unordered_map<std::string, FunctionSnapshot>;
+
+    // Cumulative histograms captured at a fixed cadence; the windowed view is the difference
+    // between the current snapshot and the newest one at least a window old. An empty
+    // snapshot marks the start of the measurements (construction, reset or a window change).
+    struct WindowSnapshot {
+        std::chrono::steady_clock::time_point mTime;
+        std::unordered_map<std::string, LatencyHistogram> mHistograms;
+    };
+
     // Internal data structures with m-prefix camelCase naming
     std::unordered_map<std::string, std::unique_ptr<PerformanceMetrics>> mFunctionMetrics;
-    std::unordered_map<std::string, std::chrono::steady_clock::time_point> mActiveMeasurements;
 
     // Mutexes for thread safety
     mutable std::mutex mFunctionMetricsMutex;
-    mutable std::mutex mActiveMeasurementsMutex;
 
     // Real-time monitoring with m-prefix camelCase naming
     std::atomic<bool> mRealTimeMonitoring{false};
     std::thread mRealTimeThread;
     std::chrono::milliseconds mMonitoringInterval{1000};
     std::string mMonitoringFilePath;
+    MonitoringSink mMonitoringSink = MonitoringSink::SharedMemory;
+
+    // Shared-memory sink; slots are only assigned and written by the monitoring thread
+    shm::Segment* mSharedSegment = nullptr;
+    std::string mSharedName;
+    std::unordered_map<std::string, uint32_t> mSharedSlots;
+
+    // Hardware counter availability, set by enableHardwareCounters()
+    mutable std::mutex mHardwareStatusMutex;
+    std::string mHardwareStatus = "disabled";
+
+    // Windowed percentiles; snapshots are taken by the sampler thread, ~8 per window
+    mutable std::mutex mWindowMutex;
+    std::deque<WindowSnapshot> mWindowSnapshots;
+    std::chrono::seconds mPercentileWindow{10};
+    std::condition_variable mWindowCondition;
+    bool mWindowSamplerRunning = false;
+    std::thread mWindowSampler;
 
     // Helper methods
+    Snapshot collectMetrics() const;
+    std::unordered_map<std::string, LatencyHistogram> windowHistograms(const Snapshot& snapshot,
+                                                                       std::chrono::duration<double>* span) const;
+    void appendWindowSnapshot(std::chrono::steady_clock::time_point time, const Snapshot& snapshot);
+    void restartWindow();
+    void windowSamplerLoop();
+    void startWindowSampler();
+    void stopWindowSampler();
+    void writeStatistics(std::ostream& out, const Snapshot& snapshot) const;
     void realTimeMonitoringLoop();
     std::string getTempFilePath() const;
+    bool openSharedSegment();
+    void closeSharedSegment();
+    void publishShared(const Snapshot& snapshot);
     void stopRealTimeMonitoring();
 };
 
+namespace {
+
+// Per-call hardware figures; events that could not be opened read as -1
+PerfMonitor::HardwareCounterStats hardwareStatsOf(const HardwareTotals& totals) {
+    PerfMonitor::HardwareCounterStats stats;
+    stats.samples = totals.mSamples;
+    if (totals.mSamples == 0) {
+        return stats;
+    }
+
+    uint32_t mask = gHardwareEventMask.load(std::memory_order_relaxed);
+    auto perCall = [&](HardwareEvent event) {
+        return (mask >> event) & 1u ? static_cast<double>(totals.mValues[event]) / static_cast<double>(totals.mSamples)
+                                    : -1.0;
+    };
+    stats.cyclesPerCall = perCall(kCycles);
+    stats.instructionsPerCall = perCall(kInstructions);
+    stats.cacheMissesPerCall = perCall(kCacheMisses);
+    stats.branchMissesPerCall = perCall(kBranchMisses);
+    if (stats.cyclesPerCall > 0.0 && stats.instructionsPerCall >= 0.0) {
+        stats.instructionsPerCycle = stats.instructionsPerCall / stats.cyclesPerCall;
+    }
+    return stats;
+}
+
+// Bucket midpoints can fall outside the observed range; clamp to exact min/max when known
+PerfMonitor::LatencyPercentiles percentilesOf(const LatencyHistogram& histogram,
+                                              const PerformanceMetrics::Data* data = nullptr) {
+    auto quantileMs = [&](double q) {
+        double valueMs = static_cast<double>(histogram.valueAtQuantile(q)) / 1e6;
+        if (data && data->callCount > 0) {
+            valueMs = std::min(std::max(valueMs, data->minDurationMs), data->maxDurationMs);
+        }
+        return valueMs;
+    };
+
+    PerfMonitor::LatencyPercentiles result;
+    result.sampleCount = histogram.mTotalCount;
+    result.p50Ms = quantileMs(0.50);
+    result.p90Ms = quantileMs(0.90);
+    result.p99Ms = quantileMs(0.99);
+    result.p999Ms = quantileMs(0.999);
+    return result;
+}
+
+}  // namespace
+
+// Snapshot of string-keyed metrics merged with registered-site shards
+PerfMonitor::Impl::Snapshot PerfMonitor::Impl::collectMetrics() const {
+    Snapshot metricsCopy;
+    {
+        std::lock_guard<std::mutex> lock(mFunctionMetricsMutex);
+        for (const auto& pair : mFunctionMetrics) {
+            if (pair.second) {  // Check if unique_ptr is valid
+                auto& entry = metricsCopy[pair.first];
+                pair.second->getSnapshot(entry.mData, entry.mHistogram);
+            }
+        }
+    }
+
+    std::vector<std::string> siteNames;
+    std::vector<SiteTotals> siteTotals;
+    auto& registry = SiteRegistry::getInstance();
+    registry.collect(siteNames, siteTotals);
+    double ticksPerMs = registry.ticksPerMs();
+
+    for (size_t siteId = 0; siteId < siteNames.size(); ++siteId) {
+        const auto& totals = siteTotals[siteId];
+        if (totals.mHardware.mSamples > 0) {
+            // Also present for string-keyed scopes, whose timings live in mFunctionMetrics
+            metricsCopy[siteNames[siteId]].mHardware.merge(totals.mHardware);
+        }
+        if (totals.mCallCount == 0) {
+            continue;
+        }
+
+        auto& entry = metricsCopy[siteNames[siteId]];
+        auto& data = entry.mData;
+        double totalMs = static_cast<double>(totals.mTotalTicks) / ticksPerMs;
+        double minMs = static_cast<double>(totals.mMinTicks) / ticksPerMs;
+        double maxMs = static_cast<double>(totals.mMaxTicks) / ticksPerMs;
+        if (data.callCount == 0) {
+            data.minDurationMs = minMs;
+            data.maxDurationMs = maxMs;
+        } else {
+            data.minDurationMs = std::min(data.minDurationMs, minMs);
+            data.maxDurationMs = std::max(data.maxDurationMs, maxMs);
+        }
+        data.callCount += totals.mCallCount;
+        data.totalDurationMs += totalMs;
+        data.avgDurationMs = data.totalDurationMs / data.callCount;
+
+        entry.mHistogram.mergeScaled(totals.mHistogram, 1e6 / ticksPerMs);
+    }
+
+    return metricsCopy;
+}
+
+std::unordered_map<std::string, LatencyHistogram> PerfMonitor::Impl::windowHistograms(
+    const Snapshot& snapshot, std::chrono::duration<double>* span) const {
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(mWindowMutex);
+
+    // Newest snapshot that already covers the full window, or the oldest one while the
+    // measurements are younger than the window
+    const WindowSnapshot* baseline = nullptr;
+    for (const auto& candidate : mWindowSnapshots) {
+        if (baseline && candidate.mTime > now - mPercentileWindow) {
+            break;
+        }
+        baseline = &candidate;
+    }
+
+    std::unordered_map<std::string, LatencyHistogram> result;
+    for (const auto& pair : snapshot) {
+        auto& histogram = result[pair.first];
+        histogram = pair.second.mHistogram;
+        if (baseline) {
+            auto it = baseline->mHistograms.find(pair.first);
+            if (it != baseline->mHistograms.end()) {
+                histogram.subtract(it->second);
+            }
+        }
+    }
+
+    if (span) {
+        *span = baseline ? now - baseline->mTime : std::chrono::duration<double>::zero();
+    }
+    return result;
+}
+
+// Caller holds mWindowMutex
+void PerfMonitor::Impl::appendWindowSnapshot(std::chrono::steady_clock::time_point time, const Snapshot& snapshot) {
+    WindowSnapshot current;
+    current.mTime = time;
+    for (const auto& pair : snapshot) {
+        current.mHistograms.emplace(pair.first, pair.second.mHistogram);
+    }
+    mWindowSnapshots.push_back(std::move(current));
+}
+
+// Drop the snapshots of earlier measurements; the empty baseline stands for the histograms'
+// state right after a reset or at construction
+void PerfMonitor::Impl::restartWindow() {
+    std::lock_guard<std::mutex> lock(mWindowMutex);
+    mWindowSnapshots.clear();
+    mWindowSnapshots.push_back({std::chrono::steady_clock::now(), {}});
+    mWindowCondition.notify_all();
+}
+
+void PerfMonitor::Impl::windowSamplerLoop() {
+    std::unique_lock<std::mutex> lock(mWindowMutex);
+    while (mWindowSamplerRunning) {
+        auto cadence = std::chrono::duration_cast<std::chrono::steady_clock::duration>(mPercentileWindow) / 8;
+        if (mWindowCondition.wait_for(lock, cadence) != std::cv_status::timeout || !mWindowSamplerRunning) {
+            // Woken by a window change or stop; wait a full cadence from here
+            continue;
+        }
+
+        lock.unlock();
+        auto now = std::chrono::steady_clock::now();
+        auto snapshot = collectMetrics();
+        lock.lock();
+
+        // A reset or window change while collecting makes this snapshot stale
+        if (!mWindowSnapshots.empty() && mWindowSnapshots.back().mTime >= now) {
+            continue;
+        }
+        appendWindowSnapshot(now, snapshot);
+
+        // Keep only the newest snapshot that already covers the full window, plus younger ones
+        while (mWindowSnapshots.size() > 1 && mWindowSnapshots[1].mTime <= now - mPercentileWindow) {
+            mWindowSnapshots.pop_front();
+        }
+    }
+}
+
+void PerfMonitor::Impl::startWindowSampler() {
+    restartWindow();
+    std::lock_guard<std::mutex> lock(mWindowMutex);
+    mWindowSamplerRunning = true;
+    mWindowSampler = std::thread(&Impl::windowSamplerLoop, this);
+}
+
+void PerfMonitor::Impl::stopWindowSampler() {
+    {
+        std::lock_guard<std::mutex> lock(mWindowMutex);
+        mWindowSamplerRunning = false;
+        mWindowCondition.notify_all();
+    }
+    if (mWindowSampler.joinable()) {
+        mWindowSampler.join();
+    }
+}
+
+// Statistics tables shared by generateReport() and the real-time monitoring file
+void PerfMonitor::Impl::writeStatistics(std::ostream& out, const Snapshot& snapshot) const {
+    size_t totalCalls = 0;
+    double totalExecutionTime = 0.0;
+    for (const auto& pair : snapshot) {
+        totalCalls += pair.second.mData.callCount;
+        totalExecutionTime += pair.second.mData.totalDurationMs;
+    }
+
+    out << "Total Functions Monitored: " << snapshot.size() << "\n";
+    out << "Total Function Calls: " << totalCalls << "\n";
+    out << "Total Execution Time: " << std::fixed << std::setprecision(3)
+        << totalExecutionTime << " ms\n\n";
+
+    out << std::left << std::setw(45) << "Function Name"
+        << std::setw(10) << "Calls"
+        << std::setw(12) << "Avg (ms)"
+        << std::setw(12) << "Min (ms)"
+        << std::setw(12) << "Max (ms)"
+        << std::setw(12) << "Total (ms)"
+        << std::setw(12) << "P50 (ms)"
+        << std::setw(12) << "P90 (ms)"
+        << std::setw(12) << "P99 (ms)"
+        << std::setw(12) << "P99.9 (ms)" << "\n";
+    out << std::string(151, '-') << "\n";
+
+    for (const auto& pair : snapshot) {
+        const auto& metrics = pair.second.mData;
+        auto percentiles = percentilesOf(pair.second.mHistogram, &metrics);
+        out << std::left << std::setw(45) << pair.first
+            << std::setw(10) << metrics.callCount
+            << std::setw(12) << std::fixed << std::setprecision(3) << metrics.avgDurationMs
+            << std::setw(12) << std::fixed << std::setprecision(3) << metrics.minDurationMs
+            << std::setw(12) << std::fixed << std::setprecision(3) << metrics.maxDurationMs
+            << std::setw(12) << std::fixed << std::setprecision(3) << metrics.totalDurationMs
+            << std::setw(12) << std::fixed << std::setprecision(3) << percentiles.p50Ms
+            << std::setw(12) << std::fixed << std::setprecision(3) << percentiles.p90Ms
+            << std::setw(12) << std::fixed << std::setprecision(3) << percentiles.p99Ms
+            << std::setw(12) << std::fixed << std::setprecision(3) << percentiles.p999Ms << "\n";
+    }
+
+    bool hasHardware = std::any_of(snapshot.begin(), snapshot.end(), [](const auto& pair) {
+        return pair.second.mHardware.mSamples > 0;
+    });
+    if (hasHardware) {
+        auto formatValue = [](double value, int precision) {
+            std::ostringstream text;
+            if (value < 0.0) {
+                text << "n/a";
+            } else {
+                text << std::fixed << std::setprecision(precision) << value;
+            }
+            return text.str();
+        };
+
+        out << "\n=== Hardware Counters (per call) ===\n\n";
+        out << std::left << std::setw(45) << "Function Name"
+            << std::setw(10) << "Samples"
+            << std::setw(14) << "Cycles"
+            << std::setw(14) << "Instructions"
+            << std::setw(8) << "IPC"
+            << std::setw(14) << "Cache Miss"
+            << std::setw(14) << "Branch Miss" << "\n";
+        out << std::string(119, '-') << "\n";
+
+        for (const auto& pair : snapshot) {
+            if (pair.second.mHardware.mSamples == 0) {
+                continue;
+            }
+            auto stats = hardwareStatsOf(pair.second.mHardware);
+            out << std::left << std::setw(45) << pair.first
+                << std::setw(10) << stats.samples
+                << std::setw(14) << formatValue(stats.cyclesPerCall, 0)
+                << std::setw(14) << formatValue(stats.instructionsPerCall, 0)
+                << std::setw(8) << formatValue(stats.instructionsPerCycle, 2)
+                << std::setw(14) << formatValue(stats.cacheMissesPerCall, 2)
+                << std::setw(14) << formatValue(stats.branchMissesPerCall, 2) << "\n";
+        }
+    }
+
+    std::chrono::duration<double> span;
+    auto windowed = windowHistograms(snapshot, &span);
+    out << "\n=== Latency Percentiles (last " << std::fixed << std::setprecision(1) << span.count() << " s of a "
+        << mPercentileWindow.count() << " s window) ===\n\n";
+    out << std::left << std::setw(45) << "Function Name"
+        << std::setw(10) << "Calls"
+        << std::setw(12) << "P50 (ms)"
+        << std::setw(12) << "P90 (ms)"
+        << std::setw(12) << "P99 (ms)"
+        << std::setw(12) << "P99.9 (ms)" << "\n";
+    out << std::string(103, '-') << "\n";
+
+    for (const auto& pair : windowed) {
+        if (pair.second.mTotalCount == 0) {
+            continue;
+        }
+        auto percentiles = percentilesOf(pair.second);
+        out << std::left << std::setw(45) << pair.first
+            << std::setw(10) << percentiles.sampleCount
+            << std::setw(12) << std::fixed << std::setprecision(3) << percentiles.p50Ms
+            << std::setw(12) << std::fixed << std::setprecision(3) << percentiles.p90Ms
+            << std::setw(12) << std::fixed << std::setprecision(3) << percentiles.p99Ms
+            << std::setw(12) << std::fixed << std::setprecision(3) << percentiles.p999Ms << "\n";
+    }
+}
+
 void PerfMonitor::Impl::realTimeMonitoringLoop() {
     while (mRealTimeMonitoring.load()) {
+        if (mSharedSegment) {
+            publishShared(collectMetrics());
+            std::this_thread::sleep_for(mMonitoringInterval);
+            continue;
+        }
+
         std::ofstream file(mMonitoringFilePath); // Remove std::ios::app to overwrite
         if (file.is_open()) {
             auto now = std::chrono::system_clock::now();
@@ -137,68 +1204,8 @@ void PerfMonitor::Impl::realTimeMonitoringLoop() {
             file << "Monitor this file with: tail -f " << mMonitoringFilePath << "\n";
             file << "Last updated at timestamp: " << timestamp << "\n\n";
 
-            // Generate current statistics report with shared lock for reading
-            // Simple struct for monitoring data
-            struct MonitorData {
-                double minDurationMs;
-                double maxDurationMs;
-                double totalDurationMs;
-                double avgDurationMs;
-                size_t callCount;
-            };
-
-            size_t totalCalls = 0;
-            double totalExecutionTime = 0.0;
-            size_t functionCount = 0;
-
-            // Create a copy of the metrics to minimize lock time
-            std::unordered_map<std::string, MonitorData> metricsCopy;
-            {
-                std::lock_guard<std::mutex> lock(mFunctionMetricsMutex);
-                for (const auto& pair : mFunctionMetrics) {
-                    if (pair.second) {  // Check if unique_ptr is valid
-                        const auto& metrics = *pair.second;
-                        auto data = metrics.getAllData();
-                        metricsCopy[pair.first] = {
-                            data.minDurationMs,
-                            data.maxDurationMs,
-                            data.totalDurationMs,
-                            data.avgDurationMs,
-                            data.callCount
-                        };
-                    }
-                }
-                functionCount = mFunctionMetrics.size();
-            }
-
-            for (const auto& pair : metricsCopy) {
-                totalCalls += pair.second.callCount;
-                totalExecutionTime += pair.second.totalDurationMs;
-            }
-
             file << "=== Current Performance Statistics ===\n\n";
-            file << "Total Functions Monitored: " << functionCount << "\n";
-            file << "Total Function Calls: " << totalCalls << "\n";
-            file << "Total Execution Time: " << std::fixed << std::setprecision(3)
-                 << totalExecutionTime << " ms\n\n";
-
-            file << std::left << std::setw(45) << "Function Name"
-                 << std::setw(10) << "Calls"
-                 << std::setw(12) << "Avg (ms)"
-                 << std::setw(12) << "Min (ms)"
-                 << std::setw(12) << "Max (ms)"
-                 << std::setw(12) << "Total (ms)" << "\n";
-            file << std::string(103, '-') << "\n";
-
-            for (const auto& pair : metricsCopy) {
-                const auto& metrics = pair.second;
-                file << std::left << std::setw(45) << pair.first
-                     << std::setw(10) << metrics.callCount
-                     << std::setw(12) << std::fixed << std::setprecision(3) << metrics.avgDurationMs
-                     << std::setw(12) << std::fixed << std::setprecision(3) << metrics.minDurationMs
-                     << std::setw(12) << std::fixed << std::setprecision(3) << metrics.maxDurationMs
-                     << std::setw(12) << std::fixed << std::setprecision(3) << metrics.totalDurationMs << "\n";
-            }
+            writeStatistics(file, collectMetrics());
 
             file.close();
         }
@@ -212,19 +1219,113 @@ std::string PerfMonitor::Impl::getTempFilePath() const {
     return tempDir + filename;
 }
 
+bool PerfMonitor::Impl::openSharedSegment() {
+    mSharedName = shm::segmentName(static_cast<uint32_t>(getpid()));
+    shm_unlink(mSharedName.c_str());  // Stale segment of an earlier process with the same pid
+
+    int fd = shm_open(mSharedName.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("PerfMonitor: shm_open");
+        return false;
+    }
+    if (ftruncate(fd, sizeof(shm::Segment)) != 0) {
+        perror("PerfMonitor: ftruncate");
+        close(fd);
+        shm_unlink(mSharedName.c_str());
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, sizeof(shm::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        perror("PerfMonitor: mmap");
+        shm_unlink(mSharedName.c_str());
+        return false;
+    }
+
+    // The truncated segment is zero-filled, which is a valid initial state for every field
+    mSharedSegment = static_cast<shm::Segment*>(mapping);
+    mSharedSegment->mVersion = shm::kVersion;
+    mSharedSegment->mProcessId = static_cast<uint32_t>(getpid());
+    mSharedSegment->mEntryCapacity = shm::kMaxEntries;
+    mSharedSegment->mIntervalMs = static_cast<uint64_t>(mMonitoringInterval.count());
+    std::atomic_thread_fence(std::memory_order_release);
+    mSharedSegment->mMagic = shm::kMagic;  // Readers check the magic last
+    mSharedSlots.clear();
+    return true;
+}
+
+void PerfMonitor::Impl::closeSharedSegment() {
+    if (!mSharedSegment) {
+        return;
+    }
+    munmap(mSharedSegment, sizeof(shm::Segment));
+    shm_unlink(mSharedName.c_str());
+    mSharedSegment = nullptr;
+}
+
+// Copy the current metrics into the segment; each entry is updated under its seqlock
+void PerfMonitor::Impl::publishShared(const Snapshot& snapshot) {
+    auto& segment = *mSharedSegment;
+    std::vector<bool> published(shm::kMaxEntries, false);
+    uint32_t overflow = 0;
+
+    for (const auto& pair : snapshot) {
+        auto it = mSharedSlots.find(pair.first);
+        bool isNew = it == mSharedSlots.end();
+        if (isNew) {
+            if (mSharedSlots.size() >= shm::kMaxEntries) {
+                ++overflow;
+                continue;
+            }
+            it = mSharedSlots.emplace(pair.first, static_cast<uint32_t>(mSharedSlots.size())).first;
+        }
+
+        const auto& data = pair.second.mData;
+        auto& entry = segment.mEntries[it->second];
+        shm::writeEntry(entry, isNew ? pair.first.c_str() : nullptr, data.callCount,
+                        static_cast<uint64_t>(data.totalDurationMs * 1e6),
+                        data.callCount ? static_cast<uint64_t>(data.minDurationMs * 1e6) : 0,
+                        static_cast<uint64_t>(data.maxDurationMs * 1e6), pair.second.mHistogram);
+        published[it->second] = true;
+        if (isNew) {
+            entry.mActive.store(1, std::memory_order_release);
+            segment.mEntryCount.store(static_cast<uint32_t>(mSharedSlots.size()), std::memory_order_release);
+        }
+    }
+
+    // Functions that disappeared after a reset read as empty
+    static const LatencyHistogram kEmptyHistogram;
+    for (const auto& pair : mSharedSlots) {
+        if (!published[pair.second]) {
+            shm::writeEntry(segment.mEntries[pair.second], nullptr, 0, 0, 0, 0, kEmptyHistogram);
+        }
+    }
+
+    segment.mOverflowCount.store(overflow, std::memory_order_relaxed);
+    segment.mPublishedAtNs.store(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count()), std::memory_order_relaxed);
+    segment.mPublishCount.fetch_add(1, std::memory_order_release);
+}
+
 void PerfMonitor::Impl::stopRealTimeMonitoring() {
     mRealTimeMonitoring.store(false);
     if (mRealTimeThread.joinable()) {
         mRealTimeThread.join();
     }
+    closeSharedSegment();
 }
 
 // PerfMonitor implementation
 PerfMonitor::PerfMonitor() : mImpl(std::make_unique<Impl>()) {
+    // Constructed first so the registry outlives the background threads at exit
+    SiteRegistry::getInstance();
+    mImpl->startWindowSampler();
 }
 
 PerfMonitor::~PerfMonitor() {
     if (mImpl) {
+        mImpl->stopWindowSampler();
         stopRealTimeMonitoring();
     }
 }
@@ -234,9 +1335,13 @@ PerfMonitor& PerfMonitor::getInstance() {
     return instance;
 }
 
+// Measurements are tracked per thread, so the same name may be measured concurrently on
+// several threads or re-entered recursively; endMeasurement() closes the innermost one.
 void PerfMonitor::startMeasurement(const std::string& functionName) {
-    std::lock_guard<std::mutex> lock(mImpl->mActiveMeasurementsMutex);
-    mImpl->mActiveMeasurements[functionName] = std::chrono::steady_clock::now();
+    uint32_t treeSiteId = enterNamedScope(functionName);
+    tManualMeasurements.push_back(ManualMeasurement{functionName, std::chrono::steady_clock::now(),
+                                                    gMeasurementGeneration.load(std::memory_order_relaxed),
+                                                    treeSiteId});
 }
 
 void PerfMonitor::endMeasurement(const std::string& functionName) {
@@ -245,20 +1350,24 @@ void PerfMonitor::endMeasurement(const std::string& functionName) {
     std::chrono::steady_clock::time_point startTime;
     bool foundMeasurement = false;
 
-    // Find and remove from active measurements
-    {
-        std::lock_guard<std::mutex> lock(mImpl->mActiveMeasurementsMutex);
-        auto it = mImpl->mActiveMeasurements.find(functionName);
-        if (it != mImpl->mActiveMeasurements.end()) {
-            startTime = it->second;
-            foundMeasurement = true;
-            mImpl->mActiveMeasurements.erase(it);
+    // Find and remove the innermost open measurement with this name
+    for (size_t i = tManualMeasurements.size(); i-- > 0;) {
+        const auto& measurement = tManualMeasurements[i];
+        if (measurement.mName != functionName) {
+            continue;
+        }
+        if (measurement.mTreeSiteId != kInvalidSiteId) {
+            currentThreadShard().callTree().exit(measurement.mTreeSiteId, readTicks());
         }
+        // Measurements started before reset() are dropped
+        foundMeasurement = measurement.mGeneration == gMeasurementGeneration.load(std::memory_order_relaxed);
+        startTime = measurement.mStartTime;
+        tManualMeasurements.erase(tManualMeasurements.begin() + static_cast<std::ptrdiff_t>(i));
+        break;
     }
 
     if (foundMeasurement) {
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
-            endTime - startTime).count() / 1000.0;
+        auto duration = std::chrono::duration<double, std::milli>(endTime - startTime).count();
 
         // Update metrics with lock
         {
@@ -269,6 +1378,10 @@ void PerfMonitor::endMeasurement(const std::string& functionName) {
             }
             metrics->update(duration);
         }
+
+        if (gTraceEnabled.load(std::memory_order_relaxed)) {
+            recordNamedTraceEvent(functionName, duration);
+        }
     }
 }
 
@@ -281,20 +1394,76 @@ void PerfMonitor::updateMetrics(const std::string& functionName, double duration
     metrics->update(durationMs);
 }
 
+PerfMonitor::SiteHandle PerfMonitor::registerSite(const std::string& functionName) {
+    return SiteHandle{SiteRegistry::getInstance().registerSite(functionName)};
+}
+
+PerfMonitor::SiteTimer::SiteTimer(SiteHandle site) noexcept
+    : mSite(site), mInCallTree(false), mCountingHardware(false), mStartTicks(0) {
+    // Counters start before the clock so the read() syscall is not part of the measured time
+    if (gHardwareCountersEnabled.load(std::memory_order_relaxed) && mSite.mId != kInvalidSiteId) {
+        mCountingHardware = beginHardwareSample();
+    }
+    mStartTicks = readTicks();
+    if (gCallTreeEnabled.load(std::memory_order_relaxed) && mSite.mId != kInvalidSiteId) {
+        currentThreadShard().callTree().enter(mSite.mId, mStartTicks);
+        mInCallTree = true;
+    }
+}
+
+PerfMonitor::SiteTimer::~SiteTimer() {
+    uint64_t ticks = readTicks() - mStartTicks;
+    if (mSite.mId == kInvalidSiteId) {
+        return;
+    }
+
+    ThreadShard* shard = tThreadShard;
+    if (!shard) {
+        shard = attachThreadShard();
+    }
+    if (mCountingHardware) {
+        endHardwareSample(*shard, mSite.mId);
+    }
+    shard->counters(mSite.mId).record(ticks);
+
+    if (mInCallTree) {
+        shard->callTree().exit(mSite.mId, mStartTicks + ticks);
+    }
+    if (gTraceEnabled.load(std::memory_order_relaxed)) {
+        recordTraceEvent(*shard, mSite.mId, mStartTicks, mStartTicks + ticks);
+    }
+}
+
 PerfMonitor::ScopedTimer::ScopedTimer(const std::string& functionName)
-    : mName(functionName), mStartTime(std::chrono::steady_clock::now()) {
+    : mName(functionName), mTreeSiteId(enterNamedScope(functionName)), mHardwareSiteId(kInvalidSiteId) {
+    if (gHardwareCountersEnabled.load(std::memory_order_relaxed)) {
+        uint32_t siteId = mTreeSiteId != kInvalidSiteId ? mTreeSiteId
+                                                        : SiteRegistry::getInstance().registerSite(functionName);
+        if (siteId != kInvalidSiteId && beginHardwareSample()) {
+            mHardwareSiteId = siteId;
+        }
+    }
+    mStartTime = std::chrono::steady_clock::now();
 }
 
 PerfMonitor::ScopedTimer::~ScopedTimer() {
     try {
         auto endTime = std::chrono::steady_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
-            endTime - mStartTime).count() / 1000.0;
+        auto duration = std::chrono::duration<double, std::milli>(endTime - mStartTime).count();
+        if (mHardwareSiteId != kInvalidSiteId) {
+            endHardwareSample(currentThreadShard(), mHardwareSiteId);
+        }
+        if (mTreeSiteId != kInvalidSiteId) {
+            currentThreadShard().callTree().exit(mTreeSiteId, readTicks());
+        }
 
         auto& monitor = PerfMonitor::getInstance();
         if (monitor.mImpl) {
             monitor.updateMetrics(mName, duration);
         }
+        if (gTraceEnabled.load(std::memory_order_relaxed)) {
+            recordNamedTraceEvent(mName, duration);
+        }
     } catch (...) {
         // Ignore exceptions during destruction
     }
@@ -305,77 +1474,171 @@ PerfMonitor::ScopedTimer::~ScopedTimer() {
 std::string PerfMonitor::generateReport() const {
     std::ostringstream report;
 
-    // Simple struct for report data
-    struct ReportData {
-        double minDurationMs;
-        double maxDurationMs;
-        double totalDurationMs;
-        double avgDurationMs;
-        size_t callCount;
-    };
+    report << "=== Performance Monitor Report ===\n\n";
+    mImpl->writeStatistics(report, mImpl->collectMetrics());
 
-    size_t totalCalls = 0;
-    double totalExecutionTime = 0.0;
-    size_t functionCount = 0;
+    return report.str();
+}
 
-    // Create a copy of the metrics to minimize lock time
-    std::unordered_map<std::string, ReportData> metricsCopy;
+PerfMonitor::LatencyPercentiles PerfMonitor::getPercentiles(const std::string& functionName) const {
+    auto snapshot = mImpl->collectMetrics();
+    auto it = snapshot.find(functionName);
+    return it != snapshot.end() ? percentilesOf(it->second.mHistogram, &it->second.mData) : LatencyPercentiles{};
+}
+
+PerfMonitor::LatencyPercentiles PerfMonitor::getWindowPercentiles(const std::string& functionName) const {
+    auto windowed = mImpl->windowHistograms(mImpl->collectMetrics(), nullptr);
+    auto it = windowed.find(functionName);
+    return it != windowed.end() ? percentilesOf(it->second) : LatencyPercentiles{};
+}
+
+void PerfMonitor::setPercentileWindow(std::chrono::seconds window) {
     {
-        std::lock_guard<std::mutex> lock(mImpl->mFunctionMetricsMutex);
-        for (const auto& pair : mImpl->mFunctionMetrics) {
-            if (pair.second) {  // Check if unique_ptr is valid
-                const auto& metrics = *pair.second;
-                auto data = metrics.getAllData();
-                metricsCopy[pair.first] = {
-                    data.minDurationMs,
-                    data.maxDurationMs,
-                    data.totalDurationMs,
-                    data.avgDurationMs,
-                    data.callCount
-                };
-            }
-        }
-        functionCount = mImpl->mFunctionMetrics.size();
+        std::lock_guard<std::mutex> lock(mImpl->mWindowMutex);
+        mImpl->mPercentileWindow = std::max(window, std::chrono::seconds(1));
     }
 
-    for (const auto& pair : metricsCopy) {
-        totalCalls += pair.second.callCount;
-        totalExecutionTime += pair.second.totalDurationMs;
+    // Snapshots spaced for the old window are dropped; the new window starts from the
+    // current histograms
+    auto now = std::chrono::steady_clock::now();
+    auto snapshot = mImpl->collectMetrics();
+    std::lock_guard<std::mutex> lock(mImpl->mWindowMutex);
+    mImpl->mWindowSnapshots.clear();
+    mImpl->appendWindowSnapshot(now, snapshot);
+    mImpl->mWindowCondition.notify_all();
+}
+
+bool PerfMonitor::enableHardwareCounters(bool enabled) {
+    if (!enabled) {
+        gHardwareCountersEnabled.store(false, std::memory_order_relaxed);
+        return true;
     }
 
-    report << "=== Performance Monitor Report ===\n\n";
-    report << "Total Functions Monitored: " << functionCount << "\n";
-    report << "Total Function Calls: " << totalCalls << "\n";
-    report << "Total Execution Time: " << std::fixed << std::setprecision(3)
-           << totalExecutionTime << " ms\n\n";
-
-    report << std::left << std::setw(45) << "Function Name"
-           << std::setw(10) << "Calls"
-           << std::setw(12) << "Avg (ms)"
-           << std::setw(12) << "Min (ms)"
-           << std::setw(12) << "Max (ms)"
-           << std::setw(12) << "Total (ms)" << "\n";
-    report << std::string(103, '-') << "\n";
-
-    for (const auto& pair : metricsCopy) {
-        const auto& metrics = pair.second;
-        report << std::left << std::setw(45) << pair.first
-               << std::setw(10) << metrics.callCount
-               << std::setw(12) << std::fixed << std::setprecision(3) << metrics.avgDurationMs
-               << std::setw(12) << std::fixed << std::setprecision(3) << metrics.minDurationMs
-               << std::setw(12) << std::fixed << std::setprecision(3) << metrics.maxDurationMs
-               << std::setw(12) << std::fixed << std::setprecision(3) << metrics.totalDurationMs << "\n";
+    // Probe on the calling thread; recording threads open their own groups lazily
+    HardwareCounterGroup probe;
+    std::string error;
+    bool available = probe.open(&error);
+    gHardwareEventMask.store(probe.availableMask(), std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mImpl->mHardwareStatusMutex);
+    if (available) {
+        mImpl->mHardwareStatus = "counting:";
+        for (size_t event = 0; event < kHardwareEventCount; ++event) {
+            mImpl->mHardwareStatus += std::string(" ") + hardwareEventName(static_cast<HardwareEvent>(event)) +
+                                      ((probe.availableMask() >> event) & 1u ? "" : " (unavailable)");
+        }
+    } else {
+        mImpl->mHardwareStatus = "unavailable: " + error;
     }
+    gHardwareCountersEnabled.store(available, std::memory_order_relaxed);
+    return available;
+}
 
+bool PerfMonitor::isHardwareCountersEnabled() const {
+    return gHardwareCountersEnabled.load(std::memory_order_relaxed);
+}
+
+std::string PerfMonitor::getHardwareCounterStatus() const {
+    std::lock_guard<std::mutex> lock(mImpl->mHardwareStatusMutex);
+    return mImpl->mHardwareStatus;
+}
+
+PerfMonitor::HardwareCounterStats PerfMonitor::getHardwareCounterStats(const std::string& functionName) const {
+    auto snapshot = mImpl->collectMetrics();
+    auto it = snapshot.find(functionName);
+    return it != snapshot.end() ? hardwareStatsOf(it->second.mHardware) : HardwareCounterStats{};
+}
+
+void PerfMonitor::enableCallTree(bool enabled) {
+    gCallTreeEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool PerfMonitor::isCallTreeEnabled() const {
+    return gCallTreeEnabled.load(std::memory_order_relaxed);
+}
+
+std::string PerfMonitor::generateCallTreeReport() const {
+    std::vector<std::string> names;
+    CallTreeTotals tree;
+    auto& registry = SiteRegistry::getInstance();
+    registry.collectCallTree(names, tree);
+    double ticksPerMs = registry.ticksPerMs();
+
+    std::ostringstream report;
+    report << "=== Call Tree ===\n\n";
+    writeCallTree(report, tree, names, ticksPerMs);
+    report << "\n=== Inclusive / Exclusive Time by Function ===\n\n";
+    writeCallTreeByFunction(report, tree, names, ticksPerMs);
     return report.str();
 }
 
-void PerfMonitor::startRealTimeMonitoring(std::chrono::milliseconds interval) {
+bool PerfMonitor::writeCollapsedStacks(const std::string& filePath) const {
+    std::vector<std::string> names;
+    CallTreeTotals tree;
+    auto& registry = SiteRegistry::getInstance();
+    registry.collectCallTree(names, tree);
+
+    std::ofstream file(filePath);
+    if (!file.is_open()) {
+        return false;
+    }
+    writeCollapsedStackLines(file, tree, names, registry.ticksPerMs());
+    return file.good();
+}
+
+void PerfMonitor::startTracing(size_t eventsPerThread) {
+    SiteRegistry::getInstance().startTracing(std::max<size_t>(eventsPerThread, 1));
+}
+
+void PerfMonitor::stopTracing() {
+    gTraceEnabled.store(false, std::memory_order_release);
+}
+
+bool PerfMonitor::isTracing() const {
+    return gTraceEnabled.load(std::memory_order_relaxed);
+}
+
+bool PerfMonitor::writeTrace(const std::string& filePath, TraceFormat format) {
+    TraceCapture capture;
+    capture.mProcessId = static_cast<int32_t>(getpid());
+    capture.mProcessName = currentProcessName();
+    SiteRegistry::getInstance().drainTrace(capture);
+
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    if (format == TraceFormat::PerfettoProto) {
+        writePerfettoTrace(file, capture);
+    } else {
+        writeChromeJsonTrace(file, capture);
+    }
+    return file.good();
+}
+
+PerfMonitor::TraceStats PerfMonitor::getTraceStats() const {
+    return SiteRegistry::getInstance().traceStats();
+}
+
+void PerfMonitor::startRealTimeMonitoring(std::chrono::milliseconds interval, MonitoringSink sink) {
     if (mImpl->mRealTimeMonitoring.load()) {
         return;
     }
 
     mImpl->mMonitoringInterval = interval;
+    mImpl->mMonitoringSink = sink;
+    if (sink == MonitoringSink::SharedMemory) {
+        if (mImpl->openSharedSegment()) {
+            mImpl->mMonitoringFilePath = "/dev/shm" + mImpl->mSharedName;
+            mImpl->publishShared(mImpl->collectMetrics());
+            mImpl->mRealTimeMonitoring.store(true);
+            mImpl->mRealTimeThread = std::thread(&Impl::realTimeMonitoringLoop, mImpl.get());
+            return;
+        }
+        // Fall back to the text file when shared memory is unavailable
+        mImpl->mMonitoringSink = MonitoringSink::TextFile;
+    }
     mImpl->mMonitoringFilePath = mImpl->getTempFilePath();
 
     // Create initial file with header
@@ -411,10 +1674,9 @@ void PerfMonitor::reset() {
         std::lock_guard<std::mutex> lock(mImpl->mFunctionMetricsMutex);
         mImpl->mFunctionMetrics.clear();
     }
-    {
-        std::lock_guard<std::mutex> lock(mImpl->mActiveMeasurementsMutex);
-        mImpl->mActiveMeasurements.clear();
-    }
+    gMeasurementGeneration.fetch_add(1, std::memory_order_relaxed);
+    SiteRegistry::getInstance().reset(nullptr);
+    mImpl->restartWindow();
 }
 
 void PerfMonitor::resetFunction(const std::string& functionName) {
@@ -423,6 +1685,7 @@ void PerfMonitor::resetFunction(const std::string& functionName) {
     if (it != mImpl->mFunctionMetrics.end() && it->second) {
         it->second->reset();
     }
+    SiteRegistry::getInstance().reset(&functionName);
 }
 
 } // namespace perf
\ No newline at end of file
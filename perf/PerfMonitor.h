@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -12,7 +13,7 @@ public:
     static PerfMonitor& getInstance();
 
 
-    // Core measurement APIs
+    // Core measurement APIs (tracked per thread: start and end must run on the same thread)
     void startMeasurement(const std::string& functionName);
     void endMeasurement(const std::string& functionName);
 
@@ -23,14 +24,117 @@ public:
         ~ScopedTimer();
     private:
         std::string mName;
+        uint32_t mTreeSiteId;      // Call-tree scope, if call-tree profiling was on at construction
+        uint32_t mHardwareSiteId;  // Site receiving hardware counter deltas, if counting
         std::chrono::steady_clock::time_point mStartTime;
     };
 
+    // Handle of a registered measurement site
+    struct SiteHandle {
+        uint32_t mId;
+    };
+
+    // Register a measurement site once (done by PERF_MEASURE_STATIC_SCOPE / PERF_MEASURE_FUNCTION).
+    // Measurements through the handle go to thread-local shards with relaxed atomics and are
+    // only aggregated when a report is generated.
+    SiteHandle registerSite(const std::string& functionName);
+
+    // Scoped measurement for a registered site (RAII): no locks, hashing or string copies
+    class SiteTimer {
+    public:
+        explicit SiteTimer(SiteHandle site) noexcept;
+        ~SiteTimer();
+
+        SiteTimer(const SiteTimer&) = delete;
+        SiteTimer& operator=(const SiteTimer&) = delete;
+    private:
+        SiteHandle mSite;
+        bool mInCallTree;
+        bool mCountingHardware;
+        uint64_t mStartTicks;
+    };
+
     // Simple reporting
     std::string generateReport() const;
 
+    // Latency percentiles from per-function log-linear histograms (~6% relative precision)
+    struct LatencyPercentiles {
+        double p50Ms = 0.0;
+        double p90Ms = 0.0;
+        double p99Ms = 0.0;
+        double p999Ms = 0.0;
+        uint64_t sampleCount = 0;
+    };
+
+    // Percentiles over the whole lifetime (since the last reset)
+    LatencyPercentiles getPercentiles(const std::string& functionName) const;
+
+    // Percentiles over roughly the last window: a background thread snapshots the histograms
+    // eight times per window, so the span covered is between one window and 1.125 windows
+    // (shorter while the measurements are younger than the window)
+    LatencyPercentiles getWindowPercentiles(const std::string& functionName) const;
+    void setPercentileWindow(std::chrono::seconds window);
+
+    // Hardware counters (cycles, instructions, cache-misses, branch-misses) for
+    // PERF_MEASURE_SCOPE / PERF_MEASURE_FUNCTION scopes via a perf_event_open group per thread.
+    // Each counted scope costs two read() syscalls. Returns false and stays disabled when the
+    // counters are unavailable (no PMU, containers, perf_event_paranoid); see the status.
+    bool enableHardwareCounters(bool enabled);
+    bool isHardwareCountersEnabled() const;
+    std::string getHardwareCounterStatus() const;
+
+    // Averages per counted call; an event the CPU or kernel does not provide reads as -1
+    struct HardwareCounterStats {
+        uint64_t samples = 0;
+        double cyclesPerCall = -1.0;
+        double instructionsPerCall = -1.0;
+        double instructionsPerCycle = -1.0;
+        double cacheMissesPerCall = -1.0;
+        double branchMissesPerCall = -1.0;
+    };
+
+    HardwareCounterStats getHardwareCounterStats(const std::string& functionName) const;
+
+    // Call-tree profiling: scopes nested on the same thread are attributed to their parent,
+    // giving inclusive and exclusive time per call path. Off by default.
+    void enableCallTree(bool enabled);
+    bool isCallTreeEnabled() const;
+    std::string generateCallTreeReport() const;
+
+    // Flamegraph-compatible collapsed stacks ("outer;inner <exclusive us>" per line)
+    bool writeCollapsedStacks(const std::string& filePath) const;
+
+    // Event tracing: every measured scope is also recorded with its thread into a per-thread
+    // lock-free ring buffer; buffers are drained into a trace file on demand.
+    enum class TraceFormat {
+        ChromeJson,     // chrome://tracing / ui.perfetto.dev JSON
+        PerfettoProto   // Perfetto protobuf (TrackEvent)
+    };
+
+    struct TraceStats {
+        uint64_t recordedEvents = 0;   // Events accepted since startTracing()
+        uint64_t droppedEvents = 0;    // Events lost because a thread's buffer was full
+        size_t bufferCapacity = 0;     // Events per thread buffer
+        size_t threadCount = 0;        // Threads that recorded in this session
+    };
+
+    // Start a session; buffers are capped at eventsPerThread (rounded up to a power of two)
+    void startTracing(size_t eventsPerThread = 65536);
+    void stopTracing();
+    bool isTracing() const;
+
+    // Drain all buffered events into a trace file; consecutive calls produce consecutive captures
+    bool writeTrace(const std::string& filePath, TraceFormat format = TraceFormat::ChromeJson);
+    TraceStats getTraceStats() const;
+
     // Real-time monitoring
-    void startRealTimeMonitoring(std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+    enum class MonitoringSink {
+        SharedMemory,  // Binary seqlock-protected segment (/dev/shm/perfmonitor_<pid>), read by perfmon-top
+        TextFile       // Formatted report rewritten in /tmp every interval (tail -f)
+    };
+
+    void startRealTimeMonitoring(std::chrono::milliseconds interval = std::chrono::milliseconds(1000),
+                                 MonitoringSink sink = MonitoringSink::SharedMemory);
     void stopRealTimeMonitoring();
     std::string getRealTimeMonitoringFilePath() const;
 
@@ -52,11 +156,27 @@ private:
 };
 
 // Convenience macros for easy integration
+#define PERF_CONCAT_INNER(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_INNER(a, b)
+
+// Registered-site measurement: the name is resolved once per call site, so it must not
+// change between calls (use PERF_MEASURE_SCOPE for names built at runtime)
+#define PERF_MEASURE_STATIC_SCOPE(name) \
+    static const perf::PerfMonitor::SiteHandle PERF_CONCAT(__perf_site__, __LINE__) = \
+        perf::PerfMonitor::getInstance().registerSite(name); \
+    perf::PerfMonitor::SiteTimer PERF_CONCAT(__perf_timer__, __LINE__)(PERF_CONCAT(__perf_site__, __LINE__))
+
+// Define PERF_MONITOR_STATIC_SITES to route every PERF_MEASURE_SCOPE through registered sites
+#ifdef PERF_MONITOR_STATIC_SITES
+#define PERF_MEASURE_SCOPE(name) PERF_MEASURE_STATIC_SCOPE(name)
+#else
 #define PERF_MEASURE_SCOPE(name) \
     perf::PerfMonitor::ScopedTimer __perf_timer__(name)
+#endif
 
+// __FUNCTION__ is constant per call site, so function scopes always use registered sites
 #define PERF_MEASURE_FUNCTION() \
-    perf::PerfMonitor::ScopedTimer __perf_timer__(__FUNCTION__)
+    PERF_MEASURE_STATIC_SCOPE(__FUNCTION__)
 
 #define PERF_START(name) \
     perf::PerfMonitor::getInstance().startMeasurement(name)
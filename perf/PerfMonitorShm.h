@@ -0,0 +1,126 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Shared-memory layout for real-time metrics.
+//
+// The monitored process maps a fixed-size POSIX shared memory segment ("/perfmonitor_<pid>")
+// and its monitoring thread publishes per-function counters and latency histograms into it.
+// Readers such as perfmon-top map it read-only; every entry is protected by a seqlock, so a
+// reader retries instead of blocking the writer and costs the monitored process nothing.
+namespace perf {
+namespace shm {
+
+constexpr uint32_t kMagic = 0x50524d4f;  // "PRMO"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kMaxEntries = 256;
+constexpr size_t kNameLength = 64;
+constexpr const char* kNamePrefix = "/perfmonitor_";
+
+// All fields are atomics so concurrent access across processes is well defined;
+// lock-free atomics of these sizes are address-free and valid in shared memory
+struct Entry {
+    std::atomic<uint32_t> mSequence;  // Odd while the writer updates the entry
+    std::atomic<uint32_t> mActive;    // Non-zero once the slot is in use
+    std::atomic<uint64_t> mNameWords[kNameLength / sizeof(uint64_t)];
+    std::atomic<uint64_t> mCallCount;
+    std::atomic<uint64_t> mTotalNs;
+    std::atomic<uint64_t> mMinNs;
+    std::atomic<uint64_t> mMaxNs;
+    std::atomic<uint64_t> mHistogram[histogram::kBucketCount];  // Nanoseconds
+};
+
+struct Segment {
+    uint32_t mMagic;
+    uint32_t mVersion;
+    uint32_t mProcessId;
+    uint32_t mEntryCapacity;
+    uint64_t mIntervalMs;
+    std::atomic<uint64_t> mPublishCount;      // Completed publish passes
+    std::atomic<uint64_t> mPublishedAtNs;     // steady_clock time of the last pass
+    std::atomic<uint32_t> mEntryCount;        // Slots in use, in registration order
+    std::atomic<uint32_t> mOverflowCount;     // Functions that did not fit into the segment
+    Entry mEntries[kMaxEntries];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared segment requires lock-free 64-bit atomics");
+
+// Plain copy of one entry as seen by a reader
+struct EntrySnapshot {
+    std::string mName;
+    uint64_t mCallCount = 0;
+    uint64_t mTotalNs = 0;
+    uint64_t mMinNs = 0;
+    uint64_t mMaxNs = 0;
+    LatencyHistogram mHistogram;
+};
+
+inline std::string segmentName(uint32_t processId) {
+    return kNamePrefix + std::to_string(processId);
+}
+
+// Writer side; only the monitoring thread of the owning process calls this
+inline void writeEntry(Entry& entry, const char* name, uint64_t callCount, uint64_t totalNs,
+                       uint64_t minNs, uint64_t maxNs, const LatencyHistogram& histogram) {
+    uint32_t sequence = entry.mSequence.load(std::memory_order_relaxed);
+    entry.mSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (name) {
+        uint64_t words[kNameLength / sizeof(uint64_t)] = {};
+        std::strncpy(reinterpret_cast<char*>(words), name, kNameLength - 1);
+        for (size_t i = 0; i < kNameLength / sizeof(uint64_t); ++i) {
+            entry.mNameWords[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+    entry.mCallCount.store(callCount, std::memory_order_relaxed);
+    entry.mTotalNs.store(totalNs, std::memory_order_relaxed);
+    entry.mMinNs.store(minNs, std::memory_order_relaxed);
+    entry.mMaxNs.store(maxNs, std::memory_order_relaxed);
+    for (size_t i = 0; i < histogram::kBucketCount; ++i) {
+        entry.mHistogram[i].store(histogram.mCounts[i], std::memory_order_relaxed);
+    }
+
+    entry.mSequence.store(sequence + 2, std::memory_order_release);
+}
+
+// Reader side; returns false if the entry kept changing while being read
+inline bool readEntry(const Entry& entry, EntrySnapshot& snapshot, int maxAttempts = 64) {
+    for (int attempt = 0; attempt < maxAttempts; ++attempt) {
+        uint32_t before = entry.mSequence.load(std::memory_order_acquire);
+        if (before & 1u) {
+            continue;
+        }
+
+        uint64_t words[kNameLength / sizeof(uint64_t)];
+        for (size_t i = 0; i < kNameLength / sizeof(uint64_t); ++i) {
+            words[i] = entry.mNameWords[i].load(std::memory_order_relaxed);
+        }
+        snapshot.mCallCount = entry.mCallCount.load(std::memory_order_relaxed);
+        snapshot.mTotalNs = entry.mTotalNs.load(std::memory_order_relaxed);
+        snapshot.mMinNs = entry.mMinNs.load(std::memory_order_relaxed);
+        snapshot.mMaxNs = entry.mMaxNs.load(std::memory_order_relaxed);
+        snapshot.mHistogram.mTotalCount = 0;
+        for (size_t i = 0; i < histogram::kBucketCount; ++i) {
+            snapshot.mHistogram.mCounts[i] = entry.mHistogram[i].load(std::memory_order_relaxed);
+            snapshot.mHistogram.mTotalCount += snapshot.mHistogram.mCounts[i];
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.mSequence.load(std::memory_order_relaxed) == before) {
+            const char* name = reinterpret_cast<const char*>(words);
+            snapshot.mName.assign(name, strnlen(name, kNameLength));
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace shm
+}  // namespace perf
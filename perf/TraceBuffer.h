@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace perf {
+
+// One completed scope in raw tick units; begin and end are recorded together so a
+// dropped event never leaves an unmatched begin in the trace
+struct TraceEvent {
+    uint64_t mStartTicks;
+    uint64_t mEndTicks;
+    uint32_t mNameId;
+};
+
+// Single-producer/single-consumer ring of trace events.
+//
+// The owning thread appends; the exporter drains under the registry mutex. When the ring
+// is full new events are dropped and counted, so recording never blocks or allocates.
+class TraceRing {
+public:
+    TraceRing(size_t capacity, uint64_t generation, int32_t threadId, std::string threadName)
+        : mGeneration(generation), mThreadId(threadId), mThreadName(std::move(threadName)) {
+        size_t rounded = 64;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        mCapacity = rounded;
+        mEvents.reset(new TraceEvent[mCapacity]);
+    }
+
+    // Writer: the owning thread
+    bool push(const TraceEvent& event) {
+        uint64_t head = mHead.load(std::memory_order_relaxed);
+        if (head - mTail.load(std::memory_order_acquire) >= mCapacity) {
+            mDropped.store(mDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        mEvents[head & (mCapacity - 1)] = event;
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Reader: hands every published event to the visitor and frees the slots
+    template <typename Visitor>
+    void drain(Visitor&& visitor) {
+        uint64_t tail = mTail.load(std::memory_order_relaxed);
+        uint64_t head = mHead.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            visitor(mEvents[tail & (mCapacity - 1)]);
+        }
+        mTail.store(tail, std::memory_order_release);
+    }
+
+    uint64_t recordedCount() const { return mHead.load(std::memory_order_relaxed); }
+    uint64_t droppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+    size_t capacity() const { return mCapacity; }
+
+    const uint64_t mGeneration;    // Tracing session the ring belongs to
+    const int32_t mThreadId;
+    const std::string mThreadName;
+    std::atomic<bool> mAbandoned{false};  // Set once the writer will never touch the ring again
+
+private:
+    size_t mCapacity;
+    std::unique_ptr<TraceEvent[]> mEvents;
+
+    alignas(64) std::atomic<uint64_t> mHead{0};
+    std::atomic<uint64_t> mDropped{0};
+    alignas(64) std::atomic<uint64_t> mTail{0};
+};
+
+}  // namespace perf
@@ -0,0 +1,216 @@
+#include "TraceExport.h"
+
+// Standard library headers
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <vector>
+
+// System headers
+#include <time.h>
+
+namespace perf {
+
+namespace {
+
+// Scopes complete inner-first; order them by start so nesting reads top-down
+std::vector<TraceSlice> sortedSlices(const TraceThread& thread) {
+    std::vector<TraceSlice> slices = thread.mSlices;
+    std::sort(slices.begin(), slices.end(), [](const TraceSlice& a, const TraceSlice& b) {
+        return a.mStartNs != b.mStartNs ? a.mStartNs < b.mStartNs : a.mEndNs > b.mEndNs;
+    });
+    return slices;
+}
+
+void writeJsonString(std::ostream& out, const std::string& value) {
+    out << '"';
+    for (char c : value) {
+        switch (c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out << escaped;
+            } else {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
+
+// Minimal protobuf encoder for the handful of Perfetto fields we emit
+class ProtoMessage {
+public:
+    void varint(uint32_t field, uint64_t value) {
+        writeVarint((static_cast<uint64_t>(field) << 3) | 0);
+        writeVarint(value);
+    }
+
+    void bytes(uint32_t field, const std::string& value) {
+        writeVarint((static_cast<uint64_t>(field) << 3) | 2);
+        writeVarint(value.size());
+        mBuffer += value;
+    }
+
+    void message(uint32_t field, const ProtoMessage& value) {
+        bytes(field, value.mBuffer);
+    }
+
+    const std::string& data() const { return mBuffer; }
+
+private:
+    void writeVarint(uint64_t value) {
+        while (value >= 0x80) {
+            mBuffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        mBuffer.push_back(static_cast<char>(value));
+    }
+
+    std::string mBuffer;
+};
+
+// Field numbers from perfetto/trace/trace_packet.proto and track_event/*.proto
+namespace field {
+constexpr uint32_t kTracePacket = 1;             // Trace.packet
+constexpr uint32_t kTimestamp = 8;               // TracePacket.timestamp
+constexpr uint32_t kSequenceId = 10;             // TracePacket.trusted_packet_sequence_id
+constexpr uint32_t kTrackEvent = 11;             // TracePacket.track_event
+constexpr uint32_t kSequenceFlags = 13;          // TracePacket.sequence_flags
+constexpr uint32_t kTrackDescriptor = 60;        // TracePacket.track_descriptor
+constexpr uint32_t kTrackUuid = 1;               // TrackDescriptor.uuid
+constexpr uint32_t kTrackProcess = 3;            // TrackDescriptor.process
+constexpr uint32_t kTrackThread = 4;             // TrackDescriptor.thread
+constexpr uint32_t kTrackParentUuid = 5;         // TrackDescriptor.parent_uuid
+constexpr uint32_t kProcessPid = 1;              // ProcessDescriptor.pid
+constexpr uint32_t kProcessName = 6;             // ProcessDescriptor.process_name
+constexpr uint32_t kThreadPid = 1;               // ThreadDescriptor.pid
+constexpr uint32_t kThreadTid = 2;               // ThreadDescriptor.tid
+constexpr uint32_t kThreadName = 5;              // ThreadDescriptor.thread_name
+constexpr uint32_t kEventType = 9;               // TrackEvent.type
+constexpr uint32_t kEventTrackUuid = 11;         // TrackEvent.track_uuid
+constexpr uint32_t kEventName = 23;              // TrackEvent.name
+}  // namespace field
+
+constexpr uint64_t kSliceBegin = 1;
+constexpr uint64_t kSliceEnd = 2;
+constexpr uint64_t kIncrementalStateCleared = 1;
+constexpr uint64_t kSequenceId = 1;
+
+void writePacket(std::ostream& out, const ProtoMessage& packet) {
+    ProtoMessage trace;
+    trace.message(field::kTracePacket, packet);
+    out.write(trace.data().data(), static_cast<std::streamsize>(trace.data().size()));
+}
+
+// Perfetto's default trace clock is CLOCK_BOOTTIME; shift monotonic timestamps onto it
+int64_t boottimeOffsetNs() {
+    timespec monotonic{};
+    timespec boottime{};
+    clock_gettime(CLOCK_MONOTONIC, &monotonic);
+    clock_gettime(CLOCK_BOOTTIME, &boottime);
+    return (static_cast<int64_t>(boottime.tv_sec) - monotonic.tv_sec) * 1000000000LL +
+           (static_cast<int64_t>(boottime.tv_nsec) - monotonic.tv_nsec);
+}
+
+}  // namespace
+
+void writeChromeJsonTrace(std::ostream& out, const TraceCapture& capture) {
+    out << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":\"" << capture.mDroppedEvents
+        << "\"},\"traceEvents\":[\n";
+
+    out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << capture.mProcessId
+        << ",\"tid\":" << capture.mProcessId << ",\"args\":{\"name\":";
+    writeJsonString(out, capture.mProcessName);
+    out << "}}";
+
+    out << std::fixed << std::setprecision(3);
+    for (const auto& thread : capture.mThreads) {
+        out << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << capture.mProcessId
+            << ",\"tid\":" << thread.mThreadId << ",\"args\":{\"name\":";
+        writeJsonString(out, thread.mThreadName);
+        out << "}}";
+
+        for (const auto& slice : sortedSlices(thread)) {
+            out << ",\n{\"ph\":\"X\",\"cat\":\"perf\",\"name\":";
+            writeJsonString(out, capture.mNames[slice.mNameId]);
+            out << ",\"pid\":" << capture.mProcessId << ",\"tid\":" << thread.mThreadId
+                << ",\"ts\":" << static_cast<double>(slice.mStartNs) / 1000.0
+                << ",\"dur\":" << static_cast<double>(slice.mEndNs - slice.mStartNs) / 1000.0 << "}";
+        }
+    }
+
+    out << "\n]}\n";
+}
+
+void writePerfettoTrace(std::ostream& out, const TraceCapture& capture) {
+    int64_t offsetNs = boottimeOffsetNs();
+    uint64_t processUuid = static_cast<uint64_t>(capture.mProcessId);
+
+    ProtoMessage process;
+    process.varint(field::kProcessPid, static_cast<uint64_t>(capture.mProcessId));
+    process.bytes(field::kProcessName, capture.mProcessName);
+    ProtoMessage processTrack;
+    processTrack.varint(field::kTrackUuid, processUuid);
+    processTrack.message(field::kTrackProcess, process);
+    ProtoMessage processPacket;
+    processPacket.varint(field::kSequenceId, kSequenceId);
+    processPacket.varint(field::kSequenceFlags, kIncrementalStateCleared);
+    processPacket.message(field::kTrackDescriptor, processTrack);
+    writePacket(out, processPacket);
+
+    for (const auto& thread : capture.mThreads) {
+        uint64_t threadUuid = (processUuid << 32) | static_cast<uint32_t>(thread.mThreadId);
+
+        ProtoMessage descriptor;
+        descriptor.varint(field::kThreadPid, static_cast<uint64_t>(capture.mProcessId));
+        descriptor.varint(field::kThreadTid, static_cast<uint64_t>(thread.mThreadId));
+        descriptor.bytes(field::kThreadName, thread.mThreadName);
+        ProtoMessage threadTrack;
+        threadTrack.varint(field::kTrackUuid, threadUuid);
+        threadTrack.varint(field::kTrackParentUuid, processUuid);
+        threadTrack.message(field::kTrackThread, descriptor);
+        ProtoMessage threadPacket;
+        threadPacket.varint(field::kSequenceId, kSequenceId);
+        threadPacket.message(field::kTrackDescriptor, threadTrack);
+        writePacket(out, threadPacket);
+
+        auto writeEvent = [&](uint64_t timestampNs, uint64_t type, const std::string* name) {
+            ProtoMessage event;
+            event.varint(field::kEventType, type);
+            event.varint(field::kEventTrackUuid, threadUuid);
+            if (name) {
+                event.bytes(field::kEventName, *name);
+            }
+            ProtoMessage packet;
+            packet.varint(field::kTimestamp, static_cast<uint64_t>(static_cast<int64_t>(timestampNs) + offsetNs));
+            packet.varint(field::kSequenceId, kSequenceId);
+            packet.message(field::kTrackEvent, event);
+            writePacket(out, packet);
+        };
+
+        // Slices on a track must nest; ends of manual measurements that overlap their
+        // parent are clamped to the parent's end
+        std::vector<uint64_t> openEnds;
+        for (const auto& slice : sortedSlices(thread)) {
+            while (!openEnds.empty() && openEnds.back() <= slice.mStartNs) {
+                writeEvent(openEnds.back(), kSliceEnd, nullptr);
+                openEnds.pop_back();
+            }
+            uint64_t endNs = openEnds.empty() ? slice.mEndNs : std::min(slice.mEndNs, openEnds.back());
+            writeEvent(slice.mStartNs, kSliceBegin, &capture.mNames[slice.mNameId]);
+            openEnds.push_back(endNs);
+        }
+        while (!openEnds.empty()) {
+            writeEvent(openEnds.back(), kSliceEnd, nullptr);
+            openEnds.pop_back();
+        }
+    }
+}
+
+}  // namespace perf
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace perf {
+
+// Trace data converted to nanoseconds on CLOCK_MONOTONIC, ready to be serialized
+struct TraceSlice {
+    uint64_t mStartNs;
+    uint64_t mEndNs;
+    uint32_t mNameId;
+};
+
+struct TraceThread {
+    int32_t mThreadId = 0;
+    std::string mThreadName;
+    std::vector<TraceSlice> mSlices;
+};
+
+struct TraceCapture {
+    int32_t mProcessId = 0;
+    std::string mProcessName;
+    std::vector<std::string> mNames;  // Indexed by TraceSlice::mNameId
+    std::vector<TraceThread> mThreads;
+    uint64_t mDroppedEvents = 0;
+};
+
+// Chrome trace event format (JSON), loadable in chrome://tracing and ui.perfetto.dev
+void writeChromeJsonTrace(std::ostream& out, const TraceCapture& capture);
+
+// Perfetto protobuf trace (TracePacket/TrackEvent) with one track per thread
+void writePerfettoTrace(std::ostream& out, const TraceCapture& capture);
+
+}  // namespace perf
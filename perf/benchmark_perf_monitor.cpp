@@ -0,0 +1,135 @@
+#include "PerfMonitor.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace perf;
+
+// Measures the per-scope overhead of the measurement paths. Each loop body is an empty
+// scope, so the cost reported is the cost of the instrumentation itself.
+
+namespace {
+
+constexpr int kIterations = 2000000;
+constexpr double kTargetNsPerScope = 30.0;
+
+// Keeps the loop from being optimized away without adding measurable work
+volatile uint64_t gSink = 0;
+
+double nsPerIteration(std::chrono::steady_clock::time_point start, int iterations) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+double runBaseline() {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        gSink = gSink + 1;
+    }
+    return nsPerIteration(start, kIterations);
+}
+
+// Two back-to-back clock reads, the floor of any scope measurement on this machine
+double runClockReads() {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        PerfMonitor::SiteTimer timer(PerfMonitor::SiteHandle{std::numeric_limits<uint32_t>::max()});
+        gSink = gSink + 1;
+    }
+    return nsPerIteration(start, kIterations);
+}
+
+double runScopedTimer() {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        PerfMonitor::ScopedTimer timer("benchmark_scoped_timer");
+        gSink = gSink + 1;
+    }
+    return nsPerIteration(start, kIterations);
+}
+
+double runStaticScope() {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        PERF_MEASURE_STATIC_SCOPE("benchmark_static_scope");
+        gSink = gSink + 1;
+    }
+    return nsPerIteration(start, kIterations);
+}
+
+// Same static scope hammered from several threads at once
+double runStaticScopeContended(int threadCount) {
+    std::vector<std::thread> threads;
+    std::vector<double> results(threadCount);
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&results, t]() { results[t] = runStaticScope(); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double worst = 0.0;
+    for (double result : results) {
+        worst = std::max(worst, result);
+    }
+    return worst;
+}
+
+void printRow(const std::string& name, double nsPerScope) {
+    std::cout << std::left << std::setw(40) << name << std::right << std::setw(10) << std::fixed
+              << std::setprecision(1) << nsPerScope << " ns/scope\n";
+}
+
+}  // namespace
+
+int main() {
+    std::cout << "=== PerfMonitor Overhead Benchmark ===\n";
+    std::cout << "Iterations per run: " << kIterations << "\n\n";
+
+    auto& monitor = PerfMonitor::getInstance();
+    monitor.reset();
+
+    // Warm up registration, shard allocation and caches
+    runStaticScope();
+    runScopedTimer();
+
+    double baseline = runBaseline();
+    double scoped = runScopedTimer() - baseline;
+    double staticScope = runStaticScope() - baseline;
+    double clockReads = runClockReads() - baseline;
+
+    printRow("Tick counter reads (2 per scope)", clockReads);
+    printRow("ScopedTimer (string key, mutex)", scoped);
+    printRow("PERF_MEASURE_STATIC_SCOPE", staticScope);
+
+    // Shards are per thread, so the cost should not grow with concurrent writers
+    int threadCount = static_cast<int>(std::min(4u, std::thread::hardware_concurrency()));
+    if (threadCount >= 2) {
+        double contended = runStaticScopeContended(threadCount) - baseline;
+        printRow("PERF_MEASURE_STATIC_SCOPE x" + std::to_string(threadCount) + " threads", contended);
+    }
+
+    bool targetMet = staticScope < kTargetNsPerScope;
+    std::cout << "\nStatic scope target (< " << kTargetNsPerScope << " ns): " << (targetMet ? "MET" : "MISSED")
+              << " (bookkeeping beyond clock reads: " << std::setprecision(1) << (staticScope - clockReads)
+              << " ns)\n";
+
+    // Hardware counters add two group read() syscalls per scope
+    if (monitor.enableHardwareCounters(true)) {
+        runStaticScope();
+        printRow("PERF_MEASURE_STATIC_SCOPE + hw counters", runStaticScope() - baseline);
+        monitor.enableHardwareCounters(false);
+    } else {
+        std::cout << "Hardware counters: " << monitor.getHardwareCounterStatus() << "\n";
+    }
+    std::cout << "\n";
+
+    std::cout << monitor.generateReport();
+    return 0;
+}
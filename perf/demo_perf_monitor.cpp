@@ -279,7 +279,8 @@ void demonstrateRealTimeMonitoring() {
 
     monitor.startRealTimeMonitoring(std::chrono::milliseconds(2000));
 
-    std::cout << "Real-time monitoring started. Running workload...\n";
+    std::cout << "Real-time monitoring started (" << monitor.getRealTimeMonitoringFilePath()
+              << ", view with perfmon-top). Running workload...\n";
 
     // Run some work while monitoring
     DataProcessor processor;
@@ -312,6 +313,14 @@ void generateFinalReport() {
     std::cout << "  - demo_performance_report.csv\n";
     std::cout << "  - demo_performance_report.json\n";
 
+    // Export the event trace captured since startTracing() in main()
+    auto traceStats = monitor.getTraceStats();
+    monitor.stopTracing();
+    if (monitor.writeTrace("demo_trace.json", PerfMonitor::TraceFormat::ChromeJson)) {
+        std::cout << "  - demo_trace.json (" << traceStats.recordedEvents << " events, "
+                  << traceStats.droppedEvents << " dropped, " << traceStats.threadCount << " threads)\n";
+    }
+
     // Show memory and custom metrics
     // auto memory_history = monitor.getMemoryHistory(); // Note: not available
     // Note: Memory usage and custom metrics functionality not available in current API
@@ -323,6 +332,9 @@ int main() {
     std::cout << "in a realistic application scenario.\n";
 
     try {
+        // Record every scope for a timeline view (load demo_trace.json in ui.perfetto.dev)
+        PerfMonitor::getInstance().startTracing();
+
         // Run all demonstrations
         demonstrateBasicUsage();
         demonstrateClassUsage();
@@ -0,0 +1,242 @@
+#include "PerfMonitorShm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// perfmon-top: live view of a process's PerfMonitor shared-memory metrics.
+//
+// Attaches read-only to /dev/shm/perfmonitor_<pid>, which the process publishes while
+// real-time monitoring runs with MonitoringSink::SharedMemory, and renders per-function
+// rates and latency percentiles over each refresh interval.
+
+using namespace perf;
+
+namespace {
+
+std::atomic<bool> gRunning{true};
+
+void handleSignal(int) {
+    gRunning.store(false);
+}
+
+void printUsage(const char* program) {
+    std::printf("Usage: %s [options] [pid]\n", program);
+    std::printf("  -i <ms>   Refresh interval (default: 1000)\n");
+    std::printf("  -n <num>  Number of refreshes, 0 = until interrupted (default: 0)\n");
+    std::printf("  -b        Batch mode: no screen clearing, suitable for logging\n");
+    std::printf("  -h        Show this help\n");
+    std::printf("Without a pid the only running monitored process is used.\n");
+}
+
+// Find monitored processes through their segments in /dev/shm
+std::vector<uint32_t> findSegments() {
+    std::vector<uint32_t> pids;
+    DIR* dir = opendir("/dev/shm");
+    if (!dir) {
+        return pids;
+    }
+    const char* prefix = shm::kNamePrefix + 1;  // Without the leading '/'
+    size_t prefixLength = std::strlen(prefix);
+    while (dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, prefix, prefixLength) == 0) {
+            pids.push_back(static_cast<uint32_t>(std::strtoul(entry->d_name + prefixLength, nullptr, 10)));
+        }
+    }
+    closedir(dir);
+    return pids;
+}
+
+const shm::Segment* attachSegment(uint32_t pid) {
+    std::string name = shm::segmentName(pid);
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        perror(("perfmon-top: shm_open " + name).c_str());
+        return nullptr;
+    }
+    void* mapping = mmap(nullptr, sizeof(shm::Segment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        perror("perfmon-top: mmap");
+        return nullptr;
+    }
+
+    auto* segment = static_cast<const shm::Segment*>(mapping);
+    if (segment->mMagic != shm::kMagic || segment->mVersion != shm::kVersion) {
+        std::fprintf(stderr, "perfmon-top: %s is not a compatible PerfMonitor segment\n", name.c_str());
+        munmap(mapping, sizeof(shm::Segment));
+        return nullptr;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return segment;
+}
+
+struct Row {
+    shm::EntrySnapshot mCurrent;
+    uint64_t mIntervalCalls = 0;
+    uint64_t mIntervalNs = 0;
+    LatencyHistogram mIntervalHistogram;
+};
+
+double toMs(uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+void render(const shm::Segment& segment, std::vector<Row>& rows, double elapsedSec, bool batch) {
+    // Busiest functions of the last interval first, then by lifetime total
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        if (a.mIntervalNs != b.mIntervalNs) {
+            return a.mIntervalNs > b.mIntervalNs;
+        }
+        return a.mCurrent.mTotalNs > b.mCurrent.mTotalNs;
+    });
+
+    if (!batch) {
+        std::printf("\033[H\033[2J");
+    }
+
+    auto nowNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    uint64_t publishedNs = segment.mPublishedAtNs.load(std::memory_order_relaxed);
+    double ageSec = nowNs > publishedNs ? static_cast<double>(nowNs - publishedNs) / 1e9 : 0.0;
+
+    std::printf("perfmon-top - pid %u, %u functions, publish interval %llu ms, last update %.1f s ago",
+                segment.mProcessId, segment.mEntryCount.load(std::memory_order_relaxed),
+                static_cast<unsigned long long>(segment.mIntervalMs), ageSec);
+    uint32_t overflow = segment.mOverflowCount.load(std::memory_order_relaxed);
+    if (overflow) {
+        std::printf(", %u not shown (segment full)", overflow);
+    }
+    std::printf("\n\n%-40s %10s %10s %10s %10s %10s %10s %12s\n", "Function", "Calls", "Calls/s", "Avg (ms)",
+                "P50 (ms)", "P99 (ms)", "Max (ms)", "Total (ms)");
+
+    for (const auto& row : rows) {
+        const auto& current = row.mCurrent;
+        if (current.mCallCount == 0) {
+            continue;
+        }
+        // Interval statistics when the function ran since the last refresh, lifetime otherwise
+        const LatencyHistogram& histogram = row.mIntervalCalls ? row.mIntervalHistogram : current.mHistogram;
+        double avgMs = row.mIntervalCalls ? toMs(row.mIntervalNs) / static_cast<double>(row.mIntervalCalls)
+                                          : toMs(current.mTotalNs) / static_cast<double>(current.mCallCount);
+        double p50Ms = std::min(toMs(histogram.valueAtQuantile(0.50)), toMs(current.mMaxNs));
+        double p99Ms = std::min(toMs(histogram.valueAtQuantile(0.99)), toMs(current.mMaxNs));
+        double rate = elapsedSec > 0.0 ? static_cast<double>(row.mIntervalCalls) / elapsedSec : 0.0;
+
+        std::printf("%-40.40s %10llu %10.1f %10.3f %10.3f %10.3f %10.3f %12.1f\n", current.mName.c_str(),
+                    static_cast<unsigned long long>(current.mCallCount), rate, avgMs, p50Ms, p99Ms,
+                    toMs(current.mMaxNs), toMs(current.mTotalNs));
+    }
+    std::fflush(stdout);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int intervalMs = 1000;
+    long iterations = 0;
+    bool batch = false;
+    uint32_t pid = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-i" && i + 1 < argc) {
+            intervalMs = std::max(50, std::atoi(argv[++i]));
+        } else if (arg == "-n" && i + 1 < argc) {
+            iterations = std::atol(argv[++i]);
+        } else if (arg == "-b") {
+            batch = true;
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] != '-') {
+            pid = static_cast<uint32_t>(std::strtoul(arg.c_str(), nullptr, 10));
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (pid == 0) {
+        auto pids = findSegments();
+        if (pids.size() != 1) {
+            std::fprintf(stderr, pids.empty() ? "perfmon-top: no monitored process found\n"
+                                              : "perfmon-top: several monitored processes, pick one:\n");
+            for (uint32_t candidate : pids) {
+                std::fprintf(stderr, "  %u\n", candidate);
+            }
+            return 1;
+        }
+        pid = pids.front();
+    }
+
+    const shm::Segment* segment = attachSegment(pid);
+    if (!segment) {
+        return 1;
+    }
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    std::unordered_map<std::string, shm::EntrySnapshot> previous;
+    auto previousTime = std::chrono::steady_clock::now();
+    long frame = 0;
+
+    while (gRunning.load()) {
+        auto now = std::chrono::steady_clock::now();
+        double elapsedSec = std::chrono::duration<double>(now - previousTime).count();
+        previousTime = now;
+
+        std::vector<Row> rows;
+        uint32_t count = std::min<uint32_t>(segment->mEntryCount.load(std::memory_order_acquire),
+                                            segment->mEntryCapacity);
+        for (uint32_t i = 0; i < count; ++i) {
+            Row row;
+            if (!shm::readEntry(segment->mEntries[i], row.mCurrent) || row.mCurrent.mName.empty()) {
+                continue;
+            }
+
+            // Counters restart after a reset in the monitored process; treat it as a new baseline
+            auto it = previous.find(row.mCurrent.mName);
+            if (it != previous.end() && frame > 0 && row.mCurrent.mCallCount >= it->second.mCallCount) {
+                row.mIntervalCalls = row.mCurrent.mCallCount - it->second.mCallCount;
+                row.mIntervalNs = row.mCurrent.mTotalNs - it->second.mTotalNs;
+                row.mIntervalHistogram = row.mCurrent.mHistogram;
+                row.mIntervalHistogram.subtract(it->second.mHistogram);
+            }
+            previous[row.mCurrent.mName] = row.mCurrent;
+            rows.push_back(std::move(row));
+        }
+
+        render(*segment, rows, frame > 0 ? elapsedSec : 0.0, batch);
+
+        if (kill(static_cast<pid_t>(pid), 0) != 0) {
+            std::printf("\nProcess %u exited.\n", pid);
+            break;
+        }
+        if (++frame == iterations) {
+            break;
+        }
+        if (batch) {
+            std::printf("\n");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+    }
+
+    munmap(const_cast<shm::Segment*>(segment), sizeof(shm::Segment));
+    return 0;
+}
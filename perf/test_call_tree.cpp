@@ -0,0 +1,203 @@
+#include "CallTree.h"
+#include "PerfMonitor.h"
+#include "test_check.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace perf;
+
+namespace {
+
+constexpr uint32_t kOuter = 1;
+constexpr uint32_t kInner = 2;
+
+// Node index of a path of name ids below the root, or size() when absent
+size_t findPath(const CallTreeTotals& tree, std::initializer_list<uint32_t> path) {
+    size_t index = 0;
+    for (uint32_t nameId : path) {
+        auto it = tree.mNodes[index].mChildren.find(nameId);
+        if (it == tree.mNodes[index].mChildren.end()) {
+            return tree.mNodes.size();
+        }
+        index = it->second;
+    }
+    return index;
+}
+
+void testInclusiveExclusive() {
+    std::cout << "\n--- Inclusive and exclusive time ---" << std::endl;
+
+    CallTree thread;
+    thread.enter(kOuter, 0);
+    thread.enter(kInner, 10);
+    thread.exit(kInner, 30);
+    thread.enter(kInner, 40);
+    thread.exit(kInner, 45);
+    thread.exit(kOuter, 100);
+
+    CallTreeTotals tree;
+    tree.merge(thread);
+    size_t outer = findPath(tree, {kOuter});
+    size_t inner = findPath(tree, {kOuter, kInner});
+    check(outer < tree.mNodes.size() && inner < tree.mNodes.size(), "nested scopes become a parent and a child node");
+    if (outer >= tree.mNodes.size() || inner >= tree.mNodes.size()) {
+        return;
+    }
+    check(tree.mNodes[outer].mCalls == 1 && tree.mNodes[outer].mInclusiveTicks == 100,
+          "the parent's inclusive time spans the whole scope");
+    check(tree.exclusiveTicks(outer) == 75, "the parent's exclusive time leaves out its children");
+    check(tree.mNodes[inner].mCalls == 2 && tree.mNodes[inner].mInclusiveTicks == 25 && tree.exclusiveTicks(inner) == 25,
+          "repeated calls of a child accumulate on one node");
+}
+
+void testReentrant() {
+    std::cout << "\n--- Re-entrant scopes ---" << std::endl;
+
+    // Recursion: the same name nested in itself gets its own node per depth
+    CallTree thread;
+    thread.enter(kOuter, 0);
+    thread.enter(kOuter, 10);
+    thread.exit(kOuter, 40);
+    thread.exit(kOuter, 100);
+
+    CallTreeTotals tree;
+    tree.merge(thread);
+    size_t outer = findPath(tree, {kOuter});
+    size_t nested = findPath(tree, {kOuter, kOuter});
+    check(nested < tree.mNodes.size(), "a recursive call nests under its caller");
+    if (nested >= tree.mNodes.size()) {
+        return;
+    }
+    check(tree.mNodes[outer].mInclusiveTicks == 100 && tree.exclusiveTicks(outer) == 70,
+          "the outer call's exclusive time leaves out the recursion");
+    check(tree.mNodes[nested].mInclusiveTicks == 30, "the inner end closes the innermost open call");
+
+    // Manual start/end may close a scope while a later one is still open
+    CallTree overlapping;
+    overlapping.enter(kOuter, 0);
+    overlapping.enter(kInner, 10);
+    overlapping.exit(kOuter, 50);
+    overlapping.exit(kInner, 70);
+
+    CallTreeTotals overlapTree;
+    overlapTree.merge(overlapping);
+    outer = findPath(overlapTree, {kOuter});
+    size_t inner = findPath(overlapTree, {kOuter, kInner});
+    check(inner < overlapTree.mNodes.size() && overlapTree.mNodes[inner].mInclusiveTicks == 60,
+          "a scope outliving its parent keeps the path it was opened on");
+    check(overlapTree.mNodes[outer].mInclusiveTicks == 50 && overlapTree.exclusiveTicks(outer) == 50,
+          "a child still open when its parent ends is not charged to the parent");
+}
+
+void testTwoThreads() {
+    std::cout << "\n--- Same name on two threads ---" << std::endl;
+
+    CallTree first;
+    CallTree second;
+    first.enter(kOuter, 0);
+    second.enter(kOuter, 5);
+    second.enter(kInner, 6);
+    first.exit(kOuter, 20);
+    second.exit(kInner, 16);
+    second.exit(kOuter, 35);
+
+    CallTreeTotals tree;
+    tree.merge(first);
+    tree.merge(second);
+    size_t outer = findPath(tree, {kOuter});
+    size_t inner = findPath(tree, {kOuter, kInner});
+    check(tree.mNodes[0].mChildren.size() == 1 && outer < tree.mNodes.size(),
+          "the same path on two threads merges into one node");
+    check(tree.mNodes[outer].mCalls == 2 && tree.mNodes[outer].mInclusiveTicks == 50 && tree.exclusiveTicks(outer) == 40,
+          "calls and times of both threads add up");
+    check(inner < tree.mNodes.size() && tree.mNodes[inner].mCalls == 1, "a child seen on one thread only is kept");
+
+    CallTreeTotals combined;
+    combined.merge(tree);
+    combined.merge(tree);
+    check(combined.mNodes[findPath(combined, {kOuter})].mInclusiveTicks == 100,
+          "merging totals adds them by path");
+}
+
+void testCollapsedStacks() {
+    std::cout << "\n--- Collapsed stacks ---" << std::endl;
+
+    auto& monitor = PerfMonitor::getInstance();
+    monitor.reset();
+    monitor.enableCallTree(true);
+
+    auto work = []() {
+        for (int i = 0; i < 2; ++i) {
+            PERF_MEASURE_SCOPE("tree::outer");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            {
+                PERF_MEASURE_STATIC_SCOPE("tree::inner;odd");
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+        PERF_START("tree::recurse");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        PERF_START("tree::recurse");
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        PERF_END("tree::recurse");
+        PERF_END("tree::recurse");
+    };
+    std::thread worker(work);
+    work();
+    worker.join();
+    monitor.enableCallTree(false);
+
+    std::string path = "/tmp/perf_call_tree_test_" + std::to_string(getpid()) + ".folded";
+    check(monitor.writeCollapsedStacks(path), "collapsed stacks written");
+
+    std::map<std::string, uint64_t> weights;
+    bool wellFormed = true;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        auto space = line.rfind(' ');
+        if (space == std::string::npos || space + 1 == line.size()) {
+            wellFormed = false;
+            continue;
+        }
+        weights[line.substr(0, space)] += std::stoull(line.substr(space + 1));
+        std::cout << "    " << line << std::endl;
+    }
+    std::remove(path.c_str());
+
+    check(wellFormed && weights.size() == 4, "one \"frames weight\" line per path");
+    check(weights.count("tree::outer;tree::inner:odd") == 1, "frames are joined with ';' and ';' in names is replaced");
+
+    // Two threads x two calls; weights are exclusive microseconds
+    uint64_t outer = weights["tree::outer"];
+    uint64_t inner = weights["tree::outer;tree::inner:odd"];
+    check(inner >= 20000, "child weight is its time on both threads");
+    check(outer >= 8000 && outer < inner, "parent weight excludes its child");
+    check(weights["tree::recurse"] >= 2000 && weights["tree::recurse;tree::recurse"] >= 6000 &&
+              weights["tree::recurse"] < weights["tree::recurse;tree::recurse"],
+          "re-entrant start/end pairs nest and split their time");
+
+    monitor.reset();
+}
+
+}  // namespace
+
+int main() {
+    std::cout << "=== Call Tree Tests ===" << std::endl;
+
+    testInclusiveExclusive();
+    testReentrant();
+    testTwoThreads();
+    testCollapsedStacks();
+
+    std::cout << "\n" << (gFailures == 0 ? "All tests passed" : std::to_string(gFailures) + " check(s) failed")
+              << std::endl;
+    return gFailures == 0 ? 0 : 1;
+}
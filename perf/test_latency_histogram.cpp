@@ -0,0 +1,159 @@
+#include "LatencyHistogram.h"
+#include "PerfMonitor.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <thread>
+
+using namespace perf;
+
+namespace {
+
+void testBucketBounds() {
+    std::cout << "\n--- Bucket bounds ---" << std::endl;
+
+    bool contained = true;
+    bool monotonic = true;
+    size_t previous = 0;
+    for (uint64_t value = 0; value < (1u << 20); ++value) {
+        size_t index = histogram::bucketIndex(value);
+        if (histogram::bucketLowerBound(index) > value || histogram::bucketLowerBound(index + 1) <= value) {
+            contained = false;
+        }
+        if (index < previous) {
+            monotonic = false;
+        }
+        previous = index;
+    }
+    check(contained, "every value lies within [lower bound, next lower bound) of its bucket");
+    check(monotonic, "bucket index never decreases with the value");
+
+    bool exact = true;
+    for (uint64_t value = 0; value < histogram::kSubBucketCount; ++value) {
+        exact = exact && histogram::bucketMidpoint(histogram::bucketIndex(value)) == value;
+    }
+    check(exact, "values below 16 have a bucket each");
+
+    check(histogram::bucketIndex((2ull << histogram::kMaxExponent) - 1) == histogram::kBucketCount - 1,
+          "the largest exponent ends in the last bucket");
+    check(histogram::bucketIndex(UINT64_MAX) == histogram::kBucketCount - 1, "huge values share the last bucket");
+}
+
+void testQuantileError() {
+    std::cout << "\n--- Quantile error ---" << std::endl;
+
+    // Log-uniform latencies from 1 us to 1 s, the range the monitor sees in practice
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> exponent(3.0, 9.0);
+    std::vector<uint64_t> values(100000);
+    LatencyHistogram histogram;
+    for (auto& value : values) {
+        value = static_cast<uint64_t>(std::pow(10.0, exponent(rng)));
+        histogram.record(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    check(histogram.mTotalCount == values.size(), "total count matches the recorded values");
+    double worst = 0.0;
+    for (double q : {0.01, 0.1, 0.5, 0.9, 0.99, 0.999}) {
+        uint64_t exact = values[static_cast<size_t>(q * static_cast<double>(values.size())) - 1];
+        double error = std::abs(static_cast<double>(histogram.valueAtQuantile(q)) - static_cast<double>(exact)) /
+                       static_cast<double>(exact);
+        worst = std::max(worst, error);
+    }
+    std::cout << "    Worst relative quantile error: " << worst << std::endl;
+    check(worst <= 1.0 / histogram::kSubBucketCount, "quantiles are within 1/16 of the exact value");
+    check(LatencyHistogram().valueAtQuantile(0.5) == 0, "an empty histogram reports 0");
+}
+
+void testMergeSubtract() {
+    std::cout << "\n--- Merge and subtract ---" << std::endl;
+
+    LatencyHistogram earlier;
+    LatencyHistogram later;
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        earlier.record(value * 1000);
+        later.record(value * 7000, 2);
+    }
+
+    LatencyHistogram cumulative = earlier;
+    cumulative.merge(later);
+    check(cumulative.mTotalCount == 3000, "merge adds the total counts");
+
+    LatencyHistogram window = cumulative;
+    window.subtract(earlier);
+    check(window.mCounts == later.mCounts && window.mTotalCount == later.mTotalCount,
+          "subtracting the earlier snapshot leaves the later recordings");
+
+    // A snapshot taken before a reset holds more than the current histogram
+    LatencyHistogram shrunk = earlier;
+    shrunk.subtract(cumulative);
+    check(shrunk.mTotalCount == 0, "subtract clamps buckets at zero");
+}
+
+void measure(PerfMonitor& monitor, const std::string& name, std::chrono::milliseconds duration, int calls) {
+    for (int i = 0; i < calls; ++i) {
+        monitor.startMeasurement(name);
+        std::this_thread::sleep_for(duration);
+        monitor.endMeasurement(name);
+    }
+}
+
+// Span printed in the "Latency Percentiles (last X s of a Y s window)" header
+double reportedSpan(const std::string& report) {
+    auto pos = report.find("Latency Percentiles (last ");
+    if (pos == std::string::npos) {
+        return -1.0;
+    }
+    return std::stod(report.substr(pos + std::string("Latency Percentiles (last ").size()));
+}
+
+void testWindowedPercentiles() {
+    std::cout << "\n--- Windowed percentiles ---" << std::endl;
+
+    auto& monitor = PerfMonitor::getInstance();
+    monitor.reset();
+    monitor.setPercentileWindow(std::chrono::seconds(1));
+
+    measure(monitor, "window", std::chrono::milliseconds(1), 20);
+    double youngSpan = reportedSpan(monitor.generateReport());
+    std::cout << "    Span while younger than the window: " << youngSpan << " s" << std::endl;
+    check(youngSpan >= 0.0 && youngSpan < 1.0, "the report shows the shorter span covered so far");
+
+    // Without any report or query in between, the window moves past the fast calls
+    std::this_thread::sleep_for(std::chrono::milliseconds(1300));
+    measure(monitor, "window", std::chrono::milliseconds(5), 20);
+
+    auto lifetime = monitor.getPercentiles("window");
+    auto recent = monitor.getWindowPercentiles("window");
+    std::cout << "    Lifetime: " << lifetime.sampleCount << " calls, p50 " << lifetime.p50Ms
+              << " ms; window: " << recent.sampleCount << " calls, p50 " << recent.p50Ms << " ms" << std::endl;
+    check(lifetime.sampleCount == 40, "lifetime percentiles cover every call");
+    check(recent.sampleCount == 20, "window percentiles only cover the recent calls");
+    check(recent.p50Ms >= 4.5, "window p50 reflects the recent slow calls");
+
+    double span = reportedSpan(monitor.generateReport());
+    std::cout << "    Span once the window is full: " << span << " s" << std::endl;
+    check(span >= 1.0 && span < 1.3, "the report shows a span between one window and one window plus a snapshot");
+
+    monitor.reset();
+}
+
+}  // namespace
+
+int main() {
+    std::cout << "=== LatencyHistogram Tests ===" << std::endl;
+
+    testBucketBounds();
+    testQuantileError();
+    testMergeSubtract();
+    testWindowedPercentiles();
+
+    std::cout << "\n" << (gFailures == 0 ? "All tests passed" : std::to_string(gFailures) + " check(s) failed")
+              << std::endl;
+    return gFailures == 0 ? 0 : 1;
+}
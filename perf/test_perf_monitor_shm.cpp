@@ -0,0 +1,188 @@
+#include "PerfMonitor.h"
+#include "PerfMonitorShm.h"
+#include "test_check.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace perf;
+
+namespace {
+
+// Every field of generation g is derived from g, so a mix of two writes is detectable
+void writeGeneration(shm::Entry& entry, uint64_t generation, LatencyHistogram& histogram) {
+    histogram.mCounts.fill(generation);
+    histogram.mTotalCount = generation * histogram::kBucketCount;
+    std::string name = "function_" + std::to_string(generation) + std::string(generation % 40, 'x');
+    shm::writeEntry(entry, name.c_str(), generation, generation * 1000, generation, generation * 2, histogram);
+}
+
+bool isConsistent(const shm::EntrySnapshot& snapshot) {
+    uint64_t generation = snapshot.mCallCount;
+    if (snapshot.mTotalNs != generation * 1000 || snapshot.mMinNs != generation ||
+        snapshot.mMaxNs != generation * 2 || snapshot.mHistogram.mTotalCount != generation * histogram::kBucketCount) {
+        return false;
+    }
+    for (uint64_t count : snapshot.mHistogram.mCounts) {
+        if (count != generation) {
+            return false;
+        }
+    }
+    return snapshot.mName == "function_" + std::to_string(generation) + std::string(generation % 40, 'x');
+}
+
+void testRoundTrip() {
+    std::cout << "\n--- Entry round trip ---" << std::endl;
+
+    auto entry = std::make_unique<shm::Entry>();
+    shm::EntrySnapshot snapshot;
+    check(shm::readEntry(*entry, snapshot) && snapshot.mName.empty() && snapshot.mCallCount == 0,
+          "a zeroed entry reads as empty");
+
+    LatencyHistogram histogram;
+    histogram.record(0);
+    histogram.record(1500, 3);
+    histogram.record(2000000000, 2);
+    histogram.record(UINT64_MAX);
+    shm::writeEntry(*entry, "Service::handle", 6, 4000003000, 0, UINT64_MAX, histogram);
+
+    check(shm::readEntry(*entry, snapshot, 1), "a quiescent entry reads on the first attempt");
+    check(snapshot.mName == "Service::handle", "name round-trips");
+    check(snapshot.mCallCount == 6 && snapshot.mTotalNs == 4000003000 && snapshot.mMinNs == 0 &&
+              snapshot.mMaxNs == UINT64_MAX,
+          "counters round-trip");
+    check(snapshot.mHistogram.mCounts == histogram.mCounts && snapshot.mHistogram.mTotalCount == 7,
+          "histogram buckets and their total round-trip");
+
+    // Later writes without a name keep the published one
+    shm::writeEntry(*entry, nullptr, 7, 1, 1, 1, histogram);
+    check(shm::readEntry(*entry, snapshot) && snapshot.mName == "Service::handle" && snapshot.mCallCount == 7,
+          "updates without a name keep the published name");
+
+    std::string longName(100, 'L');
+    shm::writeEntry(*entry, longName.c_str(), 1, 1, 1, 1, histogram);
+    check(shm::readEntry(*entry, snapshot) && snapshot.mName == longName.substr(0, shm::kNameLength - 1),
+          "long names are truncated to the slot and stay terminated");
+
+    check(entry->mSequence.load() % 2 == 0, "the sequence is even between writes");
+}
+
+void testConcurrentReaders() {
+    std::cout << "\n--- Seqlock stress ---" << std::endl;
+
+    auto entry = std::make_unique<shm::Entry>();
+    LatencyHistogram histogram;
+    writeGeneration(*entry, 1, histogram);
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> written{0};
+    std::thread writer([&]() {
+        LatencyHistogram scratch;
+        for (uint64_t generation = 2; running.load(std::memory_order_relaxed); ++generation) {
+            writeGeneration(*entry, generation, scratch);
+            written.store(generation, std::memory_order_relaxed);
+        }
+    });
+
+    uint64_t reads = 0;
+    uint64_t retriesExhausted = 0;
+    uint64_t torn = 0;
+    uint64_t lastGeneration = 0;
+    bool monotonic = true;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+    shm::EntrySnapshot snapshot;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (!shm::readEntry(*entry, snapshot)) {
+            ++retriesExhausted;
+            continue;
+        }
+        ++reads;
+        if (!isConsistent(snapshot)) {
+            ++torn;
+        }
+        monotonic = monotonic && snapshot.mCallCount >= lastGeneration;
+        lastGeneration = snapshot.mCallCount;
+    }
+    running.store(false);
+    writer.join();
+
+    std::cout << "    Writes: " << written.load() << ", reads: " << reads << ", gave up: " << retriesExhausted
+              << ", torn: " << torn << std::endl;
+    check(written.load() > 1000 && reads > 1000, "writer and reader both made progress");
+    check(torn == 0, "a reader never returns a mix of two writes");
+    check(monotonic, "readers never see an older write after a newer one");
+}
+
+void testPublishedSegment() {
+    std::cout << "\n--- Published segment ---" << std::endl;
+
+    auto& monitor = PerfMonitor::getInstance();
+    monitor.reset();
+    for (int i = 0; i < 5; ++i) {
+        monitor.startMeasurement("shm::published");
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        monitor.endMeasurement("shm::published");
+    }
+
+    monitor.startRealTimeMonitoring(std::chrono::milliseconds(20), PerfMonitor::MonitoringSink::SharedMemory);
+    if (monitor.getRealTimeMonitoringFilePath().rfind("/dev/shm/", 0) != 0) {
+        std::cout << "    Shared memory unavailable, skipping" << std::endl;
+        monitor.stopRealTimeMonitoring();
+        return;
+    }
+
+    int fd = shm_open(shm::segmentName(static_cast<uint32_t>(getpid())).c_str(), O_RDONLY, 0);
+    void* mapping = fd >= 0 ? mmap(nullptr, sizeof(shm::Segment), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if (fd >= 0) {
+        close(fd);
+    }
+    check(mapping != MAP_FAILED, "the segment maps read-only like perfmon-top does");
+    if (mapping == MAP_FAILED) {
+        monitor.stopRealTimeMonitoring();
+        return;
+    }
+    const auto& segment = *static_cast<const shm::Segment*>(mapping);
+    check(segment.mMagic == shm::kMagic && segment.mVersion == shm::kVersion &&
+              segment.mProcessId == static_cast<uint32_t>(getpid()),
+          "the header identifies the process and layout");
+
+    bool found = false;
+    shm::EntrySnapshot snapshot;
+    for (uint32_t i = 0; i < segment.mEntryCount.load(std::memory_order_acquire); ++i) {
+        if (shm::readEntry(segment.mEntries[i], snapshot) && snapshot.mName == "shm::published") {
+            found = true;
+            break;
+        }
+    }
+    check(found, "the measured function is published under its name");
+    check(snapshot.mCallCount == 5 && snapshot.mHistogram.mTotalCount == 5, "calls and histogram samples are published");
+    check(snapshot.mMinNs >= 2000000 && snapshot.mMaxNs >= snapshot.mMinNs && snapshot.mTotalNs >= 5 * snapshot.mMinNs,
+          "durations are published in nanoseconds");
+    uint64_t p50 = snapshot.mHistogram.valueAtQuantile(0.5);
+    check(p50 >= 1800000 && p50 < 50000000, "the histogram is published in nanoseconds");
+
+    munmap(mapping, sizeof(shm::Segment));
+    monitor.stopRealTimeMonitoring();
+    monitor.reset();
+}
+
+}  // namespace
+
+int main() {
+    std::cout << "=== Shared-Memory Metrics Tests ===" << std::endl;
+
+    testRoundTrip();
+    testConcurrentReaders();
+    testPublishedSegment();
+
+    std::cout << "\n" << (gFailures == 0 ? "All tests passed" : std::to_string(gFailures) + " check(s) failed")
+              << std::endl;
+    return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,313 @@
+#include "PerfMonitor.h"
+#include "TraceBuffer.h"
+#include "TraceExport.h"
+#include "test_check.h"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <unistd.h>
+
+using namespace perf;
+
+namespace {
+
+// Protobuf wire format reader for the varint and length-delimited fields the exporter emits
+struct ProtoField {
+    uint32_t mNumber = 0;
+    uint64_t mVarint = 0;
+    std::string mBytes;
+    bool mIsBytes = false;
+};
+
+bool readVarint(const std::string& data, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(data[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns false on anything but well-formed varint / length-delimited fields
+bool parseMessage(const std::string& data, std::vector<ProtoField>& fields) {
+    size_t pos = 0;
+    while (pos < data.size()) {
+        uint64_t key = 0;
+        if (!readVarint(data, pos, key)) {
+            return false;
+        }
+        ProtoField field;
+        field.mNumber = static_cast<uint32_t>(key >> 3);
+        if ((key & 7) == 0) {
+            if (!readVarint(data, pos, field.mVarint)) {
+                return false;
+            }
+        } else if ((key & 7) == 2) {
+            uint64_t length = 0;
+            if (!readVarint(data, pos, length) || length > data.size() - pos) {
+                return false;
+            }
+            field.mBytes = data.substr(pos, length);
+            field.mIsBytes = true;
+            pos += length;
+        } else {
+            return false;
+        }
+        fields.push_back(std::move(field));
+    }
+    return true;
+}
+
+const ProtoField* findField(const std::vector<ProtoField>& fields, uint32_t number) {
+    for (const auto& field : fields) {
+        if (field.mNumber == number) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+// Flattened Perfetto trace: descriptors and slice events in file order
+struct DecodedTrace {
+    bool mValid = true;
+    std::string mProcessName;
+    std::map<uint64_t, std::string> mThreadNames;  // Track uuid -> thread name
+    struct Event {
+        uint64_t mTimestamp;
+        uint64_t mType;
+        uint64_t mTrack;
+        std::string mName;
+    };
+    std::vector<Event> mEvents;
+};
+
+DecodedTrace decodePerfetto(const std::string& data) {
+    DecodedTrace trace;
+    std::vector<ProtoField> packets;
+    if (!parseMessage(data, packets)) {
+        trace.mValid = false;
+        return trace;
+    }
+
+    for (const auto& packetField : packets) {
+        std::vector<ProtoField> packet;
+        if (packetField.mNumber != 1 || !packetField.mIsBytes || !parseMessage(packetField.mBytes, packet)) {
+            trace.mValid = false;
+            continue;
+        }
+
+        if (const ProtoField* track = findField(packet, 60)) {
+            std::vector<ProtoField> descriptor;
+            parseMessage(track->mBytes, descriptor);
+            const ProtoField* uuid = findField(descriptor, 1);
+            if (const ProtoField* process = findField(descriptor, 3)) {
+                std::vector<ProtoField> fields;
+                parseMessage(process->mBytes, fields);
+                trace.mProcessName = findField(fields, 6) ? findField(fields, 6)->mBytes : "";
+            } else if (const ProtoField* thread = findField(descriptor, 4)) {
+                std::vector<ProtoField> fields;
+                parseMessage(thread->mBytes, fields);
+                trace.mThreadNames[uuid ? uuid->mVarint : 0] = findField(fields, 5) ? findField(fields, 5)->mBytes : "";
+            }
+        } else if (const ProtoField* trackEvent = findField(packet, 11)) {
+            std::vector<ProtoField> event;
+            parseMessage(trackEvent->mBytes, event);
+            const ProtoField* timestamp = findField(packet, 8);
+            const ProtoField* type = findField(event, 9);
+            const ProtoField* trackUuid = findField(event, 11);
+            const ProtoField* name = findField(event, 23);
+            if (!timestamp || !type || !trackUuid) {
+                trace.mValid = false;
+                continue;
+            }
+            trace.mEvents.push_back({timestamp->mVarint, type->mVarint, trackUuid->mVarint, name ? name->mBytes : ""});
+        }
+    }
+    return trace;
+}
+
+size_t countOccurrences(const std::string& text, const std::string& pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+void testTraceRing() {
+    std::cout << "\n--- Trace ring ---" << std::endl;
+
+    TraceRing ring(50, 1, 42, "ring");
+    check(ring.capacity() == 64, "capacity rounds up to a power of two, at least 64");
+
+    size_t accepted = 0;
+    for (uint32_t i = 0; i < 100; ++i) {
+        accepted += ring.push(TraceEvent{i * 10, i * 10 + 5, i}) ? 1 : 0;
+    }
+    check(accepted == 64 && ring.recordedCount() == 64, "a full ring accepts exactly its capacity");
+    check(ring.droppedCount() == 36, "events pushed into a full ring are counted as dropped");
+
+    std::vector<TraceEvent> drained;
+    ring.drain([&](const TraceEvent& event) { drained.push_back(event); });
+    bool ordered = drained.size() == 64;
+    for (size_t i = 0; ordered && i < drained.size(); ++i) {
+        ordered = drained[i].mNameId == i && drained[i].mStartTicks == i * 10 && drained[i].mEndTicks == i * 10 + 5;
+    }
+    check(ordered, "drain hands out the accepted events in push order");
+
+    check(ring.push(TraceEvent{1000, 1001, 7}), "draining frees the slots for new events");
+    drained.clear();
+    ring.drain([&](const TraceEvent& event) { drained.push_back(event); });
+    check(drained.size() == 1 && drained[0].mNameId == 7, "events pushed after a drain wrap around the ring");
+    check(ring.recordedCount() == 65 && ring.droppedCount() == 36, "counters survive draining");
+}
+
+TraceCapture sampleCapture() {
+    TraceCapture capture;
+    capture.mProcessId = 1234;
+    capture.mProcessName = "trace \"test\"";
+    capture.mNames = {"outer", "inner\nline", std::string(200, 'n')};
+    capture.mDroppedEvents = 3;
+
+    // Timestamps above 2^35 need five or more varint bytes; slices arrive inner-first
+    TraceThread thread;
+    thread.mThreadId = 77;
+    thread.mThreadName = "worker";
+    const uint64_t base = 50000000000ull;
+    thread.mSlices = {
+        {base + 1000, base + 2000, 1},
+        {base + 2500, base + 4500, 2},  // Overlaps the end of "outer" and is clamped in Perfetto
+        {base, base + 4000, 0},
+    };
+    capture.mThreads.push_back(thread);
+    return capture;
+}
+
+void testChromeJson() {
+    std::cout << "\n--- Chrome JSON ---" << std::endl;
+
+    std::ostringstream out;
+    writeChromeJsonTrace(out, sampleCapture());
+    std::string json = out.str();
+
+    check(json.find("\"droppedEvents\":\"3\"") != std::string::npos, "dropped events are recorded in otherData");
+    check(json.find("\"name\":\"trace \\\"test\\\"\"") != std::string::npos, "quotes in names are escaped");
+    check(json.find("\"name\":\"inner\\nline\"") != std::string::npos, "newlines in names are escaped");
+    check(countOccurrences(json, "\"ph\":\"X\"") == 3, "every slice becomes a complete event");
+    check(json.find("\"ts\":50000000.000,\"dur\":4.000") != std::string::npos,
+          "timestamps and durations are microseconds");
+    check(json.find("\"name\":\"outer\"") < json.find("\"name\":\"inner\\nline\""),
+          "slices are ordered by start time");
+    check(json.size() > 2 && json.compare(json.size() - 3, 3, "]}\n") == 0, "the event array is closed");
+}
+
+void testPerfettoEncoding() {
+    std::cout << "\n--- Perfetto encoding ---" << std::endl;
+
+    std::ostringstream out;
+    writePerfettoTrace(out, sampleCapture());
+    DecodedTrace trace = decodePerfetto(out.str());
+
+    check(trace.mValid, "every packet decodes as varint and length-delimited fields");
+    check(trace.mProcessName == "trace \"test\"", "process descriptor carries the process name");
+    uint64_t threadUuid = (1234ull << 32) | 77;
+    check(trace.mThreadNames.size() == 1 && trace.mThreadNames[threadUuid] == "worker",
+          "thread descriptor carries the thread name on its own track");
+
+    bool typesMatch = trace.mEvents.size() == 6;
+    const uint64_t expectedTypes[] = {1, 1, 2, 1, 2, 2};
+    for (size_t i = 0; typesMatch && i < trace.mEvents.size(); ++i) {
+        typesMatch = trace.mEvents[i].mType == expectedTypes[i] && trace.mEvents[i].mTrack == threadUuid;
+    }
+    check(typesMatch, "slices become nested begin/end events on the thread track");
+    if (!typesMatch) {
+        return;
+    }
+
+    // The boot-time offset is shared by all events, so only differences are compared
+    uint64_t origin = trace.mEvents[0].mTimestamp;
+    check(trace.mEvents[0].mName == "outer" && trace.mEvents[1].mName == "inner\nline" &&
+              trace.mEvents[3].mName == std::string(200, 'n'),
+          "begin events carry names, including ones longer than a one-byte length");
+    check(trace.mEvents[1].mTimestamp - origin == 1000 && trace.mEvents[2].mTimestamp - origin == 2000,
+          "multi-byte timestamps round-trip");
+    check(trace.mEvents[4].mTimestamp - origin == 4000 && trace.mEvents[5].mTimestamp - origin == 4000,
+          "a slice overlapping its parent's end is clamped to it");
+}
+
+void testRecordedTrace() {
+    std::cout << "\n--- Recorded trace ---" << std::endl;
+
+    auto& monitor = PerfMonitor::getInstance();
+    monitor.startTracing(64);
+
+    auto record = [](int scopes) {
+        std::thread worker([scopes]() {
+            pthread_setname_np(pthread_self(), "trace-worker");
+            for (int i = 0; i < scopes; ++i) {
+                PERF_MEASURE_STATIC_SCOPE("trace::scope");
+            }
+        });
+        worker.join();
+    };
+
+    record(100);
+    auto stats = monitor.getTraceStats();
+    std::cout << "    Recorded " << stats.recordedEvents << ", dropped " << stats.droppedEvents << std::endl;
+    check(stats.bufferCapacity == 64 && stats.recordedEvents == 64 && stats.droppedEvents == 36,
+          "a thread overflowing its buffer keeps the first events and counts the rest");
+
+    std::string path = "/tmp/perf_trace_test_" + std::to_string(getpid());
+    check(monitor.writeTrace(path + ".json"), "Chrome JSON trace written");
+    std::string json = readFile(path + ".json");
+    check(countOccurrences(json, "\"name\":\"trace::scope\"") == 64, "the JSON trace holds every recorded event");
+    check(json.find("\"droppedEvents\":\"36\"") != std::string::npos, "the JSON trace reports the dropped events");
+    check(json.find("\"name\":\"trace-worker\"") != std::string::npos, "the JSON trace names the recording thread");
+
+    record(10);
+    check(monitor.writeTrace(path + ".pftrace", PerfMonitor::TraceFormat::PerfettoProto), "Perfetto trace written");
+    DecodedTrace trace = decodePerfetto(readFile(path + ".pftrace"));
+    size_t begins = 0;
+    size_t ends = 0;
+    for (const auto& event : trace.mEvents) {
+        begins += event.mType == 1 && event.mName == "trace::scope";
+        ends += event.mType == 2;
+    }
+    check(trace.mValid && begins == 10 && ends == 10, "the next capture only holds events recorded since the last one");
+
+    monitor.stopTracing();
+    std::remove((path + ".json").c_str());
+    std::remove((path + ".pftrace").c_str());
+}
+
+}  // namespace
+
+int main() {
+    std::cout << "=== Trace Export Tests ===" << std::endl;
+
+    testTraceRing();
+    testChromeJson();
+    testPerfettoEncoding();
+    testRecordedTrace();
+
+    std::cout << "\n" << (gFailures == 0 ? "All tests passed" : std::to_string(gFailures) + " check(s) failed")
+              << std::endl;
+    return gFailures == 0 ? 0 : 1;
+}
@@ -1,7 +1,7 @@
 #include "AudioStreamer.h"
+#include <algorithm>
 #include <iostream>
 #include <cstdio>
-#include <queue>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -9,16 +9,680 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+#ifdef HAVE_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Chunk {
+    std::vector<short> samples;
+    AudioChunkInfo info;
+};
+
+Clock::duration framesToDuration(uint64_t frames, int sampleRate) {
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(frames) / sampleRate));
+}
+
+// --------------------- Capture Sources ---------------------
+// A source captures one chunk per read(), straight into the chunk's own buffer
+class CaptureSource {
+public:
+    CaptureSource() {
+        mWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+
+    virtual ~CaptureSource() {
+        if (mWakeFd >= 0) {
+            ::close(mWakeFd);
+        }
+    }
+
+    // Open the device or file; chunkSizeMs, sampleRate and channels are requests that
+    // the source may adjust (see getSampleRate() etc.)
+    virtual bool open(size_t chunkSizeMs, int sampleRate, int channels) = 0;
+    virtual void close() = 0;
+
+    // Blocks until a chunk is captured; false at the end of the stream, on an error
+    // or after interrupt()
+    virtual bool read(Chunk& chunk) = 0;
+
+    // Wake a blocked read() (any thread); read() fails until the next open()
+    void interrupt() {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(mWakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    int getSampleRate() const { return mSampleRate; }
+    int getChannels() const { return mChannels; }
+    size_t getChunkFrames() const { return mChunkFrames; }
+    uint64_t getOverruns() const { return mOverruns; }
+
+protected:
+    int mWakeFd = -1;
+    int mSampleRate = 0;
+    int mChannels = 0;
+    size_t mChunkFrames = 0;
+    uint64_t mPosition = 0;  // Frames delivered since open()
+    std::atomic<uint64_t> mOverruns{0};
+
+    void clearWake() {
+        uint64_t count;
+        while (::read(mWakeFd, &count, sizeof(count)) > 0) {
+        }
+    }
+
+    bool woken(const pollfd& wake) const { return (wake.revents & POLLIN) != 0; }
+};
+
+// arecord child process; chunks are read from the pipe straight into the chunk buffer
+class ArecordSource : public CaptureSource {
+public:
+    ~ArecordSource() override { close(); }
+
+    bool open(size_t chunkSizeMs, int sampleRate, int channels) override {
+        close();
+        clearWake();
+        mSampleRate = sampleRate;
+        mChannels = channels;
+        mChunkFrames = sampleRate * chunkSizeMs / 1000;
+        mPosition = 0;
+
+        std::string cmd = "arecord -q -f S16_LE -c" + std::to_string(channels) + " -r" + std::to_string(sampleRate) +
+                          " -t raw";
+        mPipe = popen(cmd.c_str(), "r");
+        if (!mPipe) {
+            std::cerr << "Failed to start arecord\n";
+            return false;
+        }
+        return true;
+    }
+
+    void close() override {
+        if (mPipe) {
+            pclose(mPipe);
+            mPipe = nullptr;
+        }
+    }
+
+    bool read(Chunk& chunk) override {
+        int fd = fileno(mPipe);
+        chunk.samples.resize(mChunkFrames * mChannels);
+        char* out = reinterpret_cast<char*>(chunk.samples.data());
+        const size_t bytes = chunk.samples.size() * sizeof(short);
+
+        size_t filled = 0;
+        while (filled < bytes) {
+            pollfd fds[2] = {{fd, POLLIN, 0}, {mWakeFd, POLLIN, 0}};
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            if (woken(fds[1])) {
+                return false;
+            }
+            ssize_t got = ::read(fd, out + filled, bytes - filled);
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                // Command terminated or encountered an error
+                std::cerr << "Audio capture command terminated unexpectedly\n";
+                return false;
+            }
+            filled += static_cast<size_t>(got);
+        }
+
+        // The pipe carries no timing; the last sample arrived just now
+        chunk.info.timestamp = Clock::now() - framesToDuration(mChunkFrames, mSampleRate);
+        chunk.info.framePosition = mPosition;
+        chunk.info.hardwareTimestamp = false;
+        mPosition += mChunkFrames;
+        return true;
+    }
+
+private:
+    FILE* mPipe = nullptr;
+};
+
+// 16-bit PCM WAV file delivered in chunks, paced at the sample rate or as fast as consumed
+class WavReplaySource : public CaptureSource {
+public:
+    WavReplaySource(const std::string& path, bool realtime) : mPath(path), mRealtime(realtime) {}
+
+    ~WavReplaySource() override { close(); }
+
+    bool open(size_t chunkSizeMs, int, int) override {
+        close();
+        clearWake();
+        mFd = ::open(mPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (mFd < 0) {
+            std::cerr << "Failed to open " << mPath << ": " << std::strerror(errno) << "\n";
+            return false;
+        }
+        if (!parseHeader()) {
+            std::cerr << mPath << " is not a 16-bit PCM WAV file\n";
+            close();
+            return false;
+        }
+        mChunkFrames = std::max<size_t>(1, mSampleRate * chunkSizeMs / 1000);
+        mPosition = 0;
+        mStart = Clock::now();
+        return true;
+    }
+
+    void close() override {
+        if (mFd >= 0) {
+            ::close(mFd);
+            mFd = -1;
+        }
+    }
+
+    bool read(Chunk& chunk) override {
+        const size_t frameBytes = static_cast<size_t>(mChannels) * sizeof(short);
+        const uint64_t totalFrames = mDataBytes / frameBytes;
+        if (mPosition >= totalFrames) {
+            return false;
+        }
+        size_t frames = static_cast<size_t>(std::min<uint64_t>(mChunkFrames, totalFrames - mPosition));
+
+        chunk.info.timestamp = mStart + framesToDuration(mPosition, mSampleRate);
+        chunk.info.framePosition = mPosition;
+        chunk.info.hardwareTimestamp = false;
+        if (mRealtime && !waitUntil(mStart + framesToDuration(mPosition + frames, mSampleRate))) {
+            return false;
+        }
+
+        chunk.samples.resize(frames * mChannels);
+        char* out = reinterpret_cast<char*>(chunk.samples.data());
+        size_t bytes = frames * frameBytes;
+        size_t filled = 0;
+        while (filled < bytes) {
+            ssize_t got = ::pread(mFd, out + filled, bytes - filled,
+                                  static_cast<off_t>(mDataOffset + mPosition * frameBytes + filled));
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                return false;
+            }
+            filled += static_cast<size_t>(got);
+        }
+        mPosition += frames;
+        return true;
+    }
+
+private:
+    std::string mPath;
+    bool mRealtime;
+    int mFd = -1;
+    uint64_t mDataOffset = 0;
+    uint64_t mDataBytes = 0;
+    Clock::time_point mStart;
+
+    static uint32_t le32(const unsigned char* p) {
+        return p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    // Walk the RIFF chunks for "fmt " and "data"
+    bool parseHeader() {
+        unsigned char riff[12];
+        if (::pread(mFd, riff, sizeof(riff), 0) != sizeof(riff) || std::memcmp(riff, "RIFF", 4) != 0 ||
+            std::memcmp(riff + 8, "WAVE", 4) != 0) {
+            return false;
+        }
+        bool haveFormat = false;
+        uint64_t offset = sizeof(riff);
+        unsigned char header[8];
+        while (::pread(mFd, header, sizeof(header), static_cast<off_t>(offset)) == sizeof(header)) {
+            uint32_t size = le32(header + 4);
+            offset += sizeof(header);
+            if (std::memcmp(header, "fmt ", 4) == 0 && size >= 16) {
+                unsigned char fmt[16];
+                if (::pread(mFd, fmt, sizeof(fmt), static_cast<off_t>(offset)) != sizeof(fmt)) {
+                    return false;
+                }
+                int format = fmt[0] | fmt[1] << 8;
+                mChannels = fmt[2] | fmt[3] << 8;
+                mSampleRate = static_cast<int>(le32(fmt + 4));
+                int bits = fmt[14] | fmt[15] << 8;
+                haveFormat = (format == 1 || format == 0xfffe) && bits == 16 && mChannels > 0 && mSampleRate > 0;
+            } else if (std::memcmp(header, "data", 4) == 0) {
+                mDataOffset = offset;
+                mDataBytes = size;
+                off_t end = ::lseek(mFd, 0, SEEK_END);
+                if (end >= 0 && mDataOffset + mDataBytes > static_cast<uint64_t>(end)) {
+                    mDataBytes = static_cast<uint64_t>(end) - mDataOffset;  // Truncated recording
+                }
+                return haveFormat;
+            }
+            offset += size + (size & 1);
+        }
+        return false;
+    }
+
+    // Sleep until the chunk would have been captured; false if interrupted
+    bool waitUntil(Clock::time_point deadline) {
+        while (true) {
+            auto left = deadline - Clock::now();
+            if (left <= Clock::duration::zero()) {
+                return true;
+            }
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+            timespec timeout{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+            pollfd wake{mWakeFd, POLLIN, 0};
+            int ret = ppoll(&wake, 1, &timeout, nullptr);
+            if (ret > 0 && woken(wake)) {
+                return false;
+            }
+        }
+    }
+};
+
+#ifdef HAVE_ALSA
+// ALSA PCM in mmap mode: each period is copied once, from the DMA ring buffer into the
+// chunk, and stamped with the driver's monotonic timestamp
+class AlsaSource : public CaptureSource {
+public:
+    AlsaSource(const std::string& device, int periods) : mDevice(device), mPeriods(periods) {}
+
+    ~AlsaSource() override { close(); }
+
+    bool open(size_t chunkSizeMs, int sampleRate, int channels) override {
+        close();
+        clearWake();
+        int err = snd_pcm_open(&mPcm, mDevice.c_str(), SND_PCM_STREAM_CAPTURE, 0);
+        if (err < 0) {
+            mPcm = nullptr;
+            return fail("open " + mDevice, err);
+        }
+        if (!configure(chunkSizeMs, sampleRate, channels)) {
+            close();
+            return false;
+        }
+
+        int count = snd_pcm_poll_descriptors_count(mPcm);
+        mPollFds.resize(static_cast<size_t>(std::max(count, 0)) + 1);
+        snd_pcm_poll_descriptors(mPcm, mPollFds.data(), static_cast<unsigned>(count));
+        mPollFds.back() = {mWakeFd, POLLIN, 0};
+
+        mPosition = 0;
+        if ((err = snd_pcm_start(mPcm)) < 0) {
+            close();
+            return fail("start", err);
+        }
+        return true;
+    }
+
+    void close() override {
+        if (mPcm) {
+            snd_pcm_close(mPcm);
+            mPcm = nullptr;
+        }
+    }
+
+    bool read(Chunk& chunk) override {
+        chunk.samples.resize(mChunkFrames * mChannels);
+        while (true) {
+            snd_pcm_sframes_t avail = snd_pcm_avail_update(mPcm);
+            if (avail < 0) {
+                if (!recover(static_cast<int>(avail))) {
+                    return false;
+                }
+                continue;
+            }
+            if (static_cast<size_t>(avail) < mChunkFrames) {
+                if (!waitForPeriod()) {
+                    return false;
+                }
+                continue;
+            }
+
+            // avail frames were in the buffer at tstamp; the oldest one starts this chunk
+            snd_pcm_uframes_t stampAvail = 0;
+            snd_htimestamp_t tstamp{};
+            bool stamped = snd_pcm_htimestamp(mPcm, &stampAvail, &tstamp) == 0 && (tstamp.tv_sec || tstamp.tv_nsec);
+
+            int err = copyPeriod(chunk.samples.data());
+            if (err < 0) {
+                if (!recover(err)) {
+                    return false;
+                }
+                continue;  // The ring was overrun; capture the next period instead
+            }
+
+            if (stamped) {
+                auto captured = std::chrono::seconds(tstamp.tv_sec) + std::chrono::nanoseconds(tstamp.tv_nsec);
+                chunk.info.timestamp = Clock::time_point(std::chrono::duration_cast<Clock::duration>(captured)) -
+                                       framesToDuration(stampAvail, mSampleRate);
+            } else {
+                chunk.info.timestamp = Clock::now() - framesToDuration(static_cast<uint64_t>(avail), mSampleRate);
+            }
+            chunk.info.framePosition = mPosition;
+            chunk.info.hardwareTimestamp = stamped;
+            mPosition += mChunkFrames;
+            return true;
+        }
+    }
+
+private:
+    std::string mDevice;
+    int mPeriods;
+    snd_pcm_t* mPcm = nullptr;
+    std::vector<pollfd> mPollFds;  // PCM descriptors, then the wake-up eventfd
+
+    bool fail(const std::string& what, int err) {
+        std::cerr << "ALSA " << what << ": " << snd_strerror(err) << "\n";
+        return false;
+    }
+
+    bool configure(size_t chunkSizeMs, int sampleRate, int channels) {
+        snd_pcm_hw_params_t* hw = nullptr;
+        snd_pcm_hw_params_malloc(&hw);
+        std::unique_ptr<snd_pcm_hw_params_t, void (*)(snd_pcm_hw_params_t*)> hwGuard(hw, snd_pcm_hw_params_free);
+        unsigned rate = static_cast<unsigned>(sampleRate);
+        snd_pcm_uframes_t period = std::max<snd_pcm_uframes_t>(1, sampleRate * chunkSizeMs / 1000);
+        unsigned periods = static_cast<unsigned>(std::max(mPeriods, 2));
+        int err;
+        if ((err = snd_pcm_hw_params_any(mPcm, hw)) < 0 ||
+            (err = snd_pcm_hw_params_set_access(mPcm, hw, SND_PCM_ACCESS_MMAP_INTERLEAVED)) < 0 ||
+            (err = snd_pcm_hw_params_set_format(mPcm, hw, SND_PCM_FORMAT_S16_LE)) < 0 ||
+            (err = snd_pcm_hw_params_set_channels(mPcm, hw, static_cast<unsigned>(channels))) < 0 ||
+            (err = snd_pcm_hw_params_set_rate_near(mPcm, hw, &rate, nullptr)) < 0 ||
+            (err = snd_pcm_hw_params_set_period_size_near(mPcm, hw, &period, nullptr)) < 0 ||
+            (err = snd_pcm_hw_params_set_periods_near(mPcm, hw, &periods, nullptr)) < 0 ||
+            (err = snd_pcm_hw_params(mPcm, hw)) < 0) {
+            return fail("hardware parameters (mmap, S16_LE, " + std::to_string(channels) + " ch, " +
+                            std::to_string(sampleRate) + " Hz)", err);
+        }
+        if (rate != static_cast<unsigned>(sampleRate)) {
+            std::cerr << "ALSA " << mDevice << " captures at " << rate << " Hz, not " << sampleRate << " Hz\n";
+            return false;
+        }
+        snd_pcm_hw_params_get_period_size(hw, &period, nullptr);
+
+        snd_pcm_sw_params_t* sw = nullptr;
+        snd_pcm_sw_params_malloc(&sw);
+        std::unique_ptr<snd_pcm_sw_params_t, void (*)(snd_pcm_sw_params_t*)> swGuard(sw, snd_pcm_sw_params_free);
+        if ((err = snd_pcm_sw_params_current(mPcm, sw)) < 0 ||
+            (err = snd_pcm_sw_params_set_avail_min(mPcm, sw, period)) < 0 ||
+            (err = snd_pcm_sw_params_set_tstamp_mode(mPcm, sw, SND_PCM_TSTAMP_ENABLE)) < 0 ||
+            (err = snd_pcm_sw_params_set_tstamp_type(mPcm, sw, SND_PCM_TSTAMP_TYPE_MONOTONIC)) < 0 ||
+            (err = snd_pcm_sw_params(mPcm, sw)) < 0) {
+            return fail("software parameters", err);
+        }
+
+        mSampleRate = sampleRate;
+        mChannels = channels;
+        mChunkFrames = period;
+        return true;
+    }
+
+    // One period out of the ring; the mmap area may wrap, so it can take two steps
+    int copyPeriod(short* out) {
+        size_t copied = 0;
+        while (copied < mChunkFrames) {
+            const snd_pcm_channel_area_t* areas = nullptr;
+            snd_pcm_uframes_t offset = 0;
+            snd_pcm_uframes_t frames = mChunkFrames - copied;
+            int err = snd_pcm_mmap_begin(mPcm, &areas, &offset, &frames);
+            if (err < 0) {
+                return err;
+            }
+            const char* ring = static_cast<const char*>(areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8;
+            std::memcpy(out + copied * mChannels, ring, frames * mChannels * sizeof(short));
+            snd_pcm_sframes_t committed = snd_pcm_mmap_commit(mPcm, offset, frames);
+            if (committed < 0) {
+                return static_cast<int>(committed);
+            }
+            if (static_cast<snd_pcm_uframes_t>(committed) != frames) {
+                return -EPIPE;
+            }
+            copied += frames;
+        }
+        return 0;
+    }
+
+    bool waitForPeriod() {
+        for (auto& fd : mPollFds) {
+            fd.revents = 0;
+        }
+        if (poll(mPollFds.data(), static_cast<nfds_t>(mPollFds.size()), -1) < 0) {
+            return errno == EINTR;
+        }
+        if (woken(mPollFds.back())) {
+            return false;
+        }
+        unsigned short revents = 0;
+        snd_pcm_poll_descriptors_revents(mPcm, mPollFds.data(), static_cast<unsigned>(mPollFds.size() - 1), &revents);
+        return true;  // An error state shows up in the next snd_pcm_avail_update()
+    }
+
+    bool recover(int err) {
+        if (err == -EPIPE) {
+            ++mOverruns;
+        }
+        if ((err = snd_pcm_recover(mPcm, err, 1)) < 0 || (err = snd_pcm_start(mPcm)) < 0) {
+            return fail("recover", err);
+        }
+        return true;
+    }
+};
+#endif
+
+// Factory function to create the requested capture source
+std::unique_ptr<CaptureSource> createCaptureSource(const CaptureConfig& capture) {
+    switch (capture.backend) {
+        case CaptureBackend::WavReplay:
+            return std::make_unique<WavReplaySource>(capture.replayPath, capture.replayRealtime);
+
+        case CaptureBackend::Alsa:
+#ifdef HAVE_ALSA
+            return std::make_unique<AlsaSource>(capture.device, capture.periods);
+#else
+            // Built without ALSA, fall back to arecord
+            return std::make_unique<ArecordSource>();
+#endif
+
+        case CaptureBackend::Arecord:
+        default:
+            return std::make_unique<ArecordSource>();
+    }
+}
+
+} // namespace
+
+// --------------------- Chunk Pool ---------------------
+// Fixed set of chunk buffers, allocated when capture starts. A buffer is free, being
+// filled by the capture thread, queued for the consumer, or leased out as an AudioChunk.
+// The queue is a ring of buffer indices; when it is full the oldest chunk is dropped.
+class AudioChunkPool {
+public:
+    AudioChunkPool(size_t queueChunks, size_t buffers, size_t samplesPerChunk)
+        : mLimit(std::max<size_t>(1, queueChunks)),
+          mSlots(buffers),
+          mQueue(buffers)
+    {
+        mFree.reserve(buffers);
+        for (size_t i = 0; i < buffers; ++i) {
+            mSlots[i].samples.reserve(samplesPerChunk);
+            mFree.push_back(i);
+        }
+    }
+
+    Chunk& slot(size_t index) { return mSlots[index]; }
+
+    // Capture thread: a free buffer, else the oldest queued chunk (dropped); false
+    // when every buffer is leased out
+    bool acquire(size_t& index) {
+        std::lock_guard<std::mutex> lock(mMtx);
+        if (!mFree.empty()) {
+            index = mFree.back();
+            mFree.pop_back();
+            return true;
+        }
+        if (mCount > 0) {
+            index = popFront();
+            ++mDropped;
+            return true;
+        }
+        return false;
+    }
+
+    // Capture thread, offline sources: waits for room in the queue and a free buffer
+    // instead of dropping; false once closed
+    bool acquireWait(size_t& index) {
+        std::unique_lock<std::mutex> lock(mMtx);
+        mCv.wait(lock, [this] { return (!mFree.empty() && mCount < mLimit) || mClosed; });
+        if (mClosed) {
+            return false;
+        }
+        index = mFree.back();
+        mFree.pop_back();
+        return true;
+    }
+
+    // Capture thread: queue a filled buffer, dropping the oldest chunk when the queue
+    // is full
+    void push(size_t index, bool dropOldest) {
+        {
+            std::lock_guard<std::mutex> lock(mMtx);
+            if (mClosed) {
+                // Stopped while this chunk was being read
+                mFree.push_back(index);
+                return;
+            }
+            if (dropOldest && mCount >= mLimit) {
+                mFree.push_back(popFront());
+                ++mDropped;
+            }
+            mQueue[(mHead + mCount) % mQueue.size()] = index;
+            ++mCount;
+        }
+        mCv.notify_one();
+    }
+
+    // Consumer: waits for a chunk; false once closed and drained
+    bool pop(size_t& index) {
+        std::unique_lock<std::mutex> lock(mMtx);
+        mCv.wait(lock, [this] { return mCount > 0 || mClosed; });
+        if (mCount == 0) {
+            return false;
+        }
+        index = popFront();
+        lock.unlock();
+        mCv.notify_all();  // Room in the queue for a waiting acquireWait()
+        return true;
+    }
+
+    void release(size_t index) {
+        {
+            std::lock_guard<std::mutex> lock(mMtx);
+            mFree.push_back(index);
+        }
+        mCv.notify_all();
+    }
+
+    void countDrop() { ++mDropped; }
+
+    // No more chunks will be queued; wakes both threads
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mMtx);
+            mClosed = true;
+        }
+        mCv.notify_all();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mMtx);
+        while (mCount > 0) {
+            mFree.push_back(popFront());
+        }
+    }
+
+    uint64_t dropped() const { return mDropped; }
+
+private:
+    const size_t mLimit;  // Queued chunks before the oldest is dropped
+    std::mutex mMtx;
+    std::condition_variable mCv;
+    std::vector<Chunk> mSlots;
+    std::vector<size_t> mFree;
+    std::vector<size_t> mQueue;  // Ring of queued buffer indices
+    size_t mHead = 0;
+    size_t mCount = 0;
+    bool mClosed = false;
+    std::atomic<uint64_t> mDropped{0};
+
+    size_t popFront() {
+        size_t index = mQueue[mHead];
+        mHead = (mHead + 1) % mQueue.size();
+        --mCount;
+        return index;
+    }
+};
+
+AudioChunk::AudioChunk(AudioChunk&& other) noexcept
+    : mPool(std::move(other.mPool)),
+      mSlot(other.mSlot),
+      mData(other.mData),
+      mSize(other.mSize),
+      mInfo(other.mInfo)
+{
+    other.mData = nullptr;
+    other.mSize = 0;
+}
+
+AudioChunk& AudioChunk::operator=(AudioChunk&& other) noexcept {
+    if (this != &other) {
+        release();
+        mPool = std::move(other.mPool);
+        mSlot = other.mSlot;
+        mData = other.mData;
+        mSize = other.mSize;
+        mInfo = other.mInfo;
+        other.mData = nullptr;
+        other.mSize = 0;
+    }
+    return *this;
+}
+
+AudioChunk::~AudioChunk() {
+    release();
+}
+
+void AudioChunk::release() {
+    if (mPool) {
+        mPool->release(mSlot);
+        mPool.reset();
+    }
+    mData = nullptr;
+    mSize = 0;
+}
 
 class AudioStreamer::Impl {
 public:
-    Impl(size_t chunkSizeMs, int sampleRate, int channels)
-        : mChunkSizeBytes(0),
-          mBytesPerSample(sizeof(short)),
+    Impl(size_t chunkSizeMs, int sampleRate, int channels, const CaptureConfig& capture)
+        : mChunkSizeMs(chunkSizeMs),
+          mSampleRate(sampleRate),
+          mChannels(channels),
+          mQueueChunks(capture.queueChunks),
+          mLeaseChunks(capture.leaseChunks),
+          mLossless(capture.backend == CaptureBackend::WavReplay && !capture.replayRealtime),
+          mSource(createCaptureSource(capture)),
           mRunning(false)
     {
-        size_t samplesPerChunk = (sampleRate * chunkSizeMs) / 1000;
-        mChunkSizeBytes = samplesPerChunk * channels * mBytesPerSample;
     }
 
     ~Impl() {
@@ -27,110 +691,157 @@ public:
 
     void start() {
         if (mRunning) return;
+        if (mWorker.joinable()) {
+            // The previous capture ended on its own
+            mWorker.join();
+        }
+        if (!mSource->open(mChunkSizeMs, mSampleRate, mChannels)) {
+            return;
+        }
+
+        // Every buffer is allocated here; leases of an earlier run keep their own pool
+        size_t samplesPerChunk = mSource->getChunkFrames() * mSource->getChannels();
+        auto pool = std::make_shared<AudioChunkPool>(mQueueChunks, mQueueChunks + mLeaseChunks + 1, samplesPerChunk);
+        mScratch.samples.reserve(samplesPerChunk);
+        std::atomic_store(&mPool, pool);
+
         mRunning = true;
-        mWorker = std::thread(&Impl::captureLoop, this);
+        mWorker = std::thread(&Impl::captureLoop, this, pool);
     }
 
     void stop() {
-        if (!mRunning) return;
         mRunning = false;
-        mCv.notify_all();
+        mSource->interrupt();
+        auto pool = std::atomic_load(&mPool);
+        if (pool) {
+            pool->close();
+        }
         if (mWorker.joinable()) {
             mWorker.join();
         }
-        if (mPipe) {
-            pclose(mPipe);
-            mPipe = nullptr;
-        }
+        mSource->close();
     }
 
     void clearQueue() {
-        std::unique_lock<std::mutex> lock(mMtx);
-        std::queue<std::vector<short>> emptyQueue;
-        std::swap(mQueue, emptyQueue);
+        if (auto pool = std::atomic_load(&mPool)) {
+            pool->clear();
+        }
     }
 
-    bool popChunk(std::vector<short>& outChunk) {
-        std::unique_lock<std::mutex> lock(mMtx);
-        mCv.wait(lock, [this] { return !mQueue.empty() || !mRunning; });
-        if (!mQueue.empty()) {
-            outChunk = std::move(mQueue.front());
-            mQueue.pop();
-            return true;
+    // Blocks for the next queued chunk; returns its pool, or null once stopped and drained
+    std::shared_ptr<AudioChunkPool> popSlot(size_t& index) {
+        auto pool = std::atomic_load(&mPool);
+        if (!pool || !pool->pop(index)) {
+            return nullptr;
         }
-        return false;
+        return pool;
+    }
+
+    bool popChunk(std::vector<short>& outChunk, AudioChunkInfo* info) {
+        size_t index;
+        auto pool = popSlot(index);
+        if (!pool) {
+            return false;
+        }
+        // The caller's vector goes back into the pool in exchange, so a reused vector
+        // keeps circulating without allocations
+        Chunk& chunk = pool->slot(index);
+        std::swap(outChunk, chunk.samples);
+        if (info) {
+            *info = chunk.info;
+        }
+        pool->release(index);
+        return true;
     }
 
     bool isRunning() const {
         return mRunning;
     }
 
-private:
-    void captureLoop() {
-        const char* cmd = "arecord -f S16_LE -c1 -r16000 -t raw";
-        mPipe = popen(cmd, "r");
-        if (!mPipe) {
-            std::cerr << "Failed to start arecord\n";
-            mRunning = false;
-            mCv.notify_all(); // Notify waiting threads that we're done
-            return;
-        }
-
-        int fd = fileno(mPipe);
-        int flags = fcntl(fd, F_GETFL, 0);
-        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    int getSampleRate() const { return mSource->getSampleRate(); }
+    int getChannels() const { return mSource->getChannels(); }
+    size_t getChunkFrames() const { return mSource->getChunkFrames(); }
+    uint64_t getOverruns() const { return mSource->getOverruns(); }
 
-        std::vector<char> buffer(mChunkSizeBytes);
+    uint64_t getDroppedChunks() const {
+        auto pool = std::atomic_load(&mPool);
+        return pool ? pool->dropped() : 0;
+    }
 
+private:
+    void captureLoop(std::shared_ptr<AudioChunkPool> pool) {
         while (mRunning) {
-            fd_set readfds;
-            FD_ZERO(&readfds);
-            FD_SET(fd, &readfds);
-
-            struct timeval tv;
-            tv.tv_sec = 0;
-            tv.tv_usec = 10000; // 10 ms
-
-            int ret = select(fd + 1, &readfds, nullptr, nullptr, &tv);
-            if (ret > 0 && FD_ISSET(fd, &readfds)) {
-                size_t bytesRead = fread(buffer.data(), 1, mChunkSizeBytes, mPipe);
-                if (bytesRead > 0) {
-                    size_t sampleCount = bytesRead / mBytesPerSample;
-                    std::vector<short> chunk(sampleCount);
-                    std::memcpy(chunk.data(), buffer.data(), bytesRead);
-
-                    {
-                        std::lock_guard<std::mutex> lock(mMtx);
-                        mQueue.push(std::move(chunk));
-                    }
-                    mCv.notify_one();
-                } else if (feof(mPipe) || ferror(mPipe)) {
-                    // Command terminated or encountered an error
-                    std::cerr << "Audio capture command terminated unexpectedly\n";
-                    mRunning = false;
-                    mCv.notify_all(); // Notify waiting threads that we're done
+            size_t index = 0;
+            bool pooled;
+            if (mLossless) {
+                // Nothing is lost by waiting for the consumer
+                if (!pool->acquireWait(index)) {
                     break;
                 }
+                pooled = true;
+            } else {
+                // With every buffer leased out the chunk is still read, to keep up with
+                // the device, but dropped
+                pooled = pool->acquire(index);
+            }
+            Chunk& chunk = pooled ? pool->slot(index) : mScratch;
+            if (!mSource->read(chunk)) {
+                if (pooled) {
+                    pool->release(index);
+                }
+                break;
+            }
+            if (pooled) {
+                pool->push(index, !mLossless);
+            } else {
+                pool->countDrop();
             }
         }
+        mRunning = false;
+        pool->close(); // Notify waiting threads that we're done
     }
 
-    size_t mChunkSizeBytes;
-    size_t mBytesPerSample;
+    size_t mChunkSizeMs;
+    int mSampleRate;
+    int mChannels;
+    size_t mQueueChunks;
+    size_t mLeaseChunks;
+    bool mLossless;  // Offline replay waits for the consumer instead of dropping
 
-    FILE* mPipe = nullptr;
+    std::unique_ptr<CaptureSource> mSource;
     std::thread mWorker;
-    std::mutex mMtx;
-    std::condition_variable mCv;
-    std::queue<std::vector<short>> mQueue;
+    std::shared_ptr<AudioChunkPool> mPool;  // Replaced by start(); accessed atomically
+    Chunk mScratch;
     std::atomic<bool> mRunning;
 };
 
-AudioStreamer::AudioStreamer(size_t chunkSizeMs, int sampleRate, int channels)
-    : mImpl(std::make_unique<Impl>(chunkSizeMs, sampleRate, channels)) {}
+AudioStreamer::AudioStreamer(size_t chunkSizeMs, int sampleRate, int channels, const CaptureConfig& capture)
+    : mImpl(std::make_unique<Impl>(chunkSizeMs, sampleRate, channels, capture)) {}
 
 AudioStreamer::~AudioStreamer() = default;
 void AudioStreamer::start() { mImpl->start(); }
 void AudioStreamer::stop() { mImpl->stop(); }
-bool AudioStreamer::popChunk(std::vector<short>& outChunk) { return mImpl->popChunk(outChunk); }
+bool AudioStreamer::popChunk(std::vector<short>& outChunk) { return mImpl->popChunk(outChunk, nullptr); }
+bool AudioStreamer::popChunk(std::vector<short>& outChunk, AudioChunkInfo& info) { return mImpl->popChunk(outChunk, &info); }
 bool AudioStreamer::isRunning() const { return mImpl->isRunning(); }
+int AudioStreamer::getSampleRate() const { return mImpl->getSampleRate(); }
+int AudioStreamer::getChannels() const { return mImpl->getChannels(); }
+size_t AudioStreamer::getChunkFrames() const { return mImpl->getChunkFrames(); }
+uint64_t AudioStreamer::getOverruns() const { return mImpl->getOverruns(); }
+uint64_t AudioStreamer::getDroppedChunks() const { return mImpl->getDroppedChunks(); }
+
+bool AudioStreamer::popChunk(AudioChunk& outChunk) {
+    outChunk.release();
+    size_t index;
+    auto pool = mImpl->popSlot(index);
+    if (!pool) {
+        return false;
+    }
+    const Chunk& chunk = pool->slot(index);
+    outChunk.mData = chunk.samples.data();
+    outChunk.mSize = chunk.samples.size();
+    outChunk.mInfo = chunk.info;
+    outChunk.mSlot = index;
+    outChunk.mPool = std::move(pool);
+    return true;
+}
@@ -0,0 +1,264 @@
+#include "periodic_scheduler.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+
+// steady_clock is CLOCK_MONOTONIC on Linux, so deadlines map directly onto the kernel clocks
+timespec toTimespec(PeriodicScheduler::Clock::time_point time) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    timespec spec{};
+    spec.tv_sec = static_cast<time_t>(ns / 1000000000);
+    spec.tv_nsec = static_cast<long>(ns % 1000000000);
+    return spec;
+}
+
+timespec toTimespec(std::chrono::nanoseconds duration) {
+    timespec spec{};
+    spec.tv_sec = static_cast<time_t>(duration.count() / 1000000000);
+    spec.tv_nsec = static_cast<long>(duration.count() % 1000000000);
+    return spec;
+}
+
+} // namespace
+
+class PeriodicScheduler::Impl {
+public:
+    using TimePoint = Clock::time_point;
+
+    const std::chrono::nanoseconds mPeriod;
+    const PeriodicSchedulerOptions mOptions;
+
+    // Owned by the waiting thread
+    bool mStarted = false;
+    bool mThreadConfigured = false;
+    int mTimerFd = -1;
+    TimePoint mNextDeadline;
+
+    // Phase requests from other threads
+    std::atomic<bool> mPhasePending{false};
+    std::atomic<int64_t> mPhaseAnchorNs{0};
+
+    // Statistics, written once per tick and read by any thread
+    mutable std::mutex mStatsMutex;
+    uint64_t mTicks = 0;
+    uint64_t mMissedTicks = 0;
+    std::array<int64_t, kLatenessWindow> mLateness{};  // Nanoseconds, ring buffer
+
+    Impl(Clock::duration period, const PeriodicSchedulerOptions& options)
+        : mPeriod(std::max<std::chrono::nanoseconds>(period, std::chrono::microseconds(1))),
+          mOptions(options) {}
+
+    ~Impl() {
+        if (mTimerFd >= 0) {
+            close(mTimerFd);
+        }
+    }
+
+    void configureThread() {
+        mThreadConfigured = true;
+        if (mOptions.minimizeTimerSlack && prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL) < 0) {
+            perror("prctl PR_SET_TIMERSLACK");
+        }
+        if (mOptions.realtimePriority > 0) {
+            sched_param param{};
+            param.sched_priority = std::min(mOptions.realtimePriority, sched_get_priority_max(SCHED_FIFO));
+            int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+            if (result != 0) {
+                errno = result;
+                perror("PeriodicScheduler: SCHED_FIFO unavailable, keeping normal scheduling");
+            }
+        }
+    }
+
+    // First deadline after now: one period ahead, or the next point on the phase grid
+    TimePoint firstDeadline(TimePoint now) {
+        if (!mPhasePending.exchange(false)) {
+            return now + mPeriod;
+        }
+        TimePoint grid = TimePoint(std::chrono::nanoseconds(mPhaseAnchorNs.load())) + mOptions.phaseOffset;
+        auto periods = (now - grid) / mPeriod + 1;
+        return grid + periods * mPeriod;
+    }
+
+    // Arm the periodic timerfd on mNextDeadline; falls back to clock_nanosleep on failure
+    bool armTimerFd() {
+        if (mTimerFd < 0) {
+            mTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+            if (mTimerFd < 0) {
+                perror("timerfd_create");
+                return false;
+            }
+        }
+        itimerspec spec{};
+        spec.it_value = toTimespec(mNextDeadline);
+        spec.it_interval = toTimespec(mPeriod);
+        if (timerfd_settime(mTimerFd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+            perror("timerfd_settime");
+            close(mTimerFd);
+            mTimerFd = -1;
+            return false;
+        }
+        return true;
+    }
+
+    void start(TimePoint now) {
+        mNextDeadline = firstDeadline(now);
+        if (mOptions.waitMethod == PeriodicSchedulerOptions::WaitMethod::TimerFd) {
+            armTimerFd();
+        }
+        mStarted = true;
+    }
+
+    TimePoint now() const {
+        return mOptions.simulatedClock ? mOptions.simulatedClock->now() : Clock::now();
+    }
+
+    void recordTick(int64_t latenessNs, uint64_t missed) {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        mLateness[mTicks % kLatenessWindow] = latenessNs;
+        ++mTicks;
+        mMissedTicks += missed;
+    }
+
+    // Deadlines on a simulated clock are never late: the clock jumps to each one in turn
+    bool pollSimulatedTick(TimePoint until, TimePoint& deadline) {
+        if (!mStarted || mPhasePending.load(std::memory_order_relaxed)) {
+            mNextDeadline = firstDeadline(now());
+            mStarted = true;
+        }
+        if (mNextDeadline > until) {
+            return false;
+        }
+        deadline = mNextDeadline;
+        mNextDeadline += mPeriod;
+        mOptions.simulatedClock->advanceTo(deadline);
+        recordTick(0, 0);
+        return true;
+    }
+
+    TimePoint waitNextTick() {
+        if (mOptions.simulatedClock) {
+            TimePoint deadline;
+            pollSimulatedTick(TimePoint::max(), deadline);
+            return deadline;
+        }
+        if (!mThreadConfigured) {
+            configureThread();
+        }
+        if (!mStarted || mPhasePending.load(std::memory_order_relaxed)) {
+            start(Clock::now());
+        }
+
+        TimePoint deadline;
+        uint64_t missed = 0;
+        if (mTimerFd >= 0) {
+            // Each read returns the number of expirations since the last one; more than one
+            // means the loop overran and those periods were skipped
+            uint64_t expirations = 0;
+            while (read(mTimerFd, &expirations, sizeof(expirations)) < 0 && errno == EINTR) {
+            }
+            expirations = std::max<uint64_t>(expirations, 1);
+            missed = expirations - 1;
+            deadline = mNextDeadline + static_cast<int64_t>(missed) * mPeriod;
+        } else {
+            TimePoint now = Clock::now();
+            if (now - mNextDeadline >= mPeriod) {
+                missed = static_cast<uint64_t>((now - mNextDeadline) / mPeriod);
+                mNextDeadline += static_cast<int64_t>(missed) * mPeriod;
+            }
+            deadline = mNextDeadline;
+            timespec spec = toTimespec(deadline);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &spec, nullptr) == EINTR) {
+            }
+        }
+        mNextDeadline = deadline + mPeriod;
+
+        recordTick(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - deadline).count(), missed);
+        return deadline;
+    }
+
+    void alignPhase(TimePoint anchor) {
+        mPhaseAnchorNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(anchor.time_since_epoch()).count());
+        mPhasePending.store(true);
+    }
+
+    PeriodicSchedulerStats getStats() const {
+        PeriodicSchedulerStats stats;
+        std::vector<int64_t> window;
+        {
+            std::lock_guard<std::mutex> lock(mStatsMutex);
+            stats.ticks = mTicks;
+            stats.missedTicks = mMissedTicks;
+            size_t count = static_cast<size_t>(std::min<uint64_t>(mTicks, kLatenessWindow));
+            window.assign(mLateness.begin(), mLateness.begin() + count);
+        }
+        if (window.empty()) {
+            return stats;
+        }
+
+        std::sort(window.begin(), window.end());
+        double sum = 0.0;
+        for (int64_t value : window) {
+            sum += static_cast<double>(value);
+        }
+        auto percentile = [&window](double quantile) {
+            size_t index = static_cast<size_t>(quantile * static_cast<double>(window.size() - 1) + 0.5);
+            return static_cast<double>(window[index]) / 1000.0;
+        };
+        stats.meanLatenessUs = sum / static_cast<double>(window.size()) / 1000.0;
+        stats.p50LatenessUs = percentile(0.50);
+        stats.p99LatenessUs = percentile(0.99);
+        stats.maxLatenessUs = static_cast<double>(window.back()) / 1000.0;
+        return stats;
+    }
+
+    void resetStats() {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        mTicks = 0;
+        mMissedTicks = 0;
+    }
+};
+
+PeriodicScheduler::PeriodicScheduler(Clock::duration period, const PeriodicSchedulerOptions& options)
+    : mImpl(std::make_unique<Impl>(period, options)) {}
+
+PeriodicScheduler::~PeriodicScheduler() = default;
+
+PeriodicScheduler::Clock::time_point PeriodicScheduler::waitNextTick() {
+    return mImpl->waitNextTick();
+}
+
+bool PeriodicScheduler::pollNextTick(Clock::time_point until, Clock::time_point& deadline) {
+    if (!mImpl->mOptions.simulatedClock) {
+        return false;
+    }
+    return mImpl->pollSimulatedTick(until, deadline);
+}
+
+void PeriodicScheduler::alignPhase(Clock::time_point anchor) {
+    mImpl->alignPhase(anchor);
+}
+
+PeriodicScheduler::Clock::duration PeriodicScheduler::getPeriod() const {
+    return std::chrono::duration_cast<Clock::duration>(mImpl->mPeriod);
+}
+
+PeriodicSchedulerStats PeriodicScheduler::getStats() const {
+    return mImpl->getStats();
+}
+
+void PeriodicScheduler::resetStats() {
+    mImpl->resetStats();
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "simulated_clock.h"
+
+// Options of a periodic scheduler
+struct PeriodicSchedulerOptions {
+    // How the scheduler thread blocks until a deadline
+    enum class WaitMethod {
+        TimerFd,        // Periodic timerfd armed once with TFD_TIMER_ABSTIME; the kernel keeps the cadence
+        ClockNanosleep  // clock_nanosleep(TIMER_ABSTIME) on each deadline
+    };
+
+    WaitMethod waitMethod = WaitMethod::TimerFd;
+
+    // SCHED_FIFO priority (1-99) for the waiting thread; 0 keeps the current policy.
+    // Requires CAP_SYS_NICE or an RLIMIT_RTPRIO allowance; failure is reported once and ignored.
+    int realtimePriority = 0;
+
+    // Drop the waiting thread's timer slack to 1 ns (normal threads default to 50 us)
+    bool minimizeTimerSlack = true;
+
+    // Offset of ticks from the phase anchor set with alignPhase() (e.g. negative to run
+    // ahead of vsync so output is ready when the frame is composed)
+    std::chrono::nanoseconds phaseOffset{0};
+
+    // Take time from this clock instead of steady_clock. Nothing sleeps: the owner steps the
+    // loop with pollNextTick(), or waitNextTick() jumps the clock to the next deadline.
+    // Thread options are ignored and lateness is always zero.
+    std::shared_ptr<SimulatedClock> simulatedClock;
+};
+
+// Wake-up statistics; lateness is wake time minus deadline over the last kLatenessWindow ticks
+struct PeriodicSchedulerStats {
+    uint64_t ticks = 0;
+    uint64_t missedTicks = 0;  // Periods that passed without a tick because the loop overran
+    double meanLatenessUs = 0.0;
+    double p50LatenessUs = 0.0;
+    double p99LatenessUs = 0.0;
+    double maxLatenessUs = 0.0;
+};
+
+// Drift-free periodic wake-ups on absolute deadlines.
+//
+// Deadlines are start + n * period, independent of when the loop actually woke up or how
+// long it worked, so oversleeping does not accumulate into the cadence. When the loop
+// overruns whole periods they are skipped rather than fired back to back. The thread
+// that calls waitNextTick() is the one that gets the real-time priority and timer slack.
+class PeriodicScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kLatenessWindow = 1024;
+
+    explicit PeriodicScheduler(Clock::duration period,
+                               const PeriodicSchedulerOptions& options = PeriodicSchedulerOptions());
+    ~PeriodicScheduler();
+
+    PeriodicScheduler(const PeriodicScheduler&) = delete;
+    PeriodicScheduler& operator=(const PeriodicScheduler&) = delete;
+
+    // Block until the next deadline and return it. The first call starts the cadence one
+    // period from now, or on the phase grid when alignPhase() was called.
+    Clock::time_point waitNextTick();
+
+    // Simulated clock only: if the next deadline is at or before until, advance the clock to
+    // it, store it in deadline and return true. Loop while it returns true to run every tick
+    // up to until on the calling thread.
+    bool pollNextTick(Clock::time_point until, Clock::time_point& deadline);
+
+    // Align deadlines to anchor + phaseOffset + k * period, e.g. with a vsync timestamp.
+    // Callable from any thread; takes effect at the next waitNextTick().
+    void alignPhase(Clock::time_point anchor);
+
+    Clock::duration getPeriod() const;
+
+    // Callable from any thread
+    PeriodicSchedulerStats getStats() const;
+    void resetStats();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> mImpl;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Manually advanced steady_clock stand-in for running periodic loops in virtual time.
+//
+// Time only moves when the owner advances it, so a loop driven through
+// PeriodicScheduler::pollNextTick() runs as fast as it can compute and gives the
+// same result on every run. now() may be read from any thread.
+class SimulatedClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit SimulatedClock(Clock::time_point start = Clock::time_point())
+        : mNowNs(toNs(start)) {}
+
+    Clock::time_point now() const {
+        return Clock::time_point(std::chrono::nanoseconds(mNowNs.load(std::memory_order_acquire)));
+    }
+
+    // Move the clock to time; the clock never goes backwards
+    void advanceTo(Clock::time_point time) {
+        int64_t target = toNs(time);
+        int64_t current = mNowNs.load(std::memory_order_relaxed);
+        while (current < target &&
+               !mNowNs.compare_exchange_weak(current, target, std::memory_order_acq_rel)) {
+        }
+    }
+
+    void advanceBy(Clock::duration delta) { advanceTo(now() + delta); }
+
+private:
+    static int64_t toNs(Clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+
+    std::atomic<int64_t> mNowNs;
+};
@@ -1,5 +1,7 @@
 #include "timer.h"
+#include "timer_schedule.h"
 #include <algorithm>
+#include <array>
 #include <queue>
 #include <vector>
 
@@ -8,18 +10,42 @@ class Timer::Impl {
 public:
     using TimePoint = std::chrono::steady_clock::time_point;
 
+    virtual ~Impl() = default;
+
+    virtual uint64_t addTimer(const Duration& duration, Callback callback, bool repeating,
+                              const TimerOptions& options) = 0;
+    virtual bool removeTimer(uint64_t timer_id) = 0;
+    virtual void update() = 0;
+    virtual size_t getActiveTimerCount() const = 0;
+    virtual Duration getTimeToNextTimer() const = 0;
+    virtual Backend getBackend() const = 0;
+
+    class HeapBackend;
+    class WheelBackend;
+};
+
+// Binary min-heap backend
+class Timer::Impl::HeapBackend : public Timer::Impl {
+public:
+    // Timers with slack behave like hrtimer ranges: the heap is ordered by the latest allowed
+    // expiry (deadline + slack), and update() expires every timer from the top whose window
+    // has opened, so nearby timers share one wake-up.
     struct TimerNode {
-        TimePoint mExpiryTime;
+        TimePoint mExpiryTime;  // Latest allowed expiry (deadline + slack), the heap key
+        TimePoint mIdealTime;   // Requested deadline; repeating timers are scheduled from it
         Timer::Callback mCallback;
         uint64_t mTimerId;
         bool mIsRepeating;
         Timer::Duration mRepeatInterval;
+        TimerOptions mOptions;
 
-        TimerNode(TimePoint expiry, Timer::Callback cb, uint64_t id, bool repeating = false, Timer::Duration interval = Timer::Duration::zero())
-            : mExpiryTime(expiry), mCallback(std::move(cb)), mTimerId(id), mIsRepeating(repeating), mRepeatInterval(interval) {}
+        TimerNode(TimePoint ideal, Timer::Callback cb, uint64_t id, bool repeating = false,
+                  Timer::Duration interval = Timer::Duration::zero(), const TimerOptions& options = TimerOptions())
+            : mExpiryTime(ideal + options.slack), mIdealTime(ideal), mCallback(std::move(cb)),
+              mTimerId(id), mIsRepeating(repeating), mRepeatInterval(interval), mOptions(options) {}
     };
 
-        struct TimerComparator {
+    struct TimerComparator {
         bool operator()(const std::unique_ptr<TimerNode>& a, const std::unique_ptr<TimerNode>& b) const {
             // Min-heap: return true if a should come after b
             return a->mExpiryTime > b->mExpiryTime;
@@ -33,147 +59,586 @@ public:
     TimerHeap mTimerHeap;
     uint64_t mNextTimerId;
 
-    Impl() : mNextTimerId(1) {}
+    HeapBackend() : mNextTimerId(1) {}
+
+    uint64_t addTimer(const Timer::Duration& duration, Timer::Callback callback, bool repeating,
+                      const TimerOptions& options) override {
+        auto current_time = std::chrono::steady_clock::now();
+        auto expiry_time = current_time + duration;
+        auto timer_node = std::make_unique<TimerNode>(expiry_time, std::move(callback), mNextTimerId, repeating,
+                                                      repeating ? duration : Timer::Duration::zero(), options);
+
+        mTimerHeap.push(std::move(timer_node));
+
+        return mNextTimerId++;
+    }
+
+    bool removeTimer(uint64_t timer_id) override {
+        // Since std::priority_queue doesn't support arbitrary removal,
+        // we'll rebuild the heap without the target timer
+        std::vector<std::unique_ptr<TimerNode>> remaining_timers;
+        bool found = false;
+
+        while (!mTimerHeap.empty()) {
+            auto timer = std::move(const_cast<std::unique_ptr<TimerNode>&>(mTimerHeap.top()));
+            mTimerHeap.pop();
+
+            if (timer->mTimerId == timer_id) {
+                found = true;
+                // Don't add this timer back
+            } else {
+                remaining_timers.push_back(std::move(timer));
+            }
+        }
+
+        // Rebuild the heap with remaining timers
+        for (auto& timer : remaining_timers) {
+            mTimerHeap.push(std::move(timer));
+        }
+
+        return found;
+    }
+
+    void update() override {
+        // Get current time for comparison
+        auto current_time = std::chrono::steady_clock::now();
+
+        // Store expired timers to execute their callbacks after heap manipulation
+        std::vector<Timer::Callback> callbacks_to_execute;
+
+        // Store repeating timers that need to be re-added
+        std::vector<std::unique_ptr<TimerNode>> repeating_timers_to_readd;
+
+        // First pass: collect all expired timers and prepare repeating timers
+        while (!mTimerHeap.empty()) {
+            const auto& next_timer = mTimerHeap.top();
+
+            // Check if this timer's expiry window has opened
+            if (next_timer->mIdealTime <= current_time) {
+                // Store the callback for later execution
+                if (next_timer->mCallback) {
+                    callbacks_to_execute.push_back(next_timer->mCallback);
+                }
+
+                // If it's a repeating timer, prepare to re-add it at its next ideal deadline
+                if (next_timer->mIsRepeating) {
+                    auto new_deadline = timer_schedule::nextDeadline(next_timer->mIdealTime, next_timer->mRepeatInterval,
+                                                                     current_time, next_timer->mOptions.repeatPolicy);
+                    auto new_timer = std::make_unique<TimerNode>(
+                        new_deadline,
+                        next_timer->mCallback,
+                        next_timer->mTimerId,
+                        true,
+                        next_timer->mRepeatInterval,
+                        next_timer->mOptions
+                    );
+                    repeating_timers_to_readd.push_back(std::move(new_timer));
+                }
+
+                // Timer has expired, remove it from heap
+                mTimerHeap.pop();
+            } else {
+                // This timer (and all subsequent timers) haven't expired yet
+                break;
+            }
+        }
+
+        // Re-add repeating timers before executing callbacks
+        for (auto& timer : repeating_timers_to_readd) {
+            mTimerHeap.push(std::move(timer));
+        }
+
+        // Second pass: execute all callbacks after heap manipulation is complete
+        // This ensures that any new timers added in callbacks won't interfere with current update
+        for (const auto& callback : callbacks_to_execute) {
+            callback();
+        }
+    }
+
+    size_t getActiveTimerCount() const override {
+        return mTimerHeap.size();
+    }
+
+    Timer::Duration getTimeToNextTimer() const override {
+        if (mTimerHeap.empty()) {
+            return Timer::Duration::zero();
+        }
+
+        auto current_time = std::chrono::steady_clock::now();
+        auto next_expiry = mTimerHeap.top()->mExpiryTime;
+        if (next_expiry <= current_time) {
+            return Timer::Duration::zero(); // Timer has already expired
+        }
+
+        // Round up so sleeping for the returned time never wakes before the expiry
+        return std::chrono::ceil<Timer::Duration>(next_expiry - current_time);
+    }
+
+    Timer::Backend getBackend() const override {
+        return Timer::Backend::Heap;
+    }
 };
 
-// Timer class implementation
-Timer::Timer() : pImpl(std::make_unique<Impl>()) {
-}
+// Hierarchical timing wheel backend.
+//
+// Four levels of slots with 1 ms ticks (256 x 1 ms, 64 x 256 ms, 64 x 16.4 s, 64 x 17.5 min),
+// covering ~18.6 hours; longer timers are parked in the last level and re-cascaded. Each slot
+// is an intrusive doubly-linked list, so insertion and cancellation are O(1). Nodes live in
+// fixed-size slab chunks with stable addresses and are recycled through a free list, and the
+// timer ID encodes the slab index plus a generation counter so stale IDs are rejected.
+class Timer::Impl::WheelBackend : public Timer::Impl {
+public:
+    static constexpr int kLevelCount = 4;
+    static constexpr int kLevel0Bits = 8;
+    static constexpr int kLevelBits = 6;
+    static constexpr uint64_t kLevel0Size = 1u << kLevel0Bits;
+    static constexpr uint64_t kLevelSize = 1u << kLevelBits;
+    static constexpr uint64_t kMaxTicks = 1ull << (kLevel0Bits + (kLevelCount - 1) * kLevelBits);
+    static constexpr size_t kSlabChunkSize = 1024;
+
+    enum class NodeState : uint8_t {
+        Free,       // On the free list
+        Pending,    // Linked into a wheel slot
+        Due,        // Collected for firing in the current update()
+        Firing,     // Callback is running
+        Cancelled   // Removed while Due/Firing; released once update() is done with it
+    };
 
-Timer::~Timer() = default;
+    struct Slot;
 
-Timer::Timer(Timer&&) noexcept = default;
+    struct TimerNode {
+        TimerNode* mPrev = nullptr;
+        TimerNode* mNext = nullptr;
+        Slot* mSlot = nullptr;
+        uint64_t mDeadlineTick = 0;
+        TimePoint mIdealTime;
+        Timer::Duration mRepeatInterval{0};
+        TimerOptions mOptions;
+        Timer::Callback mCallback;
+        uint32_t mIndex = 0;
+        uint32_t mGeneration = 0;
+        NodeState mState = NodeState::Free;
+        bool mIsRepeating = false;
+    };
 
-Timer& Timer::operator=(Timer&&) noexcept = default;
+    struct Slot {
+        TimerNode* mHead = nullptr;
+    };
 
-uint64_t Timer::addTimer(const Duration& duration, Callback callback) {
-    auto current_time = std::chrono::steady_clock::now();
-    auto expiry_time = current_time + duration;
-    auto timer_node = std::make_unique<Impl::TimerNode>(expiry_time, std::move(callback), pImpl->mNextTimerId, false);
+    TimePoint mStartTime;
+    uint64_t mCurrentTick;  // Next tick to be processed
+    size_t mActiveCount;
+
+    std::array<Slot, kLevel0Size> mLevel0;
+    std::array<std::array<Slot, kLevelSize>, kLevelCount - 1> mUpperLevels;
+
+    std::vector<std::unique_ptr<TimerNode[]>> mSlabChunks;
+    TimerNode* mFreeList;
+    std::vector<TimerNode*> mDueScratch;
+
+    WheelBackend()
+        : mStartTime(std::chrono::steady_clock::now()), mCurrentTick(0), mActiveCount(0), mFreeList(nullptr) {}
+
+    uint64_t addTimer(const Timer::Duration& duration, Timer::Callback callback, bool repeating,
+                      const TimerOptions& options) override {
+        TimerNode* node = allocateNode();
+        node->mCallback = std::move(callback);
+        node->mIsRepeating = repeating;
+        node->mRepeatInterval = repeating ? duration : Timer::Duration::zero();
+        node->mOptions = options;
+        node->mIdealTime = std::chrono::steady_clock::now() + duration;
+        node->mDeadlineTick = deadlineTick(timer_schedule::coalesce(node->mIdealTime, options.slack));
+        node->mState = NodeState::Pending;
+        insertNode(node);
+        ++mActiveCount;
+
+        return makeTimerId(node);
+    }
 
-    pImpl->mTimerHeap.push(std::move(timer_node));
+    bool removeTimer(uint64_t timer_id) override {
+        TimerNode* node = lookupNode(timer_id);
+        if (!node) {
+            return false;
+        }
 
-    return pImpl->mNextTimerId++;
-}
+        switch (node->mState) {
+            case NodeState::Pending:
+                unlinkNode(node);
+                releaseNode(node);
+                --mActiveCount;
+                return true;
+            case NodeState::Due:
+                node->mState = NodeState::Cancelled;
+                --mActiveCount;
+                return true;
+            case NodeState::Firing:
+                // A one-shot timer has already expired once its callback runs
+                if (!node->mIsRepeating) {
+                    return false;
+                }
+                node->mState = NodeState::Cancelled;
+                --mActiveCount;
+                return true;
+            default:
+                return false;
+        }
+    }
 
-uint64_t Timer::addRepeatingTimer(const Duration& interval, Callback callback) {
-    auto current_time = std::chrono::steady_clock::now();
-    auto expiry_time = current_time + interval;
-    auto timer_node = std::make_unique<Impl::TimerNode>(expiry_time, std::move(callback), pImpl->mNextTimerId, true, interval);
+    void update() override {
+        auto current_time = std::chrono::steady_clock::now();
+        uint64_t now_tick = elapsedTicks(current_time);
 
-    pImpl->mTimerHeap.push(std::move(timer_node));
+        std::vector<TimerNode*> due;
+        due.swap(mDueScratch);
 
-    return pImpl->mNextTimerId++;
-}
+        if (mActiveCount == 0) {
+            // Nothing to cascade, jump straight to the present
+            mCurrentTick = std::max(mCurrentTick, now_tick + 1);
+        }
 
-uint64_t Timer::addTimer(const std::chrono::seconds& duration, Callback callback) {
-    auto duration_ms = std::chrono::duration_cast<Duration>(duration);
-    return addTimer(duration_ms, std::move(callback));
-}
+        while (mCurrentTick <= now_tick) {
+            uint64_t tick = mCurrentTick;
+            uint64_t index0 = tick & (kLevel0Size - 1);
 
-uint64_t Timer::addRepeatingTimer(const std::chrono::seconds& interval, Callback callback) {
-    auto interval_ms = std::chrono::duration_cast<Duration>(interval);
-    return addRepeatingTimer(interval_ms, std::move(callback));
-}
+            if (index0 == 0 && tick != 0) {
+                cascade(tick);
+            }
 
-bool Timer::removeTimer(uint64_t timer_id) {
-    // Since std::priority_queue doesn't support arbitrary removal,
-    // we'll rebuild the heap without the target timer
-    std::vector<std::unique_ptr<Impl::TimerNode>> remaining_timers;
-    bool found = false;
-
-    while (!pImpl->mTimerHeap.empty()) {
-        auto timer = std::move(const_cast<std::unique_ptr<Impl::TimerNode>&>(pImpl->mTimerHeap.top()));
-        pImpl->mTimerHeap.pop();
-
-        if (timer->mTimerId == timer_id) {
-            found = true;
-            // Don't add this timer back
-        } else {
-            remaining_timers.push_back(std::move(timer));
+            collectSlot(mLevel0[index0], tick, due);
+            ++mCurrentTick;
+        }
+
+        // Callbacks run after the wheel has been advanced, so timers added from a callback
+        // are inserted relative to the new current tick
+        for (TimerNode* node : due) {
+            if (node->mState == NodeState::Cancelled) {
+                releaseNode(node);
+                continue;
+            }
+
+            node->mState = NodeState::Firing;
+            if (!node->mIsRepeating) {
+                --mActiveCount;
+            }
+
+            if (node->mCallback) {
+                node->mCallback();
+            }
+
+            if (node->mState == NodeState::Cancelled || !node->mIsRepeating) {
+                releaseNode(node);
+            } else {
+                node->mIdealTime = timer_schedule::nextDeadline(node->mIdealTime, node->mRepeatInterval, current_time,
+                                                                node->mOptions.repeatPolicy);
+                node->mDeadlineTick = std::max(deadlineTick(timer_schedule::coalesce(node->mIdealTime,
+                                                                                     node->mOptions.slack)),
+                                               now_tick + 1);
+                node->mState = NodeState::Pending;
+                insertNode(node);
+            }
+        }
+
+        due.clear();
+        if (mDueScratch.empty()) {
+            mDueScratch.swap(due);
         }
     }
 
-    // Rebuild the heap with remaining timers
-    for (auto& timer : remaining_timers) {
-        pImpl->mTimerHeap.push(std::move(timer));
+    size_t getActiveTimerCount() const override {
+        return mActiveCount;
     }
 
-    return found;
-}
+    Timer::Duration getTimeToNextTimer() const override {
+        if (mActiveCount == 0) {
+            return Timer::Duration::zero();
+        }
 
-void Timer::update() {
-    // Get current time for comparison
-    auto current_time = std::chrono::steady_clock::now();
+        uint64_t next_tick = UINT64_MAX;
 
-    // Store expired timers to execute their callbacks after heap manipulation
-    std::vector<Callback> callbacks_to_execute;
+        // Level 0 slots map one-to-one onto the next 256 ticks
+        for (uint64_t i = 0; i < kLevel0Size; ++i) {
+            const Slot& slot = mLevel0[(mCurrentTick + i) & (kLevel0Size - 1)];
+            if (slot.mHead) {
+                next_tick = minDeadline(slot);
+                break;
+            }
+        }
 
-    // Store repeating timers that need to be re-added
-    std::vector<std::unique_ptr<Impl::TimerNode>> repeating_timers_to_readd;
+        // Upper levels: the first occupied slot after the current index holds the level's earliest
+        // timers. On a level boundary the current slot itself cascades on the next tick processed,
+        // so it is checked first.
+        for (int level = 1; level < kLevelCount; ++level) {
+            const auto& slots = mUpperLevels[level - 1];
+            uint64_t current_index = levelIndex(mCurrentTick, level);
+            uint64_t lower_mask = (uint64_t(1) << (kLevel0Bits + (level - 1) * kLevelBits)) - 1;
+            uint64_t first = (mCurrentTick & lower_mask) == 0 ? 0 : 1;
+            for (uint64_t i = first; i < first + kLevelSize; ++i) {
+                const Slot& slot = slots[(current_index + i) & (kLevelSize - 1)];
+                if (slot.mHead) {
+                    next_tick = std::min(next_tick, minDeadline(slot));
+                    break;
+                }
+            }
+        }
 
-    // First pass: collect all expired timers and prepare repeating timers
-    while (!pImpl->mTimerHeap.empty()) {
-        const auto& next_timer = pImpl->mTimerHeap.top();
+        if (next_tick == UINT64_MAX) {
+            return Timer::Duration::zero();
+        }
 
-        // Check if this timer has expired
-        if (next_timer->mExpiryTime <= current_time) {
-            // Store the callback for later execution
-            if (next_timer->mCallback) {
-                callbacks_to_execute.push_back(next_timer->mCallback);
-            }
+        auto next_expiry = mStartTime + Timer::Duration(next_tick);
+        auto current_time = std::chrono::steady_clock::now();
+        if (next_expiry <= current_time) {
+            return Timer::Duration::zero();
+        }
 
-            // If it's a repeating timer, prepare to re-add it
-            if (next_timer->mIsRepeating) {
-                auto new_expiry = current_time + next_timer->mRepeatInterval;
-                auto new_timer = std::make_unique<Impl::TimerNode>(
-                    new_expiry,
-                    next_timer->mCallback,
-                    next_timer->mTimerId,
-                    true,
-                    next_timer->mRepeatInterval
-                );
-                repeating_timers_to_readd.push_back(std::move(new_timer));
+        // Round up so sleeping for the returned time never wakes before the expiry
+        return std::chrono::ceil<Timer::Duration>(next_expiry - current_time);
+    }
+
+    Timer::Backend getBackend() const override {
+        return Timer::Backend::TimingWheel;
+    }
+
+private:
+    static uint64_t levelIndex(uint64_t tick, int level) {
+        return (tick >> (kLevel0Bits + (level - 1) * kLevelBits)) & (kLevelSize - 1);
+    }
+
+    uint64_t elapsedTicks(TimePoint time) const {
+        if (time <= mStartTime) {
+            return 0;
+        }
+        return static_cast<uint64_t>(std::chrono::duration_cast<Timer::Duration>(time - mStartTime).count());
+    }
+
+    // Round up so a timer never fires before its expiry time
+    uint64_t deadlineTick(TimePoint expiry) const {
+        if (expiry <= mStartTime) {
+            return 0;
+        }
+        auto elapsed = expiry - mStartTime;
+        auto ticks = std::chrono::duration_cast<Timer::Duration>(elapsed);
+        if (ticks < elapsed) {
+            ticks += Timer::Duration(1);
+        }
+        return static_cast<uint64_t>(ticks.count());
+    }
+
+    uint64_t makeTimerId(const TimerNode* node) const {
+        return (static_cast<uint64_t>(node->mGeneration) << 32) | (static_cast<uint64_t>(node->mIndex) + 1);
+    }
+
+    TimerNode* lookupNode(uint64_t timer_id) const {
+        uint64_t slot_id = timer_id & 0xffffffffu;
+        if (slot_id == 0) {
+            return nullptr;
+        }
+
+        uint64_t index = slot_id - 1;
+        if (index >= mSlabChunks.size() * kSlabChunkSize) {
+            return nullptr;
+        }
+
+        TimerNode* node = &mSlabChunks[index / kSlabChunkSize][index % kSlabChunkSize];
+        if (node->mGeneration != static_cast<uint32_t>(timer_id >> 32) || node->mState == NodeState::Free) {
+            return nullptr;
+        }
+        return node;
+    }
+
+    TimerNode* allocateNode() {
+        if (!mFreeList) {
+            auto chunk = std::make_unique<TimerNode[]>(kSlabChunkSize);
+            uint32_t base = static_cast<uint32_t>(mSlabChunks.size() * kSlabChunkSize);
+            // Thread the new chunk onto the free list in index order
+            for (size_t i = kSlabChunkSize; i-- > 0;) {
+                chunk[i].mIndex = base + static_cast<uint32_t>(i);
+                chunk[i].mNext = mFreeList;
+                mFreeList = &chunk[i];
             }
+            mSlabChunks.push_back(std::move(chunk));
+        }
+
+        TimerNode* node = mFreeList;
+        mFreeList = node->mNext;
+        node->mPrev = nullptr;
+        node->mNext = nullptr;
+        return node;
+    }
 
-            // Timer has expired, remove it from heap
-            pImpl->mTimerHeap.pop();
+    void releaseNode(TimerNode* node) {
+        node->mCallback = nullptr;
+        node->mState = NodeState::Free;
+        node->mIsRepeating = false;
+        ++node->mGeneration;
+        node->mSlot = nullptr;
+        node->mPrev = nullptr;
+        node->mNext = mFreeList;
+        mFreeList = node;
+    }
+
+    Slot& slotFor(uint64_t deadline) {
+        uint64_t delta = deadline - mCurrentTick;
+
+        if (delta < kLevel0Size) {
+            return mLevel0[deadline & (kLevel0Size - 1)];
+        }
+
+        // Timers beyond the wheel's range wait in the last level and are re-cascaded
+        if (delta >= kMaxTicks) {
+            deadline = mCurrentTick + kMaxTicks - 1;
+            delta = kMaxTicks - 1;
+        }
+
+        int level = 1;
+        while (level < kLevelCount - 1 && delta >= (kLevel0Size << (level * kLevelBits))) {
+            ++level;
+        }
+        return mUpperLevels[level - 1][levelIndex(deadline, level)];
+    }
+
+    void insertNode(TimerNode* node) {
+        if (node->mDeadlineTick < mCurrentTick) {
+            node->mDeadlineTick = mCurrentTick;
+        }
+
+        Slot& slot = slotFor(node->mDeadlineTick);
+        node->mSlot = &slot;
+        node->mPrev = nullptr;
+        node->mNext = slot.mHead;
+        if (slot.mHead) {
+            slot.mHead->mPrev = node;
+        }
+        slot.mHead = node;
+    }
+
+    void unlinkNode(TimerNode* node) {
+        if (node->mPrev) {
+            node->mPrev->mNext = node->mNext;
         } else {
-            // This timer (and all subsequent timers) haven't expired yet
-            break;
+            node->mSlot->mHead = node->mNext;
+        }
+        if (node->mNext) {
+            node->mNext->mPrev = node->mPrev;
+        }
+        node->mPrev = nullptr;
+        node->mNext = nullptr;
+        node->mSlot = nullptr;
+    }
+
+    // Move every timer of the upper-level slots that begin at this tick down the hierarchy
+    void cascade(uint64_t tick) {
+        for (int level = 1; level < kLevelCount; ++level) {
+            uint64_t index = levelIndex(tick, level);
+            Slot& slot = mUpperLevels[level - 1][index];
+
+            TimerNode* node = slot.mHead;
+            slot.mHead = nullptr;
+            while (node) {
+                TimerNode* next = node->mNext;
+                insertNode(node);
+                node = next;
+            }
+
+            // Only continue upwards when this level wrapped around as well
+            if (index != 0) {
+                break;
+            }
         }
     }
 
-    // Re-add repeating timers before executing callbacks
-    for (auto& timer : repeating_timers_to_readd) {
-        pImpl->mTimerHeap.push(std::move(timer));
+    void collectSlot(Slot& slot, uint64_t tick, std::vector<TimerNode*>& due) {
+        TimerNode* node = slot.mHead;
+        slot.mHead = nullptr;
+        while (node) {
+            TimerNode* next = node->mNext;
+            node->mPrev = nullptr;
+            node->mNext = nullptr;
+            node->mSlot = nullptr;
+            if (node->mDeadlineTick > tick) {
+                insertNode(node);
+            } else {
+                node->mState = NodeState::Due;
+                due.push_back(node);
+            }
+            node = next;
+        }
+    }
+
+    static uint64_t minDeadline(const Slot& slot) {
+        uint64_t result = UINT64_MAX;
+        for (const TimerNode* node = slot.mHead; node; node = node->mNext) {
+            result = std::min(result, node->mDeadlineTick);
+        }
+        return result;
     }
+};
+
+// Timer class implementation
+Timer::Timer(Backend backend) {
+    if (backend == Backend::TimingWheel) {
+        pImpl = std::make_unique<Impl::WheelBackend>();
+    } else {
+        pImpl = std::make_unique<Impl::HeapBackend>();
+    }
+}
+
+Timer::~Timer() = default;
+
+Timer::Timer(Timer&&) noexcept = default;
+
+Timer& Timer::operator=(Timer&&) noexcept = default;
+
+uint64_t Timer::addTimer(const Duration& duration, Callback callback) {
+    return pImpl->addTimer(duration, std::move(callback), false, TimerOptions());
+}
+
+uint64_t Timer::addRepeatingTimer(const Duration& interval, Callback callback) {
+    return addRepeatingTimer(interval, std::move(callback), TimerOptions());
+}
 
-    // Second pass: execute all callbacks after heap manipulation is complete
-    // This ensures that any new timers added in callbacks won't interfere with current update
-    for (const auto& callback : callbacks_to_execute) {
-        callback();
+uint64_t Timer::addTimer(const Duration& duration, Callback callback, const TimerOptions& options) {
+    return pImpl->addTimer(duration, std::move(callback), false, options);
+}
+
+uint64_t Timer::addRepeatingTimer(const Duration& interval, Callback callback, const TimerOptions& options) {
+    // A timer that is due again as soon as it fired would spin update() forever
+    if (interval <= Duration::zero()) {
+        return 0;
     }
+    return pImpl->addTimer(interval, std::move(callback), true, options);
+}
+
+uint64_t Timer::addTimer(const std::chrono::seconds& duration, Callback callback) {
+    auto duration_ms = std::chrono::duration_cast<Duration>(duration);
+    return addTimer(duration_ms, std::move(callback));
+}
+
+uint64_t Timer::addRepeatingTimer(const std::chrono::seconds& interval, Callback callback) {
+    auto interval_ms = std::chrono::duration_cast<Duration>(interval);
+    return addRepeatingTimer(interval_ms, std::move(callback));
+}
+
+bool Timer::removeTimer(uint64_t timer_id) {
+    return pImpl->removeTimer(timer_id);
+}
+
+void Timer::update() {
+    pImpl->update();
 }
 
 size_t Timer::getActiveTimerCount() const {
-    return pImpl->mTimerHeap.size();
+    return pImpl->getActiveTimerCount();
 }
 
 bool Timer::hasActiveTimers() const {
-    return !pImpl->mTimerHeap.empty();
+    return pImpl->getActiveTimerCount() > 0;
 }
 
 Timer::Duration Timer::getTimeToNextTimer() const {
-    if (pImpl->mTimerHeap.empty()) {
-        return Duration::zero();
-    }
-
-    auto current_time = std::chrono::steady_clock::now();
-    auto next_expiry = pImpl->mTimerHeap.top()->mExpiryTime;
-    if (next_expiry <= current_time) {
-        return Duration::zero(); // Timer has already expired
-    }
+    return pImpl->getTimeToNextTimer();
+}
 
-    return std::chrono::duration_cast<Duration>(next_expiry - current_time);
+Timer::Backend Timer::getBackend() const {
+    return pImpl->getBackend();
 }
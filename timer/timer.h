@@ -1,21 +1,43 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 
+// Per-timer scheduling options
+struct TimerOptions {
+    // What a repeating timer does when one or more periods were missed
+    enum class RepeatPolicy {
+        CatchUp,  // Fire once for every missed period until back on schedule
+        Skip      // Drop missed periods and resume at the next future deadline
+    };
+
+    // Allowed lateness. Expirations are aligned within [deadline, deadline + slack] so that
+    // timers with overlapping windows share a single wake-up.
+    std::chrono::milliseconds slack{0};
+
+    RepeatPolicy repeatPolicy = RepeatPolicy::Skip;
+};
+
 class Timer {
 public:
     using Callback = std::function<void()>;
     using Duration = std::chrono::milliseconds;
 
+    // Timer queue implementation, selected at construction
+    enum class Backend {
+        Heap,        // Binary min-heap: exact ordering, O(n log n) removal
+        TimingWheel  // Hierarchical timing wheel: O(1) add/remove, 1 ms resolution
+    };
+
 private:
     // Forward declaration of implementation class
     class Impl;
     std::unique_ptr<Impl> pImpl;
 
 public:
-    Timer();
+    explicit Timer(Backend backend = Backend::Heap);
     ~Timer();
 
     // Explicitly defaulted move operations (copy is implicitly deleted due to unique_ptr)
@@ -25,9 +47,17 @@ public:
     // Add a timer that expires after the specified duration
     uint64_t addTimer(const Duration& duration, Callback callback);
 
-    // Add a repeating timer that fires repeatedly at the specified interval
+    // Add a repeating timer that fires repeatedly at the specified interval. Returns 0, which is
+    // never a valid timer id, when the interval is not positive.
     uint64_t addRepeatingTimer(const Duration& interval, Callback callback);
 
+    // Add a timer with explicit scheduling options (slack for wake-up coalescing)
+    uint64_t addTimer(const Duration& duration, Callback callback, const TimerOptions& options);
+
+    // Add a repeating timer with explicit scheduling options. Repeating timers are always scheduled
+    // from their ideal previous deadline, so periods do not drift with processing delay.
+    uint64_t addRepeatingTimer(const Duration& interval, Callback callback, const TimerOptions& options);
+
     // Add a timer that expires after the specified duration in seconds
     uint64_t addTimer(const std::chrono::seconds& duration, Callback callback);
 
@@ -48,4 +78,7 @@ public:
 
     // Get time until next timer expires (returns 0 if no timers or timer already expired)
     Duration getTimeToNextTimer() const;
+
+    // Get the backend this timer was constructed with
+    Backend getBackend() const;
 };
@@ -0,0 +1,188 @@
+#include "timer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Session-timeout style workload: many timers are armed, almost all are cancelled
+// before they expire, and the survivors fire. Heap and timing wheel are compared
+// phase by phase.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kDefaultTimerCount = 100000;
+constexpr double kCancelRatio = 0.9;
+constexpr int kMaxTimeoutMs = 1000;
+
+// Heap removal rebuilds the whole queue, so only samples are timed and the rest is extrapolated.
+// The cost shrinks with the heap, so the cancel sequence is split into stages and each stage is
+// sampled on a heap holding the timers still armed halfway through it.
+constexpr size_t kHeapCancelStages = 8;
+constexpr size_t kHeapCancelSample = 50;
+
+struct PhaseResult {
+    double mAddMs = 0.0;
+    double mCancelMs = 0.0;
+    bool mCancelEstimated = false;
+    double mExpireMs = 0.0;
+    size_t mFired = 0;
+};
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double timeHeapCancels(const std::vector<int>& timeouts, const std::vector<size_t>& cancel_order, size_t first,
+                       size_t count) {
+    std::vector<bool> armed(timeouts.size(), true);
+    for (size_t i = 0; i < first; ++i) {
+        armed[cancel_order[i]] = false;
+    }
+
+    Timer timer(Timer::Backend::Heap);
+    std::vector<uint64_t> ids(timeouts.size());
+    for (size_t i = 0; i < timeouts.size(); ++i) {
+        if (armed[i]) {
+            ids[i] = timer.addTimer(std::chrono::milliseconds(timeouts[i]), []() {});
+        }
+    }
+
+    auto start = Clock::now();
+    for (size_t i = first; i < first + count; ++i) {
+        timer.removeTimer(ids[cancel_order[i]]);
+    }
+    return elapsedMs(start);
+}
+
+double estimateHeapCancelMs(const std::vector<int>& timeouts, const std::vector<size_t>& cancel_order,
+                            size_t cancel_count) {
+    double total_ms = 0.0;
+    for (size_t stage = 0; stage < kHeapCancelStages; ++stage) {
+        size_t begin = cancel_count * stage / kHeapCancelStages;
+        size_t end = cancel_count * (stage + 1) / kHeapCancelStages;
+        if (begin == end) {
+            continue;
+        }
+        size_t middle = (begin + end) / 2;
+        size_t sample = std::min(end - middle, kHeapCancelSample);
+        total_ms += timeHeapCancels(timeouts, cancel_order, middle, sample) * static_cast<double>(end - begin) /
+                    static_cast<double>(sample);
+    }
+    return total_ms;
+}
+
+// Run update() until every remaining timer fired, accumulating only the time spent inside update()
+double drainTimers(Timer& timer) {
+    double update_ms = 0.0;
+    auto deadline = Clock::now() + std::chrono::milliseconds(kMaxTimeoutMs * 2);
+    while (timer.hasActiveTimers() && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        auto start = Clock::now();
+        timer.update();
+        update_ms += elapsedMs(start);
+    }
+    return update_ms;
+}
+
+PhaseResult runBenchmark(Timer::Backend backend, const std::vector<int>& timeouts, const std::vector<size_t>& cancel_order,
+                         size_t cancel_count) {
+    PhaseResult result;
+    Timer timer(backend);
+    std::vector<uint64_t> ids(timeouts.size());
+    auto callback = [&result]() { ++result.mFired; };
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < timeouts.size(); ++i) {
+        ids[i] = timer.addTimer(std::chrono::milliseconds(timeouts[i]), callback);
+    }
+    result.mAddMs = elapsedMs(start);
+
+    if (backend == Timer::Backend::Heap) {
+        result.mCancelEstimated = cancel_count > kHeapCancelStages * kHeapCancelSample;
+        result.mCancelMs = result.mCancelEstimated ? estimateHeapCancelMs(timeouts, cancel_order, cancel_count)
+                                                   : timeHeapCancels(timeouts, cancel_order, 0, cancel_count);
+
+        // Expire phase runs on a heap that only holds the survivors
+        timer = Timer(backend);
+        std::vector<bool> cancelled(timeouts.size(), false);
+        for (size_t i = 0; i < cancel_count; ++i) {
+            cancelled[cancel_order[i]] = true;
+        }
+        for (size_t i = 0; i < timeouts.size(); ++i) {
+            if (!cancelled[i]) {
+                timer.addTimer(std::chrono::milliseconds(timeouts[i]), callback);
+            }
+        }
+    } else {
+        start = Clock::now();
+        for (size_t i = 0; i < cancel_count; ++i) {
+            timer.removeTimer(ids[cancel_order[i]]);
+        }
+        result.mCancelMs = elapsedMs(start);
+    }
+
+    result.mExpireMs = drainTimers(timer);
+    return result;
+}
+
+void printResult(const std::string& name, const PhaseResult& result, size_t timer_count, size_t cancel_count) {
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::left << std::setw(14) << name
+              << " add: " << std::setw(10) << result.mAddMs << " ms ("
+              << std::setw(8) << (result.mAddMs * 1e6 / timer_count) << " ns/op)"
+              << " cancel: " << std::setw(12) << result.mCancelMs << " ms ("
+              << std::setw(10) << (cancel_count ? result.mCancelMs * 1e6 / cancel_count : 0.0) << " ns/op)"
+              << (result.mCancelEstimated ? " (estimated)" : "            ")
+              << " expire: " << std::setw(8) << result.mExpireMs << " ms"
+              << " fired: " << result.mFired << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t timer_count = kDefaultTimerCount;
+    if (argc > 1) {
+        timer_count = static_cast<size_t>(std::strtoull(argv[1], nullptr, 10));
+    }
+    size_t cancel_count = static_cast<size_t>(static_cast<double>(timer_count) * kCancelRatio);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> timeout_dist(1, kMaxTimeoutMs);
+    std::vector<int> timeouts(timer_count);
+    for (auto& timeout : timeouts) {
+        timeout = timeout_dist(rng);
+    }
+
+    std::vector<size_t> cancel_order(timer_count);
+    for (size_t i = 0; i < timer_count; ++i) {
+        cancel_order[i] = i;
+    }
+    std::shuffle(cancel_order.begin(), cancel_order.end(), rng);
+
+    std::cout << "=== Timer Benchmark ===" << std::endl;
+    std::cout << "Timers: " << timer_count << ", cancelled: " << cancel_count
+              << ", timeouts: 1-" << kMaxTimeoutMs << " ms" << std::endl;
+
+    auto heap = runBenchmark(Timer::Backend::Heap, timeouts, cancel_order, cancel_count);
+    printResult("Heap", heap, timer_count, cancel_count);
+
+    auto wheel = runBenchmark(Timer::Backend::TimingWheel, timeouts, cancel_order, cancel_count);
+    printResult("TimingWheel", wheel, timer_count, cancel_count);
+
+    if (wheel.mCancelMs > 0.0) {
+        std::cout << "Cancel speedup (wheel vs heap): " << std::setprecision(1) << heap.mCancelMs / wheel.mCancelMs << "x"
+                  << (heap.mCancelEstimated ? " (heap cancel time estimated from sampled stages)" : "") << std::endl;
+    }
+
+    size_t expected = timer_count - cancel_count;
+    bool passed = heap.mFired == expected && wheel.mFired == expected;
+    std::cout << "Fired count check: " << (passed ? "PASSED" : "FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "timer.h"
+
+// Deadline arithmetic shared by Timer and TimerService (internal header)
+namespace timer_schedule {
+
+using Clock = std::chrono::steady_clock;
+
+// Pick the latest point of [deadline, deadline + slack] that lies on a power-of-two
+// nanosecond grid no coarser than the slack. Grids of different slacks nest, so timers
+// whose windows overlap tend to land on the same instant and expire together. Used where
+// timers cannot be harvested early (the timing wheel); sorted queues instead order by
+// deadline + slack and expire everything whose window has opened.
+inline Clock::time_point coalesce(Clock::time_point deadline, std::chrono::milliseconds slack) {
+    if (slack <= std::chrono::milliseconds::zero()) {
+        return deadline;
+    }
+
+    int64_t slack_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(slack).count();
+    int64_t granularity = 1;
+    while (granularity <= slack_ns / 2) {
+        granularity *= 2;
+    }
+
+    int64_t latest = std::chrono::duration_cast<std::chrono::nanoseconds>((deadline + slack).time_since_epoch()).count();
+    int64_t aligned = latest - (latest % granularity);
+    return Clock::time_point(std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(aligned)));
+}
+
+// Next ideal deadline of a repeating timer, computed from the previous ideal deadline
+// rather than from the time the callback actually ran. Timers with a non-positive interval are
+// rejected when added; the guard only keeps this function total.
+inline Clock::time_point nextDeadline(Clock::time_point ideal, std::chrono::milliseconds interval, Clock::time_point now,
+                                      TimerOptions::RepeatPolicy policy) {
+    if (interval <= std::chrono::milliseconds::zero()) {
+        return now;
+    }
+
+    Clock::time_point next = ideal + interval;
+    if (policy == TimerOptions::RepeatPolicy::Skip && next <= now) {
+        auto missed = (now - next) / interval + 1;
+        next += missed * interval;
+    }
+    return next;
+}
+
+}  // namespace timer_schedule
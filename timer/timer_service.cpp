@@ -0,0 +1,429 @@
+#include "timer_service.h"
+#include "timer_schedule.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+class TimerService::Impl {
+public:
+    // steady_clock is CLOCK_MONOTONIC on Linux, so deadlines map directly onto the timerfd clock
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    enum class CommandType { Add, Cancel };
+
+    // Request handed from producer threads to the service loop
+    struct Command {
+        CommandType mType;
+        uint64_t mTimerId;
+        TimePoint mIdealTime;
+        Duration mRepeatInterval;
+        bool mIsRepeating;
+        TimerOptions mOptions;
+        Callback mCallback;
+        Command* mNext = nullptr;
+    };
+
+    struct TimerEntry {
+        TimePoint mExpiryTime;  // Latest allowed expiry (deadline + slack); the timerfd is armed with it
+        TimePoint mIdealTime;   // Requested deadline; repeating timers are scheduled from it
+        Duration mRepeatInterval;
+        bool mIsRepeating;
+        TimerOptions mOptions;
+        Callback mCallback;
+    };
+
+    struct DeadlineEntry {
+        TimePoint mExpiryTime;
+        uint64_t mTimerId;
+    };
+
+    struct DeadlineComparator {
+        bool operator()(const DeadlineEntry& a, const DeadlineEntry& b) const {
+            return a.mExpiryTime > b.mExpiryTime;
+        }
+    };
+
+    Executor mExecutor;
+
+    // Lock-free MPSC command stack; the loop takes the whole list at once
+    std::atomic<Command*> mCommandHead{nullptr};
+    std::atomic<uint64_t> mNextTimerId{1};
+    std::atomic<bool> mRunning{false};
+    std::atomic<size_t> mActiveCount{0};
+    std::atomic<uint64_t> mWakeupCount{0};
+
+    // Lives as long as the Impl: a producer racing with stop() may still write to it
+    std::atomic<int> mEventFd{-1};
+    int mTimerFd = -1;
+    int mEpollFd = -1;
+    std::thread mThread;
+
+    // Owned by the service thread. Cancelled timers leave stale deadline entries behind,
+    // which are skipped when popped and purged when they outnumber the live ones.
+    std::priority_queue<DeadlineEntry, std::vector<DeadlineEntry>, DeadlineComparator> mDeadlines;
+    std::unordered_map<uint64_t, TimerEntry> mTimers;
+    TimePoint mArmedExpiry = TimePoint::max();
+
+    explicit Impl(Executor executor) : mExecutor(std::move(executor)) {}
+
+    ~Impl() {
+        stop();
+        freeCommands(mCommandHead.exchange(nullptr, std::memory_order_acquire));
+        int event_fd = mEventFd.exchange(-1);
+        if (event_fd >= 0) {
+            close(event_fd);
+        }
+    }
+
+    bool start() {
+        if (mRunning) {
+            return true;
+        }
+
+        mTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (mTimerFd < 0) {
+            perror("timerfd_create");
+            closeFds();
+            return false;
+        }
+
+        int event_fd = mEventFd.load();
+        if (event_fd < 0) {
+            event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (event_fd < 0) {
+                perror("eventfd");
+                closeFds();
+                return false;
+            }
+            mEventFd = event_fd;
+        }
+
+        mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (mEpollFd < 0) {
+            perror("epoll_create1");
+            closeFds();
+            return false;
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = mTimerFd;
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mTimerFd, &ev) < 0) {
+            perror("epoll_ctl timerfd");
+            closeFds();
+            return false;
+        }
+        ev.data.fd = event_fd;
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, event_fd, &ev) < 0) {
+            perror("epoll_ctl eventfd");
+            closeFds();
+            return false;
+        }
+
+        mArmedExpiry = TimePoint::max();
+        mRunning = true;
+        mThread = std::thread([this]() { loop(); });
+        return true;
+    }
+
+    void stop() {
+        if (!mRunning.exchange(false)) {
+            return;
+        }
+
+        wake();
+        if (mThread.joinable()) {
+            mThread.join();
+        }
+
+        closeFds();
+        mDeadlines = decltype(mDeadlines)();
+        mTimers.clear();
+        mActiveCount = 0;
+    }
+
+    uint64_t addTimer(const Duration& duration, Callback callback, bool repeating, const TimerOptions& options) {
+        auto* command = new Command();
+        command->mType = CommandType::Add;
+        command->mTimerId = mNextTimerId.fetch_add(1, std::memory_order_relaxed);
+        command->mIdealTime = Clock::now() + duration;
+        command->mRepeatInterval = duration;
+        command->mIsRepeating = repeating;
+        command->mOptions = options;
+        command->mCallback = std::move(callback);
+
+        uint64_t timer_id = command->mTimerId;
+        pushCommand(command);
+        return timer_id;
+    }
+
+    void cancelTimer(uint64_t timer_id) {
+        auto* command = new Command();
+        command->mType = CommandType::Cancel;
+        command->mTimerId = timer_id;
+        command->mIsRepeating = false;
+        pushCommand(command);
+    }
+
+private:
+    void pushCommand(Command* command) {
+        Command* head = mCommandHead.load(std::memory_order_relaxed);
+        do {
+            command->mNext = head;
+        } while (!mCommandHead.compare_exchange_weak(head, command, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+
+        // Only the push onto an empty queue needs to wake the loop
+        if (head == nullptr) {
+            wake();
+        }
+    }
+
+    void wake() {
+        int fd = mEventFd.load();
+        if (fd >= 0) {
+            uint64_t one = 1;
+            ssize_t ret = write(fd, &one, sizeof(one));
+            (void) ret;
+        }
+    }
+
+    // The eventfd is kept open until destruction so wake() never writes to a reused descriptor
+    void closeFds() {
+        if (mTimerFd >= 0) {
+            close(mTimerFd);
+            mTimerFd = -1;
+        }
+        if (mEpollFd >= 0) {
+            close(mEpollFd);
+            mEpollFd = -1;
+        }
+    }
+
+    static void freeCommands(Command* command) {
+        while (command) {
+            Command* next = command->mNext;
+            delete command;
+            command = next;
+        }
+    }
+
+    void loop() {
+        epoll_event events[2];
+
+        while (mRunning) {
+            processCommands();
+            dispatchExpired();
+            rearm();
+
+            int count = epoll_wait(mEpollFd, events, 2, -1);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("epoll_wait");
+                break;
+            }
+
+            for (int i = 0; i < count; ++i) {
+                uint64_t value = 0;
+                if (events[i].data.fd == mTimerFd) {
+                    if (read(mTimerFd, &value, sizeof(value)) == sizeof(value)) {
+                        mWakeupCount.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    // The armed deadline has been consumed
+                    mArmedExpiry = TimePoint::max();
+                } else {
+                    ssize_t ret = read(events[i].data.fd, &value, sizeof(value));
+                    (void) ret;
+                }
+            }
+        }
+    }
+
+    void processCommands() {
+        Command* list = mCommandHead.exchange(nullptr, std::memory_order_acquire);
+
+        // The stack is LIFO; reverse it so commands apply in submission order
+        Command* ordered = nullptr;
+        while (list) {
+            Command* next = list->mNext;
+            list->mNext = ordered;
+            ordered = list;
+            list = next;
+        }
+
+        for (Command* command = ordered; command; command = command->mNext) {
+            if (command->mType == CommandType::Add) {
+                TimePoint expiry_time = command->mIdealTime + command->mOptions.slack;
+                mDeadlines.push({expiry_time, command->mTimerId});
+                mTimers.emplace(command->mTimerId,
+                                TimerEntry{expiry_time, command->mIdealTime, command->mRepeatInterval,
+                                           command->mIsRepeating, command->mOptions, std::move(command->mCallback)});
+            } else {
+                mTimers.erase(command->mTimerId);
+            }
+        }
+        freeCommands(ordered);
+
+        if (mDeadlines.size() > 2 * mTimers.size() + 64) {
+            purgeStaleDeadlines();
+        }
+        mActiveCount = mTimers.size();
+    }
+
+    void purgeStaleDeadlines() {
+        std::vector<DeadlineEntry> live;
+        live.reserve(mTimers.size());
+        for (const auto& timer : mTimers) {
+            live.push_back({timer.second.mExpiryTime, timer.first});
+        }
+        mDeadlines = decltype(mDeadlines)(DeadlineComparator(), std::move(live));
+    }
+
+    // Pop deadline entries whose timer was cancelled or rescheduled
+    void skipStaleDeadlines() {
+        while (!mDeadlines.empty()) {
+            const auto& top = mDeadlines.top();
+            auto it = mTimers.find(top.mTimerId);
+            if (it != mTimers.end() && it->second.mExpiryTime == top.mExpiryTime) {
+                return;
+            }
+            mDeadlines.pop();
+        }
+    }
+
+    void dispatchExpired() {
+        auto current_time = Clock::now();
+        std::vector<Callback> callbacks_to_execute;
+
+        std::vector<DeadlineEntry> repeating_to_readd;
+
+        // Ordered by latest allowed expiry; expire from the top while the timer's window has opened
+        skipStaleDeadlines();
+        while (!mDeadlines.empty()) {
+            uint64_t timer_id = mDeadlines.top().mTimerId;
+            auto it = mTimers.find(timer_id);
+            TimerEntry& entry = it->second;
+            if (entry.mIdealTime > current_time) {
+                break;
+            }
+            mDeadlines.pop();
+
+            if (entry.mIsRepeating) {
+                callbacks_to_execute.push_back(entry.mCallback);
+                entry.mIdealTime = timer_schedule::nextDeadline(entry.mIdealTime, entry.mRepeatInterval, current_time,
+                                                                entry.mOptions.repeatPolicy);
+                entry.mExpiryTime = entry.mIdealTime + entry.mOptions.slack;
+                repeating_to_readd.push_back({entry.mExpiryTime, timer_id});
+            } else {
+                callbacks_to_execute.push_back(std::move(entry.mCallback));
+                mTimers.erase(it);
+            }
+            skipStaleDeadlines();
+        }
+
+        // Re-added after the scan so a catching-up timer fires once per dispatch
+        for (const auto& deadline : repeating_to_readd) {
+            mDeadlines.push(deadline);
+        }
+        mActiveCount = mTimers.size();
+
+        for (auto& callback : callbacks_to_execute) {
+            if (!callback) {
+                continue;
+            }
+            if (mExecutor) {
+                mExecutor(std::move(callback));
+            } else {
+                callback();
+            }
+        }
+    }
+
+    void rearm() {
+        skipStaleDeadlines();
+        TimePoint next_expiry = mDeadlines.empty() ? TimePoint::max() : mDeadlines.top().mExpiryTime;
+        if (next_expiry == mArmedExpiry) {
+            return;
+        }
+
+        itimerspec spec{};
+        if (next_expiry != TimePoint::max()) {
+            auto since_epoch = next_expiry.time_since_epoch();
+            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+            auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds);
+            spec.it_value.tv_sec = static_cast<time_t>(seconds.count());
+            spec.it_value.tv_nsec = static_cast<long>(nanoseconds.count());
+            if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+                // A zero it_value would disarm the timer
+                spec.it_value.tv_nsec = 1;
+            }
+        }
+
+        if (timerfd_settime(mTimerFd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+            perror("timerfd_settime");
+            return;
+        }
+        mArmedExpiry = next_expiry;
+    }
+};
+
+TimerService::TimerService(Executor executor) : mImpl(std::make_unique<Impl>(std::move(executor))) {
+}
+
+TimerService::~TimerService() = default;
+
+bool TimerService::start() {
+    return mImpl->start();
+}
+
+void TimerService::stop() {
+    mImpl->stop();
+}
+
+bool TimerService::isRunning() const {
+    return mImpl->mRunning;
+}
+
+uint64_t TimerService::addTimer(const Duration& duration, Callback callback) {
+    return mImpl->addTimer(duration, std::move(callback), false, TimerOptions());
+}
+
+uint64_t TimerService::addRepeatingTimer(const Duration& interval, Callback callback) {
+    return addRepeatingTimer(interval, std::move(callback), TimerOptions());
+}
+
+uint64_t TimerService::addTimer(const Duration& duration, Callback callback, const TimerOptions& options) {
+    return mImpl->addTimer(duration, std::move(callback), false, options);
+}
+
+uint64_t TimerService::addRepeatingTimer(const Duration& interval, Callback callback, const TimerOptions& options) {
+    // A timer that is due again as soon as it fired would keep the service thread spinning
+    if (interval <= Duration::zero()) {
+        return 0;
+    }
+    return mImpl->addTimer(interval, std::move(callback), true, options);
+}
+
+void TimerService::cancelTimer(uint64_t timer_id) {
+    mImpl->cancelTimer(timer_id);
+}
+
+size_t TimerService::getActiveTimerCount() const {
+    return mImpl->mActiveCount;
+}
+
+uint64_t TimerService::getWakeupCount() const {
+    return mImpl->mWakeupCount.load(std::memory_order_relaxed);
+}
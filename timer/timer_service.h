@@ -0,0 +1,60 @@
+#pragma once
+
+#include "timer.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+// Thread-safe timer service with its own event loop.
+//
+// A dedicated thread blocks in epoll on a timerfd that is re-armed to the earliest
+// deadline, so the process only wakes up when a timer is actually due. Timers can be
+// added and cancelled from any thread; requests are handed to the loop through a
+// lock-free queue. Expired callbacks are passed to the executor, or run on the service
+// thread when no executor is configured.
+class TimerService {
+public:
+    using Callback = std::function<void()>;
+    using Duration = std::chrono::milliseconds;
+    using Executor = std::function<void(Callback)>;
+
+    explicit TimerService(Executor executor = nullptr);
+    ~TimerService();
+
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+
+    // Start the service thread; returns false if the timerfd/epoll setup failed
+    bool start();
+
+    // Stop the service thread; pending timers are discarded
+    void stop();
+
+    bool isRunning() const;
+
+    // Add a timer that expires after the specified duration (callable from any thread)
+    uint64_t addTimer(const Duration& duration, Callback callback);
+
+    // Add a repeating timer that fires at the specified interval (callable from any thread).
+    // Returns 0, which is never a valid timer id, when the interval is not positive.
+    uint64_t addRepeatingTimer(const Duration& interval, Callback callback);
+
+    // Variants with scheduling options; timers with slack are coalesced onto shared wake-ups
+    uint64_t addTimer(const Duration& duration, Callback callback, const TimerOptions& options);
+    uint64_t addRepeatingTimer(const Duration& interval, Callback callback, const TimerOptions& options);
+
+    // Request cancellation of a timer (callable from any thread, including callbacks).
+    // Takes effect asynchronously; a callback already handed to the executor still runs.
+    void cancelTimer(uint64_t timer_id);
+
+    // Number of timers currently armed in the service loop
+    size_t getActiveTimerCount() const;
+
+    // Number of timerfd expirations handled by the loop (useful to verify wake-up counts)
+    uint64_t getWakeupCount() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> mImpl;
+};
@@ -1,4 +1,7 @@
 #include "timer.h"
+#include "timer_service.h"
+#include "periodic_scheduler.h"
+#include <atomic>
 #include <iostream>
 #include <chrono>
 #include <thread>
@@ -14,6 +17,12 @@ public:
         testTimerOrdering();
         testSecondsAndMilliseconds();
         testRecursiveTimerAddition();
+        testTimingWheelBackend();
+        testTimerService();
+        testDriftFreeRepeatingTimers();
+        testSlackCoalescing();
+        testPeriodicScheduler();
+        testSimulatedClockScheduler();
 
         std::cout << "\n=== All Tests Completed ===" << std::endl;
     }
@@ -357,6 +366,408 @@ private:
 
         std::cout << "Recursive timer addition test: " << (test_passed ? "PASSED" : "FAILED") << std::endl;
     }
+
+    void testTimingWheelBackend() {
+        std::cout << "\n--- Test 6: Timing Wheel Backend ---" << std::endl;
+
+        Timer timer(Timer::Backend::TimingWheel);
+        std::vector<int> execution_order;
+        int repeat_count = 0;
+        bool cancelled_fired = false;
+        bool test_passed = true;
+
+        // Add timers in reverse chronological order, spanning more than one wheel level
+        timer.addTimer(std::chrono::milliseconds(400), [&]() { execution_order.push_back(3); });
+        timer.addTimer(std::chrono::milliseconds(50), [&]() { execution_order.push_back(1); });
+        timer.addTimer(std::chrono::milliseconds(150), [&]() { execution_order.push_back(2); });
+
+        auto cancelled_id = timer.addTimer(std::chrono::milliseconds(100), [&]() { cancelled_fired = true; });
+        uint64_t repeating_id = 0;
+        repeating_id = timer.addRepeatingTimer(std::chrono::milliseconds(60), [&]() {
+            if (++repeat_count == 3) {
+                // Cancelling a repeating timer from its own callback must be safe
+                timer.removeTimer(repeating_id);
+            }
+        });
+
+        std::cout << "Active timers: " << timer.getActiveTimerCount() << std::endl;
+
+        if (!timer.removeTimer(cancelled_id) || timer.removeTimer(cancelled_id)) {
+            std::cout << "ERROR: Timer removal should succeed exactly once!" << std::endl;
+            test_passed = false;
+        }
+
+        auto start_time = std::chrono::steady_clock::now();
+        while (timer.hasActiveTimers() && std::chrono::steady_clock::now() - start_time < std::chrono::seconds(1)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            timer.update();
+        }
+
+        std::cout << "Execution order: ";
+        for (int order : execution_order) {
+            std::cout << order << " ";
+        }
+        std::cout << "| Repeats: " << repeat_count << std::endl;
+
+        if (execution_order != std::vector<int>{1, 2, 3}) {
+            std::cout << "ERROR: Timers fired out of order!" << std::endl;
+            test_passed = false;
+        }
+        if (cancelled_fired) {
+            std::cout << "ERROR: Cancelled timer fired!" << std::endl;
+            test_passed = false;
+        }
+        if (repeat_count != 3 || timer.hasActiveTimers()) {
+            std::cout << "ERROR: Repeating timer should stop after 3 runs!" << std::endl;
+            test_passed = false;
+        }
+
+        // Right after the wheel processed tick 255 it sits on a level-1 boundary, where the
+        // 266 ms timer still waits in the slot that cascades next
+        auto before_create = std::chrono::steady_clock::now();
+        Timer boundary_timer(Timer::Backend::TimingWheel);
+        auto created = std::chrono::steady_clock::now();
+        boundary_timer.addTimer(std::chrono::milliseconds(266), []() {});
+        boundary_timer.addTimer(std::chrono::milliseconds(1000), []() {});
+
+        auto boundary = created + std::chrono::microseconds(255200);
+        std::this_thread::sleep_until(boundary - std::chrono::milliseconds(5));
+        while (std::chrono::steady_clock::now() < boundary) {
+        }
+        boundary_timer.update();
+        auto next = boundary_timer.getTimeToNextTimer();
+        auto latest = before_create + std::chrono::milliseconds(268) - std::chrono::steady_clock::now();
+
+        std::cout << "Time to next timer on the level boundary: "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(next).count() << "us" << std::endl;
+        if (next > latest) {
+            std::cout << "ERROR: Next timer missed on the level boundary!" << std::endl;
+            test_passed = false;
+        }
+
+        std::cout << "Timing wheel backend test: " << (test_passed ? "PASSED" : "FAILED") << std::endl;
+    }
+
+    void testTimerService() {
+        std::cout << "\n--- Test 7: Timer Service (timerfd event loop) ---" << std::endl;
+
+        std::atomic<int> executed_count{0};
+        std::atomic<int> executor_count{0};
+        std::atomic<bool> cancelled_fired{false};
+        bool test_passed = true;
+
+        // Executor that counts hand-offs and runs the callback inline
+        TimerService service([&](TimerService::Callback callback) {
+            executor_count++;
+            callback();
+        });
+
+        if (!service.start()) {
+            std::cout << "Timer service could not start (timerfd/epoll unavailable), skipping" << std::endl;
+            return;
+        }
+
+        // Add timers concurrently from several threads, all sharing four deadlines
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&, t]() {
+                for (int i = 0; i < 25; ++i) {
+                    service.addTimer(std::chrono::milliseconds(50 * (t + 1)), [&]() { executed_count++; });
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+
+        auto cancelled_id = service.addTimer(std::chrono::milliseconds(100), [&]() { cancelled_fired = true; });
+        service.cancelTimer(cancelled_id);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(350));
+
+        std::cout << "Executed: " << executed_count << ", via executor: " << executor_count
+                  << ", timerfd wake-ups: " << service.getWakeupCount()
+                  << ", active: " << service.getActiveTimerCount() << std::endl;
+
+        if (executed_count != 100 || executor_count != 100) {
+            std::cout << "ERROR: Expected 100 callbacks through the executor!" << std::endl;
+            test_passed = false;
+        }
+        if (cancelled_fired) {
+            std::cout << "ERROR: Cancelled timer fired!" << std::endl;
+            test_passed = false;
+        }
+        if (service.getActiveTimerCount() != 0) {
+            std::cout << "ERROR: No timers should remain active!" << std::endl;
+            test_passed = false;
+        }
+
+        // Repeating timer cancelled from its own callback
+        std::atomic<int> repeat_count{0};
+        std::atomic<uint64_t> repeating_id{0};
+        repeating_id = service.addRepeatingTimer(std::chrono::milliseconds(20), [&]() {
+            if (++repeat_count == 3) {
+                service.cancelTimer(repeating_id);
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (repeat_count != 3) {
+            std::cout << "ERROR: Repeating timer should stop after 3 runs, ran " << repeat_count << std::endl;
+            test_passed = false;
+        }
+
+        // A repeating timer without a positive interval would keep the service thread spinning
+        if (service.addRepeatingTimer(std::chrono::milliseconds(0), []() {}) != 0 ||
+            service.addRepeatingTimer(std::chrono::milliseconds(-5), []() {}) != 0 ||
+            service.getActiveTimerCount() != 0) {
+            std::cout << "ERROR: Non-positive repeat interval should be rejected!" << std::endl;
+            test_passed = false;
+        }
+
+        service.stop();
+        std::cout << "Timer service test: " << (test_passed ? "PASSED" : "FAILED") << std::endl;
+    }
+
+    void testDriftFreeRepeatingTimers() {
+        std::cout << "\n--- Test 8: Drift-Free Repeating Timers ---" << std::endl;
+
+        bool test_passed = true;
+
+        for (auto backend : {Timer::Backend::Heap, Timer::Backend::TimingWheel}) {
+            const char* name = backend == Timer::Backend::Heap ? "Heap" : "TimingWheel";
+            Timer timer(backend);
+            int fire_count = 0;
+            auto start_time = std::chrono::steady_clock::now();
+
+            // Each callback takes 3ms; with rescheduling from "now" the period would stretch to 23ms
+            timer.addRepeatingTimer(std::chrono::milliseconds(20), [&]() {
+                fire_count++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(3));
+            });
+
+            while (fire_count < 10) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                timer.update();
+            }
+
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time).count();
+            std::cout << name << ": 10 periods of 20ms took " << elapsed << "ms" << std::endl;
+
+            if (elapsed >= 220) {
+                std::cout << "ERROR: " << name << " repeating timer drifted!" << std::endl;
+                test_passed = false;
+            }
+
+            // A repeating timer without a positive interval would be due again on every update()
+            if (timer.addRepeatingTimer(std::chrono::milliseconds(0), []() {}) != 0 ||
+                timer.addRepeatingTimer(std::chrono::seconds(-1), []() {}) != 0 || timer.getActiveTimerCount() != 1) {
+                std::cout << "ERROR: " << name << " should reject a non-positive repeat interval!" << std::endl;
+                test_passed = false;
+            }
+        }
+
+        // After a 55ms stall, CatchUp fires once per missed period while Skip resumes on schedule
+        for (auto policy : {TimerOptions::RepeatPolicy::CatchUp, TimerOptions::RepeatPolicy::Skip}) {
+            Timer timer;
+            int fire_count = 0;
+            TimerOptions options;
+            options.repeatPolicy = policy;
+            timer.addRepeatingTimer(std::chrono::milliseconds(10), [&]() { fire_count++; }, options);
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(55));
+            for (int i = 0; i < 10; ++i) {
+                timer.update();
+            }
+
+            bool catch_up = policy == TimerOptions::RepeatPolicy::CatchUp;
+            std::cout << (catch_up ? "CatchUp" : "Skip") << ": fired " << fire_count << " times after stall" << std::endl;
+            if ((catch_up && fire_count != 5) || (!catch_up && fire_count != 1)) {
+                std::cout << "ERROR: Unexpected repeat policy behaviour!" << std::endl;
+                test_passed = false;
+            }
+        }
+
+        std::cout << "Drift-free repeating timer test: " << (test_passed ? "PASSED" : "FAILED") << std::endl;
+    }
+
+    void testSlackCoalescing() {
+        std::cout << "\n--- Test 9: Slack Window Coalescing ---" << std::endl;
+
+        bool test_passed = true;
+
+        // Heap: a 100ms timer with 50ms slack expires together with a 130ms timer
+        Timer timer;
+        std::vector<int> fired_at;
+        auto start_time = std::chrono::steady_clock::now();
+        auto elapsed_ms = [&]() {
+            return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time).count());
+        };
+        TimerOptions options;
+        options.slack = std::chrono::milliseconds(50);
+        timer.addTimer(std::chrono::milliseconds(100), [&]() { fired_at.push_back(elapsed_ms()); }, options);
+        timer.addTimer(std::chrono::milliseconds(130), [&]() { fired_at.push_back(elapsed_ms()); });
+
+        // Sleep exactly as long as the timer asks, as an idle owner loop would
+        int wakeups = 0;
+        while (timer.hasActiveTimers()) {
+            std::this_thread::sleep_for(timer.getTimeToNextTimer());
+            timer.update();
+            wakeups++;
+        }
+        std::cout << "Heap: fired at " << fired_at[0] << "ms and " << fired_at[1] << "ms with " << wakeups
+                  << " wake-up(s)" << std::endl;
+        if (wakeups != 1 || fired_at[0] < 100) {
+            std::cout << "ERROR: Timers within the slack window should share one wake-up!" << std::endl;
+            test_passed = false;
+        }
+
+        // Timer service: same scenario, counted in timerfd expirations
+        std::atomic<int> service_fired{0};
+        TimerService service;
+        if (service.start()) {
+            service.addTimer(std::chrono::milliseconds(100), [&]() { service_fired++; }, options);
+            service.addTimer(std::chrono::milliseconds(130), [&]() { service_fired++; });
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            std::cout << "TimerService: fired " << service_fired << " timers with " << service.getWakeupCount()
+                      << " wake-up(s)" << std::endl;
+            if (service_fired != 2 || service.getWakeupCount() != 1) {
+                std::cout << "ERROR: Timer service should coalesce both timers into one wake-up!" << std::endl;
+                test_passed = false;
+            }
+            service.stop();
+        }
+
+        std::cout << "Slack coalescing test: " << (test_passed ? "PASSED" : "FAILED") << std::endl;
+    }
+
+    void testPeriodicScheduler() {
+        std::cout << "\n--- Test 10: Deadline-Driven Periodic Scheduler ---" << std::endl;
+
+        bool test_passed = true;
+        const auto period = std::chrono::microseconds(4000);
+
+        for (auto method : {PeriodicSchedulerOptions::WaitMethod::TimerFd,
+                            PeriodicSchedulerOptions::WaitMethod::ClockNanosleep}) {
+            const char* name = method == PeriodicSchedulerOptions::WaitMethod::TimerFd ? "timerfd" : "clock_nanosleep";
+            PeriodicSchedulerOptions options;
+            options.waitMethod = method;
+            PeriodicScheduler scheduler(period, options);
+
+            // 1.5ms of work per tick; deadlines must stay on first + k * period. A scheduling
+            // hiccup may legitimately skip a period, so only require k to advance.
+            auto first = scheduler.waitNextTick();
+            auto previous = first;
+            bool on_grid = true;
+            for (int i = 0; i < 50; ++i) {
+                std::this_thread::sleep_for(std::chrono::microseconds(1500));
+                auto deadline = scheduler.waitNextTick();
+                on_grid = on_grid && deadline > previous &&
+                          (deadline - first) % period == std::chrono::steady_clock::duration::zero();
+                previous = deadline;
+            }
+            auto drift = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - (first + 50 * period)).count();
+
+            // Overrunning 3.5 periods passes at least three deadlines: the latest is delivered
+            // late and the ones before it are skipped instead of firing a burst
+            std::this_thread::sleep_for(period * 7 / 2);
+            auto after_overrun = scheduler.waitNextTick();
+            auto stats = scheduler.getStats();
+
+            std::cout << name << ": 50 ticks ended " << drift << "us after the ideal time, lateness p50 "
+                      << stats.p50LatenessUs << "us p99 " << stats.p99LatenessUs << "us, missed "
+                      << stats.missedTicks << " after overrun" << std::endl;
+            if (!on_grid || (after_overrun - first) % period != std::chrono::steady_clock::duration::zero()) {
+                std::cout << "ERROR: " << name << " deadlines left the period grid!" << std::endl;
+                test_passed = false;
+            }
+            // Every period between the first and last tick was either delivered or counted as missed
+            auto periods = static_cast<uint64_t>((after_overrun - first) / period);
+            if (stats.ticks != 52 || stats.missedTicks < 2 || periods != stats.ticks - 1 + stats.missedTicks) {
+                std::cout << "ERROR: " << name << " expected 52 ticks and at least 2 missed over " << periods
+                          << " periods, got " << stats.ticks << " and " << stats.missedTicks << std::endl;
+                test_passed = false;
+            }
+        }
+
+        // Phase alignment: ticks land on anchor + offset + k * period
+        PeriodicSchedulerOptions options;
+        options.phaseOffset = std::chrono::microseconds(-500);
+        PeriodicScheduler scheduler(period, options);
+        scheduler.waitNextTick();
+        auto anchor = std::chrono::steady_clock::now() + std::chrono::microseconds(1234);
+        scheduler.alignPhase(anchor);
+        auto aligned = scheduler.waitNextTick();
+        auto phase = (aligned - (anchor + options.phaseOffset)) % period;
+        std::cout << "Phase-aligned tick is " << std::chrono::duration_cast<std::chrono::nanoseconds>(phase).count()
+                  << "ns off the anchor grid" << std::endl;
+        if (phase != std::chrono::steady_clock::duration::zero()) {
+            std::cout << "ERROR: Tick not aligned to the requested phase!" << std::endl;
+            test_passed = false;
+        }
+
+        std::cout << "Periodic scheduler test: " << (test_passed ? "PASSED" : "FAILED") << std::endl;
+    }
+
+    void testSimulatedClockScheduler() {
+        std::cout << "\n--- Test 11: Periodic Scheduler on a Simulated Clock ---" << std::endl;
+
+        bool test_passed = true;
+        const auto period = std::chrono::microseconds(8333);
+        const auto start = std::chrono::steady_clock::time_point() + std::chrono::seconds(10);
+
+        PeriodicSchedulerOptions options;
+        options.simulatedClock = std::make_shared<SimulatedClock>(start);
+        PeriodicScheduler scheduler(period, options);
+
+        // An hour of 120 Hz ticks, stepped in 100 ms slices; nothing may sleep
+        auto wall_start = std::chrono::steady_clock::now();
+        auto expected = start + period;
+        uint64_t ticks = 0;
+        bool on_grid = true;
+        for (auto until = start; until < start + std::chrono::hours(1);) {
+            until += std::chrono::milliseconds(100);
+            std::chrono::steady_clock::time_point deadline;
+            while (scheduler.pollNextTick(until, deadline)) {
+                on_grid = on_grid && deadline == expected && options.simulatedClock->now() == deadline;
+                expected += period;
+                ++ticks;
+            }
+            options.simulatedClock->advanceTo(until);
+        }
+        auto wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - wall_start).count();
+        auto stats = scheduler.getStats();
+
+        std::cout << "Simulated 1 h: " << ticks << " ticks in " << wall_ms << "ms wall time, max lateness "
+                  << stats.maxLatenessUs << "us" << std::endl;
+        if (!on_grid || stats.ticks != ticks || stats.maxLatenessUs != 0.0 || wall_ms > 5000) {
+            std::cout << "ERROR: Simulated ticks left the period grid or waited on real time!" << std::endl;
+            test_passed = false;
+        }
+
+        // waitNextTick() jumps the clock instead of sleeping; alignPhase() still applies
+        auto anchor = options.simulatedClock->now() + std::chrono::microseconds(1234);
+        scheduler.alignPhase(anchor);
+        auto aligned = scheduler.waitNextTick();
+        if ((aligned - anchor) % period != std::chrono::steady_clock::duration::zero() ||
+            options.simulatedClock->now() != aligned) {
+            std::cout << "ERROR: Simulated tick not aligned to the requested phase!" << std::endl;
+            test_passed = false;
+        }
+
+        // A scheduler on the real clock has nothing to poll
+        PeriodicScheduler real(period);
+        std::chrono::steady_clock::time_point unused;
+        if (real.pollNextTick(std::chrono::steady_clock::time_point::max(), unused)) {
+            std::cout << "ERROR: Real-time scheduler accepted a poll!" << std::endl;
+            test_passed = false;
+        }
+
+        std::cout << "Simulated clock scheduler test: " << (test_passed ? "PASSED" : "FAILED") << std::endl;
+    }
 };
 
 void demonstrateRealTimeUsage() {
@@ -1,10 +1,13 @@
 #include "TouchUpscaler.h"
+#include "UpscalerEngine.h"
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cmath>
 #include <condition_variable>
 #include <deque>
+#include <iostream>
 #include <mutex>
 #include <thread>
 
@@ -18,13 +21,6 @@
 
 using namespace std::chrono;
 namespace {
-struct TouchPoint {
-    steady_clock::time_point timestamp;
-    float x{0.0f};
-    float y{0.0f};
-    bool valid{false};
-};
-
 struct TouchInput {
     int x{0};
     int y{0};
@@ -43,6 +39,7 @@ class SingleTouchDevice : public InputBackend {
    private:
     int mUinputFd = -1;
     bool mPressed = false;
+    bool mWriteFailed = false;
 
    public:
     bool setup(const vtd::Config& cfg) override {
@@ -102,34 +99,39 @@ class SingleTouchDevice : public InputBackend {
         if (mUinputFd < 0)
             return;
 
-        struct input_event ev{};
-        gettimeofday(&ev.time, nullptr);
+        struct timeval now{};
+        gettimeofday(&now, nullptr);
+
+        // Build the whole frame and hand it to uinput with a single write()
+        struct input_event frame[4]{};
+        size_t count = 0;
+        auto add = [&](uint16_t type, uint16_t code, int32_t value) {
+            frame[count].time = now;
+            frame[count].type = type;
+            frame[count].code = code;
+            frame[count].value = value;
+            ++count;
+        };
 
         // Move pointer
-        ev.type = EV_ABS;
-        ev.code = ABS_X;
-        ev.value = point.x;
-        write(mUinputFd, &ev, sizeof(ev));
-        ev.type = EV_ABS;
-        ev.code = ABS_Y;
-        ev.value = point.y;
-        write(mUinputFd, &ev, sizeof(ev));
+        add(EV_ABS, ABS_X, point.x);
+        add(EV_ABS, ABS_Y, point.y);
 
         // Button press / release
         bool shouldPress = point.isDown;
         if (shouldPress != mPressed) {
-            ev.type = EV_KEY;
-            ev.code = BTN_LEFT;
-            ev.value = shouldPress ? 1 : 0;
-            write(mUinputFd, &ev, sizeof(ev));
+            add(EV_KEY, BTN_LEFT, shouldPress ? 1 : 0);
             mPressed = shouldPress;
         }
 
         // Frame sync
-        ev.type = EV_SYN;
-        ev.code = SYN_REPORT;
-        ev.value = 0;
-        write(mUinputFd, &ev, sizeof(ev));
+        add(EV_SYN, SYN_REPORT, 0);
+
+        ssize_t written = write(mUinputFd, frame, count * sizeof(frame[0]));
+        if (written != static_cast<ssize_t>(count * sizeof(frame[0])) && !mWriteFailed) {
+            perror("write uinput frame");
+            mWriteFailed = true;
+        }
     }
 };
 
@@ -160,10 +162,7 @@ Config Config::getDefault() {
 
 struct TouchUpscaler::Impl {
    public:
-    enum class State { Idle, Active, MaybeUp };
-
-    Impl(const Config& cfg) : mCfg(cfg) {
-        mHistory.reserve(10);
+    Impl(const Config& cfg) : mCfg(cfg), mScheduler(outputPeriod(cfg), schedulerOptions(cfg)), mEngine(cfg) {
         switch (cfg.backend) {
             case Backend::SingleTouchDevice:
                 mBackend = std::make_unique<SingleTouchDevice>();
@@ -189,79 +188,148 @@ struct TouchUpscaler::Impl {
 
         mRunning = true;
         mBackend->setup(mCfg);
-        mWorkerThread = std::thread(&Impl::runLoop, this);
+        if (!mCfg.simulatedClock) {
+            mWorkerThread = std::thread(&Impl::runLoop, this);
+        }
     }
 
     void stop() {
-        mRunning = false;
+        bool wasRunning = mRunning.exchange(false);
         if (mWorkerThread.joinable()) {
             mWorkerThread.join();
         }
+        if (wasRunning && mCfg.simulatedClock) {
+            release(now());
+        }
+        std::lock_guard<std::mutex> g(mInputMutex);
+        if (mDroppedSamples > 0) {
+            std::cerr << "TouchUpscaler: dropped " << mDroppedSamples << " input samples while the output thread stalled"
+                      << std::endl;
+            mDroppedSamples = 0;
+        }
     }
 
     void push(const TouchSample& raw) {
-        TouchPoint point = {.timestamp = steady_clock::now(), .x = raw.x, .y = raw.y, .valid = raw.valid};
+        PendingSample pending{raw, now()};
         {
             std::lock_guard<std::mutex> g(mInputMutex);
-            mLatestInput = point;
-            mHasNewInput = true;
+            if (mPendingCount == mPending.size()) {
+                ++mDroppedSamples;  // Output thread stalled for a whole queue of input
+                return;
+            }
+            mPending[mPendingCount++] = pending;
         }
     }
 
+    void setEventCallback(std::function<void(const TouchEvent&)> callback) { mEventCallback = callback; }
+
+    void alignOutputPhase(steady_clock::time_point vsync) { mScheduler.alignPhase(vsync); }
+
+    bool advanceClock(steady_clock::time_point until) {
+        if (!mCfg.simulatedClock || !mRunning) {
+            return false;
+        }
+        steady_clock::time_point tick;
+        while (mScheduler.pollNextTick(until, tick)) {
+            processTick(tick);
+        }
+        mCfg.simulatedClock->advanceTo(until);
+        return true;
+    }
+
+    PeriodicSchedulerStats getOutputTimingStats() const { return mScheduler.getStats(); }
+
    private:
+    struct PendingSample {
+        TouchSample sample;
+        steady_clock::time_point timestamp;
+    };
+
+    static steady_clock::duration outputPeriod(const Config& cfg) {
+        return duration_cast<steady_clock::duration>(duration<double>(1.0 / cfg.outputHz));
+    }
+
+    static PeriodicSchedulerOptions schedulerOptions(const Config& cfg) {
+        PeriodicSchedulerOptions options;
+        options.realtimePriority = cfg.realtimePriority;
+        options.phaseOffset = duration_cast<nanoseconds>(duration<double, std::milli>(cfg.outputPhaseOffsetMs));
+        options.simulatedClock = cfg.simulatedClock;
+        return options;
+    }
+
+    steady_clock::time_point now() const {
+        return mCfg.simulatedClock ? mCfg.simulatedClock->now() : steady_clock::now();
+    }
+
+    void emit(const TouchEvent& event) {
+        if (mEventCallback) {
+            mEventCallback(event);
+        }
+        TouchInput input;
+        input.x = static_cast<int>(event.x);
+        input.y = static_cast<int>(event.y);
+        input.isDown = event.type != TouchEventType::Up;
+        mBackend->emit(input);
+    }
+
     void runLoop() {
-        double period = 1.0 / mCfg.outputHz;
         while (mRunning) {
-            auto currentTick = steady_clock::now();
-
-            // 1. Check for new input
-            TouchPoint input;
-            bool hasInput = false;
-            {
-                std::lock_guard<std::mutex> lk(mInputMutex);
-                if (mHasNewInput) {
-                    input = mLatestInput;
-                    mHasNewInput = false;
-                    hasInput = true;
-                }
-            }
+            // Absolute deadlines: oversleeping one tick does not delay the following ones
+            processTick(mScheduler.waitNextTick());
+        }
 
-            if (hasInput) {  // process new input
-                if (input.valid) {
-                    if (mHistory.size() >= mCfg.historySize) {
-                        mHistory.erase(mHistory.begin());
-                    } else {
-                        mHistory.push_back(input);
-                    }
-                } else {
-                    // mState = State::MaybeUp; we can't just directly update the state?
-                }
-            }
+        // Release a finger that is still down
+        release(steady_clock::now());
+    }
+
+    // One output tick; on the output thread, or the caller of advanceClock() in virtual time
+    void processTick(steady_clock::time_point now) {
+        // 1. Take every sample since the last tick
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lk(mInputMutex);
+            count = mPendingCount;
+            std::copy(mPending.begin(), mPending.begin() + count, mBatch.begin());
+            mPendingCount = 0;
+        }
 
-            // 2. Update history if input is valid
+        // 2. Drive the state machine in arrival order, then emit this tick's event
+        TouchEvent event;
+        for (size_t i = 0; i < count; ++i) {
+            mEngine.addSample(mBatch[i].sample, mBatch[i].timestamp);
+        }
+        if (mEngine.tick(now, event)) {
+            emit(event);
+        }
+    }
 
-            auto nextTick = currentTick + std::chrono::duration_cast<steady_clock::duration>(duration<double>(period));
-            std::this_thread::sleep_until(nextTick);
+    void release(steady_clock::time_point releaseTime) {
+        TouchEvent event;
+        if (mEngine.release(releaseTime, event)) {
+            emit(event);
         }
     }
 
    private:
+    static constexpr size_t kPendingCapacity = 64;
+
     Config mCfg;
 
-    std::mutex mMutex;
     std::atomic<bool> mRunning{false};
     std::thread mWorkerThread;
     std::unique_ptr<InputBackend> mBackend;
+    PeriodicScheduler mScheduler;
+    std::function<void(const TouchEvent&)> mEventCallback;
 
+    // Samples pushed since the last tick; any thread may push
     std::mutex mInputMutex;
-    TouchPoint mLatestInput;
-    bool mHasNewInput = false;
-
-    // state management
-    State mState{State::Idle};
-    std::vector<TouchPoint> mHistory;
-    TouchPoint mLastOutput;
-    steady_clock::time_point mMaybeUpStart;
+    std::array<PendingSample, kPendingCapacity> mPending;
+    size_t mPendingCount = 0;
+    uint64_t mDroppedSamples = 0;
+
+    // Output thread only
+    UpscalerEngine mEngine;
+    std::array<PendingSample, kPendingCapacity> mBatch;
 };
 
 TouchUpscaler::TouchUpscaler(const Config& cfg) : mImpl(std::make_unique<Impl>(cfg)) {
@@ -281,4 +349,20 @@ void TouchUpscaler::push(const TouchSample& p) {
     mImpl->push(p);
 }
 
+void TouchUpscaler::setEventCallback(std::function<void(const TouchEvent&)> callback) {
+    mImpl->setEventCallback(callback);
+}
+
+void TouchUpscaler::alignOutputPhase(steady_clock::time_point vsync) {
+    mImpl->alignOutputPhase(vsync);
+}
+
+bool TouchUpscaler::advanceClock(steady_clock::time_point until) {
+    return mImpl->advanceClock(until);
+}
+
+PeriodicSchedulerStats TouchUpscaler::getOutputTimingStats() const {
+    return mImpl->getOutputTimingStats();
+}
+
 }  // namespace vtd
@@ -5,16 +5,29 @@
 #include <memory>
 #include <string>
 
+#include "periodic_scheduler.h"
+
 using namespace std::chrono;
 
 namespace vtd {
 
+// One sensor report in screen pixels; valid = false when the sensor sees no finger
 struct TouchSample {
     float x{0.0f};
     float y{0.0f};
     bool valid{false};
 };
 
+enum class TouchEventType { Down, Move, Up };
+
+// One output event, emitted on an output tick
+struct TouchEvent {
+    steady_clock::time_point timestamp;
+    float x{0.0f};
+    float y{0.0f};
+    TouchEventType type{TouchEventType::Move};
+};
+
 enum class Backend { SingleTouchDevice, Mock };
 
 struct Config {
@@ -25,8 +38,16 @@ struct Config {
     int screenHeight = 1080;
 
     double outputHz = 130.0;
+    int realtimePriority = 0;         // SCHED_FIFO priority of the output thread (0 = normal scheduling)
+    double outputPhaseOffsetMs = 0.0; // Tick offset from the anchor given to alignOutputPhase()
+    std::shared_ptr<SimulatedClock> simulatedClock;  // Run in virtual time: no output thread, ticks run in advanceClock()
 
-    size_t historySize = 6;
+    size_t historySize = 6;              // Valid samples kept for interpolation (ring, fixed capacity)
+    double interpolationDelayMs = 10.0;  // Render this far behind the tick; inside the history output is interpolated
+    double maxExtrapolationMs = 30.0;    // Past the newest sample, extrapolate at most this far, then hold
+    double liftDebounceMs = 30.0;        // Invalid samples for this long lift the finger (shorter dropouts are bridged)
+    double idleGraceMs = 100.0;          // Lift when no valid sample arrived for this long
+    double smoothing = 0.0;              // EMA weight of the previous output (0 = off, < 1)
 
     std::string deviceName = "IR Touch";
 
@@ -42,6 +63,20 @@ class TouchUpscaler {
     void stop();
     void push(const TouchSample& sample);
 
+    // Called on the output thread for every emitted event
+    void setEventCallback(std::function<void(const TouchEvent&)> callback);
+
+    // Align output ticks to a display vsync timestamp (callable from any thread)
+    void alignOutputPhase(steady_clock::time_point vsync);
+
+    // Simulated clock only: run every output tick up to until on the calling thread, then leave
+    // the clock at until. Pushed samples are stamped with the simulated time. Returns false
+    // when stopped or on the real clock.
+    bool advanceClock(steady_clock::time_point until);
+
+    // Wake-up cadence of the output thread (lateness percentiles, missed ticks)
+    PeriodicSchedulerStats getOutputTimingStats() const;
+
    private:
     class Impl;
     std::unique_ptr<Impl> mImpl;
@@ -0,0 +1,138 @@
+#include "UpscalerEngine.h"
+
+#include <algorithm>
+
+namespace vtd {
+
+namespace {
+steady_clock::duration fromMs(double ms) {
+    return duration_cast<steady_clock::duration>(duration<double, std::milli>(std::max(0.0, ms)));
+}
+}  // namespace
+
+UpscalerEngine::UpscalerEngine(const Config& cfg)
+    : mCfg(cfg),
+      mIdleGrace(fromMs(cfg.idleGraceMs)),
+      mLiftDebounce(fromMs(cfg.liftDebounceMs)),
+      mMaxExtrapolation(fromMs(cfg.maxExtrapolationMs)),
+      mInterpolationDelay(fromMs(cfg.interpolationDelayMs)),
+      mHistory(cfg.historySize) {
+    mCfg.smoothing = std::min(std::max(cfg.smoothing, 0.0), 0.99);
+}
+
+void UpscalerEngine::addSample(const TouchSample& sample, steady_clock::time_point timestamp) {
+    if (!sample.valid) {
+        if (mState == State::Active) {
+            mState = State::MaybeUp;
+            mMaybeUpStart = timestamp;
+        }
+        return;
+    }
+
+    // Samples closer than 0.1 ms carry no motion information and would break velocity estimates
+    if (!mHistory.empty() && timestamp - mHistory.back().timestamp < microseconds(100)) {
+        return;
+    }
+    mHistory.push({timestamp, sample.x, sample.y});
+    mLastValid = timestamp;
+
+    if (mState == State::Idle) {
+        mDownPending = true;
+    }
+    mState = State::Active;
+}
+
+bool UpscalerEngine::tick(steady_clock::time_point now, TouchEvent& event) {
+    if (mState == State::Idle) {
+        return false;
+    }
+
+    bool lifted = now - mLastValid > mIdleGrace;
+    if (mState == State::MaybeUp && now - mMaybeUpStart >= mLiftDebounce) {
+        lifted = true;
+    }
+    if (lifted) {
+        return release(now, event);
+    }
+
+    if (mDownPending) {
+        // Touch down where the finger actually is, not at an extrapolated point
+        mDownPending = false;
+        const auto& newest = mHistory.back();
+        mLastOutput = TouchEvent{now, newest.x, newest.y, TouchEventType::Down};
+        event = mLastOutput;
+        return true;
+    }
+
+    if (mState == State::MaybeUp) {
+        return false;  // Hold the last output while the finger may be lifting
+    }
+
+    float x;
+    float y;
+    evaluate(now - mInterpolationDelay, x, y);
+    if (mCfg.smoothing > 0.0) {
+        float keep = static_cast<float>(mCfg.smoothing);
+        x = keep * mLastOutput.x + (1.0f - keep) * x;
+        y = keep * mLastOutput.y + (1.0f - keep) * y;
+    }
+    mLastOutput = TouchEvent{now, x, y, TouchEventType::Move};
+    event = mLastOutput;
+    return true;
+}
+
+bool UpscalerEngine::release(steady_clock::time_point now, TouchEvent& event) {
+    bool pressed = mState != State::Idle && !mDownPending;  // No Down was emitted before the first tick
+    reset();
+    if (!pressed) {
+        return false;
+    }
+    event = mLastOutput;
+    event.timestamp = now;
+    event.type = TouchEventType::Up;
+    return true;
+}
+
+void UpscalerEngine::reset() {
+    mState = State::Idle;
+    mHistory.clear();
+    mDownPending = false;
+}
+
+void UpscalerEngine::evaluate(steady_clock::time_point t, float& x, float& y) const {
+    size_t count = mHistory.size();
+    const auto& newest = mHistory.back();
+    x = newest.x;
+    y = newest.y;
+
+    if (t >= newest.timestamp) {
+        // Extrapolate along the last segment, for at most maxExtrapolationMs
+        if (count >= 2) {
+            const auto& previous = mHistory[count - 2];
+            double segment = duration<double>(newest.timestamp - previous.timestamp).count();
+            double ahead = duration<double>(std::min(t - newest.timestamp, mMaxExtrapolation)).count();
+            double scale = ahead / segment;
+            x = static_cast<float>(newest.x + (newest.x - previous.x) * scale);
+            y = static_cast<float>(newest.y + (newest.y - previous.y) * scale);
+        }
+    } else if (t <= mHistory[0].timestamp) {
+        x = mHistory[0].x;
+        y = mHistory[0].y;
+    } else {
+        // Bracketing segment, searched from the newest end where render times fall
+        size_t i = count - 1;
+        while (i > 0 && mHistory[i - 1].timestamp > t) {
+            --i;
+        }
+        const auto& a = mHistory[i - 1];
+        const auto& b = mHistory[i];
+        double f = duration<double>(t - a.timestamp).count() / duration<double>(b.timestamp - a.timestamp).count();
+        x = static_cast<float>(a.x + (b.x - a.x) * f);
+        y = static_cast<float>(a.y + (b.y - a.y) * f);
+    }
+
+    x = std::min(std::max(x, 0.0f), static_cast<float>(mCfg.screenWidth - 1));
+    y = std::min(std::max(y, 0.0f), static_cast<float>(mCfg.screenHeight - 1));
+}
+
+}  // namespace vtd
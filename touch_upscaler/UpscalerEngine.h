@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "TouchUpscaler.h"
+
+namespace vtd {
+
+// Fixed-capacity history of the newest valid samples, oldest first.
+// Pushing into a full ring overwrites the oldest sample; nothing is allocated after construction.
+class HistoryRing {
+   public:
+    struct Entry {
+        steady_clock::time_point timestamp;
+        float x{0.0f};
+        float y{0.0f};
+    };
+
+    explicit HistoryRing(size_t capacity) : mEntries(capacity < 2 ? 2 : capacity) {}
+
+    void push(const Entry& entry) {
+        mEntries[(mStart + mCount) % mEntries.size()] = entry;
+        if (mCount < mEntries.size()) {
+            ++mCount;
+        } else {
+            mStart = (mStart + 1) % mEntries.size();
+        }
+    }
+
+    void clear() {
+        mStart = 0;
+        mCount = 0;
+    }
+
+    // i = 0 is the oldest sample
+    const Entry& operator[](size_t i) const { return mEntries[(mStart + i) % mEntries.size()]; }
+    const Entry& back() const { return (*this)[mCount - 1]; }
+
+    size_t size() const { return mCount; }
+    size_t capacity() const { return mEntries.size(); }
+    bool empty() const { return mCount == 0; }
+
+   private:
+    std::vector<Entry> mEntries;
+    size_t mStart = 0;
+    size_t mCount = 0;
+};
+
+// Touch state machine and output interpolation, driven entirely by the caller's clock.
+//
+// TouchUpscaler feeds it arrival-stamped samples and steady_clock output deadlines; tests and
+// benchmarks feed it simulated time, so behaviour is deterministic and runs faster than real time.
+//
+//   Idle    --valid-->   Active  (Down on the next tick)
+//   Active  --invalid--> MaybeUp (output holds; a valid sample within liftDebounceMs resumes)
+//   MaybeUp --liftDebounceMs without a valid sample--> Idle (Up)
+//   Active/MaybeUp --idleGraceMs since the last valid sample--> Idle (Up)
+class UpscalerEngine {
+   public:
+    enum class State { Idle, Active, MaybeUp };
+
+    explicit UpscalerEngine(const Config& cfg);
+
+    // Feed one sensor sample taken at timestamp
+    void addSample(const TouchSample& sample, steady_clock::time_point timestamp);
+
+    // Advance to output time now; true if an event should be emitted
+    bool tick(steady_clock::time_point now, TouchEvent& event);
+
+    // Lift a finger that is still down (shutdown); true if an Up event should be emitted
+    bool release(steady_clock::time_point now, TouchEvent& event);
+
+    void reset();
+
+    State state() const { return mState; }
+    const HistoryRing& history() const { return mHistory; }
+
+   private:
+    void evaluate(steady_clock::time_point t, float& x, float& y) const;
+
+    Config mCfg;
+    steady_clock::duration mIdleGrace;
+    steady_clock::duration mLiftDebounce;
+    steady_clock::duration mMaxExtrapolation;
+    steady_clock::duration mInterpolationDelay;
+
+    State mState{State::Idle};
+    HistoryRing mHistory;
+    bool mDownPending = false;
+    steady_clock::time_point mLastValid;
+    steady_clock::time_point mMaybeUpStart;
+    TouchEvent mLastOutput;
+};
+
+}  // namespace vtd
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "UpscalerEngine.h"
+
+namespace vtd {
+
+// A sensor sample at a simulated time, in ms from the start of the session
+struct ScriptedSample {
+    double timeMs{0.0};
+    TouchSample sample;
+};
+
+// Deterministic driver for UpscalerEngine on a simulated clock.
+//
+// Output ticks fall every 1/outputHz from tickPhaseMs; before each tick every scripted sample
+// at or before it is fed in, exactly as the output thread would have drained them. Nothing
+// sleeps, so sessions run as fast as the engine does and give the same events every run.
+class UpscalerSimulation {
+   public:
+    explicit UpscalerSimulation(const Config& cfg, double tickPhaseMs = 0.0)
+        : mEngine(cfg), mPeriodMs(1000.0 / cfg.outputHz), mTickPhaseMs(tickPhaseMs) {}
+
+    static steady_clock::time_point at(double ms) {
+        return steady_clock::time_point() + duration_cast<steady_clock::duration>(duration<double, std::milli>(ms));
+    }
+
+    static double toMs(steady_clock::time_point t) {
+        return duration<double, std::milli>(t.time_since_epoch()).count();
+    }
+
+    // Run the script (sorted by time) until endMs, appending emitted events; returns the tick count
+    size_t run(const std::vector<ScriptedSample>& script, double endMs, std::vector<TouchEvent>& events) {
+        size_t next = 0;
+        size_t ticks = 0;
+        TouchEvent event;
+        for (double tickMs = mTickPhaseMs; tickMs <= endMs; tickMs = mTickPhaseMs + mPeriodMs * ++ticks) {
+            for (; next < script.size() && script[next].timeMs <= tickMs; ++next) {
+                mEngine.addSample(script[next].sample, at(script[next].timeMs));
+            }
+            if (mEngine.tick(at(tickMs), event)) {
+                events.push_back(event);
+            }
+        }
+        return ticks;
+    }
+
+    UpscalerEngine& engine() { return mEngine; }
+
+   private:
+    UpscalerEngine mEngine;
+    double mPeriodMs;
+    double mTickPhaseMs;
+};
+
+}  // namespace vtd
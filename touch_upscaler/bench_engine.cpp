@@ -0,0 +1,69 @@
+// Benchmark: per-tick CPU cost of the upscaler state machine on a simulated clock.
+//
+// Runs an hour of scripted touch input (60 Hz strokes, taps and sensor dropouts) through
+// UpscalerEngine at outputHz without sleeping and reports the cost per output tick and how
+// much faster than real time the session ran, for a few history sizes.
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "UpscalerSimulation.h"
+
+using namespace vtd;
+
+namespace {
+
+constexpr double kSessionMs = 3600.0 * 1000.0;
+constexpr double kInputHz = 60.0;
+
+std::vector<ScriptedSample> buildSession() {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(0.0f, 1.0f);
+    std::uniform_real_distribution<double> strokeMs(50.0, 1500.0);
+    std::uniform_real_distribution<double> gapMs(100.0, 800.0);
+    std::bernoulli_distribution dropout(0.02);
+
+    std::vector<ScriptedSample> script;
+    double t = 0.0;
+    while (t < kSessionMs) {
+        float x0 = position(rng) * 1919.0f;
+        float y0 = position(rng) * 1079.0f;
+        float x1 = position(rng) * 1919.0f;
+        float y1 = position(rng) * 1079.0f;
+        double duration = strokeMs(rng);
+        for (double s = 0.0; s <= duration; s += 1000.0 / kInputHz) {
+            float f = static_cast<float>(s / duration);
+            script.push_back({t + s, TouchSample{x0 + (x1 - x0) * f, y0 + (y1 - y0) * f, !dropout(rng)}});
+        }
+        t += duration;
+        script.push_back({t + 1.0, TouchSample{0.0f, 0.0f, false}});
+        t += gapMs(rng);
+    }
+    return script;
+}
+
+}  // namespace
+
+int main() {
+    std::vector<ScriptedSample> script = buildSession();
+    std::printf("Simulated session: %.0f s, %zu input samples, output at %.0f Hz\n\n", kSessionMs / 1000.0,
+                script.size(), Config::getDefault().outputHz);
+    std::printf("%-12s %12s %10s %12s %14s\n", "historySize", "Ticks", "Events", "ns/tick", "x real time");
+
+    for (size_t historySize : {6, 32, 128}) {
+        Config cfg = Config::getDefault();
+        cfg.historySize = historySize;
+        UpscalerSimulation sim(cfg, 0.5);
+        std::vector<TouchEvent> events;
+        events.reserve(static_cast<size_t>(kSessionMs / 1000.0 * cfg.outputHz) + 1);
+
+        auto start = std::chrono::steady_clock::now();
+        size_t ticks = sim.run(script, kSessionMs, events);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%-12zu %12zu %10zu %12.1f %14.0f\n", historySize, ticks, events.size(), seconds * 1e9 / ticks,
+                    kSessionMs / 1000.0 / seconds);
+    }
+    return 0;
+}
@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <functional>
 #include <iostream>
 #include <random>
@@ -8,6 +10,7 @@
 #include <vector>
 
 #include "TouchUpscaler.h"
+#include "UpscalerSimulation.h"
 
 using namespace vtd;
 using namespace std::chrono;
@@ -303,6 +306,169 @@ void testPerformance() {
     upscaler.stop();
 }
 
+// Simulated-clock tests: the engine runs on scripted time, no sleeping
+
+// Straight stroke sampled at rateHz, from (x0, y0) to (x1, y1)
+std::vector<ScriptedSample> strokeScript(double startMs, double durationMs, double rateHz, float x0, float y0,
+                                         float x1, float y1) {
+    std::vector<ScriptedSample> script;
+    int intervals = static_cast<int>(std::lround(durationMs * rateHz / 1000.0));
+    for (int i = 0; i <= intervals; ++i) {
+        double t = durationMs * i / intervals;
+        float f = static_cast<float>(t / durationMs);
+        script.push_back({startMs + t, TouchSample{x0 + (x1 - x0) * f, y0 + (y1 - y0) * f, true}});
+    }
+    return script;
+}
+
+size_t countType(const std::vector<TouchEvent>& events, TouchEventType type) {
+    return static_cast<size_t>(std::count_if(events.begin(), events.end(),
+                                             [type](const TouchEvent& e) { return e.type == type; }));
+}
+
+void testSimulatedTap() {
+    Config cfg = Config::getDefault();
+    UpscalerSimulation sim(cfg, 0.5);
+    std::vector<ScriptedSample> script = {{10.0, {500.0f, 400.0f, true}},
+                                          {26.0, {501.0f, 400.0f, true}},
+                                          {42.0, {0.0f, 0.0f, false}}};
+    std::vector<TouchEvent> events;
+    sim.run(script, 300.0, events);
+
+    assertTrue(events.size() >= 3, "Tap produces Down, Move and Up");
+    assertTrue(events.front().type == TouchEventType::Down, "First event is Down");
+    assertEqual(500.0f, events.front().x);
+    assertTrue(events.back().type == TouchEventType::Up, "Last event is Up");
+    assertTrue(countType(events, TouchEventType::Up) == 1, "Exactly one Up");
+
+    // Lifted liftDebounceMs after the invalid sample, on the next tick
+    double upMs = UpscalerSimulation::toMs(events.back().timestamp);
+    assertTrue(upMs >= 42.0 + cfg.liftDebounceMs && upMs < 42.0 + cfg.liftDebounceMs + 1000.0 / cfg.outputHz,
+               "Up follows the lift debounce");
+    assertTrue(sim.engine().state() == UpscalerEngine::State::Idle, "Engine returns to Idle");
+}
+
+void testSimulatedDropoutBridged() {
+    Config cfg = Config::getDefault();
+    UpscalerSimulation sim(cfg, 0.5);
+    std::vector<ScriptedSample> script = strokeScript(0.0, 300.0, 60.0, 100.0f, 500.0f, 700.0f, 500.0f);
+    // One lost IR frame in the middle of the stroke
+    script.insert(script.begin() + 9, ScriptedSample{script[8].timeMs + 8.0, TouchSample{0.0f, 0.0f, false}});
+    std::vector<TouchEvent> events;
+    sim.run(script, 280.0, events);
+
+    assertTrue(countType(events, TouchEventType::Down) == 1, "One Down");
+    assertTrue(countType(events, TouchEventType::Up) == 0, "Short dropout does not lift the finger");
+}
+
+void testSimulatedIdleGrace() {
+    Config cfg = Config::getDefault();
+    UpscalerSimulation sim(cfg, 0.5);
+    std::vector<ScriptedSample> script = strokeScript(0.0, 100.0, 60.0, 100.0f, 100.0f, 200.0f, 100.0f);
+    std::vector<TouchEvent> events;
+    sim.run(script, 400.0, events);
+
+    assertTrue(events.back().type == TouchEventType::Up, "Input stopping lifts the finger");
+    double upMs = UpscalerSimulation::toMs(events.back().timestamp);
+    assertTrue(upMs > script.back().timeMs + cfg.idleGraceMs, "Up waits for the idle grace");
+    assertEqual(events[events.size() - 2].x, events.back().x);
+}
+
+void testSimulatedInterpolation() {
+    Config cfg = Config::getDefault();
+    cfg.interpolationDelayMs = 1000.0 / 60.0;  // One input period: every output lies between two samples
+    UpscalerSimulation sim(cfg, 0.5);
+    // 60 Hz input moving 6 px/ms along x, output at 130 Hz
+    std::vector<ScriptedSample> script = strokeScript(0.0, 500.0, 60.0, 100.0f, 300.0f, 1100.0f, 300.0f);
+    std::vector<TouchEvent> events;
+    size_t ticks = sim.run(script, 500.0, events);
+
+    size_t moves = 0;
+    for (const auto& e : events) {
+        if (e.type != TouchEventType::Move) {
+            continue;
+        }
+        ++moves;
+        double renderMs = UpscalerSimulation::toMs(e.timestamp) - cfg.interpolationDelayMs;
+        if (renderMs > 0.0) {
+            assertEqual(static_cast<float>(100.0 + 2.0 * renderMs), e.x, 0.05f);
+        }
+        assertEqual(300.0f, e.y);
+    }
+    assertTrue(moves + 1 == ticks, "A Move on every tick after Down");
+}
+
+void testSimulatedExtrapolationLimit() {
+    Config cfg = Config::getDefault();
+    cfg.interpolationDelayMs = 0.0;
+    UpscalerSimulation sim(cfg, 0.5);
+    std::vector<ScriptedSample> script = strokeScript(0.0, 50.0, 100.0, 100.0f, 100.0f, 200.0f, 100.0f);
+    std::vector<TouchEvent> events;
+    sim.run(script, 90.0, events);
+
+    // Newest sample at 50 ms, 200 px, moving 2 px/ms; output stops advancing maxExtrapolationMs later
+    float limit = static_cast<float>(200.0 + 2.0 * cfg.maxExtrapolationMs);
+    assertEqual(limit, events.back().x, 0.01f);
+    assertTrue(events.back().type == TouchEventType::Move, "Still touching within the idle grace");
+}
+
+void testHistoryRing() {
+    HistoryRing ring(6);
+    for (int i = 0; i < 20; ++i) {
+        ring.push({UpscalerSimulation::at(i), static_cast<float>(i), 0.0f});
+    }
+    assertTrue(ring.size() == 6 && ring.capacity() == 6, "Ring keeps historySize samples");
+    assertEqual(14.0f, ring[0].x);
+    assertEqual(19.0f, ring.back().x);
+    ring.clear();
+    assertTrue(ring.empty(), "Clear empties the ring");
+
+    Config cfg = Config::getDefault();
+    UpscalerSimulation sim(cfg, 0.5);
+    std::vector<TouchEvent> events;
+    sim.run(strokeScript(0.0, 1000.0, 120.0, 100.0f, 100.0f, 900.0f, 100.0f), 1010.0, events);
+    assertTrue(sim.engine().history().size() == cfg.historySize, "Engine history stays at historySize");
+    assertEqual(900.0f, sim.engine().history().back().x, 0.01f);
+}
+
+// The threaded pipeline on a simulated clock: same events as the engine simulation, no sleeping
+void testVirtualTimeUpscaler() {
+    Config cfg = Config::getDefault();
+    cfg.simulatedClock = std::make_shared<SimulatedClock>(UpscalerSimulation::at(0.0));
+    std::vector<ScriptedSample> script = strokeScript(3.0, 400.0, 60.0, 100.0f, 200.0f, 900.0f, 600.0f);
+    script.push_back({410.0, TouchSample{0.0f, 0.0f, false}});
+
+    TouchUpscaler upscaler(cfg);
+    std::vector<TouchEvent> events;
+    upscaler.setEventCallback([&events](const TouchEvent& e) { events.push_back(e); });
+    assertFalse(upscaler.advanceClock(UpscalerSimulation::at(1.0)), "Stopped upscaler does not advance");
+    upscaler.start();
+    auto wallStart = steady_clock::now();
+    for (const auto& step : script) {
+        assertTrue(upscaler.advanceClock(UpscalerSimulation::at(step.timeMs)), "Simulated clock advances");
+        upscaler.push(step.sample);
+    }
+    upscaler.advanceClock(UpscalerSimulation::at(600.0));
+    upscaler.stop();
+    assertTrue(steady_clock::now() - wallStart < milliseconds(100), "600 ms of input runs faster than real time");
+
+    // First tick one period after start, as on the real clock
+    Config reference = Config::getDefault();
+    UpscalerSimulation sim(reference, 1000.0 / reference.outputHz);
+    std::vector<TouchEvent> expected;
+    sim.run(script, 600.0, expected);
+
+    assertTrue(events.size() == expected.size(), "Same event count as the engine simulation");
+    for (size_t i = 0; i < events.size(); ++i) {
+        assertTrue(events[i].type == expected[i].type, "Same event types");
+        assertEqual(static_cast<float>(UpscalerSimulation::toMs(expected[i].timestamp)),
+                    static_cast<float>(UpscalerSimulation::toMs(events[i].timestamp)), 0.001f);
+        assertEqual(expected[i].x, events[i].x, 0.01f);
+        assertEqual(expected[i].y, events[i].y, 0.01f);
+    }
+    assertTrue(upscaler.getOutputTimingStats().maxLatenessUs == 0.0, "Simulated ticks are never late");
+}
+
 int main() {
     TestRunner runner;
 
@@ -320,6 +486,13 @@ int main() {
     runner.runTest("Skipped Frame Detection", testSkippedFrameDetection);
     runner.runTest("EMA Smoothing", testEMASmoothing);
     runner.runTest("Performance Test", testPerformance);
+    runner.runTest("Simulated Tap", testSimulatedTap);
+    runner.runTest("Simulated Dropout Bridged", testSimulatedDropoutBridged);
+    runner.runTest("Simulated Idle Grace", testSimulatedIdleGrace);
+    runner.runTest("Simulated Interpolation", testSimulatedInterpolation);
+    runner.runTest("Simulated Extrapolation Limit", testSimulatedExtrapolationLimit);
+    runner.runTest("History Ring", testHistoryRing);
+    runner.runTest("Virtual Time Upscaler", testVirtualTimeUpscaler);
 
     runner.printSummary();
 
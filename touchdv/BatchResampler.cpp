@@ -0,0 +1,246 @@
+#include "BatchResampler.h"
+#include "ContactTracker.h"
+#include "TouchResampler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace vtd {
+
+namespace {
+
+steady_clock::time_point toTimePoint(int64_t ns) {
+    return steady_clock::time_point(duration_cast<steady_clock::duration>(nanoseconds(ns)));
+}
+
+// Output period as PeriodicScheduler derives it, in whole nanoseconds
+int64_t outputPeriodNs(const Config& cfg) {
+    auto period = duration_cast<steady_clock::duration>(duration<double>(1.0 / cfg.outputRateHz));
+    return std::max<int64_t>(duration_cast<nanoseconds>(period).count(), 1000);
+}
+
+} // namespace
+
+// --------------------- TouchTrace ---------------------
+void TouchTrace::clear() {
+    timeNs.clear();
+    x.clear();
+    y.clear();
+    touching.clear();
+}
+
+void TouchTrace::reserve(size_t count) {
+    timeNs.reserve(count);
+    x.reserve(count);
+    y.reserve(count);
+    touching.reserve(count);
+}
+
+void TouchTrace::append(const TouchPoint& point) {
+    timeNs.push_back(duration_cast<nanoseconds>(point.ts.time_since_epoch()).count());
+    x.push_back(point.x);
+    y.push_back(point.y);
+    touching.push_back(point.touching ? 1 : 0);
+}
+
+TouchPoint TouchTrace::point(size_t index) const {
+    return TouchPoint{toTimePoint(timeNs[index]), x[index], y[index], touching[index] != 0};
+}
+
+// --------------------- BatchResampler::Impl ---------------------
+class BatchResampler::Impl {
+public:
+    explicit Impl(unsigned threads) {
+        unsigned count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 1; i < count; ++i) {
+            mWorkers.emplace_back(&Impl::workerLoop, this);
+        }
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mWake.notify_all();
+        for (auto& worker : mWorkers) {
+            worker.join();
+        }
+    }
+
+    void run(const Config& cfg, const std::vector<TouchTrace>& inputs, std::vector<TouchTrace>& outputs) {
+        outputs.resize(inputs.size());
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mConfig = &cfg;
+            mInputs = &inputs;
+            mOutputs = &outputs;
+            mNext = 0;
+            mBusy = mWorkers.size();
+            ++mGeneration;
+        }
+        mWake.notify_all();
+
+        work();
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDone.wait(lock, [this] { return mBusy == 0; });
+    }
+
+    unsigned threadCount() const { return static_cast<unsigned>(mWorkers.size() + 1); }
+
+private:
+    std::vector<std::thread> mWorkers;
+
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+    uint64_t mGeneration = 0;
+    size_t mBusy = 0;
+    bool mStopping = false;
+
+    // Current job, fixed while workers are busy
+    const Config* mConfig = nullptr;
+    const std::vector<TouchTrace>* mInputs = nullptr;
+    std::vector<TouchTrace>* mOutputs = nullptr;
+    std::atomic<size_t> mNext{0};
+
+    // Traces are claimed one at a time, so long and short traces balance across threads
+    void work() {
+        for (size_t i = mNext++; i < mInputs->size(); i = mNext++) {
+            BatchResampler::resample(*mConfig, (*mInputs)[i], (*mOutputs)[i]);
+        }
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWake.wait(lock, [&] { return mStopping || mGeneration != seen; });
+                if (mStopping) {
+                    return;
+                }
+                seen = mGeneration;
+            }
+            work();
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                --mBusy;
+            }
+            mDone.notify_one();
+        }
+    }
+};
+
+// --------------------- BatchResampler ---------------------
+BatchResampler::BatchResampler(unsigned threads) : mImpl(std::make_unique<Impl>(threads)) {}
+
+BatchResampler::~BatchResampler() = default;
+
+void BatchResampler::run(const Config& cfg, const std::vector<TouchTrace>& inputs, std::vector<TouchTrace>& outputs) {
+    mImpl->run(cfg, inputs, outputs);
+}
+
+unsigned BatchResampler::threadCount() const {
+    return mImpl->threadCount();
+}
+
+// The sender loop per tick, for one contact: apply the inputs that arrived before the tick
+// (lifting on a release, ignoring rejected points), lift after kInputTimeoutSec without input,
+// then sample. Runs of ticks that see the same input are sampled in one call.
+void BatchResampler::resample(const Config& cfg, const TouchTrace& input, TouchTrace& output) {
+    output.clear();
+    if (input.empty()) {
+        return;
+    }
+
+    const int64_t period = outputPeriodNs(cfg);
+    const int64_t timeout = duration_cast<nanoseconds>(duration<double>(ContactTracker::kInputTimeoutSec)).count();
+    const float maxX = static_cast<float>(cfg.screenWidth - 1);
+    const float maxY = static_cast<float>(cfg.screenHeight - 1);
+    const size_t count = input.size();
+    const int64_t end = input.timeNs.back() + timeout + period;  // The contact has timed out by then
+    output.reserve(static_cast<size_t>((end - input.timeNs.front()) / period) + count);
+
+    TouchResampler resampler(cfg);
+    bool active = false;
+    int64_t lastInput = 0;
+    float lastX = 0.0f;
+    float lastY = 0.0f;
+    auto lift = [&](int64_t ts, float x, float y) {
+        active = false;
+        resampler.reset();
+        output.timeNs.push_back(ts);
+        output.x.push_back(x);
+        output.y.push_back(y);
+        output.touching.push_back(0);
+    };
+
+    size_t next = 0;
+    for (int64_t tick = input.timeNs.front() + period; tick <= end;) {
+        for (; next < count && input.timeNs[next] < tick; ++next) {
+            float x = input.x[next];
+            float y = input.y[next];
+            if (std::isnan(x) || std::isnan(y) || x < 0 || x > cfg.screenWidth - 1 || y < 0 ||
+                y > cfg.screenHeight - 1) {
+                // The device ignores the frame, so the contact stays down
+                continue;
+            }
+            if (!input.touching[next]) {
+                if (active) {
+                    lift(input.timeNs[next], x, y);
+                }
+                continue;
+            }
+            active = true;
+            resampler.addSample(input.point(next));
+            lastInput = input.timeNs[next];
+            lastX = x;
+            lastY = y;
+        }
+
+        if (!active) {
+            if (next == count) {
+                break;
+            }
+            tick += ((input.timeNs[next] - tick) / period + 1) * period;  // First tick after the next input
+            continue;
+        }
+        if (duration<double>(toTimePoint(tick) - toTimePoint(lastInput)).count() >= ContactTracker::kInputTimeoutSec) {
+            lift(tick, lastX, lastY);
+            tick += period;
+            continue;
+        }
+
+        // Ticks up to the next input, the timeout or the end all see the same knots
+        int64_t runEnd = std::min(end, lastInput + timeout - 1);
+        if (next < count) {
+            runEnd = std::min(runEnd, input.timeNs[next]);
+        }
+        size_t run = static_cast<size_t>((runEnd - tick) / period + 1);
+
+        size_t first = output.size();
+        output.timeNs.resize(first + run);
+        output.x.resize(first + run);
+        output.y.resize(first + run);
+        size_t sampled = resampler.sampleRun(toTimePoint(tick), nanoseconds(period), run, &output.x[first],
+                                             &output.y[first]);
+        output.timeNs.resize(first + sampled);
+        output.x.resize(first + sampled);
+        output.y.resize(first + sampled);
+        output.touching.resize(first + sampled, 1);
+        for (size_t i = 0; i < sampled; ++i) {
+            output.timeNs[first + i] = tick + static_cast<int64_t>(i) * period;
+            output.x[first + i] = std::max(0.0f, std::min(output.x[first + i], maxX));
+            output.y[first + i] = std::max(0.0f, std::min(output.y[first + i], maxY));
+        }
+        tick += static_cast<int64_t>(run) * period;
+    }
+}
+
+} // namespace vtd
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "VirtualTouchDevice.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vtd {
+
+// One contact's recorded points, column-wise: times in steady_clock nanoseconds
+// (non-decreasing), positions in pixels, touching as 0/1
+struct TouchTrace {
+    std::vector<int64_t> timeNs;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<uint8_t> touching;
+
+    size_t size() const { return timeNs.size(); }
+    bool empty() const { return timeNs.empty(); }
+    void clear();
+    void reserve(size_t count);
+    void append(const TouchPoint& point);
+    TouchPoint point(size_t index) const;
+};
+
+// Offline upsampling of whole recorded traces, for running filter and interpolation
+// variants over large corpora.
+//
+// Each trace gives the output VirtualTouchDevice produces in deterministic mode: a
+// simulated clock started at the first input (output ticks every 1/outputRateHz from one
+// period later), stampInputOnArrival = false, and every point pushed with pushInputPoint()
+// once the clock has reached its time. That output (lifts, timeouts and upsampled points,
+// with the same clamping) is reproduced bit for bit, up to the tick where the contact has
+// timed out after the last input.
+//
+// Ticks and inputs are walked in one merged sweep: the ticks between two inputs are
+// evaluated as a run against the same knots (TouchResampler::sampleRun), and stretches
+// without a contact are skipped. Traces are spread over a pool of worker threads.
+class BatchResampler {
+public:
+    // threads = 0 uses every hardware thread; the calling thread always takes part
+    explicit BatchResampler(unsigned threads = 0);
+    ~BatchResampler();
+
+    BatchResampler(const BatchResampler&) = delete;
+    BatchResampler& operator=(const BatchResampler&) = delete;
+
+    // Upsample every trace with cfg; outputs[i] belongs to inputs[i]
+    void run(const Config& cfg, const std::vector<TouchTrace>& inputs, std::vector<TouchTrace>& outputs);
+
+    // Upsample one trace on the calling thread
+    static void resample(const Config& cfg, const TouchTrace& input, TouchTrace& output);
+
+    unsigned threadCount() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
+} // namespace vtd
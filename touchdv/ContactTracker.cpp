@@ -0,0 +1,171 @@
+#include "ContactTracker.h"
+
+#include <algorithm>
+
+namespace vtd {
+
+namespace {
+
+constexpr size_t kMaxFrameContacts = 32;  // Contacts beyond this in one frame are ignored
+
+struct Candidate {
+    float distanceSq;
+    uint8_t slot;
+    uint8_t contact;
+};
+
+} // namespace
+
+ContactTracker::ContactTracker(const Config& cfg, size_t slotCount)
+    : mSlotCount(std::max<size_t>(1, std::min(slotCount, kMaxSlots))),
+      mAssociationDistancePx(cfg.contactAssociationDistancePx) {
+    mContactId.fill(-1);
+    mResamplers.reserve(mSlotCount);
+    for (size_t i = 0; i < mSlotCount; ++i) {
+        mResamplers.emplace_back(cfg);
+    }
+}
+
+size_t ContactTracker::freeSlot() const {
+    for (size_t slot = 0; slot < mSlotCount; ++slot) {
+        if (!mActive[slot] && !mSeen[slot]) {
+            return slot;
+        }
+    }
+    return kMaxSlots;
+}
+
+void ContactTracker::lift(size_t slot, steady_clock::time_point ts, float x, float y, std::vector<TouchPoint>& lifted) {
+    mActive[slot] = 0;
+    mContactId[slot] = -1;
+    mResamplers[slot].reset();
+
+    TouchPoint point{ts, x, y, false};
+    point.slot = static_cast<int>(slot);
+    lifted.push_back(point);
+}
+
+void ContactTracker::applyFrame(const TouchPoint* contacts, size_t count, std::vector<TouchPoint>& lifted) {
+    size_t contactCount = std::min(count, kMaxFrameContacts);
+    std::array<int8_t, kMaxFrameContacts> assigned;
+    assigned.fill(-1);
+    mSeen.fill(0);
+
+    // Contacts with a sensor id keep their slot
+    for (size_t i = 0; i < contactCount; ++i) {
+        const TouchPoint& contact = contacts[i];
+        if (contact.contactId < 0) {
+            continue;
+        }
+        for (size_t slot = 0; slot < mSlotCount; ++slot) {
+            if (mActive[slot] && mContactId[slot] == contact.contactId) {
+                assigned[i] = static_cast<int8_t>(slot);
+                mSeen[slot] = 1;
+                break;
+            }
+        }
+    }
+
+    // Anonymous contacts: nearest active anonymous slot, closest pairs first
+    std::array<Candidate, kMaxSlots * kMaxFrameContacts> candidates;
+    size_t candidateCount = 0;
+    float maxDistanceSq = static_cast<float>(mAssociationDistancePx * mAssociationDistancePx);
+    for (size_t i = 0; i < contactCount; ++i) {
+        const TouchPoint& contact = contacts[i];
+        if (contact.contactId >= 0 || !contact.touching) {
+            continue;
+        }
+        for (size_t slot = 0; slot < mSlotCount; ++slot) {
+            if (!mActive[slot] || mContactId[slot] >= 0) {
+                continue;
+            }
+            float dx = contact.x - mLastX[slot];
+            float dy = contact.y - mLastY[slot];
+            float distanceSq = dx * dx + dy * dy;
+            if (distanceSq <= maxDistanceSq) {
+                candidates[candidateCount++] = Candidate{distanceSq, static_cast<uint8_t>(slot), static_cast<uint8_t>(i)};
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(candidateCount),
+              [](const Candidate& a, const Candidate& b) { return a.distanceSq < b.distanceSq; });
+    for (size_t c = 0; c < candidateCount; ++c) {
+        const Candidate& candidate = candidates[c];
+        if (assigned[candidate.contact] < 0 && !mSeen[candidate.slot]) {
+            assigned[candidate.contact] = static_cast<int8_t>(candidate.slot);
+            mSeen[candidate.slot] = 1;
+        }
+    }
+
+    // Lift slots whose contact is gone before new contacts take free slots, so a slot is
+    // never released and reused within one frame
+    for (size_t slot = 0; slot < mSlotCount; ++slot) {
+        if (mActive[slot] && !mSeen[slot]) {
+            lift(slot, contactCount ? contacts[0].ts : mLastInput[slot], mLastX[slot], mLastY[slot], lifted);
+            mSeen[slot] = 1;
+        }
+    }
+
+    for (size_t i = 0; i < contactCount; ++i) {
+        const TouchPoint& contact = contacts[i];
+        int slot = assigned[i];
+        if (slot < 0) {
+            if (!contact.touching) {
+                continue;  // Lift of a contact that is not down
+            }
+            size_t free = freeSlot();
+            if (free == kMaxSlots) {
+                continue;  // More contacts than slots
+            }
+            slot = static_cast<int>(free);
+            mActive[free] = 1;
+            mSeen[free] = 1;
+            mContactId[free] = contact.contactId;
+        }
+
+        if (!contact.touching) {
+            lift(static_cast<size_t>(slot), contact.ts, contact.x, contact.y, lifted);
+            continue;
+        }
+        mResamplers[slot].addSample(contact);
+        mLastX[slot] = contact.x;
+        mLastY[slot] = contact.y;
+        mLastInput[slot] = contact.ts;
+    }
+}
+
+void ContactTracker::expire(steady_clock::time_point now, double timeoutSec, std::vector<TouchPoint>& lifted) {
+    for (size_t slot = 0; slot < mSlotCount; ++slot) {
+        if (mActive[slot] && duration<double>(now - mLastInput[slot]).count() >= timeoutSec) {
+            lift(slot, now, mLastX[slot], mLastY[slot], lifted);
+        }
+    }
+}
+
+void ContactTracker::liftAll(steady_clock::time_point now, std::vector<TouchPoint>& lifted) {
+    for (size_t slot = 0; slot < mSlotCount; ++slot) {
+        if (mActive[slot]) {
+            lift(slot, now, mLastX[slot], mLastY[slot], lifted);
+        }
+    }
+}
+
+void ContactTracker::sample(steady_clock::time_point tick, std::vector<TouchPoint>& out) const {
+    for (size_t slot = 0; slot < mSlotCount; ++slot) {
+        TouchPoint point;
+        if (mActive[slot] && mResamplers[slot].sample(tick, point)) {
+            point.slot = static_cast<int>(slot);
+            out.push_back(point);
+        }
+    }
+}
+
+size_t ContactTracker::activeCount() const {
+    size_t count = 0;
+    for (size_t slot = 0; slot < mSlotCount; ++slot) {
+        count += mActive[slot];
+    }
+    return count;
+}
+
+} // namespace vtd
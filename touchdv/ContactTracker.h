@@ -0,0 +1,67 @@
+#pragma once
+
+#include "TouchResampler.h"
+#include "VirtualTouchDevice.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vtd {
+
+// Slot assignment and per-contact upsampling for multi-touch frames.
+//
+// Each slot corresponds to an MT protocol B slot. Contacts that carry a sensor id
+// (TouchPoint::contactId >= 0) keep the slot of that id; anonymous contacts are matched to
+// the nearest active anonymous slot within contactAssociationDistancePx, closest pairs
+// first. Slots without a matching contact in a frame are lifted.
+//
+// Per-slot state is kept column-wise (structure of arrays) so association, timeout checks
+// and sampling scan contiguous arrays of only the fields they need. Only the processing
+// thread uses a tracker.
+class ContactTracker {
+public:
+    static constexpr size_t kMaxSlots = 16;
+    static constexpr double kInputTimeoutSec = 0.1;  // Contacts without input for this long are lifted
+
+    ContactTracker(const Config& cfg, size_t slotCount);
+
+    // Apply one input frame: every contact the sensor reports, all stamped with the same time.
+    // Contacts with touching == false lift their slot at the given position. Lift events for
+    // this frame are appended to lifted.
+    void applyFrame(const TouchPoint* contacts, size_t count, std::vector<TouchPoint>& lifted);
+    void applyFrame(const std::vector<TouchPoint>& contacts, std::vector<TouchPoint>& lifted) {
+        applyFrame(contacts.data(), contacts.size(), lifted);
+    }
+
+    // Lift slots that have not seen input for timeoutSec
+    void expire(steady_clock::time_point now, double timeoutSec, std::vector<TouchPoint>& lifted);
+
+    // Lift every active slot (shutdown)
+    void liftAll(steady_clock::time_point now, std::vector<TouchPoint>& lifted);
+
+    // Upsampled position of every active slot at tick
+    void sample(steady_clock::time_point tick, std::vector<TouchPoint>& out) const;
+
+    size_t activeCount() const;
+    size_t slotCount() const { return mSlotCount; }
+
+private:
+    void lift(size_t slot, steady_clock::time_point ts, float x, float y, std::vector<TouchPoint>& lifted);
+    size_t freeSlot() const;
+
+    size_t mSlotCount;
+    double mAssociationDistancePx;
+
+    // Slot columns
+    std::array<uint8_t, kMaxSlots> mActive{};
+    std::array<uint8_t, kMaxSlots> mSeen{};           // Matched in the frame being applied
+    std::array<int32_t, kMaxSlots> mContactId{};      // Sensor id, -1 for anonymous contacts
+    std::array<float, kMaxSlots> mLastX{};
+    std::array<float, kMaxSlots> mLastY{};
+    std::array<steady_clock::time_point, kMaxSlots> mLastInput{};
+    std::vector<TouchResampler> mResamplers;
+};
+
+} // namespace vtd
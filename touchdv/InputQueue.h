@@ -0,0 +1,70 @@
+#pragma once
+
+#include "ContactTracker.h"
+#include "VirtualTouchDevice.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace vtd {
+
+// Every contact of one sensor frame
+struct InputFrame {
+    std::array<TouchPoint, ContactTracker::kMaxSlots> contacts;
+    uint32_t count = 0;
+};
+
+// Single-producer/single-consumer ring of input frames between the sensor reader and the
+// sender thread.
+//
+// The reader fills a frame in place and publishes it; the sender drains every frame that
+// arrived since its last tick. When the ring is full new frames are dropped and counted,
+// so the reader never blocks or allocates.
+class InputQueue {
+public:
+    static constexpr size_t kCapacity = 64;  // Power of two; 0.5 s of 120 Hz input
+
+    // Writer: slot for the next frame, nullptr when the ring is full
+    InputFrame* beginPush() {
+        uint64_t head = mHead.load(std::memory_order_relaxed);
+        if (head - mTail.load(std::memory_order_acquire) >= kCapacity) {
+            mDropped.store(mDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        InputFrame* frame = &mFrames[head & (kCapacity - 1)];
+        frame->count = 0;
+        return frame;
+    }
+
+    // Writer: publish the frame returned by beginPush()
+    void commitPush() {
+        mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Reader: hands every published frame to the visitor, oldest first, and frees the slots
+    template <typename Visitor>
+    size_t drain(Visitor&& visitor) {
+        uint64_t tail = mTail.load(std::memory_order_relaxed);
+        uint64_t head = mHead.load(std::memory_order_acquire);
+        size_t count = static_cast<size_t>(head - tail);
+        for (; tail != head; ++tail) {
+            visitor(mFrames[tail & (kCapacity - 1)]);
+        }
+        mTail.store(tail, std::memory_order_release);
+        return count;
+    }
+
+    uint64_t pushedCount() const { return mHead.load(std::memory_order_relaxed); }
+    uint64_t droppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+    std::array<InputFrame, kCapacity> mFrames{};
+
+    alignas(64) std::atomic<uint64_t> mHead{0};
+    std::atomic<uint64_t> mDropped{0};
+    alignas(64) std::atomic<uint64_t> mTail{0};
+};
+
+} // namespace vtd
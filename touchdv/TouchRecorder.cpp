@@ -0,0 +1,211 @@
+#include "TouchRecorder.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace vtd {
+
+TouchRecord toRecord(const TouchPoint& point) {
+    TouchRecord record{};
+    record.timestampNs = duration_cast<nanoseconds>(point.ts.time_since_epoch()).count();
+    record.x = point.x;
+    record.y = point.y;
+    record.slot = static_cast<int16_t>(point.slot);
+    record.contactId = static_cast<int16_t>(point.contactId);
+    record.touching = point.touching ? 1 : 0;
+    return record;
+}
+
+TouchPoint fromRecord(const TouchRecord& record) {
+    TouchPoint point{steady_clock::time_point(duration_cast<steady_clock::duration>(nanoseconds(record.timestampNs))),
+                     record.x, record.y, record.touching != 0};
+    point.slot = record.slot;
+    point.contactId = record.contactId;
+    return point;
+}
+
+bool loadTouchRecording(const std::string& path, RecordingHeader& header, std::vector<TouchPoint>& points) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open recording: " << path << std::endl;
+        return false;
+    }
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kRecordingMagic, sizeof(kRecordingMagic)) != 0) {
+        std::cerr << "Not a touch recording: " << path << std::endl;
+        return false;
+    }
+    if (header.version != kRecordingVersion || header.recordSize != sizeof(TouchRecord)) {
+        std::cerr << "Unsupported recording version " << header.version << ": " << path << std::endl;
+        return false;
+    }
+    header.deviceName[sizeof(header.deviceName) - 1] = '\0';
+
+    TouchRecord record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        points.push_back(fromRecord(record));
+    }
+    return true;
+}
+
+class TouchRecorder::Impl {
+public:
+    Impl(const std::string& path, const Config& cfg, RecordType type) : mPath(path) {
+        mFront.reserve(kBufferRecords);
+        mBack.reserve(kBufferRecords);
+
+        mFile.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!mFile.is_open()) {
+            std::cerr << "Failed to open " << (type == RecordType::RawInput ? "raw_input" : "upsampled_output")
+                      << " record file: " << path << std::endl;
+            return;
+        }
+
+        RecordingHeader header{};
+        std::memcpy(header.magic, kRecordingMagic, sizeof(kRecordingMagic));
+        header.version = kRecordingVersion;
+        header.recordSize = sizeof(TouchRecord);
+        header.recordType = static_cast<uint32_t>(type);
+        header.screenWidth = cfg.screenWidth;
+        header.screenHeight = cfg.screenHeight;
+        header.inputRateHz = static_cast<float>(cfg.inputRateHz);
+        header.outputRateHz = static_cast<float>(cfg.outputRateHz);
+        std::strncpy(header.deviceName, cfg.deviceName.c_str(), sizeof(header.deviceName) - 1);
+        mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        mOpen = true;
+        mWriterThread = std::thread(&Impl::writerLoop, this);
+    }
+
+    ~Impl() {
+        close();
+    }
+
+    void record(const TouchPoint& point) {
+        TouchRecord record = toRecord(point);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mOpen) return;
+        if (mFront.size() == kBufferRecords) {
+            if (mBackPending) {
+                ++mDropped;  // Writer is a whole buffer behind
+                return;
+            }
+            mFront.swap(mBack);
+            mBackPending = true;
+            mWake.notify_one();
+        }
+        mFront.push_back(record);
+        ++mRecorded;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!mOpen) return;
+            mOpen = false;
+            mStopping = true;
+        }
+        mWake.notify_one();
+        if (mWriterThread.joinable()) {
+            mWriterThread.join();
+        }
+        mFile.close();
+
+        if (mRecorded > 0) {
+            std::cout << "Recorded " << mRecorded << " events to: " << mPath << std::endl;
+        }
+        if (mDropped > 0) {
+            std::cerr << "Recorder fell behind: dropped " << mDropped << " events for " << mPath << std::endl;
+        }
+    }
+
+    bool isOpen() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mOpen;
+    }
+
+    uint64_t recordedCount() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mRecorded;
+    }
+
+    uint64_t droppedCount() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mDropped;
+    }
+
+private:
+    std::string mPath;
+    std::ofstream mFile;  // Writer thread only once started
+    std::thread mWriterThread;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mWake;
+    std::vector<TouchRecord> mFront;  // Filled by the producer
+    std::vector<TouchRecord> mBack;   // Full buffer waiting for, or being written by, the writer
+    bool mBackPending = false;
+    bool mOpen = false;
+    bool mStopping = false;
+    uint64_t mRecorded = 0;
+    uint64_t mDropped = 0;
+
+    void writeBack() {
+        mFile.write(reinterpret_cast<const char*>(mBack.data()),
+                    static_cast<std::streamsize>(mBack.size() * sizeof(TouchRecord)));
+        mFile.flush();
+        mBack.clear();
+    }
+
+    void writerLoop() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true) {
+            mWake.wait_for(lock, milliseconds(kFlushIntervalMs), [this] { return mBackPending || mStopping; });
+
+            // Nothing full yet: flush what the front holds so the file keeps up with the session
+            if (!mBackPending && !mFront.empty()) {
+                mFront.swap(mBack);
+                mBackPending = true;
+            }
+            if (mBackPending) {
+                lock.unlock();
+                writeBack();
+                lock.lock();
+                mBackPending = false;
+            } else if (mStopping) {
+                break;
+            }
+        }
+    }
+};
+
+TouchRecorder::TouchRecorder(const std::string& path, const Config& cfg, RecordType type)
+    : mImpl(std::make_unique<Impl>(path, cfg, type)) {}
+
+TouchRecorder::~TouchRecorder() = default;
+
+bool TouchRecorder::isOpen() const {
+    return mImpl->isOpen();
+}
+
+void TouchRecorder::record(const TouchPoint& point) {
+    mImpl->record(point);
+}
+
+void TouchRecorder::close() {
+    mImpl->close();
+}
+
+uint64_t TouchRecorder::recordedCount() const {
+    return mImpl->recordedCount();
+}
+
+uint64_t TouchRecorder::droppedCount() const {
+    return mImpl->droppedCount();
+}
+
+} // namespace vtd
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "VirtualTouchDevice.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vtd {
+
+// --------------------- Recording File Format ---------------------
+// A recording is one RecordingHeader followed by fixed-size TouchRecords, appended as the
+// session runs. The record count follows from the file size; a record cut short by a crash
+// is ignored. All fields are host byte order.
+
+enum class RecordType : uint32_t {
+    RawInput = 0,         // Points as pushed to the device
+    UpsampledOutput = 1   // Points as emitted on output ticks
+};
+
+struct RecordingHeader {
+    char magic[8];                // kRecordingMagic
+    uint32_t version;
+    uint32_t recordSize;          // sizeof(TouchRecord) when written
+    uint32_t recordType;          // RecordType
+    int32_t screenWidth;
+    int32_t screenHeight;
+    float inputRateHz;
+    float outputRateHz;
+    char deviceName[92];          // NUL-terminated, truncated
+};
+
+struct TouchRecord {
+    int64_t timestampNs;          // steady_clock time since epoch
+    float x;
+    float y;
+    int16_t slot;
+    int16_t contactId;
+    uint8_t touching;
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(RecordingHeader) == 128, "RecordingHeader layout is part of the file format");
+static_assert(sizeof(TouchRecord) == 24, "TouchRecord layout is part of the file format");
+
+constexpr char kRecordingMagic[8] = {'V', 'T', 'D', 'R', 'E', 'C', '\0', '\1'};
+constexpr uint32_t kRecordingVersion = 1;
+
+TouchRecord toRecord(const TouchPoint& point);
+TouchPoint fromRecord(const TouchRecord& record);
+
+// Read a whole recording; false if the file is missing or not a recording
+bool loadTouchRecording(const std::string& path, RecordingHeader& header, std::vector<TouchPoint>& points);
+
+// --------------------- Streaming Recorder ---------------------
+// Appends records to a file from one producer thread without blocking it on disk I/O.
+//
+// Records are copied into the front buffer; a background writer thread swaps in the
+// back buffer when the front fills (or every kFlushIntervalMs) and writes the full one.
+// Memory stays at two buffers however long the session runs. If the writer falls a whole
+// buffer behind, new records are dropped and counted rather than stalling the producer.
+class TouchRecorder {
+public:
+    static constexpr size_t kBufferRecords = 4096;   // 96 KiB per buffer
+    static constexpr int kFlushIntervalMs = 500;
+
+    TouchRecorder(const std::string& path, const Config& cfg, RecordType type);
+    ~TouchRecorder();
+
+    bool isOpen() const;
+    void record(const TouchPoint& point);
+
+    // Write everything recorded so far and stop the writer; further records are ignored
+    void close();
+
+    uint64_t recordedCount() const;
+    uint64_t droppedCount() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
+} // namespace vtd
@@ -0,0 +1,251 @@
+#include "TouchResampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vtd {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMinDtSec = 1e-4;  // Inputs closer than this are treated as simultaneous
+
+double smoothingFactor(double cutoffHz, double dtSec) {
+    double tau = 1.0 / (2.0 * kPi * cutoffHz);
+    return 1.0 / (1.0 + tau / dtSec);
+}
+
+} // namespace
+
+// --------------------- OneEuroFilter ---------------------
+OneEuroFilter::OneEuroFilter(double minCutoffHz, double beta, double derivativeCutoffHz)
+    : mMinCutoffHz(minCutoffHz), mBeta(beta), mDerivativeCutoffHz(derivativeCutoffHz) {}
+
+void OneEuroFilter::filter(double& x, double& y, double dtSec) {
+    if (!mInitialized) {
+        mX = x;
+        mY = y;
+        mDx = mDy = 0.0;
+        mInitialized = true;
+        return;
+    }
+    dtSec = std::max(dtSec, kMinDtSec);
+
+    // Speed is taken from the 2D velocity so both axes share one cutoff
+    double derivativeAlpha = smoothingFactor(mDerivativeCutoffHz, dtSec);
+    mDx += derivativeAlpha * ((x - mX) / dtSec - mDx);
+    mDy += derivativeAlpha * ((y - mY) / dtSec - mDy);
+
+    double cutoff = mMinCutoffHz + mBeta * std::hypot(mDx, mDy);
+    double alpha = smoothingFactor(cutoff, dtSec);
+    mX += alpha * (x - mX);
+    mY += alpha * (y - mY);
+
+    x = mX;
+    y = mY;
+}
+
+void OneEuroFilter::reset() {
+    mInitialized = false;
+}
+
+// --------------------- KalmanFilter ---------------------
+KalmanFilter::KalmanFilter(double processNoise, double measurementNoise)
+    : mProcessNoise(processNoise), mMeasurementNoise(measurementNoise) {}
+
+double KalmanFilter::update(double z, double dtSec) {
+    if (!mInitialized) {
+        mPosition = z;
+        mVelocity = 0.0;
+        mP00 = mMeasurementNoise;
+        mP01 = 0.0;
+        mP11 = 1.0e6;  // Velocity unknown until the second point
+        mInitialized = true;
+        return mPosition;
+    }
+    double dt = std::max(dtSec, kMinDtSec);
+
+    // Predict: x = F x, P = F P F' + Q with F = [1 dt; 0 1]
+    mPosition += mVelocity * dt;
+    mP00 += dt * (2.0 * mP01 + dt * mP11) + mProcessNoise * dt * dt * dt / 3.0;
+    mP01 += dt * mP11 + mProcessNoise * dt * dt / 2.0;
+    mP11 += mProcessNoise * dt;
+
+    // Correct with the position measurement
+    double innovation = z - mPosition;
+    double s = mP00 + mMeasurementNoise;
+    double k0 = mP00 / s;
+    double k1 = mP01 / s;
+    mPosition += k0 * innovation;
+    mVelocity += k1 * innovation;
+    mP11 -= k1 * mP01;
+    mP00 -= k0 * mP00;
+    mP01 -= k0 * mP01;
+    return mPosition;
+}
+
+void KalmanFilter::reset() {
+    mInitialized = false;
+}
+
+// --------------------- TouchResampler ---------------------
+TouchResampler::TouchResampler(const Config& cfg)
+    : mCfg(cfg),
+      mOneEuro(cfg.oneEuroMinCutoffHz, cfg.oneEuroBeta, cfg.oneEuroDerivativeCutoffHz),
+      mKalmanX(cfg.kalmanProcessNoise, cfg.kalmanMeasurementNoise),
+      mKalmanY(cfg.kalmanProcessNoise, cfg.kalmanMeasurementNoise) {}
+
+void TouchResampler::addSample(const TouchPoint& point) {
+    if (mKnotCount == 0) {
+        mOrigin = point.ts;
+    }
+    double t = duration<double>(point.ts - mOrigin).count();
+    double dt = mKnotCount > 0 ? t - knot(mKnotCount - 1).t : 0.0;
+    if (mKnotCount > 0 && dt < kMinDtSec) {
+        // Same instant or out of order; a knot can't move backwards in time
+        mLastInput = point;
+        return;
+    }
+
+    Knot k{t, point.x, point.y, 0.0, 0.0};
+    switch (mCfg.filterType) {
+        case FilterType::OneEuro:
+            mOneEuro.filter(k.x, k.y, dt);
+            break;
+        case FilterType::Kalman:
+            k.x = mKalmanX.update(k.x, dt);
+            k.y = mKalmanY.update(k.y, dt);
+            k.vx = mKalmanX.velocity();
+            k.vy = mKalmanY.velocity();
+            break;
+        case FilterType::None:
+        default:
+            break;
+    }
+
+    if (mKnotCount == kMaxKnots) {
+        mFirstKnot = (mFirstKnot + 1) % kMaxKnots;
+        --mKnotCount;
+    }
+    mKnots[(mFirstKnot + mKnotCount) % kMaxKnots] = k;
+    ++mKnotCount;
+    mLastInput = point;
+}
+
+void TouchResampler::reset() {
+    mFirstKnot = 0;
+    mKnotCount = 0;
+    mOneEuro.reset();
+    mKalmanX.reset();
+    mKalmanY.reset();
+}
+
+void TouchResampler::tangent(size_t index, double& mx, double& my) const {
+    const Knot& k = knot(index);
+    if (mCfg.interpolationType == InterpolationType::Hermite && mCfg.filterType == FilterType::Kalman) {
+        mx = k.vx;
+        my = k.vy;
+        return;
+    }
+
+    // Finite differences: central inside, one-sided at the ends (Catmull-Rom on a time axis)
+    size_t before = index > 0 ? index - 1 : index;
+    size_t after = index + 1 < mKnotCount ? index + 1 : index;
+    if (mCfg.interpolationType == InterpolationType::Linear) {
+        after = index;  // Only the last segment's slope is ever needed for linear extrapolation
+    }
+    const Knot& a = knot(before);
+    const Knot& b = knot(after);
+    double dt = b.t - a.t;
+    if (dt < kMinDtSec) {
+        mx = my = 0.0;
+        return;
+    }
+    mx = (b.x - a.x) / dt;
+    my = (b.y - a.y) / dt;
+}
+
+bool TouchResampler::evaluate(steady_clock::time_point outputTime, size_t& segment, double& x, double& y) const {
+    const Knot& last = knot(mKnotCount - 1);
+    double now = duration<double>(outputTime - mOrigin).count();
+    if ((now - last.t) * 1000.0 > mCfg.maxExtrapolationMs) {
+        return false;  // Input stalled; don't invent motion
+    }
+
+    double t = now + mCfg.predictionHorizonMs / 1000.0;
+    if (t <= knot(0).t) {
+        x = knot(0).x;
+        y = knot(0).y;
+    } else if (t >= last.t) {
+        double mx, my;
+        tangent(mKnotCount - 1, mx, my);
+        double ahead = t - last.t;
+        x = last.x + mx * ahead;
+        y = last.y + my * ahead;
+    } else {
+        while (knot(segment + 1).t <= t) {
+            ++segment;
+        }
+        const Knot& p0 = knot(segment);
+        const Knot& p1 = knot(segment + 1);
+        double h = p1.t - p0.t;
+        double s = (t - p0.t) / h;
+
+        if (mCfg.interpolationType == InterpolationType::Linear) {
+            x = p0.x + s * (p1.x - p0.x);
+            y = p0.y + s * (p1.y - p0.y);
+        } else {
+            double m0x, m0y, m1x, m1y;
+            tangent(segment, m0x, m0y);
+            tangent(segment + 1, m1x, m1y);
+
+            // Cubic Hermite basis
+            double s2 = s * s;
+            double s3 = s2 * s;
+            double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+            double h10 = s3 - 2.0 * s2 + s;
+            double h01 = -2.0 * s3 + 3.0 * s2;
+            double h11 = s3 - s2;
+            x = h00 * p0.x + h10 * h * m0x + h01 * p1.x + h11 * h * m1x;
+            y = h00 * p0.y + h10 * h * m0y + h01 * p1.y + h11 * h * m1y;
+        }
+    }
+    return true;
+}
+
+bool TouchResampler::sample(steady_clock::time_point outputTime, TouchPoint& out) const {
+    if (mKnotCount == 0) {
+        return false;
+    }
+
+    size_t segment = 0;
+    double x, y;
+    if (!evaluate(outputTime, segment, x, y)) {
+        return false;
+    }
+    out.ts = outputTime;
+    out.x = static_cast<float>(x);
+    out.y = static_cast<float>(y);
+    out.touching = true;
+    return true;
+}
+
+size_t TouchResampler::sampleRun(steady_clock::time_point firstTick, steady_clock::duration period, size_t count,
+                                 float* x, float* y) const {
+    if (mKnotCount == 0) {
+        return 0;
+    }
+
+    size_t segment = 0;
+    for (size_t i = 0; i < count; ++i) {
+        double px, py;
+        if (!evaluate(firstTick + static_cast<steady_clock::duration::rep>(i) * period, segment, px, py)) {
+            return i;  // Later ticks are further past the newest input
+        }
+        x[i] = static_cast<float>(px);
+        y[i] = static_cast<float>(py);
+    }
+    return count;
+}
+
+} // namespace vtd
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "VirtualTouchDevice.h"
+
+#include <array>
+#include <cstddef>
+
+namespace vtd {
+
+// --------------------- Jitter Filters ---------------------
+
+// One-euro filter (Casiez et al.) over 2D positions: a low-pass whose cutoff rises with
+// speed, so a resting finger is heavily smoothed while fast strokes keep little lag.
+class OneEuroFilter {
+public:
+    OneEuroFilter(double minCutoffHz, double beta, double derivativeCutoffHz);
+
+    // Filter one position in place; dtSec is the time since the previous sample
+    void filter(double& x, double& y, double dtSec);
+    void reset();
+
+    // Low-passed velocity in px/s
+    double velocityX() const { return mDx; }
+    double velocityY() const { return mDy; }
+
+private:
+    double mMinCutoffHz;
+    double mBeta;
+    double mDerivativeCutoffHz;
+    bool mInitialized = false;
+    double mX = 0.0, mY = 0.0;
+    double mDx = 0.0, mDy = 0.0;
+};
+
+// Constant-velocity Kalman filter for one axis with white-noise acceleration
+class KalmanFilter {
+public:
+    KalmanFilter(double processNoise, double measurementNoise);
+
+    // Predict dtSec ahead and correct with measured position z; returns the filtered position
+    double update(double z, double dtSec);
+    void reset();
+
+    double position() const { return mPosition; }
+    double velocity() const { return mVelocity; }
+
+private:
+    double mProcessNoise;
+    double mMeasurementNoise;
+    bool mInitialized = false;
+    double mPosition = 0.0;
+    double mVelocity = 0.0;
+    double mP00 = 0.0, mP01 = 0.0, mP11 = 0.0;  // State covariance
+};
+
+// --------------------- Touch Resampler ---------------------
+
+// Continuous-time upsampling engine for one touch contact.
+//
+// Input points carry their arrival time. Each point is passed through the configured
+// jitter filter and kept as a knot of a piecewise cubic (or linear) curve over time.
+// sample() evaluates that curve at output time + predictionHorizonMs: inside the knot
+// range it interpolates, past the newest knot it extrapolates along the end tangent,
+// which is how a positive horizon compensates pipeline latency. No clock is read here,
+// so the same engine drives the real-time sender loop and offline evaluation.
+class TouchResampler {
+public:
+    static constexpr size_t kMaxKnots = 8;
+
+    explicit TouchResampler(const Config& cfg);
+
+    // Add a touching input point; timestamps must not decrease
+    void addSample(const TouchPoint& point);
+
+    // Position for the output tick at outputTime; false if there is no input or the newest
+    // input is older than maxExtrapolationMs
+    bool sample(steady_clock::time_point outputTime, TouchPoint& out) const;
+
+    // Positions for count output ticks at firstTick + k * period, all against the current
+    // input, written to x and y; stops at the first tick past maxExtrapolationMs and returns
+    // the number written. Each value equals what sample() gives for that tick: the bracketing
+    // knot segment is carried from tick to tick instead of searched again.
+    size_t sampleRun(steady_clock::time_point firstTick, steady_clock::duration period, size_t count,
+                     float* x, float* y) const;
+
+    // Forget the contact (touch released)
+    void reset();
+
+    bool empty() const { return mKnotCount == 0; }
+    const TouchPoint& lastInput() const { return mLastInput; }
+
+private:
+    struct Knot {
+        double t;       // Seconds since mOrigin
+        double x, y;    // Filtered position
+        double vx, vy;  // Kalman velocity estimate (px/s), used by Hermite tangents
+    };
+
+    const Knot& knot(size_t index) const {
+        return mKnots[(mFirstKnot + index) % kMaxKnots];
+    }
+
+    void tangent(size_t index, double& mx, double& my) const;
+
+    // Position at outputTime; segment is the first knot segment to search from and is left on
+    // the bracketing one, so increasing times can pass it on. False when extrapolation stalls.
+    bool evaluate(steady_clock::time_point outputTime, size_t& segment, double& x, double& y) const;
+
+    Config mCfg;
+    OneEuroFilter mOneEuro;
+    KalmanFilter mKalmanX;
+    KalmanFilter mKalmanY;
+
+    std::array<Knot, kMaxKnots> mKnots{};
+    size_t mFirstKnot = 0;
+    size_t mKnotCount = 0;
+    steady_clock::time_point mOrigin;
+    TouchPoint mLastInput;
+};
+
+} // namespace vtd
@@ -0,0 +1,77 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <linux/input.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace vtd {
+
+// One evdev frame (all events up to SYN_REPORT) handed to uinput with a single write().
+//
+// uinput accepts any number of whole input_events per write, so batching a frame costs
+// one kernel entry instead of one per event.
+class UinputFrame {
+public:
+    static constexpr size_t kCapacity = 96;  // 16 MT slots fully updated plus single-touch emulation
+
+    // Start a new frame stamped with the current time
+    void begin() {
+        mCount = 0;
+        gettimeofday(&mTime, nullptr);
+    }
+
+    // Append an event; false if the frame is full (SYN_REPORT is always reserved)
+    bool add(uint16_t type, uint16_t code, int32_t value) {
+        if (mCount + 1 >= kCapacity) {
+            return false;
+        }
+        input_event& ev = mEvents[mCount++];
+        ev.time = mTime;
+        ev.type = type;
+        ev.code = code;
+        ev.value = value;
+        return true;
+    }
+
+    size_t size() const { return mCount; }
+
+    // Terminate the frame with SYN_REPORT and write it; false if the write failed
+    bool submit(int fd) {
+        input_event& syn = mEvents[mCount++];
+        syn.time = mTime;
+        syn.type = EV_SYN;
+        syn.code = SYN_REPORT;
+        syn.value = 0;
+
+        const char* data = reinterpret_cast<const char*>(mEvents.data());
+        size_t remaining = mCount * sizeof(input_event);
+        mCount = 0;
+        while (remaining > 0) {
+            ssize_t written = write(fd, data, remaining);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+private:
+    std::array<input_event, kCapacity> mEvents{};
+    size_t mCount = 0;
+    timeval mTime{};
+};
+
+} // namespace vtd
+
+#endif
@@ -1,5 +1,9 @@
 
 #include "VirtualTouchDevice.h"
+#include "ContactTracker.h"
+#include "InputQueue.h"
+#include "TouchRecorder.h"
+#include "UinputFrame.h"
 #include <iostream>
 #include <cmath>
 #include <cstring>
@@ -36,89 +40,6 @@ Config Config::getDefault() {
     return cfg;
 }
 
-// --------------------- Internal Utility Functions ---------------------
-static double toSeconds(steady_clock::duration d) {
-    return duration_cast<duration<double>>(d).count();
-}
-
-
-// --------------------- File Recorder Utility ---------------------
-// Utility class for recording touch events to JSON files
-class FileRecorder {
-private:
-    std::vector<TouchPoint> mRecordedEvents;
-    std::string mFilePath;
-    bool mRecordRawInput{true};
-    Config mConfig;
-
-public:
-    FileRecorder(const std::string& filePath, const Config& config, bool recordRawInput = true)
-        : mFilePath(filePath), mRecordRawInput(recordRawInput), mConfig(config) {
-        mRecordedEvents.reserve(10000); // Reserve space for many events
-    }
-
-    void recordEvent(const TouchPoint& point) {
-        mRecordedEvents.push_back(point);
-    }
-
-    void saveToFile() {
-        if (mRecordedEvents.empty()) return;
-
-        std::ofstream file(mFilePath, std::ios::out | std::ios::trunc);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open " << (mRecordRawInput ? "raw_input" : "upsampled_output") << " record file: " << mFilePath << std::endl;
-            return;
-        }
-
-        file << "{\n";
-        file << "  \"deviceName\": \"" << mConfig.deviceName << "\",\n";
-        file << "  \"screenWidth\": " << mConfig.screenWidth << ",\n";
-        file << "  \"screenHeight\": " << mConfig.screenHeight << ",\n";
-        if (mRecordRawInput) {
-            file << "  \"recordType\": \"raw_ir_input\",\n";
-            file << "  \"inputRateHz\": " << mConfig.inputRateHz << ",\n";
-        } else {
-            file << "  \"recordType\": \"upsampled_output\",\n";
-            file << "  \"inputRateHz\": " << mConfig.inputRateHz << ",\n";
-            file << "  \"outputRateHz\": " << mConfig.outputRateHz << ",\n";
-        }
-        file << "  \"totalEvents\": " << mRecordedEvents.size() << ",\n";
-        file << "  \"events\": [\n";
-
-        for (size_t i = 0; i < mRecordedEvents.size(); ++i) {
-            const auto& event = mRecordedEvents[i];
-            auto timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                event.ts.time_since_epoch()).count();
-
-            file << "    {\n";
-            file << "      \"timestamp_ms\": " << timestamp_ms << ",\n";
-            file << "      \"x\": " << std::fixed << std::setprecision(2) << event.x << ",\n";
-            file << "      \"y\": " << std::fixed << std::setprecision(2) << event.y << ",\n";
-            file << "      \"touching\": " << (event.touching ? "true" : "false") << "\n";
-            file << "    }";
-            if (i < mRecordedEvents.size() - 1) {
-                file << ",";
-            }
-            file << "\n";
-        }
-
-        file << "  ]\n";
-        file << "}\n";
-        file.close();
-
-        std::cout << "Recorded " << mRecordedEvents.size()
-                  << " events to: " << mFilePath << std::endl;
-    }
-
-    size_t getEventCount() const {
-        return mRecordedEvents.size();
-    }
-
-    void clear() {
-        mRecordedEvents.clear();
-    }
-};
-
 // --------------------- Touch Device Interface ---------------------
 // Abstract interface for touch devices (uinput, mock, etc.)
 class TouchDevice {
@@ -127,6 +48,13 @@ public:
     virtual bool setup(const Config& cfg) = 0;
     virtual void teardown() = 0;
     virtual void emit(const TouchPoint& point) = 0;
+
+    // Emit every point of one output tick; backends that can batch a tick override this
+    virtual void emitFrame(const std::vector<TouchPoint>& points) {
+        for (const auto& point : points) {
+            emit(point);
+        }
+    }
 };
 
 // --------------------- Touch Device Implementations ---------------------
@@ -137,6 +65,8 @@ class LinuxTouchDevice : public TouchDevice {
 private:
     int mUinputFd = -1;
     bool mPressed  = false;
+    UinputFrame mFrame;
+    bool mWriteFailed = false;
 
 public:
     bool setup(const Config& cfg) override {
@@ -195,26 +125,203 @@ public:
     void emit(const TouchPoint& point) override {
         if (mUinputFd < 0) return;
 
-        struct input_event ev{};
-        gettimeofday(&ev.time, nullptr);
-
         // Move pointer
-        ev.type = EV_ABS; ev.code = ABS_X; ev.value = static_cast<int>(point.x);
-        write(mUinputFd, &ev, sizeof(ev));
-        ev.type = EV_ABS; ev.code = ABS_Y; ev.value = static_cast<int>(point.y);
-        write(mUinputFd, &ev, sizeof(ev));
+        mFrame.begin();
+        mFrame.add(EV_ABS, ABS_X, static_cast<int>(point.x));
+        mFrame.add(EV_ABS, ABS_Y, static_cast<int>(point.y));
 
         // Button press / release
         bool shouldPress = point.touching;
         if (shouldPress != mPressed) {
-            ev.type = EV_KEY; ev.code = BTN_LEFT; ev.value = shouldPress ? 1 : 0;
-            write(mUinputFd, &ev, sizeof(ev));
+            mFrame.add(EV_KEY, BTN_LEFT, shouldPress ? 1 : 0);
             mPressed = shouldPress;
         }
 
-        // Frame sync
-        ev.type = EV_SYN; ev.code = SYN_REPORT; ev.value = 0;
-        write(mUinputFd, &ev, sizeof(ev));
+        // Frame sync; the whole frame goes out in one write()
+        if (!mFrame.submit(mUinputFd) && !mWriteFailed) {
+            perror("write uinput frame");
+            mWriteFailed = true;  // Report once, not at the output rate
+        }
+    }
+};
+
+// Linux uinput multi-touch device (MT protocol B)
+//
+// Each slot carries a tracking id while its contact is down; ABS_MT_TRACKING_ID -1 lifts it.
+// Unchanged slot state is not re-sent, and all slots of an output tick go out as one frame.
+// BTN_TOUCH and ABS_X/ABS_Y follow the lowest active slot for single-touch consumers.
+class LinuxMultiTouchDevice : public TouchDevice {
+private:
+    int mUinputFd = -1;
+    int mSlotCount = 1;
+    UinputFrame mFrame;
+    bool mWriteFailed = false;
+
+    // Last state sent to the kernel
+    int mCurrentSlot = -1;
+    int mNextTrackingId = 0;
+    std::array<int, ContactTracker::kMaxSlots> mTrackingId;  // -1 while the slot is up
+    std::array<int, ContactTracker::kMaxSlots> mX;
+    std::array<int, ContactTracker::kMaxSlots> mY;
+    bool mTouching = false;
+    int mPrimaryX = -1;
+    int mPrimaryY = -1;
+
+    void selectSlot(int slot) {
+        if (slot != mCurrentSlot) {
+            mFrame.add(EV_ABS, ABS_MT_SLOT, slot);
+            mCurrentSlot = slot;
+        }
+    }
+
+    void addPoint(const TouchPoint& point) {
+        if (point.slot < 0 || point.slot >= mSlotCount) return;
+        int slot = point.slot;
+
+        if (!point.touching) {
+            if (mTrackingId[slot] >= 0) {
+                selectSlot(slot);
+                mFrame.add(EV_ABS, ABS_MT_TRACKING_ID, -1);
+                mTrackingId[slot] = -1;
+            }
+            return;
+        }
+
+        selectSlot(slot);
+        if (mTrackingId[slot] < 0) {
+            mTrackingId[slot] = mNextTrackingId;
+            mNextTrackingId = (mNextTrackingId + 1) & 0xffff;
+            mFrame.add(EV_ABS, ABS_MT_TRACKING_ID, mTrackingId[slot]);
+            mX[slot] = -1;
+            mY[slot] = -1;
+        }
+        int x = static_cast<int>(point.x);
+        int y = static_cast<int>(point.y);
+        if (x != mX[slot]) {
+            mFrame.add(EV_ABS, ABS_MT_POSITION_X, x);
+            mX[slot] = x;
+        }
+        if (y != mY[slot]) {
+            mFrame.add(EV_ABS, ABS_MT_POSITION_Y, y);
+            mY[slot] = y;
+        }
+    }
+
+    void submitFrame() {
+        // Single-touch emulation from the lowest active slot
+        int primary = -1;
+        for (int slot = 0; slot < mSlotCount && primary < 0; ++slot) {
+            if (mTrackingId[slot] >= 0) primary = slot;
+        }
+        bool touching = primary >= 0;
+        if (touching != mTouching) {
+            mFrame.add(EV_KEY, BTN_TOUCH, touching ? 1 : 0);
+            mTouching = touching;
+        }
+        if (touching) {
+            if (mX[primary] != mPrimaryX) {
+                mFrame.add(EV_ABS, ABS_X, mX[primary]);
+                mPrimaryX = mX[primary];
+            }
+            if (mY[primary] != mPrimaryY) {
+                mFrame.add(EV_ABS, ABS_Y, mY[primary]);
+                mPrimaryY = mY[primary];
+            }
+        }
+
+        if (mFrame.size() == 0) return;  // Nothing changed this tick
+        if (!mFrame.submit(mUinputFd) && !mWriteFailed) {
+            perror("write uinput frame");
+            mWriteFailed = true;  // Report once, not at the output rate
+        }
+    }
+
+public:
+    bool setup(const Config& cfg) override {
+        mSlotCount = std::max(1, std::min(cfg.maxContacts, static_cast<int>(ContactTracker::kMaxSlots)));
+        mTrackingId.fill(-1);
+        mX.fill(-1);
+        mY.fill(-1);
+
+        mUinputFd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+        if (mUinputFd < 0) {
+            perror("open /dev/uinput");
+            return false;
+        }
+
+        // Advertise a direct (touchscreen) multi-touch device
+        ioctl(mUinputFd, UI_SET_EVBIT, EV_SYN);
+        ioctl(mUinputFd, UI_SET_EVBIT, EV_KEY);
+        ioctl(mUinputFd, UI_SET_EVBIT, EV_ABS);
+        ioctl(mUinputFd, UI_SET_PROPBIT, INPUT_PROP_DIRECT);
+
+        ioctl(mUinputFd, UI_SET_KEYBIT, BTN_TOUCH);
+        ioctl(mUinputFd, UI_SET_ABSBIT, ABS_X);
+        ioctl(mUinputFd, UI_SET_ABSBIT, ABS_Y);
+        ioctl(mUinputFd, UI_SET_ABSBIT, ABS_MT_SLOT);
+        ioctl(mUinputFd, UI_SET_ABSBIT, ABS_MT_TRACKING_ID);
+        ioctl(mUinputFd, UI_SET_ABSBIT, ABS_MT_POSITION_X);
+        ioctl(mUinputFd, UI_SET_ABSBIT, ABS_MT_POSITION_Y);
+
+        struct uinput_user_dev uidev{};
+        snprintf(uidev.name, sizeof(uidev.name), "%s", cfg.deviceName.c_str());
+        uidev.id.bustype = BUS_USB;
+        uidev.id.vendor  = 0x1234;
+        uidev.id.product = 0x5679;
+        uidev.id.version = 1;
+
+        // Absolute coordinate and slot ranges
+        uidev.absmin[ABS_X] = 0;
+        uidev.absmax[ABS_X] = cfg.screenWidth  - 1;
+        uidev.absmin[ABS_Y] = 0;
+        uidev.absmax[ABS_Y] = cfg.screenHeight - 1;
+        uidev.absmin[ABS_MT_SLOT] = 0;
+        uidev.absmax[ABS_MT_SLOT] = mSlotCount - 1;
+        uidev.absmin[ABS_MT_TRACKING_ID] = 0;
+        uidev.absmax[ABS_MT_TRACKING_ID] = 0xffff;
+        uidev.absmin[ABS_MT_POSITION_X] = 0;
+        uidev.absmax[ABS_MT_POSITION_X] = cfg.screenWidth  - 1;
+        uidev.absmin[ABS_MT_POSITION_Y] = 0;
+        uidev.absmax[ABS_MT_POSITION_Y] = cfg.screenHeight - 1;
+
+        if (write(mUinputFd, &uidev, sizeof(uidev)) < 0) {
+            perror("write uidev");
+            close(mUinputFd);
+            mUinputFd = -1;
+            return false;
+        }
+        if (ioctl(mUinputFd, UI_DEV_CREATE) < 0) {
+            perror("UI_DEV_CREATE");
+            close(mUinputFd);
+            mUinputFd = -1;
+            return false;
+        }
+
+        return true;
+    }
+
+    void teardown() override {
+        if (mUinputFd >= 0) {
+            ioctl(mUinputFd, UI_DEV_DESTROY);
+            close(mUinputFd);
+            mUinputFd = -1;
+        }
+    }
+
+    void emit(const TouchPoint& point) override {
+        if (mUinputFd < 0) return;
+        mFrame.begin();
+        addPoint(point);
+        submitFrame();
+    }
+
+    void emitFrame(const std::vector<TouchPoint>& points) override {
+        if (mUinputFd < 0) return;
+        mFrame.begin();
+        for (const auto& point : points) {
+            addPoint(point);
+        }
+        submitFrame();
     }
 };
 
@@ -253,6 +360,13 @@ std::unique_ptr<TouchDevice> createTouchDevice(const Config& cfg) {
             return std::make_unique<MockTouchDevice>();
 #endif
 
+        case DeviceType::LinuxMultiTouch:
+#ifdef __linux__
+            return std::make_unique<LinuxMultiTouchDevice>();
+#else
+            return std::make_unique<MockTouchDevice>();
+#endif
+
         case DeviceType::Mock:
         default:
             return std::make_unique<MockTouchDevice>();
@@ -264,38 +378,37 @@ std::unique_ptr<TouchDevice> createTouchDevice(const Config& cfg) {
 // --------------------- VirtualTouchDevice::Impl Class ---------------------
 class VirtualTouchDevice::Impl {
 public:
-    explicit Impl(const Config& cfg) : mCfg(cfg) {
-        // Pre-allocate processing buffer for efficiency
-        // Reserve space for: inputRate * historyDuration + some extra headroom
-        size_t expectedSize = static_cast<size_t>(cfg.inputRateHz * cfg.maxInputHistorySec * 1.5);
-        mProcessingBuffer.reserve(std::max(expectedSize, size_t(100))); // Minimum 100 elements
-
+    explicit Impl(const Config& cfg)
+        : mCfg(cfg), mTracker(cfg, static_cast<size_t>(std::max(1, cfg.maxContacts))),
+          mScheduler(duration_cast<steady_clock::duration>(duration<double>(1.0 / cfg.outputRateHz)),
+                     makeSchedulerOptions(cfg)) {
+        mOutputFrame.reserve(2 * ContactTracker::kMaxSlots);
 
         // Create appropriate touch device
         mTouchDevice = createTouchDevice(cfg);
 
         // Initialize recording functionality if enabled
         if (cfg.enableRawInputRecording) {
-            mRawInputRecorder = std::make_unique<FileRecorder>(
-                cfg.rawInputRecordPath, cfg, true);
+            mRawInputRecorder = std::make_unique<TouchRecorder>(
+                cfg.rawInputRecordPath, cfg, RecordType::RawInput);
         }
 
         if (cfg.enableUpsampledRecording) {
-            mUpsampledRecorder = std::make_unique<FileRecorder>(
-                cfg.upsampledRecordPath,  cfg, false);
+            mUpsampledRecorder = std::make_unique<TouchRecorder>(
+                cfg.upsampledRecordPath, cfg, RecordType::UpsampledOutput);
         }
     }
 
     ~Impl() {
         stop();
 
-        // Save recorded data before destruction
+        // Write out the rest of the recordings
         if (mRawInputRecorder) {
-            mRawInputRecorder->saveToFile();
+            mRawInputRecorder->close();
         }
 
         if (mUpsampledRecorder) {
-            mUpsampledRecorder->saveToFile();
+            mUpsampledRecorder->close();
         }
     }
 
@@ -305,37 +418,42 @@ public:
             std::cerr << "Failed to setup touch device\n";
             mRunning=false; return false;
         }
-        mSenderThread=std::thread(&Impl::senderLoop,this);
+        if (!mCfg.simulatedClock) {
+            mSenderThread=std::thread(&Impl::senderLoop,this);
+        }
         return true;
     }
 
     void stop() {
         if (!mRunning.exchange(false)) return;
         if (mSenderThread.joinable()) mSenderThread.join();
+        if (mCfg.simulatedClock) {
+            releaseAll(now());
+        }
+        if (mInputQueue.droppedCount() > 0) {
+            std::cerr << "Input queue full: dropped " << mInputQueue.droppedCount() << " of "
+                      << mInputQueue.droppedCount() + mInputQueue.pushedCount() << " input frames\n";
+        }
+        if (mRejectedFrames.load(std::memory_order_relaxed) > 0) {
+            std::cerr << "Ignored " << mRejectedFrames.load(std::memory_order_relaxed)
+                      << " input frames with invalid points\n";
+        }
         if (mTouchDevice) {
             mTouchDevice->teardown();
         }
     }
 
-    void pushInputPoint(const TouchPoint& p) {
-        // Validate input point
-        if (std::isnan(p.x) || std::isnan(p.y) ||
-            p.x < 0 || p.x > mCfg.screenWidth - 1 ||
-            p.y < 0 || p.y > mCfg.screenHeight - 1 ) {
-            perror("invalid input point");
-            return;
-        }
-
-        // Record raw input if enabled
-        if (mRawInputRecorder) {
-            mRawInputRecorder->recordEvent(p);
+    void pushInputPoint(const TouchPoint& input) {
+        // Single-touch input is one contact with a fixed id
+        TouchPoint p = input;
+        if (p.contactId < 0) {
+            p.contactId = 0;
         }
+        pushFrame(&p, 1);
+    }
 
-        {
-            std::lock_guard<std::mutex> g(mInputMutex);
-            mLatestInput = p;
-            mHasNewInput = true;
-        }
+    void pushInputFrame(const std::vector<TouchPoint>& contacts) {
+        pushFrame(contacts.data(), contacts.size());
     }
 
     // Event callback interface
@@ -343,24 +461,41 @@ public:
         mEventCallback = callback;
     }
 
+    void alignOutputPhase(steady_clock::time_point vsync) {
+        mScheduler.alignPhase(vsync);
+    }
+
+    bool advanceClock(steady_clock::time_point until) {
+        if (!mCfg.simulatedClock || !mRunning) return false;
+        steady_clock::time_point tick;
+        while (mScheduler.pollNextTick(until, tick)) {
+            processTick(tick);
+        }
+        mCfg.simulatedClock->advanceTo(until);
+        return true;
+    }
+
+    PeriodicSchedulerStats getOutputTimingStats() const {
+        return mScheduler.getStats();
+    }
+
     // Access to touch device for testing
     TouchDevice* getTouchDevice() const { return mTouchDevice.get(); }
 
 private:
     Config mCfg;
-    std::vector<TouchPoint> mProcessingBuffer;  // Only accessed by processing thread
+    ContactTracker mTracker;  // Only accessed by processing thread
 
-    // Single input point with minimal locking
-    std::mutex mInputMutex;
-    TouchPoint mLatestInput;
-    bool mHasNewInput = false;
+    // Every input frame since the last tick, from the input thread without locking
+    InputQueue mInputQueue;
+    std::atomic<uint64_t> mRejectedFrames{0};  // Written by the input thread only
 
-    // Touch timeout tracking (processing thread only)
-    std::chrono::steady_clock::time_point mLastInputTime;
-    bool mHasActiveTouch = false;
+    // Processing thread only
+    std::vector<TouchPoint> mOutputFrame;
 
     std::atomic<bool> mRunning{false};
     std::thread mSenderThread;
+    PeriodicScheduler mScheduler;  // Absolute output deadlines; waited on by the sender thread
 
     std::unique_ptr<TouchDevice> mTouchDevice;
 
@@ -368,247 +503,129 @@ private:
     std::function<void(const TouchPoint&)> mEventCallback;
 
     // Recording functionality
-    std::unique_ptr<FileRecorder> mRawInputRecorder;
-    std::unique_ptr<FileRecorder> mUpsampledRecorder;
+    std::unique_ptr<TouchRecorder> mRawInputRecorder;   // Input thread
+    std::unique_ptr<TouchRecorder> mUpsampledRecorder;  // Sender thread
+
+    static PeriodicSchedulerOptions makeSchedulerOptions(const Config& cfg) {
+        PeriodicSchedulerOptions options;
+        options.realtimePriority = cfg.senderPriority;
+        options.phaseOffset = duration_cast<nanoseconds>(duration<double, std::milli>(cfg.outputPhaseOffsetMs));
+        options.simulatedClock = cfg.simulatedClock;
+        return options;
+    }
 
-    bool findBracketing(steady_clock::time_point target, TouchPoint& a, TouchPoint& b) {
-        // Lock-free operation - only called from processing thread
-        if (mProcessingBuffer.empty()) return false;
+    steady_clock::time_point now() const {
+        return mCfg.simulatedClock ? mCfg.simulatedClock->now() : steady_clock::now();
+    }
 
-        // Need at least 2 points for proper interpolation
-        if (mProcessingBuffer.size() < 2) return false;
+    void pushFrame(const TouchPoint* contacts, size_t count) {
+        // Arrival time, not the next output tick, is when the sensor positions were valid
+        auto arrival = now();
 
-        if (target <= mProcessingBuffer.front().ts){
-            a=b=mProcessingBuffer.front();
-            return true;
+        // A frame with an invalid point is ignored as a whole: committing it without that
+        // contact would lift it, and one noisy edge sample mid-drag would become a click
+        for (size_t i = 0; i < count; ++i) {
+            if (!isValidInput(contacts[i])) {
+                reportInvalidInput(contacts[i]);
+                return;
+            }
         }
 
-        if (target >= mProcessingBuffer.back().ts){
-            auto& last = mProcessingBuffer.back();
-
-            // Check if we're too far ahead for extrapolation
-            double future = toSeconds(target - last.ts);
-            auto extrapolationLimit = std::chrono::duration<double, std::milli>(mCfg.maxExtrapolationMs);
-            if (future > extrapolationLimit.count() / 1000.0) {
-                // Don't generate events beyond extrapolation limit
-                return false;
+        InputFrame* frame = mInputQueue.beginPush();
+        if (!frame) {
+            return;  // Sender thread stalled; counted by the queue
+        }
+        for (size_t i = 0; i < count && frame->count < frame->contacts.size(); ++i) {
+            TouchPoint p = contacts[i];
+            if (mCfg.stampInputOnArrival) {
+                p.ts = arrival;
             }
 
-            // Extrapolate if we have velocity information and sufficient confidence
-            if (mProcessingBuffer.size() >= 2){
-                double confidence = calculateVelocityConfidence(mProcessingBuffer);
-                if (confidence > 0.5) { // Only extrapolate with reasonable confidence
-                    // Use weighted average of multiple points for better velocity estimation
-                    size_t pointsToUse = std::min(size_t(3), mProcessingBuffer.size());
-                    double totalWeight = 0.0;
-                    double vx = 0.0, vy = 0.0;
-
-                    for (size_t i = 0; i < pointsToUse - 1; ++i) {
-                        size_t idx1 = mProcessingBuffer.size() - 1 - i;
-                        size_t idx2 = mProcessingBuffer.size() - 2 - i;
-
-                        double dt = toSeconds(mProcessingBuffer[idx1].ts - mProcessingBuffer[idx2].ts);
-                        if (dt > 1e-6) {
-                            double weight = 1.0 / (1.0 + i); // Recent points have higher weight
-                            vx += weight * (mProcessingBuffer[idx1].x - mProcessingBuffer[idx2].x) / dt;
-                            vy += weight * (mProcessingBuffer[idx1].y - mProcessingBuffer[idx2].y) / dt;
-                            totalWeight += weight;
-                        }
-                    }
-
-                    if (totalWeight > 0.0) {
-                        vx /= totalWeight;
-                        vy /= totalWeight;
-
-                        a = last;
-                        b = last;
-                        b.x = float(last.x + vx * future);
-                        b.y = float(last.y + vy * future);
-                        b.ts = target;
-                        b.touching = last.touching;
-
-                        // Validate extrapolated position is reasonable
-                        if (b.x >= -100 && b.x <= mCfg.screenWidth + 100 &&
-                            b.y >= -100 && b.y <= mCfg.screenHeight + 100) {
-                            return true;
-                        }
-                    }
-                }
+            // Record raw input if enabled
+            if (mRawInputRecorder) {
+                mRawInputRecorder->record(p);
             }
-            a=b=last;
-            return true;
+            frame->contacts[frame->count++] = p;
         }
-
-        //should never happen
-        std::cout<<"should never happen\n";
-        assert(false);
-
-        return false;
+        mInputQueue.commitPush();
     }
 
-    TouchPoint interpolate(const TouchPoint& a, const TouchPoint& b, steady_clock::time_point t) {
-        TouchPoint out;
-        out.ts = t;
-
-        double denom = toSeconds(b.ts - a.ts);
-        double u = (denom <= 1e-6) ? 0.0 : toSeconds(t - a.ts) / denom;
-
-        // Clamp interpolation factor
-        u = std::max(0.0, std::min(1.0, u));
-
-        // Interpolate position
-        out.x = float((1.0 - u) * a.x + u * b.x);
-        out.y = float((1.0 - u) * a.y + u * b.y);
-
-        out.touching = true;
-
-        return out;
+    bool isValidInput(const TouchPoint& p) const {
+        return !std::isnan(p.x) && !std::isnan(p.y) &&
+               p.x >= 0 && p.x <= mCfg.screenWidth - 1 &&
+               p.y >= 0 && p.y <= mCfg.screenHeight - 1;
     }
 
-    double calculateVelocityConfidence(const std::vector<TouchPoint>& buffer, size_t count = 3) {
-        if (buffer.size() < 2) return 0.0;
-
-        // Use std::array with bounds checking
-        std::array<double, 10> speeds;
-        size_t speedCount = 0;
-
-        size_t pointsToCheck = std::min({count, buffer.size() - 1, speeds.size()});
-        double avgSpeed = 0.0;
-        double speedVariance = 0.0;
-
-        // Calculate speeds between consecutive points
-        for (size_t i = 0; i < pointsToCheck; ++i) {
-            size_t idx1 = buffer.size() - 1 - i;
-            size_t idx2 = buffer.size() - 2 - i;
-
-            double dt = toSeconds(buffer[idx1].ts - buffer[idx2].ts);
-            if (dt > 1e-6 && speedCount < speeds.size()) {
-                double dx = buffer[idx1].x - buffer[idx2].x;
-                double dy = buffer[idx1].y - buffer[idx2].y;
-                double speed = std::sqrt(dx*dx + dy*dy) / dt;
-                speeds[speedCount] = speed;
-                avgSpeed += speed;
-                speedCount++;
-            }
-        }
-
-        if (speedCount == 0) return 0.0;
-
-        avgSpeed /= speedCount;
-
-        // Calculate variance
-        for (size_t i = 0; i < speedCount; ++i) {
-            double diff = speeds[i] - avgSpeed;
-            speedVariance += diff * diff;
+    // Input thread; logs the 1st, 2nd, 4th, 8th... rejected frame so a noisy sensor
+    // cannot flood stderr from the input path
+    void reportInvalidInput(const TouchPoint& p) {
+        uint64_t rejected = mRejectedFrames.load(std::memory_order_relaxed) + 1;
+        mRejectedFrames.store(rejected, std::memory_order_relaxed);
+        if ((rejected & (rejected - 1)) == 0) {
+            std::cerr << "Invalid input point (" << p.x << ", " << p.y << "): ignored " << rejected
+                      << " input frame(s)\n";
         }
-        speedVariance /= speedCount;
-
-        // Confidence is inversely related to coefficient of variation
-        if (avgSpeed < 1e-6) return 1.0; // Static point, high confidence
-
-        double cv = std::sqrt(speedVariance) / avgSpeed;
-        return std::exp(-cv); // Returns value between 0 and 1
     }
 
-    void emitTouchPoint(const TouchPoint& point) {
-        // Record upsampled output if enabled
-        if (mUpsampledRecorder) {
-            mUpsampledRecorder->recordEvent(point);
-        }
+    // All points of one output tick: lifts first, then the position of every active slot
+    void emitFrame(const std::vector<TouchPoint>& points) {
+        for (const auto& point : points) {
+            // Record upsampled output if enabled
+            if (mUpsampledRecorder) {
+                mUpsampledRecorder->record(point);
+            }
 
-        // Call the callback first if installed
-        if (mEventCallback) {
-            mEventCallback(point);
+            // Call the callback first if installed
+            if (mEventCallback) {
+                mEventCallback(point);
+            }
         }
 
-        // Then emit to the backend device
+        // Then emit to the backend device, one frame per tick
         if (mTouchDevice) {
-            mTouchDevice->emit(point);
+            mTouchDevice->emitFrame(points);
         }
     }
 
-    void cleanupOldPoints(steady_clock::time_point /*currentTime*/) {
-        if (mProcessingBuffer.size() > 20) {
-            mProcessingBuffer.erase(mProcessingBuffer.begin());
-        }
-    }
-
-    void handleReleaseTouchPoint(const TouchPoint& releasePoint) {
-        std::cout<<"handleReleaseTouchPoint \n";
-        emitTouchPoint(releasePoint);
-        mHasActiveTouch = false;
-        mProcessingBuffer.clear();
-    }
-
     void senderLoop() {
-        using clk = steady_clock;
-        double period = 1.0 / mCfg.outputRateHz;
-
         while (mRunning) {
-            auto currentTick = clk::now();
-
-            // Check for new input and update timestamp to current tick
-            bool processNewInput = false;
-            TouchPoint newInput;
-            {
-                std::lock_guard<std::mutex> g(mInputMutex);
-                if (mHasNewInput) {
-                    newInput = mLatestInput;
-                    newInput.ts = currentTick; // Update timestamp to current tick
-                    processNewInput = true;
-                    mHasNewInput = false;
-                    mLastInputTime = currentTick;
-                }
-            }
-
-            // Handle new input.
-            if (processNewInput) {
-                if (newInput.touching) {
-                    mProcessingBuffer.push_back(newInput);
-                    mHasActiveTouch = true;
-                    emitTouchPoint(newInput);
-                } else {
-                    handleReleaseTouchPoint(newInput);
-                }
-            } else { //handle upsampling if required.
-                if (mHasActiveTouch) {
-                    auto timeSinceLastInput = toSeconds(currentTick - mLastInputTime);
-                    if (timeSinceLastInput >= 0.1 ) {
-                        TouchPoint releasePoint = mProcessingBuffer.back();
-                        releasePoint.ts = currentTick;
-                        releasePoint.touching = false;
-                        handleReleaseTouchPoint(releasePoint);
-                    } else {
-                        if (mProcessingBuffer.size() >= 2) {
-                            TouchPoint a, b;
-                            if (findBracketing(currentTick, a, b)) {
-                                TouchPoint out = interpolate(a, b, currentTick);
-
-                                out.x = std::max(0.0f, std::min(out.x, float(mCfg.screenWidth-1)));
-                                out.y = std::max(0.0f, std::min(out.y, float(mCfg.screenHeight-1)));
-
-                                emitTouchPoint(out);
-                            }
-                        }
-                    }
-                }
+            // Deadlines advance by exactly one period, however late this thread woke up
+            processTick(mScheduler.waitNextTick());
+        }
 
-            }
+        // Send final release if needed
+        releaseAll(steady_clock::now());
+    }
 
-            // Clean up old points periodically
-            cleanupOldPoints(currentTick);
+    // One output tick; on the sender thread, or the caller of advanceClock() in virtual time
+    void processTick(steady_clock::time_point currentTick) {
+        // Every frame since the last tick feeds the motion model, oldest first;
+        // contacts that left a frame are lifted
+        mOutputFrame.clear();
+        mInputQueue.drain([this](const InputFrame& frame) {
+            mTracker.applyFrame(frame.contacts.data(), frame.count, mOutputFrame);
+        });
+        mTracker.expire(currentTick, ContactTracker::kInputTimeoutSec, mOutputFrame);
+
+        // Upsample every active contact at this tick
+        size_t firstSample = mOutputFrame.size();
+        mTracker.sample(currentTick, mOutputFrame);
+        for (size_t i = firstSample; i < mOutputFrame.size(); ++i) {
+            TouchPoint& out = mOutputFrame[i];
+            out.x = std::max(0.0f, std::min(out.x, float(mCfg.screenWidth-1)));
+            out.y = std::max(0.0f, std::min(out.y, float(mCfg.screenHeight-1)));
+        }
 
-            // Wait for next tick using fixed interval
-            auto nextTick = currentTick + std::chrono::duration_cast<steady_clock::duration>(duration<double>(period));
-            std::this_thread::sleep_until(nextTick);
+        if (!mOutputFrame.empty()) {
+            emitFrame(mOutputFrame);
         }
+    }
 
-        // Send final release if needed
-        if (mHasActiveTouch && !mProcessingBuffer.empty()) {
-            TouchPoint rel = mProcessingBuffer.back();
-            rel.ts = clk::now();
-            rel.touching = false;
-            handleReleaseTouchPoint(rel);
+    void releaseAll(steady_clock::time_point releaseTime) {
+        mOutputFrame.clear();
+        mTracker.liftAll(releaseTime, mOutputFrame);
+        if (!mOutputFrame.empty()) {
+            emitFrame(mOutputFrame);
         }
     }
 
@@ -634,11 +651,27 @@ void VirtualTouchDevice::pushInputPoint(const TouchPoint& p) {
     mImpl->pushInputPoint(p);
 }
 
+void VirtualTouchDevice::pushInputFrame(const std::vector<TouchPoint>& contacts) {
+    mImpl->pushInputFrame(contacts);
+}
+
 // Event callback interface
 void VirtualTouchDevice::setEventCallback(std::function<void(const TouchPoint&)> callback) {
     mImpl->setEventCallback(callback);
 }
 
+void VirtualTouchDevice::alignOutputPhase(steady_clock::time_point vsync) {
+    mImpl->alignOutputPhase(vsync);
+}
+
+bool VirtualTouchDevice::advanceClock(steady_clock::time_point until) {
+    return mImpl->advanceClock(until);
+}
+
+PeriodicSchedulerStats VirtualTouchDevice::getOutputTimingStats() const {
+    return mImpl->getOutputTimingStats();
+}
+
 // --------------------- VirtualTouchDevice::Impl Method Implementations ---------------------
 
 } // namespace vtd
@@ -4,6 +4,9 @@
 #include <string>
 #include <chrono>
 #include <functional>
+#include <vector>
+
+#include "periodic_scheduler.h"
 
 using namespace std::chrono;
 
@@ -14,14 +17,31 @@ struct TouchPoint {
     float x = 0.0f;
     float y = 0.0f;
     bool touching = false;
+    int slot = 0;         // Output: MT slot the point belongs to (0 for single touch)
+    int contactId = -1;   // Input: sensor contact id, -1 to associate contacts by position
 };
 
 // --------------------- Device Types ---------------------
 enum class DeviceType {
     Linux,          // Linux uinput device (requires /dev/uinput access)
+    LinuxMultiTouch, // Linux uinput multi-touch device, MT protocol B (requires /dev/uinput access)
     Mock            // Mock device for testing (no actual output)
 };
 
+// --------------------- Upsampling ---------------------
+enum class FilterType {
+    None,           // Use input positions as received
+    OneEuro,        // Speed-adaptive low-pass (one-euro filter)
+    Kalman          // Constant-velocity Kalman filter per axis
+};
+
+enum class InterpolationType {
+    Linear,         // Piecewise linear between input points
+    CatmullRom,     // Cubic through input points, tangents from neighbouring points
+    Hermite         // Cubic through input points, tangents from the Kalman velocity estimate
+                    // (Catmull-Rom tangents with other filters)
+};
+
 // --------------------- Config ---------------------
 struct Config {
     int screenWidth = 1920;
@@ -33,14 +53,34 @@ struct Config {
     double touchTimeoutMs = 200.0;     // Auto-release touch after this timeout (0 = disabled)
     std::string deviceName = "Virtual IR Touch";
 
+    // Upsampling engine
+    bool stampInputOnArrival = true;   // Timestamp input when pushed; false keeps TouchPoint::ts as given
+    FilterType filterType = FilterType::None;  // OneEuro/CatmullRom smooth jitter but add ~2.5 ms of lag
+    InterpolationType interpolationType = InterpolationType::Linear;
+    double predictionHorizonMs = 0.0;  // Evaluate the trajectory this far past output time (< 0 renders delayed)
+    double oneEuroMinCutoffHz = 1.0;   // Cutoff at rest; lower suppresses more jitter
+    double oneEuroBeta = 0.05;         // Cutoff increase per px/s of speed; higher reduces lag
+    double oneEuroDerivativeCutoffHz = 1.0;
+    double kalmanProcessNoise = 3.0e6; // Acceleration noise spectral density (px^2/s^3)
+    double kalmanMeasurementNoise = 4.0; // Input position variance (px^2)
+
+    // Multi-touch
+    int maxContacts = 1;               // Simultaneous contacts tracked (MT slots), up to 16
+    double contactAssociationDistancePx = 150.0; // Max movement per input frame for an anonymous contact to keep its slot
+
+    // Output scheduling
+    int senderPriority = 0;            // SCHED_FIFO priority of the sender thread (0 = normal scheduling)
+    double outputPhaseOffsetMs = 0.0;  // Tick offset from the anchor given to alignOutputPhase()
+    std::shared_ptr<SimulatedClock> simulatedClock; // Run in virtual time: no sender thread, ticks run in advanceClock()
+
     // Device configuration
     DeviceType deviceType = DeviceType::Mock; // Device type selection
 
     // Recording configuration - works with all backends
     bool enableRawInputRecording = false;        // Record raw input from user
     bool enableUpsampledRecording = false;       // Record upsampled touchpoints
-    std::string rawInputRecordPath = "./raw_input.json";         // File path for raw input recording
-    std::string upsampledRecordPath = "./upsampled_output.json"; // File path for upsampled recording
+    std::string rawInputRecordPath = "./raw_input.vtdrec";         // File path for raw input recording
+    std::string upsampledRecordPath = "./upsampled_output.vtdrec"; // File path for upsampled recording
 
     // Default configuration factory
     static Config getDefault();
@@ -53,11 +93,31 @@ public:
 
     bool start();
     void stop();
+
+    // Input is handed to the sender thread through a lock-free single-producer queue, so
+    // pushInputPoint() and pushInputFrame() must be called from one thread (the sensor reader).
+    // Every pushed sample reaches the motion model, however many arrive between output ticks.
     void pushInputPoint(const TouchPoint& p);
 
+    // Push one sensor frame with every current contact. Contacts missing from the frame
+    // are lifted; each contact is tracked in its own slot (up to Config::maxContacts).
+    void pushInputFrame(const std::vector<TouchPoint>& contacts);
+
     // Event callback interface (works with all device types)
     void setEventCallback(std::function<void(const TouchPoint&)> callback);
 
+    // Align output ticks to a display vsync timestamp (callable from any thread)
+    void alignOutputPhase(steady_clock::time_point vsync);
+
+    // Simulated clock only: run every output tick up to until on the calling thread (the
+    // input thread), then leave the clock at until. Input pushed in between is stamped with
+    // the simulated time, so whole sessions replay faster than real time and deterministically.
+    // Returns false when the device is stopped or runs on the real clock.
+    bool advanceClock(steady_clock::time_point until);
+
+    // Wake-up cadence of the sender thread (lateness percentiles, missed ticks)
+    PeriodicSchedulerStats getOutputTimingStats() const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> mImpl;
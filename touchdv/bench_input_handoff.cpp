@@ -0,0 +1,134 @@
+// Benchmark: input samples lost between the sensor reader and the 120 Hz sender thread.
+//
+// A reader thread pushes samples at the input rate, from its own slightly drifting sensor
+// clock and with arrival jitter as USB and serial readers deliver them, while a sender
+// thread wakes on absolute 120 Hz deadlines and takes what arrived. The previous hand-off
+// kept only the latest sample under a mutex; the InputQueue hands over every sample
+// since the last tick.
+#include "InputQueue.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unistd.h>
+
+using namespace vtd;
+
+namespace {
+
+constexpr double kOutputRateHz = 120.0;
+
+// Previous hand-off: one latest sample, overwritten by every push
+class LatestValueHandoff {
+public:
+    void push(const TouchPoint& p) {
+        std::lock_guard<std::mutex> g(mMutex);
+        mLatest = p;
+        mHasNew = true;
+    }
+
+    size_t take() {
+        std::lock_guard<std::mutex> g(mMutex);
+        bool hadNew = mHasNew;
+        mHasNew = false;
+        return hadNew ? 1 : 0;
+    }
+
+private:
+    std::mutex mMutex;
+    TouchPoint mLatest;
+    bool mHasNew = false;
+};
+
+class QueueHandoff {
+public:
+    void push(const TouchPoint& p) {
+        InputFrame* frame = mQueue.beginPush();
+        if (frame) {
+            frame->contacts[frame->count++] = p;
+            mQueue.commitPush();
+        }
+    }
+
+    size_t take() {
+        return mQueue.drain([](const InputFrame&) {});
+    }
+
+private:
+    InputQueue mQueue;
+};
+
+struct Result {
+    size_t pushed = 0;
+    size_t received = 0;
+};
+
+template <typename Handoff>
+Result run(double inputRateHz, double driftPercent, double jitterMs, double seconds) {
+    Handoff handoff;
+    Result result;
+    std::atomic<bool> producing{true};
+
+    std::thread reader([&] {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> jitter(0.0, jitterMs);
+        auto start = steady_clock::now();
+        size_t total = static_cast<size_t>(inputRateHz * seconds);
+        for (size_t i = 0; i < total; ++i) {
+            double due = static_cast<double>(i) / (inputRateHz * (1.0 + driftPercent / 100.0)) + jitter(rng) / 1000.0;
+            std::this_thread::sleep_until(start + duration_cast<steady_clock::duration>(duration<double>(due)));
+            TouchPoint p{steady_clock::now(), static_cast<float>(i), 0.0f, true};
+            handoff.push(p);
+        }
+        result.pushed = total;
+        producing = false;
+    });
+
+    PeriodicScheduler scheduler(duration_cast<steady_clock::duration>(duration<double>(1.0 / kOutputRateHz)));
+    bool draining = true;
+    while (draining) {
+        draining = producing.load();
+        scheduler.waitNextTick();
+        result.received += handoff.take();
+    }
+    reader.join();
+    return result;
+}
+
+void report(double rateHz, const char* name, const Result& result) {
+    double dropped = result.pushed ? 100.0 * static_cast<double>(result.pushed - result.received) /
+                                         static_cast<double>(result.pushed)
+                                   : 0.0;
+    std::printf("%8.0f  %-22s %8zu %9zu %9.1f%%\n", rateHz, name, result.pushed, result.received, dropped);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double driftPercent = 0.5;
+    double jitterMs = 2.0;
+    double seconds = 3.0;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:j:s:")) != -1) {
+        switch (opt) {
+            case 'd': driftPercent = std::atof(optarg); break;
+            case 'j': jitterMs = std::atof(optarg); break;
+            case 's': seconds = std::atof(optarg); break;
+            default:
+                std::fprintf(stderr, "Usage: %s [-d sensor_clock_drift_percent] [-j arrival_jitter_ms] [-s seconds_per_run]\n",
+                             argv[0]);
+                return 1;
+        }
+    }
+
+    std::printf("Input hand-off to a %.0f Hz sender, %.1f%% sensor clock drift, %.1f ms arrival jitter, %.0f s per run\n\n",
+                kOutputRateHz, driftPercent, jitterMs, seconds);
+    std::printf("%8s  %-22s %8s %9s %10s\n", "Input Hz", "Hand-off", "Pushed", "Received", "Dropped");
+    for (double rateHz : {30.0, 60.0, 120.0}) {
+        report(rateHz, "latest value (mutex)", run<LatestValueHandoff>(rateHz, driftPercent, jitterMs, seconds));
+        report(rateHz, "InputQueue (SPSC)", run<QueueHandoff>(rateHz, driftPercent, jitterMs, seconds));
+    }
+    return 0;
+}
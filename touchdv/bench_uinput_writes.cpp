@@ -0,0 +1,114 @@
+// Benchmark: kernel entries per touch frame, one write() per event vs one per frame.
+//
+// Emits the same frame sequence a touch stroke produces (ABS_X, ABS_Y, BTN_LEFT on
+// press/release, SYN_REPORT) to a sink file descriptor both ways and reports write
+// syscalls counted by the kernel (/proc/self/io syscw) and time per frame.
+#include "UinputFrame.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+using namespace vtd;
+
+namespace {
+
+constexpr int kFrames = 200000;
+constexpr int kStrokeFrames = 50;  // Press on the first frame of a stroke, release on the last
+
+// Write syscalls issued by this process so far
+long writeSyscalls() {
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    long value = 0;
+    while (io >> key >> value) {
+        if (key == "syscw:") {
+            return value;
+        }
+    }
+    return -1;
+}
+
+// Previous emit(): one write() per event
+void emitPerEvent(int fd, int frame, bool& pressed) {
+    input_event ev{};
+    gettimeofday(&ev.time, nullptr);
+
+    ev.type = EV_ABS; ev.code = ABS_X; ev.value = frame % 1920;
+    (void)!write(fd, &ev, sizeof(ev));
+    ev.type = EV_ABS; ev.code = ABS_Y; ev.value = frame % 1080;
+    (void)!write(fd, &ev, sizeof(ev));
+
+    bool shouldPress = frame % kStrokeFrames != kStrokeFrames - 1;
+    if (shouldPress != pressed) {
+        ev.type = EV_KEY; ev.code = BTN_LEFT; ev.value = shouldPress ? 1 : 0;
+        (void)!write(fd, &ev, sizeof(ev));
+        pressed = shouldPress;
+    }
+
+    ev.type = EV_SYN; ev.code = SYN_REPORT; ev.value = 0;
+    (void)!write(fd, &ev, sizeof(ev));
+}
+
+// Current emit(): the frame is batched into one write()
+void emitBatched(int fd, UinputFrame& batch, int frame, bool& pressed) {
+    batch.begin();
+    batch.add(EV_ABS, ABS_X, frame % 1920);
+    batch.add(EV_ABS, ABS_Y, frame % 1080);
+
+    bool shouldPress = frame % kStrokeFrames != kStrokeFrames - 1;
+    if (shouldPress != pressed) {
+        batch.add(EV_KEY, BTN_LEFT, shouldPress ? 1 : 0);
+        pressed = shouldPress;
+    }
+    batch.submit(fd);
+}
+
+template <typename Emit>
+void run(const char* name, Emit emit, double& syscallsPerFrame) {
+    long before = writeSyscalls();
+    auto start = std::chrono::steady_clock::now();
+    bool pressed = false;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        emit(frame, pressed);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    long syscalls = writeSyscalls() - before;
+
+    syscallsPerFrame = static_cast<double>(syscalls) / kFrames;
+    std::printf("%-22s %12ld %14.2f %12.0f %16.0f\n", name, syscalls, syscallsPerFrame, ns / kFrames,
+                syscallsPerFrame * 130.0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* sink = argc > 1 ? argv[1] : "/dev/null";
+    int fd = open(sink, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror("open sink");
+        return 1;
+    }
+    if (writeSyscalls() < 0) {
+        std::cerr << "/proc/self/io unavailable; syscall counts will be wrong" << std::endl;
+    }
+
+    std::printf("Touch frame emission: %d frames to %s\n\n", kFrames, sink);
+    std::printf("%-22s %12s %14s %12s %16s\n", "Method", "Writes", "Writes/frame", "ns/frame", "Writes/s @130Hz");
+
+    double perEvent = 0.0;
+    double batched = 0.0;
+    UinputFrame batch;
+    run("write() per event", [fd](int frame, bool& pressed) { emitPerEvent(fd, frame, pressed); }, perEvent);
+    run("write() per frame", [fd, &batch](int frame, bool& pressed) { emitBatched(fd, batch, frame, pressed); },
+        batched);
+
+    std::printf("\nKernel entries reduced %.1fx\n", batched > 0.0 ? perEvent / batched : 0.0);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,346 @@
+// Batch replay of gestures through VirtualTouchDevice on a simulated clock.
+//
+// The gestures run one after another, with random pauses, through one device (mock backend,
+// contact tracking and upsampling as in production) whose output ticks are driven by
+// SimulatedClock, so nothing sleeps and thousands of gestures replay per second with identical
+// results on every run. Per gesture it measures:
+//   - Down latency: from the first input arriving to the tick that emits the touch down
+//   - Lift latency: from the lift arriving (or the last input, when the gesture ends without
+//     one and the contact times out) to the tick that emits the release
+//   - Position error: distance of every touching output event from the piecewise-linear
+//     input path at the same instant
+// Raw input recordings are split into gestures at lifts and gaps; frames with several
+// contacts are reduced to their first contact. Without recordings a seeded synthetic set of
+// taps, holds, swipes and pans is replayed. With -e or -l the run fails (exit status 1) when
+// the RMS error or the p95 down latency exceeds the limit, for use as a regression gate.
+//
+// Usage: gesture_batch [-n gestures] [-i input_hz] [-r output_hz] [-e max_rms_px] [-l max_latency_ms] [raw.vtdrec ...]
+#include "TouchRecorder.h"
+#include "VirtualTouchDevice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace vtd;
+
+namespace {
+
+constexpr double kGestureGapMs = 250.0;  // Silence that ends a recorded gesture without a lift
+
+struct Gesture {
+    std::vector<double> offsetMs;   // Arrival of each input, from the start of the gesture
+    std::vector<TouchPoint> input;  // Positions and touching state; timestamps are stamped on arrival
+};
+
+struct Emitted {
+    steady_clock::time_point tick;  // Output tick that emitted the event
+    TouchPoint point;
+};
+
+struct GestureResult {
+    double downLatencyMs = -1.0;    // < 0 when the gesture produced no touching output
+    double liftLatencyMs = -1.0;    // < 0 when no release was seen
+    double squaredErrorSum = 0.0;
+    double maxErrorPx = 0.0;
+    size_t touchingOutputs = 0;
+    size_t outputEvents = 0;
+};
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [-n gestures] [-i input_hz] [-r output_hz] [-e max_rms_px] [-l max_latency_ms] [raw.vtdrec ...]"
+              << std::endl;
+}
+
+// Split a raw recording into gestures at lifts and gaps; simultaneous points keep the first contact
+void splitGestures(const std::vector<TouchPoint>& points, std::vector<Gesture>& gestures) {
+    Gesture current;
+    steady_clock::time_point start;
+    steady_clock::time_point last;
+    auto flush = [&]() {
+        if (current.input.size() >= 2) {
+            gestures.push_back(current);
+        }
+        current = Gesture();
+    };
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        const TouchPoint& p = points[i];
+        if (i > 0 && p.ts == points[i - 1].ts) {
+            continue;  // Another contact of the same frame
+        }
+        if (!current.input.empty() && p.ts - last > duration<double, std::milli>(kGestureGapMs)) {
+            flush();
+        }
+        if (current.input.empty()) {
+            if (!p.touching) {
+                continue;
+            }
+            start = p.ts;
+        }
+        current.offsetMs.push_back(duration<double, std::milli>(p.ts - start).count());
+        current.input.push_back(p);
+        last = p.ts;
+        if (!p.touching) {
+            flush();
+        }
+    }
+    flush();
+}
+
+// Taps, holds, swipes and pans at inputHz, arriving with +-2 ms of jitter, each ending in a lift
+void syntheticGestures(size_t count, double inputHz, std::mt19937& rng, std::vector<Gesture>& gestures) {
+    std::uniform_int_distribution<int> kind(0, 3);
+    std::uniform_real_distribution<double> position(100.0, 1800.0);
+    std::uniform_real_distribution<double> height(100.0, 980.0);
+    std::uniform_real_distribution<double> jitter(-2.0, 2.0);
+    const double periodMs = 1000.0 / inputHz;
+
+    for (size_t g = 0; g < count; ++g) {
+        double x0 = position(rng);
+        double y0 = height(rng);
+        double x1 = x0;
+        double y1 = y0;
+        double durationMs = 0.0;
+        double bend = 0.0;
+        switch (kind(rng)) {
+            case 0: durationMs = std::uniform_real_distribution<double>(60.0, 150.0)(rng); break;  // Tap
+            case 1: durationMs = std::uniform_real_distribution<double>(500.0, 1000.0)(rng); break;  // Hold
+            case 2:  // Swipe
+                durationMs = std::uniform_real_distribution<double>(120.0, 350.0)(rng);
+                x1 = position(rng);
+                y1 = height(rng);
+                break;
+            default:  // Curved pan
+                durationMs = std::uniform_real_distribution<double>(400.0, 1200.0)(rng);
+                x1 = position(rng);
+                y1 = height(rng);
+                bend = std::uniform_real_distribution<double>(-150.0, 150.0)(rng);
+                break;
+        }
+
+        Gesture gesture;
+        int steps = std::max(1, static_cast<int>(durationMs / periodMs));
+        for (int i = 0; i <= steps + 1; ++i) {
+            double u = std::min(1.0, static_cast<double>(i) / steps);
+            TouchPoint p;
+            p.x = static_cast<float>(std::min(1919.0, std::max(0.0, x0 + (x1 - x0) * u + bend * std::sin(M_PI * u))));
+            p.y = static_cast<float>(std::min(1079.0, std::max(0.0, y0 + (y1 - y0) * u)));
+            p.touching = i <= steps;
+            double offset = i * periodMs + (i > 0 ? jitter(rng) : 0.0);
+            gesture.offsetMs.push_back(std::max(offset, gesture.offsetMs.empty() ? 0.0 : gesture.offsetMs.back()));
+            gesture.input.push_back(p);
+        }
+        gestures.push_back(gesture);
+    }
+}
+
+// Piecewise-linear input path, clamped to its ends
+void pathAt(const std::vector<TouchPoint>& path, steady_clock::time_point t, double& x, double& y) {
+    auto it = std::lower_bound(path.begin(), path.end(), t,
+                               [](const TouchPoint& p, steady_clock::time_point value) { return p.ts < value; });
+    if (it == path.begin() || it == path.end()) {
+        const TouchPoint& p = it == path.end() ? path.back() : path.front();
+        x = p.x;
+        y = p.y;
+        return;
+    }
+    const TouchPoint& b = *it;
+    const TouchPoint& a = *(it - 1);
+    double u = duration<double>(t - a.ts).count() / duration<double>(b.ts - a.ts).count();
+    x = a.x + u * (b.x - a.x);
+    y = a.y + u * (b.y - a.y);
+}
+
+// Replay one gesture starting at the current simulated time; output collects the device events
+GestureResult replay(VirtualTouchDevice& device, const Config& cfg, const Gesture& gesture,
+                     std::vector<Emitted>& output, std::vector<TouchPoint>& path) {
+    SimulatedClock& clock = *cfg.simulatedClock;
+    output.clear();
+    path.clear();
+
+    auto origin = clock.now();
+    steady_clock::time_point liftArrival;
+    bool lifted = false;
+    for (size_t i = 0; i < gesture.input.size(); ++i) {
+        auto arrival = origin + duration_cast<steady_clock::duration>(duration<double, std::milli>(gesture.offsetMs[i]));
+        device.advanceClock(arrival);
+        device.pushInputPoint(gesture.input[i]);
+
+        TouchPoint stamped = gesture.input[i];
+        stamped.ts = arrival;
+        if (stamped.touching) {
+            path.push_back(stamped);
+        } else {
+            liftArrival = arrival;
+            lifted = true;
+            break;
+        }
+    }
+    if (!lifted) {
+        liftArrival = path.back().ts;
+    }
+
+    // Long enough for a missing lift to time out
+    device.advanceClock(clock.now() + milliseconds(static_cast<int>(std::max(cfg.touchTimeoutMs, 100.0)) + 100));
+
+    GestureResult result;
+    result.outputEvents = output.size();
+    for (const auto& event : output) {
+        const TouchPoint& p = event.point;
+        if (p.touching) {
+            if (result.downLatencyMs < 0.0) {
+                result.downLatencyMs = duration<double, std::milli>(event.tick - path.front().ts).count();
+            }
+            double x, y;
+            pathAt(path, p.ts, x, y);
+            double error = std::hypot(p.x - x, p.y - y);
+            result.squaredErrorSum += error * error;
+            result.maxErrorPx = std::max(result.maxErrorPx, error);
+            ++result.touchingOutputs;
+        } else if (result.liftLatencyMs < 0.0 && result.downLatencyMs >= 0.0) {
+            result.liftLatencyMs = duration<double, std::milli>(event.tick - liftArrival).count();
+        }
+    }
+    return result;
+}
+
+double percentile(std::vector<double> values, double quantile) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(quantile * static_cast<double>(values.size() - 1) + 0.5)];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t syntheticCount = 2000;
+    double inputHz = 30.0;
+    double outputHz = 120.0;
+    double maxRmsPx = 0.0;
+    double maxLatencyMs = 0.0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:i:r:e:l:")) != -1) {
+        switch (opt) {
+            case 'n': syntheticCount = static_cast<size_t>(std::max(1, std::atoi(optarg))); break;
+            case 'i': inputHz = std::max(1.0, std::atof(optarg)); break;
+            case 'r': outputHz = std::max(1.0, std::atof(optarg)); break;
+            case 'e': maxRmsPx = std::atof(optarg); break;
+            case 'l': maxLatencyMs = std::atof(optarg); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    Config cfg = Config::getDefault();
+    cfg.inputRateHz = inputHz;
+    cfg.outputRateHz = outputHz;
+
+    std::mt19937 rng(7);
+    std::vector<Gesture> gestures;
+    if (optind == argc) {
+        syntheticGestures(syntheticCount, inputHz, rng, gestures);
+    }
+    for (int i = optind; i < argc; ++i) {
+        RecordingHeader header;
+        std::vector<TouchPoint> points;
+        if (!loadTouchRecording(argv[i], header, points)) {
+            return 1;
+        }
+        if (header.recordType != static_cast<uint32_t>(RecordType::RawInput)) {
+            std::cerr << "Not a raw input recording: " << argv[i] << std::endl;
+            return 1;
+        }
+        cfg.screenWidth = header.screenWidth;
+        cfg.screenHeight = header.screenHeight;
+        splitGestures(points, gestures);
+    }
+    if (gestures.empty()) {
+        std::cerr << "No gestures with at least 2 input points to replay" << std::endl;
+        return 1;
+    }
+
+    // One clock and device for the whole batch; pauses between gestures vary the tick phase
+    cfg.simulatedClock = std::make_shared<SimulatedClock>(steady_clock::time_point() + seconds(1));
+    auto simulatedStart = cfg.simulatedClock->now();
+    std::vector<Emitted> output;
+    std::vector<TouchPoint> path;
+    VirtualTouchDevice device(cfg);
+    device.setEventCallback([&output, &cfg](const TouchPoint& p) {
+        output.push_back({cfg.simulatedClock->now(), p});
+    });
+    device.start();
+    std::uniform_int_distribution<int> pauseUs(0, 100000);
+
+    std::vector<double> downLatency;
+    std::vector<double> liftLatency;
+    std::vector<double> gestureRms;
+    double squaredErrorSum = 0.0;
+    double maxErrorPx = 0.0;
+    size_t touchingOutputs = 0;
+    size_t outputEvents = 0;
+    size_t inputPoints = 0;
+    size_t missingDown = 0;
+    size_t missingLift = 0;
+
+    auto wallStart = steady_clock::now();
+    for (const auto& gesture : gestures) {
+        device.advanceClock(cfg.simulatedClock->now() + microseconds(pauseUs(rng)));
+        GestureResult result = replay(device, cfg, gesture, output, path);
+        inputPoints += gesture.input.size();
+        outputEvents += result.outputEvents;
+        if (result.downLatencyMs < 0.0) {
+            ++missingDown;
+            continue;
+        }
+        downLatency.push_back(result.downLatencyMs);
+        if (result.liftLatencyMs >= 0.0) {
+            liftLatency.push_back(result.liftLatencyMs);
+        } else {
+            ++missingLift;
+        }
+        gestureRms.push_back(std::sqrt(result.squaredErrorSum / static_cast<double>(result.touchingOutputs)));
+        squaredErrorSum += result.squaredErrorSum;
+        maxErrorPx = std::max(maxErrorPx, result.maxErrorPx);
+        touchingOutputs += result.touchingOutputs;
+    }
+    device.stop();
+    double wallSec = duration<double>(steady_clock::now() - wallStart).count();
+    double simulatedSec = duration<double>(cfg.simulatedClock->now() - simulatedStart).count();
+    double rmsPx = touchingOutputs ? std::sqrt(squaredErrorSum / static_cast<double>(touchingOutputs)) : 0.0;
+    double p95DownMs = percentile(downLatency, 0.95);
+
+    std::printf("Gestures:          %zu (%zu input points, %zu output events)\n", gestures.size(), inputPoints,
+                outputEvents);
+    std::printf("Replay time:       %.3f s for %.1f s of input (%.0fx real time, %.0f gestures/s)\n", wallSec,
+                simulatedSec, simulatedSec / std::max(wallSec, 1e-9), gestures.size() / std::max(wallSec, 1e-9));
+    std::printf("Down latency:      p50 %.1f ms, p95 %.1f ms, max %.1f ms\n", percentile(downLatency, 0.5),
+                p95DownMs, percentile(downLatency, 1.0));
+    std::printf("Lift latency:      p50 %.1f ms, p95 %.1f ms, max %.1f ms\n", percentile(liftLatency, 0.5),
+                percentile(liftLatency, 0.95), percentile(liftLatency, 1.0));
+    std::printf("Position error:    RMS %.2f px, per-gesture RMS p95 %.2f px, max %.2f px\n", rmsPx,
+                percentile(gestureRms, 0.95), maxErrorPx);
+    std::printf("Incomplete:        %zu without touch down, %zu without release\n", missingDown, missingLift);
+
+    bool failed = missingDown > 0 || missingLift > 0;
+    if (maxRmsPx > 0.0 && rmsPx > maxRmsPx) {
+        std::printf("FAIL: RMS error %.2f px exceeds %.2f px\n", rmsPx, maxRmsPx);
+        failed = true;
+    }
+    if (maxLatencyMs > 0.0 && p95DownMs > maxLatencyMs) {
+        std::printf("FAIL: p95 down latency %.1f ms exceeds %.1f ms\n", p95DownMs, maxLatencyMs);
+        failed = true;
+    }
+    return failed ? 1 : 0;
+}
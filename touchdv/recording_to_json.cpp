@@ -0,0 +1,82 @@
+// Convert a binary touch recording (TouchRecorder) to the JSON layout used by analysis tools.
+//
+// Usage: recording_to_json <recording.vtdrec> [output.json]   (stdout without an output path)
+#include "TouchRecorder.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace vtd;
+
+namespace {
+
+void writeJson(std::ostream& out, const RecordingHeader& header, const std::vector<TouchPoint>& events) {
+    bool rawInput = header.recordType == static_cast<uint32_t>(RecordType::RawInput);
+
+    out << "{\n";
+    out << "  \"deviceName\": \"" << header.deviceName << "\",\n";
+    out << "  \"screenWidth\": " << header.screenWidth << ",\n";
+    out << "  \"screenHeight\": " << header.screenHeight << ",\n";
+    if (rawInput) {
+        out << "  \"recordType\": \"raw_ir_input\",\n";
+        out << "  \"inputRateHz\": " << header.inputRateHz << ",\n";
+    } else {
+        out << "  \"recordType\": \"upsampled_output\",\n";
+        out << "  \"inputRateHz\": " << header.inputRateHz << ",\n";
+        out << "  \"outputRateHz\": " << header.outputRateHz << ",\n";
+    }
+    out << "  \"totalEvents\": " << events.size() << ",\n";
+    out << "  \"events\": [\n";
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        const auto& event = events[i];
+        auto timestamp_ms = duration_cast<milliseconds>(event.ts.time_since_epoch()).count();
+
+        out << "    {\n";
+        out << "      \"timestamp_ms\": " << timestamp_ms << ",\n";
+        out << "      \"x\": " << std::fixed << std::setprecision(2) << event.x << ",\n";
+        out << "      \"y\": " << std::fixed << std::setprecision(2) << event.y << ",\n";
+        out << "      \"touching\": " << (event.touching ? "true" : "false") << ",\n";
+        out << "      \"slot\": " << event.slot << "\n";
+        out << "    }";
+        if (i < events.size() - 1) {
+            out << ",";
+        }
+        out << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <recording.vtdrec> [output.json]" << std::endl;
+        return 1;
+    }
+
+    RecordingHeader header;
+    std::vector<TouchPoint> events;
+    if (!loadTouchRecording(argv[1], header, events)) {
+        return 1;
+    }
+
+    if (argc == 2) {
+        writeJson(std::cout, header, events);
+        return 0;
+    }
+
+    std::ofstream file(argv[2], std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open output file: " << argv[2] << std::endl;
+        return 1;
+    }
+    writeJson(file, header, events);
+    std::cerr << "Converted " << events.size() << " events to: " << argv[2] << std::endl;
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Replay a raw input recording (TouchRecorder) into VirtualTouchDevice.
+//
+// Input frames are pushed at their recorded spacing divided by the speed factor, so a
+// session can be re-run at original timing for regression checks (record the output with
+// -o and compare) or accelerated to stress the input path and sender thread. The output
+// rate stays at the recorded rate, so at speed > 1 each output tick sees more input.
+//
+// Usage: replay_recording [-s speed] [-d mock|linux|multitouch] [-c contacts] [-o out.vtdrec] <raw.vtdrec>
+#include "TouchRecorder.h"
+#include "VirtualTouchDevice.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace vtd;
+
+namespace {
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [-s speed] [-d mock|linux|multitouch] [-c contacts] [-o out.vtdrec] <raw.vtdrec>"
+              << std::endl;
+}
+
+// Points pushed together share one arrival stamp; each run of equal timestamps is one frame
+std::vector<std::vector<TouchPoint>> splitFrames(const std::vector<TouchPoint>& points) {
+    std::vector<std::vector<TouchPoint>> frames;
+    for (const auto& p : points) {
+        if (frames.empty() || frames.back().front().ts != p.ts) {
+            frames.emplace_back();
+        }
+        frames.back().push_back(p);
+    }
+    return frames;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double speed = 1.0;
+    DeviceType deviceType = DeviceType::Mock;
+    int maxContacts = 0;
+    std::string outputPath;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:d:c:o:")) != -1) {
+        switch (opt) {
+            case 's': speed = std::atof(optarg); break;
+            case 'd':
+                if (std::strcmp(optarg, "linux") == 0) {
+                    deviceType = DeviceType::Linux;
+                } else if (std::strcmp(optarg, "multitouch") == 0) {
+                    deviceType = DeviceType::LinuxMultiTouch;
+                } else if (std::strcmp(optarg, "mock") != 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'c': maxContacts = std::atoi(optarg); break;
+            case 'o': outputPath = optarg; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind != argc - 1 || speed <= 0.0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    RecordingHeader header;
+    std::vector<TouchPoint> points;
+    if (!loadTouchRecording(argv[optind], header, points)) {
+        return 1;
+    }
+    if (header.recordType != static_cast<uint32_t>(RecordType::RawInput)) {
+        std::cerr << "Not a raw input recording: " << argv[optind] << std::endl;
+        return 1;
+    }
+    if (points.empty()) {
+        std::cerr << "Recording is empty: " << argv[optind] << std::endl;
+        return 1;
+    }
+
+    std::vector<std::vector<TouchPoint>> frames = splitFrames(points);
+    if (maxContacts <= 0) {
+        size_t widest = 1;
+        for (const auto& frame : frames) {
+            widest = std::max(widest, frame.size());
+        }
+        maxContacts = static_cast<int>(widest);
+    }
+
+    Config cfg = Config::getDefault();
+    cfg.deviceType = deviceType;
+    cfg.deviceName = header.deviceName;
+    cfg.screenWidth = header.screenWidth;
+    cfg.screenHeight = header.screenHeight;
+    cfg.inputRateHz = header.inputRateHz * speed;
+    cfg.outputRateHz = header.outputRateHz;
+    cfg.maxContacts = maxContacts;
+    if (!outputPath.empty()) {
+        cfg.enableUpsampledRecording = true;
+        cfg.upsampledRecordPath = outputPath;
+    }
+
+    std::atomic<uint64_t> outputEvents{0};
+    VirtualTouchDevice device(cfg);
+    device.setEventCallback([&outputEvents](const TouchPoint&) { ++outputEvents; });
+    if (!device.start()) {
+        return 1;
+    }
+
+    std::cout << "Replaying " << frames.size() << " frames (" << points.size() << " points, " << maxContacts
+              << " contact(s)) at " << speed << "x" << std::endl;
+
+    auto recordedStart = frames.front().front().ts;
+    auto replayStart = steady_clock::now();
+    for (const auto& frame : frames) {
+        auto offset = duration_cast<steady_clock::duration>((frame.front().ts - recordedStart) / speed);
+        std::this_thread::sleep_until(replayStart + offset);
+        device.pushInputFrame(frame);
+    }
+    // Let the last contacts time out and release
+    std::this_thread::sleep_for(milliseconds(200));
+    double elapsed = duration<double>(steady_clock::now() - replayStart).count();
+    PeriodicSchedulerStats timing = device.getOutputTimingStats();
+    device.stop();
+
+    std::printf("Replay time:       %.2f s (recorded %.2f s)\n", elapsed,
+                duration<double>(frames.back().front().ts - recordedStart).count());
+    std::printf("Output events:     %llu\n", static_cast<unsigned long long>(outputEvents.load()));
+    std::printf("Output ticks:      %llu (%llu missed)\n", static_cast<unsigned long long>(timing.ticks),
+                static_cast<unsigned long long>(timing.missedTicks));
+    std::printf("Tick lateness:     p50 %.1f us, p99 %.1f us, max %.1f us\n", timing.p50LatenessUs,
+                timing.p99LatenessUs, timing.maxLatenessUs);
+    return 0;
+}
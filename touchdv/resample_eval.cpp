@@ -0,0 +1,377 @@
+// Offline evaluation of the touch upsampling engine.
+//
+// Replays raw input recordings (TouchRecorder binary, or JSON from recording_to_json) through
+// BatchResampler, which gives the sender loop's output at the output rate, all strokes of a
+// configuration in parallel, and compares every output tick with a reference trajectory:
+//   - RMS error: distance between output and reference at the same instant
+//   - Perceived lag: time shift of the reference that best matches the output
+//     (positive = output trails the finger, negative = output runs ahead)
+// For recordings the reference is the piecewise-linear path through the recorded points;
+// with -j the input is additionally jittered so filters can be compared against a clean
+// path. Without recordings a synthetic gesture set with known noise-free paths is used.
+#include "BatchResampler.h"
+#include "TouchRecorder.h"
+#include "VirtualTouchDevice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace vtd;
+
+namespace {
+
+struct Stroke {
+    std::string name;
+    std::vector<TouchPoint> input;      // As delivered to the device
+    std::vector<TouchPoint> reference;  // Path the output should follow
+};
+
+struct Result {
+    double rmsPx = 0.0;
+    double maxPx = 0.0;
+    double lagMs = 0.0;
+    size_t samples = 0;
+};
+
+struct Variant {
+    const char* name;
+    FilterType filter;
+    InterpolationType interpolation;
+    double horizonMs;
+};
+
+const Variant kVariants[] = {
+    {"linear, no filter", FilterType::None, InterpolationType::Linear, 0.0},
+    {"linear, no filter, +16 ms", FilterType::None, InterpolationType::Linear, 16.0},
+    {"catmull-rom + one-euro", FilterType::OneEuro, InterpolationType::CatmullRom, 0.0},
+    {"catmull-rom + one-euro, -33 ms", FilterType::OneEuro, InterpolationType::CatmullRom, -33.0},
+    {"catmull-rom + one-euro, +16 ms", FilterType::OneEuro, InterpolationType::CatmullRom, 16.0},
+    {"hermite + kalman", FilterType::Kalman, InterpolationType::Hermite, 0.0},
+    {"hermite + kalman, +16 ms", FilterType::Kalman, InterpolationType::Hermite, 16.0},
+};
+
+// Reads the numeric or boolean value following "key": starting at pos
+bool findValue(const std::string& text, const std::string& key, size_t& pos, std::string& value) {
+    size_t at = text.find("\"" + key + "\"", pos);
+    if (at == std::string::npos) {
+        return false;
+    }
+    size_t colon = text.find(':', at);
+    size_t begin = text.find_first_not_of(" \t\r\n", colon + 1);
+    size_t end = text.find_first_of(",}\r\n", begin);
+    value = text.substr(begin, end - begin);
+    pos = end;
+    return true;
+}
+
+// Binary recordings directly; otherwise a minimal reader for the fixed JSON layout
+// recording_to_json writes
+bool loadRecording(const std::string& path, std::vector<TouchPoint>& points) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open recording: " << path << std::endl;
+        return false;
+    }
+    char magic[sizeof(kRecordingMagic)] = {};
+    if (file.read(magic, sizeof(magic)) && std::memcmp(magic, kRecordingMagic, sizeof(magic)) == 0) {
+        RecordingHeader header;
+        return loadTouchRecording(path, header, points) && !points.empty();
+    }
+    file.clear();
+    file.seekg(0);
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    size_t pos = text.find("\"events\"");
+    if (pos == std::string::npos) {
+        std::cerr << "No events in recording: " << path << std::endl;
+        return false;
+    }
+    std::string ts, x, y, touching;
+    while (findValue(text, "timestamp_ms", pos, ts) && findValue(text, "x", pos, x) &&
+           findValue(text, "y", pos, y) && findValue(text, "touching", pos, touching)) {
+        TouchPoint p;
+        p.ts = steady_clock::time_point(milliseconds(std::atoll(ts.c_str())));
+        p.x = std::strtof(x.c_str(), nullptr);
+        p.y = std::strtof(y.c_str(), nullptr);
+        p.touching = touching == "true";
+        points.push_back(p);
+    }
+    return !points.empty();
+}
+
+// Split a recording into touching strokes; a release or a gap ends a stroke
+void splitStrokes(const std::string& name, const std::vector<TouchPoint>& points, double jitterPx,
+                  std::mt19937& rng, std::vector<Stroke>& strokes) {
+    std::normal_distribution<double> noise(0.0, jitterPx);
+    Stroke current;
+    auto flush = [&]() {
+        if (current.input.size() >= 3) {
+            current.name = name + " #" + std::to_string(strokes.size() + 1);
+            strokes.push_back(current);
+        }
+        current = Stroke();
+    };
+
+    for (const auto& p : points) {
+        if (!p.touching || (!current.input.empty() && p.ts - current.input.back().ts > milliseconds(100))) {
+            flush();
+        }
+        if (p.touching) {
+            TouchPoint jittered = p;
+            if (jitterPx > 0.0) {
+                jittered.x += static_cast<float>(noise(rng));
+                jittered.y += static_cast<float>(noise(rng));
+            }
+            current.input.push_back(jittered);
+            current.reference.push_back(p);
+        }
+    }
+    flush();
+}
+
+// Synthetic strokes sampled at 30 Hz with sensor noise, arriving after a pipeline latency
+// with some jitter; the reference is the noise-free path sampled at 1 kHz
+void syntheticStrokes(double noisePx, double latencyMs, std::mt19937& rng, std::vector<Stroke>& strokes) {
+    struct Path {
+        const char* name;
+        double durationSec;
+        void (*at)(double t, double& x, double& y);
+    };
+    const Path paths[] = {
+        {"swipe", 0.5, [](double t, double& x, double& y) {
+             double s = 0.5 - 0.5 * std::cos(t / 0.5 * 3.14159265358979);  // Ease in/out
+             x = 300.0 + 1200.0 * s;
+             y = 500.0 + 80.0 * s;
+         }},
+        {"circle", 1.5, [](double t, double& x, double& y) {
+             x = 960.0 + 300.0 * std::cos(2.0 * 3.14159265358979 * t / 1.5);
+             y = 540.0 + 300.0 * std::sin(2.0 * 3.14159265358979 * t / 1.5);
+         }},
+        {"zigzag pan", 1.2, [](double t, double& x, double& y) {
+             x = 400.0 + 800.0 * t / 1.2;
+             y = 540.0 + 150.0 * std::sin(2.0 * 3.14159265358979 * 2.0 * t / 1.2);
+         }},
+        {"hold", 1.0, [](double, double& x, double& y) {
+             x = 700.0;
+             y = 400.0;
+         }},
+    };
+
+    std::normal_distribution<double> noise(0.0, noisePx);
+    std::uniform_real_distribution<double> arrival(-0.004, 0.004);
+    auto origin = steady_clock::time_point(seconds(1000));
+
+    for (const auto& path : paths) {
+        Stroke stroke;
+        stroke.name = std::string("synthetic ") + path.name;
+        for (double t = 0.0; t <= path.durationSec; t += 1.0 / 30.0) {
+            // The sensor samples at t; the point arrives latencyMs later, give or take
+            double x, y;
+            path.at(t, x, y);
+            TouchPoint p;
+            p.ts = origin + duration_cast<steady_clock::duration>(
+                duration<double>(t + latencyMs / 1000.0 + arrival(rng)));
+            p.x = static_cast<float>(x + noise(rng));
+            p.y = static_cast<float>(y + noise(rng));
+            p.touching = true;
+            stroke.input.push_back(p);
+        }
+        for (double t = 0.0; t <= path.durationSec; t += 0.001) {
+            double x, y;
+            path.at(t, x, y);
+            TouchPoint p;
+            p.ts = origin + duration_cast<steady_clock::duration>(duration<double>(t));
+            p.x = static_cast<float>(x);
+            p.y = static_cast<float>(y);
+            p.touching = true;
+            stroke.reference.push_back(p);
+        }
+        strokes.push_back(stroke);
+        origin += seconds(10);
+    }
+}
+
+// Piecewise-linear reference position, clamped to the ends of the stroke
+void referenceAt(const std::vector<TouchPoint>& reference, steady_clock::time_point t, double& x, double& y) {
+    auto it = std::lower_bound(reference.begin(), reference.end(), t,
+                               [](const TouchPoint& p, steady_clock::time_point value) { return p.ts < value; });
+    if (it == reference.begin() || it == reference.end()) {
+        const TouchPoint& p = it == reference.end() ? reference.back() : reference.front();
+        x = p.x;
+        y = p.y;
+        return;
+    }
+    const TouchPoint& b = *it;
+    const TouchPoint& a = *(it - 1);
+    double u = duration<double>(t - a.ts).count() / duration<double>(b.ts - a.ts).count();
+    x = a.x + u * (b.x - a.x);
+    y = a.y + u * (b.y - a.y);
+}
+
+double rmsAgainst(const std::vector<TouchPoint>& output, const std::vector<TouchPoint>& reference,
+                  steady_clock::duration shift, double* maxError = nullptr) {
+    double sum = 0.0;
+    for (const auto& p : output) {
+        double x, y;
+        referenceAt(reference, p.ts - shift, x, y);
+        double error = std::hypot(p.x - x, p.y - y);
+        sum += error * error;
+        if (maxError) {
+            *maxError = std::max(*maxError, error);
+        }
+    }
+    return output.empty() ? 0.0 : std::sqrt(sum / static_cast<double>(output.size()));
+}
+
+// Score the touching output ticks up to the last input of the stroke
+Result evaluate(const Stroke& stroke, const TouchTrace& trace) {
+    std::vector<TouchPoint> output;
+    for (size_t i = 0; i < trace.size(); ++i) {
+        TouchPoint p = trace.point(i);
+        if (p.ts > stroke.input.back().ts) {
+            break;
+        }
+        if (p.touching) {
+            output.push_back(p);
+        }
+    }
+
+    Result result;
+    result.samples = output.size();
+    result.rmsPx = rmsAgainst(output, stroke.reference, steady_clock::duration::zero(), &result.maxPx);
+
+    // Perceived lag: the reference shift with the smallest error
+    double best = result.rmsPx;
+    for (int shiftMs = -100; shiftMs <= 150; ++shiftMs) {
+        double rms = rmsAgainst(output, stroke.reference, milliseconds(shiftMs));
+        if (rms < best) {
+            best = rms;
+            result.lagMs = shiftMs;
+        }
+    }
+    return result;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options] [recording.vtdrec|recording.json ...]\n"
+              << "  -r <hz>   Output rate (default: 120)\n"
+              << "  -j <px>   Add Gaussian jitter to recorded input (default: 0)\n"
+              << "  -n <px>   Sensor noise of the synthetic gestures (default: 2)\n"
+              << "  -l <ms>   Sensor-to-arrival latency of the synthetic gestures (default: 20)\n"
+              << "  -h        Show this help\n"
+              << "Without recordings a synthetic gesture set is evaluated.\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double outputRateHz = 120.0;
+    double jitterPx = 0.0;
+    double noisePx = 2.0;
+    double latencyMs = 20.0;
+    std::vector<std::string> recordings;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-r" && i + 1 < argc) {
+            outputRateHz = std::max(1.0, std::atof(argv[++i]));
+        } else if (arg == "-j" && i + 1 < argc) {
+            jitterPx = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "-n" && i + 1 < argc) {
+            noisePx = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "-l" && i + 1 < argc) {
+            latencyMs = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] != '-') {
+            recordings.push_back(arg);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(42);
+    std::vector<Stroke> strokes;
+    if (recordings.empty()) {
+        syntheticStrokes(noisePx, latencyMs, rng, strokes);
+    }
+    for (const auto& path : recordings) {
+        std::vector<TouchPoint> points;
+        if (!loadRecording(path, points)) {
+            return 1;
+        }
+        splitStrokes(path, points, jitterPx, rng, strokes);
+    }
+    if (strokes.empty()) {
+        std::cerr << "No strokes with at least 3 touching points to evaluate" << std::endl;
+        return 1;
+    }
+
+    std::vector<TouchTrace> traces(strokes.size());
+    for (size_t i = 0; i < strokes.size(); ++i) {
+        traces[i].reserve(strokes[i].input.size());
+        for (const auto& p : strokes[i].input) {
+            traces[i].append(p);
+        }
+    }
+
+    // Every stroke of one configuration in one parallel batch
+    const size_t variantCount = sizeof(kVariants) / sizeof(kVariants[0]);
+    std::vector<std::vector<Result>> results(variantCount);
+    BatchResampler batch;
+    std::vector<TouchTrace> outputs;
+    for (size_t v = 0; v < variantCount; ++v) {
+        Config cfg = Config::getDefault();
+        cfg.outputRateHz = outputRateHz;
+        cfg.filterType = kVariants[v].filter;
+        cfg.interpolationType = kVariants[v].interpolation;
+        cfg.predictionHorizonMs = kVariants[v].horizonMs;
+        batch.run(cfg, traces, outputs);
+        for (size_t i = 0; i < strokes.size(); ++i) {
+            results[v].push_back(evaluate(strokes[i], outputs[i]));
+        }
+    }
+
+    std::vector<Result> totals(variantCount);
+    for (size_t i = 0; i < strokes.size(); ++i) {
+        std::printf("\n%s (%zu input points)\n", strokes[i].name.c_str(), strokes[i].input.size());
+        std::printf("  %-34s %10s %10s %10s\n", "Configuration", "RMS (px)", "Max (px)", "Lag (ms)");
+        for (size_t v = 0; v < variantCount; ++v) {
+            const Result& result = results[v][i];
+            std::printf("  %-34s %10.2f %10.2f %10.0f\n", kVariants[v].name, result.rmsPx, result.maxPx,
+                        result.lagMs);
+
+            // Sample-weighted totals across strokes
+            Result& total = totals[v];
+            double n = static_cast<double>(result.samples);
+            total.rmsPx += result.rmsPx * result.rmsPx * n;
+            total.lagMs += result.lagMs * n;
+            total.maxPx = std::max(total.maxPx, result.maxPx);
+            total.samples += result.samples;
+        }
+    }
+
+    std::printf("\nAll strokes\n");
+    std::printf("  %-34s %10s %10s %10s\n", "Configuration", "RMS (px)", "Max (px)", "Lag (ms)");
+    for (size_t v = 0; v < totals.size(); ++v) {
+        const Result& total = totals[v];
+        double n = std::max<double>(1.0, static_cast<double>(total.samples));
+        std::printf("  %-34s %10.2f %10.2f %10.1f\n", kVariants[v].name, std::sqrt(total.rmsPx / n), total.maxPx,
+                    total.lagMs / n);
+    }
+    return 0;
+}
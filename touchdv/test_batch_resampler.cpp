@@ -0,0 +1,204 @@
+// Unit tests for the offline batch resampler: bit-exact agreement with the device's sender
+// loop on a simulated clock, and parallel runs matching serial ones
+#include "BatchResampler.h"
+#include "VirtualTouchDevice.h"
+#include "test_check.h"
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace vtd;
+
+static bool sameTrace(const TouchTrace& a, const TouchTrace& b) {
+    return a.size() == b.size() && a.timeNs == b.timeNs && a.touching == b.touching &&
+           std::memcmp(a.x.data(), b.x.data(), a.size() * sizeof(float)) == 0 &&
+           std::memcmp(a.y.data(), b.y.data(), a.size() * sizeof(float)) == 0;
+}
+
+// Strokes with input jitter, repeated timestamps, sensor stalls shorter and longer than the
+// contact timeout, releases, and an end without a release
+static TouchTrace makeTrace(std::mt19937& rng, double inputHz) {
+    std::uniform_real_distribution<double> position(50.0, 1850.0);
+    std::uniform_real_distribution<double> velocity(-3000.0, 3000.0);
+    std::uniform_real_distribution<double> jitterMs(-3.0, 3.0);
+    std::uniform_int_distribution<int> event(0, 40);
+
+    TouchTrace trace;
+    double t = 5.0;
+    double x = position(rng);
+    double y = 540.0;
+    double vx = velocity(rng);
+    double vy = velocity(rng) / 3.0;
+    for (int i = 0; i < 400; ++i) {
+        TouchPoint p;
+        p.ts = steady_clock::time_point() + duration_cast<steady_clock::duration>(duration<double>(t));
+        p.x = static_cast<float>(std::min(1900.0, std::max(10.0, x)));
+        p.y = static_cast<float>(std::min(1070.0, std::max(10.0, y)));
+        p.touching = true;
+
+        int kind = event(rng);
+        if (kind == 0) {
+            p.touching = false;  // Release, then a new stroke elsewhere
+            x = position(rng);
+            vx = velocity(rng);
+        }
+        trace.append(p);
+        if (kind == 1) {
+            trace.append(p);  // Same timestamp twice
+        }
+
+        double stepMs = 1000.0 / inputHz + jitterMs(rng);
+        if (kind == 2) {
+            stepMs += 70.0;  // Stall past maxExtrapolationMs but within the contact timeout
+        } else if (kind == 3) {
+            stepMs += 150.0;  // Stall past the contact timeout
+        }
+        t += stepMs / 1000.0;
+        x += vx * stepMs / 1000.0;
+        y += vy * stepMs / 1000.0;
+        if (x < 10.0 || x > 1900.0) vx = -vx;
+        if (y < 10.0 || y > 1070.0) vy = -vy;
+    }
+    return trace;
+}
+
+// Deterministic mode of the device: simulated clock from the first input, given timestamps,
+// each point pushed once the clock reaches it
+static TouchTrace runOnline(const Config& base, const TouchTrace& trace) {
+    Config cfg = base;
+    cfg.stampInputOnArrival = false;
+    cfg.simulatedClock = std::make_shared<SimulatedClock>(trace.point(0).ts);
+
+    TouchTrace output;
+    VirtualTouchDevice device(cfg);
+    device.setEventCallback([&output](const TouchPoint& p) { output.append(p); });
+    device.start();
+    for (size_t i = 0; i < trace.size(); ++i) {
+        TouchPoint p = trace.point(i);
+        device.advanceClock(p.ts);
+        device.pushInputPoint(p);
+    }
+    device.advanceClock(trace.point(trace.size() - 1).ts + milliseconds(200));
+    device.stop();
+    return output;
+}
+
+static void testMatchesSenderLoop() {
+    std::cout << "\n🧪 Offline output matches the sender loop bit for bit" << std::endl;
+    struct Variant {
+        const char* name;
+        FilterType filter;
+        InterpolationType interpolation;
+        double horizonMs;
+        double outputHz;
+    };
+    const Variant variants[] = {
+        {"linear, no filter", FilterType::None, InterpolationType::Linear, 0.0, 120.0},
+        {"catmull-rom + one-euro", FilterType::OneEuro, InterpolationType::CatmullRom, 0.0, 120.0},
+        {"catmull-rom + one-euro, -33 ms", FilterType::OneEuro, InterpolationType::CatmullRom, -33.0, 90.0},
+        {"hermite + kalman, +16 ms", FilterType::Kalman, InterpolationType::Hermite, 16.0, 240.0},
+    };
+
+    std::mt19937 rng(3);
+    for (const auto& variant : variants) {
+        Config cfg = Config::getDefault();
+        cfg.filterType = variant.filter;
+        cfg.interpolationType = variant.interpolation;
+        cfg.predictionHorizonMs = variant.horizonMs;
+        cfg.outputRateHz = variant.outputHz;
+
+        bool same = true;
+        size_t points = 0;
+        for (double inputHz : {30.0, 60.0, 125.0}) {
+            TouchTrace trace = makeTrace(rng, inputHz);
+            TouchTrace offline;
+            BatchResampler::resample(cfg, trace, offline);
+            TouchTrace online = runOnline(cfg, trace);
+            same = same && sameTrace(offline, online);
+            points += online.size();
+        }
+        check(same && points > 0, std::string(variant.name) + " at " + std::to_string(int(variant.outputHz)) +
+                                      " Hz (" + std::to_string(points) + " output points)");
+    }
+}
+
+static void testRejectedInputIgnored() {
+    std::cout << "\n🧪 Rejected input points" << std::endl;
+    Config cfg = Config::getDefault();
+    TouchTrace trace;
+    auto start = steady_clock::time_point() + seconds(1);
+    for (int i = 0; i < 10; ++i) {
+        trace.append(TouchPoint{start + milliseconds(33 * i), 100.0f + 10.0f * i, 200.0f, true});
+    }
+    trace.append(TouchPoint{start + milliseconds(330), -5.0f, 200.0f, true});  // Off screen
+    for (int i = 11; i < 20; ++i) {
+        trace.append(TouchPoint{start + milliseconds(33 * i), 100.0f + 10.0f * i, 200.0f, true});
+    }
+
+    TouchTrace offline;
+    BatchResampler::resample(cfg, trace, offline);
+    size_t lifts = 0;
+    for (uint8_t touching : offline.touching) {
+        lifts += touching ? 0 : 1;
+    }
+    check(lifts == 1 && offline.touching[offline.size() - 2],
+          "Off-screen point is ignored; the contact stays down until it times out");
+    check(sameTrace(offline, runOnline(cfg, trace)), "Same output as the device");
+}
+
+static void testParallelMatchesSerial() {
+    std::cout << "\n🧪 Thread pool" << std::endl;
+    std::mt19937 rng(11);
+    std::vector<TouchTrace> traces;
+    for (int i = 0; i < 200; ++i) {
+        traces.push_back(makeTrace(rng, i % 2 ? 30.0 : 60.0));
+    }
+    Config cfg = Config::getDefault();
+
+    std::vector<TouchTrace> serial(traces.size());
+    auto serialStart = steady_clock::now();
+    for (size_t i = 0; i < traces.size(); ++i) {
+        BatchResampler::resample(cfg, traces[i], serial[i]);
+    }
+    double serialMs = duration<double, std::milli>(steady_clock::now() - serialStart).count();
+
+    BatchResampler batch(4);
+    std::vector<TouchTrace> parallel;
+    auto parallelStart = steady_clock::now();
+    batch.run(cfg, traces, parallel);
+    double parallelMs = duration<double, std::milli>(steady_clock::now() - parallelStart).count();
+
+    bool same = parallel.size() == serial.size();
+    for (size_t i = 0; same && i < serial.size(); ++i) {
+        same = sameTrace(serial[i], parallel[i]);
+    }
+    std::cout << "    " << traces.size() << " traces: " << serialMs << " ms serial, " << parallelMs << " ms on "
+              << batch.threadCount() << " threads" << std::endl;
+    check(same, "Parallel run equals the serial one");
+
+    // The pool is reused across runs, e.g. one run per configuration variant
+    cfg.filterType = FilterType::Kalman;
+    cfg.interpolationType = InterpolationType::Hermite;
+    batch.run(cfg, traces, parallel);
+    TouchTrace expected;
+    BatchResampler::resample(cfg, traces.back(), expected);
+    check(sameTrace(parallel.back(), expected), "Second run on the same pool uses its own configuration");
+}
+
+int main() {
+    std::cout << "🎯 Batch Resampler Test Suite" << std::endl;
+    std::cout << "=============================" << std::endl;
+
+    testMatchesSenderLoop();
+    testRejectedInputIgnored();
+    testParallelMatchesSerial();
+
+    if (gFailures) {
+        std::cout << "\n❌ " << gFailures << " BATCH RESAMPLER CHECK(S) FAILED!" << std::endl;
+        return 1;
+    }
+    std::cout << "\n✅ ALL BATCH RESAMPLER TESTS PASSED!" << std::endl;
+    return 0;
+}
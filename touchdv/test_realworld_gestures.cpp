@@ -2,7 +2,6 @@
 using namespace vtd;
 #include <iostream>
 #include <chrono>
-#include <thread>
 #include <cassert>
 #include <iomanip>
 
@@ -359,8 +358,16 @@ public:
     }
 };
 
-void executeGestureCommand(VirtualTouchDevice& device, const GestureSequenceGenerator::GestureCommand& cmd, steady_clock::time_point baseTime) {
+// The device runs on a simulated clock: advancing it runs the output ticks in between on this
+// thread, so a 16 s scenario replays in milliseconds with the same timing on every run
+static void advance(VirtualTouchDevice& device, const SimulatedClock& clock, milliseconds delta) {
+    device.advanceClock(clock.now() + delta);
+}
+
+void executeGestureCommand(VirtualTouchDevice& device, const SimulatedClock& clock,
+                           const GestureSequenceGenerator::GestureCommand& cmd, steady_clock::time_point baseTime) {
     auto startTime = baseTime + milliseconds(static_cast<int>(cmd.startTimeMs));
+    device.advanceClock(std::max(clock.now(), startTime));
 
     if (cmd.type == "tap") {
         auto pos = cmd.waypoints[0];
@@ -372,7 +379,7 @@ void executeGestureCommand(VirtualTouchDevice& device, const GestureSequenceGene
         down.ts = startTime;
         device.pushInputPoint(down);
 
-        std::this_thread::sleep_for(milliseconds(static_cast<int>(cmd.durationMs)));
+        advance(device, clock, milliseconds(static_cast<int>(cmd.durationMs)));
 
         TouchPoint up;
         up.x = pos.first;
@@ -392,7 +399,7 @@ void executeGestureCommand(VirtualTouchDevice& device, const GestureSequenceGene
         down1.ts = startTime;
         device.pushInputPoint(down1);
 
-        std::this_thread::sleep_for(milliseconds(static_cast<int>(cmd.durationMs)));
+        advance(device, clock, milliseconds(static_cast<int>(cmd.durationMs)));
 
         TouchPoint up1;
         up1.x = pos.first;
@@ -402,7 +409,7 @@ void executeGestureCommand(VirtualTouchDevice& device, const GestureSequenceGene
         device.pushInputPoint(up1);
 
         // Small gap
-        std::this_thread::sleep_for(milliseconds(100));
+        advance(device, clock, milliseconds(100));
 
         // Second tap
         TouchPoint down2;
@@ -412,7 +419,7 @@ void executeGestureCommand(VirtualTouchDevice& device, const GestureSequenceGene
         down2.ts = startTime + milliseconds(static_cast<int>(cmd.durationMs) + 100);
         device.pushInputPoint(down2);
 
-        std::this_thread::sleep_for(milliseconds(static_cast<int>(cmd.durationMs)));
+        advance(device, clock, milliseconds(static_cast<int>(cmd.durationMs)));
 
         TouchPoint up2;
         up2.x = pos.first + 2;
@@ -440,7 +447,7 @@ void executeGestureCommand(VirtualTouchDevice& device, const GestureSequenceGene
             hold.touching = true;
             hold.ts = startTime + milliseconds(i * 33);
             device.pushInputPoint(hold);
-            std::this_thread::sleep_for(milliseconds(33));
+            advance(device, clock, milliseconds(33));
         }
 
         TouchPoint up;
@@ -495,7 +502,7 @@ void executeGestureCommand(VirtualTouchDevice& device, const GestureSequenceGene
             move.ts = startTime + milliseconds(i * 33);
             device.pushInputPoint(move);
 
-            std::this_thread::sleep_for(milliseconds(33));
+            advance(device, clock, milliseconds(33));
         }
 
         TouchPoint up;
@@ -518,6 +525,8 @@ void testRealWorldMixedGestures() {
     cfg.outputRateHz = 120.0; // High output rate for UI framework
     cfg.touchTimeoutMs = 0.0;
     cfg.maxInputHistorySec = 2.0;
+    auto clock = std::make_shared<SimulatedClock>(steady_clock::time_point() + seconds(1));
+    cfg.simulatedClock = clock;
 
     VirtualTouchDevice device(cfg);
 
@@ -525,9 +534,9 @@ void testRealWorldMixedGestures() {
     RealTimeUIFramework uiFramework;
 
     // Set up real-time callback - this is the ONLY interface we need!
-    // device.setEventCallback([&uiFramework](const TouchPoint& point) {
-    //     uiFramework.onTouchEvent(point);
-    // });
+    device.setEventCallback([&uiFramework](const TouchPoint& point) {
+        uiFramework.onTouchEvent(point);
+    });
 
     if (!device.start()) {
         std::cerr << "Failed to start device" << std::endl;
@@ -535,7 +544,7 @@ void testRealWorldMixedGestures() {
     }
 
     auto gestureSequence = GestureSequenceGenerator::createRealWorldScenario();
-    auto baseTime = steady_clock::now();
+    auto baseTime = clock->now();
 
     std::cout << "\n  🎬 Executing Real-World Gesture Scenario:" << std::endl;
     std::cout << "  Total gestures: " << gestureSequence.size() << std::endl;
@@ -553,34 +562,25 @@ void testRealWorldMixedGestures() {
     // Execute gesture sequence
     std::cout << "\n  🎮 Executing gesture sequence..." << std::endl;
 
-    std::thread executionThread([&]() {
-        for (const auto& cmd : gestureSequence) {
-            executeGestureCommand(device, cmd, baseTime);
-            std::this_thread::sleep_for(milliseconds(50)); // Small gap between gestures
-        }
-    });
-
-    // Monitor progress
-    auto startTime = steady_clock::now();
-    auto endTime = startTime + seconds(18); // 16s + 2s buffer
-
+    auto wallStart = steady_clock::now();
     size_t lastEventCount = 0;
-    while (steady_clock::now() < endTime && executionThread.joinable()) {
-        std::this_thread::sleep_for(milliseconds(1000));
+    for (const auto& cmd : gestureSequence) {
+        executeGestureCommand(device, *clock, cmd, baseTime);
+        advance(device, *clock, milliseconds(50)); // Small gap between gestures
 
         auto currentEventCount = uiFramework.getEventCount();
-        auto elapsed = duration_cast<seconds>(steady_clock::now() - startTime).count();
-
         if (currentEventCount != lastEventCount) {
-            std::cout << "    " << elapsed << "s: " << currentEventCount << " events received by UI framework" << std::endl;
+            std::cout << "    " << std::fixed << std::setprecision(2) << toSeconds(clock->now() - baseTime)
+                      << "s: " << currentEventCount << " events received by UI framework" << std::endl;
             lastEventCount = currentEventCount;
         }
     }
 
-    executionThread.join();
-
     // Final processing time
-    std::this_thread::sleep_for(milliseconds(500));
+    advance(device, *clock, milliseconds(500));
+    std::cout << "  Replayed " << std::fixed << std::setprecision(1) << toSeconds(clock->now() - baseTime)
+              << "s of input in " << duration_cast<milliseconds>(steady_clock::now() - wallStart).count()
+              << "ms wall time" << std::endl;
 
     // Analyze results - using ONLY the UI framework data (callback-based)
     auto recognizedGestures = uiFramework.getRecognizedGestures();
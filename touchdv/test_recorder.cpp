@@ -0,0 +1,111 @@
+// Unit tests for the streaming binary touch recorder
+#include "TouchRecorder.h"
+#include "VirtualTouchDevice.h"
+#include "test_check.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace vtd;
+
+static long fileSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file.is_open() ? static_cast<long>(file.tellg()) : -1;
+}
+
+// More records than both buffers hold, read back field by field
+static void testRoundTrip() {
+    std::cout << "\n🧪 Round trip across buffer swaps" << std::endl;
+    const std::string path = "./test_recorder_roundtrip.vtdrec";
+    const size_t count = TouchRecorder::kBufferRecords * 3 + 17;
+
+    Config cfg = Config::getDefault();
+    cfg.deviceName = "Recorder Test";
+    cfg.screenWidth = 2560;
+    cfg.screenHeight = 1440;
+
+    std::vector<TouchPoint> written;
+    auto start = steady_clock::now();
+    {
+        TouchRecorder recorder(path, cfg, RecordType::UpsampledOutput);
+        check(recorder.isOpen(), "Recorder opens its file");
+        for (size_t i = 0; i < count; ++i) {
+            TouchPoint p{start + microseconds(8333 * i), static_cast<float>(i % 2560) + 0.25f,
+                         static_cast<float>(i % 1440), i % 50 != 49};
+            p.slot = static_cast<int>(i % 3);
+            p.contactId = static_cast<int>(i % 5) - 1;
+            recorder.record(p);
+            written.push_back(p);
+            if (i % 1000 == 0) {
+                std::this_thread::sleep_for(milliseconds(1));  // Give the writer time, as a real session does
+            }
+        }
+        recorder.close();
+        check(recorder.recordedCount() == count && recorder.droppedCount() == 0, "Every record accepted");
+    }
+
+    RecordingHeader header;
+    std::vector<TouchPoint> read;
+    check(loadTouchRecording(path, header, read), "Recording loads");
+    check(header.recordType == static_cast<uint32_t>(RecordType::UpsampledOutput) && header.screenWidth == 2560 &&
+              header.screenHeight == 1440 && std::string(header.deviceName) == "Recorder Test",
+          "Header carries the configuration");
+
+    bool same = read.size() == written.size();
+    for (size_t i = 0; same && i < read.size(); ++i) {
+        same = read[i].ts == written[i].ts && read[i].x == written[i].x && read[i].y == written[i].y &&
+               read[i].touching == written[i].touching && read[i].slot == written[i].slot &&
+               read[i].contactId == written[i].contactId;
+    }
+    check(same, "Records read back unchanged and in order");
+    std::remove(path.c_str());
+}
+
+// A quiet session still reaches the disk without waiting for a full buffer
+static void testPeriodicFlush() {
+    std::cout << "\n🧪 Periodic flush of a partial buffer" << std::endl;
+    const std::string path = "./test_recorder_flush.vtdrec";
+    TouchRecorder recorder(path, Config::getDefault(), RecordType::RawInput);
+    for (int i = 0; i < 10; ++i) {
+        recorder.record(TouchPoint{steady_clock::now(), 100.0f, 100.0f, true});
+    }
+    std::this_thread::sleep_for(milliseconds(TouchRecorder::kFlushIntervalMs * 2));
+    long expected = static_cast<long>(sizeof(RecordingHeader) + 10 * sizeof(TouchRecord));
+    check(fileSize(path) == expected, "Records are on disk while the recorder is open");
+    recorder.close();
+    std::remove(path.c_str());
+}
+
+static void testRejectsOtherFiles() {
+    std::cout << "\n🧪 Loading non-recordings" << std::endl;
+    const std::string path = "./test_recorder_text.vtdrec";
+    {
+        std::ofstream file(path);
+        file << "{ \"events\": [] }\n";
+    }
+    RecordingHeader header;
+    std::vector<TouchPoint> read;
+    check(!loadTouchRecording(path, header, read), "Text file is rejected");
+    check(!loadTouchRecording("./does_not_exist.vtdrec", header, read), "Missing file is rejected");
+    std::remove(path.c_str());
+}
+
+int main() {
+    std::cout << "🎯 Touch Recorder Test Suite" << std::endl;
+    std::cout << "============================" << std::endl;
+
+    testRoundTrip();
+    testPeriodicFlush();
+    testRejectsOtherFiles();
+
+    if (gFailures) {
+        std::cout << "\n❌ " << gFailures << " RECORDER CHECK(S) FAILED!" << std::endl;
+        return 1;
+    }
+    std::cout << "\n✅ ALL RECORDER TESTS PASSED!" << std::endl;
+    return 0;
+}
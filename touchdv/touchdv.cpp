@@ -398,8 +398,8 @@ int main(){
     cfg.deviceType = DeviceType::Mock;
     cfg.enableRawInputRecording = true;
     cfg.enableUpsampledRecording = true;
-    cfg.rawInputRecordPath = "./dump/raw_recording.json";
-    cfg.upsampledRecordPath = "./dump/upsampled_recording.json";
+    cfg.rawInputRecordPath = "./dump/raw_recording.vtdrec";
+    cfg.upsampledRecordPath = "./dump/upsampled_recording.vtdrec";
     cfg.screenWidth = 1920;
     cfg.screenHeight = 1080;
     cfg.deviceName = "IR Device";